@@ -60,6 +60,7 @@ CPUGenerator::CPUGenerator(uint64_t seed_in)
 void CPUGenerator::set_current_seed(uint64_t seed) {
   next_float_normal_sample_.reset();
   next_double_normal_sample_.reset();
+  philox_offset_ = 0;
   engine_ = mt19937(seed);
 }
 
@@ -159,6 +160,69 @@ void CPUGenerator::set_engine(at::mt19937 engine) {
   engine_ = engine;
 }
 
+/**
+ * Note [Philox mode of CPUGenerator]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * By default CPUGenerator draws from a single mt19937 stream, so kernels
+ * using it have to run serially while holding the generator lock.
+ *
+ * In philox mode, uniform_, normal_ and bernoulli_ (and hence dropout)
+ * use the counter based philox engine instead: the element at linear index
+ * i of the output is computed from philox_engine(seed, i, offset) alone, so
+ * these kernels run in parallel and give the same result whatever the
+ * number of threads. Every call reserves its offsets with
+ * philox_engine_inputs, which is the only step done under the lock. The seed
+ * is the current seed of the generator, and seeding it resets the offset.
+ *
+ * The mt19937 engine is left untouched by philox kernels, and the other
+ * random kernels keep using it in either mode.
+ */
+
+/**
+ * Returns whether uniform_, normal_ and bernoulli_ use the philox engine.
+ */
+bool CPUGenerator::philox_mode() const {
+  return philox_mode_;
+}
+
+/**
+ * Switches uniform_, normal_ and bernoulli_ to the philox engine
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+void CPUGenerator::set_philox_mode(bool enabled) {
+  philox_mode_ = enabled;
+}
+
+/**
+ * Gets the current offset of the philox engine
+ */
+uint64_t CPUGenerator::philox_offset() const {
+  return philox_offset_;
+}
+
+/**
+ * Sets the offset of the philox engine
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+void CPUGenerator::set_philox_offset(uint64_t offset) {
+  philox_offset_ = offset;
+}
+
+/**
+ * Gets the seed and offset to construct philox engines with, and advances
+ * the offset by increment, i.e. the number of 128 bit values drawn per
+ * subsequence by the caller.
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+std::pair<uint64_t, uint64_t> CPUGenerator::philox_engine_inputs(uint64_t increment) {
+  uint64_t offset = philox_offset_;
+  philox_offset_ += increment;
+  return std::make_pair(engine_.seed(), offset);
+}
+
 /**
  * Public clone method implementation
  * 
@@ -178,6 +242,8 @@ CPUGenerator* CPUGenerator::clone_impl() const {
   gen->set_engine(engine_);
   gen->set_next_float_normal_sample(next_float_normal_sample_);
   gen->set_next_double_normal_sample(next_double_normal_sample_);
+  gen->set_philox_mode(philox_mode_);
+  gen->set_philox_offset(philox_offset_);
   return gen;
 }
 
@@ -91,6 +91,10 @@ _(aten, _log2) \
 _(aten, _logspace) \
 _(aten, _lu_with_info) \
 _(aten, _masked_scale) \
+_(aten, _mkl_fft_clear_plan_cache) \
+_(aten, _mkl_fft_get_plan_cache_max_size) \
+_(aten, _mkl_fft_get_plan_cache_size) \
+_(aten, _mkl_fft_set_plan_cache_max_size) \
 _(aten, _mm) \
 _(aten, _mv) \
 _(aten, _nnz) \
@@ -20,58 +20,6 @@
 
 namespace c10 {
 
-namespace impl {
-/**
- * A KernelFunctionTable is a map from DispatchKey to a KernelFunction.
- * It can store zero or one KernelFunctions for each DispatchKey.
- */
-class KernelFunctionTable final {
-public:
-  explicit KernelFunctionTable()
-  : kernels_()
-  , kernelCount_(0) {}
-
-  enum class SetKernelResult : uint8_t {ADDED_NEW_KERNEL, OVERWROTE_EXISTING_KERNEL};
-  C10_NODISCARD SetKernelResult setKernel(DispatchKey dispatchKey, KernelFunction kernel) {
-    TORCH_INTERNAL_ASSERT(dispatchKey != DispatchKey::UndefinedTensorId);
-    auto& slot = kernels_[static_cast<uint8_t>(dispatchKey)];
-    SetKernelResult result;;
-    if (slot.isValid()) {
-      result = SetKernelResult::OVERWROTE_EXISTING_KERNEL;
-    } else {
-      result = SetKernelResult::ADDED_NEW_KERNEL;
-      ++kernelCount_;
-    }
-    slot = std::move(kernel);
-    return result;
-  }
-
-  enum class RemoveKernelIfExistsResult : uint8_t {REMOVED_KERNEL, KERNEL_DIDNT_EXIST};
-  RemoveKernelIfExistsResult removeKernelIfExists(DispatchKey dispatchKey) {
-    auto& slot = kernels_[static_cast<uint8_t>(dispatchKey)];
-    if (slot.isValid()) {
-      --kernelCount_;
-      slot = {};
-      return RemoveKernelIfExistsResult::REMOVED_KERNEL;
-    } else {
-      return RemoveKernelIfExistsResult::KERNEL_DIDNT_EXIST;
-    }
-  }
-
-  const KernelFunction& operator[](DispatchKey dispatchKey) const {
-    return kernels_[static_cast<uint8_t>(dispatchKey)];
-  }
-
-  size_t size() const {
-    return kernelCount_;
-  }
-
-private:
-  std::array<KernelFunction, static_cast<uint8_t>(DispatchKey::NumDispatchKeys)> kernels_;
-  size_t kernelCount_;
-};
-}
-
 /**
  * Per-operator dispatch table.
  *
@@ -85,20 +33,38 @@ class DispatchTable final {
  public:
   explicit DispatchTable(const FunctionSchema& schema)
   : kernels_()
-  , catchallKernel_()
+  , kernelCount_(0)
+  , catchallKernel_(nullptr)
+  , backendFallbackKernels_()
+  , dispatchTable_()
   , dispatchKeyExtractor_(DispatchKeyExtractor::make(schema))
-  , operatorName_(toString(schema.operator_name())) {}
+  , operatorName_(toString(schema.operator_name())) {
+    kernels_.fill(nullptr);
+    backendFallbackKernels_.fill(nullptr);
+    for (auto& slot : dispatchTable_) {
+      slot.store(nullptr, std::memory_order_relaxed);
+    }
+  }
 
   /**
    * Register a kernel in the table at some dispatch key.
+   * The kernel is not copied; it must not change and must stay alive as long
+   * as this table does, since calls that are already in flight may still be
+   * using it after it has been replaced or removed.
    * @param dispatch_key Dispatch key to define when this kernel is selected.
    * @param kernel Concrete kernel function implementation to register
    */
-  void setKernel(DispatchKey dispatchKey, KernelFunction kernel) {
-    auto result = kernels_.setKernel(dispatchKey, std::move(kernel));
-    if (result == impl::KernelFunctionTable::SetKernelResult::OVERWROTE_EXISTING_KERNEL) {
+  void setKernel(DispatchKey dispatchKey, const KernelFunction* kernel) {
+    TORCH_INTERNAL_ASSERT(dispatchKey != DispatchKey::UndefinedTensorId);
+    TORCH_INTERNAL_ASSERT(kernel != nullptr && kernel->isValid());
+    auto& slot = kernels_[static_cast<uint8_t>(dispatchKey)];
+    if (slot != nullptr) {
       TORCH_WARN("Registered a kernel for operator ", operatorName_, " with dispatch key ", toString(dispatchKey), " that overwrote a previously registered kernel with the same dispatch key for the same operator.");
+    } else {
+      ++kernelCount_;
     }
+    slot = kernel;
+    updateDispatchTable_(static_cast<uint8_t>(dispatchKey));
   }
 
   /**
@@ -107,7 +73,12 @@ class DispatchTable final {
    * @param dispatch_key Dispatch key to unregister.
    */
   void removeKernelIfExists(DispatchKey dispatchKey) {
-    kernels_.removeKernelIfExists(dispatchKey);
+    auto& slot = kernels_[static_cast<uint8_t>(dispatchKey)];
+    if (slot != nullptr) {
+      --kernelCount_;
+      slot = nullptr;
+      updateDispatchTable_(static_cast<uint8_t>(dispatchKey));
+    }
   }
 
   /**
@@ -115,24 +86,38 @@ class DispatchTable final {
    * independent of the inputs. An operator can have either
    * a catch-all kernel or a set of kernels with concrete
    * dispatch keys, not both.
+   * The same lifetime rules as for setKernel apply.
    */
-  void setCatchallKernel(KernelFunction kernel) {
-    if (catchallKernel_.isValid()) {
+  void setCatchallKernel(const KernelFunction* kernel) {
+    TORCH_INTERNAL_ASSERT(kernel != nullptr && kernel->isValid());
+    if (catchallKernel_ != nullptr) {
       TORCH_WARN("Registered a catch-all kernel for operator ", operatorName_," that overwrote a previously registered catch-all kernel for the same operator.");
     }
-    catchallKernel_ = std::move(kernel);
+    catchallKernel_ = kernel;
+    updateAllDispatchTable_();
   }
 
   /**
    * Remove the catch-all kernel.
    */
   void removeCatchallKernel() {
-    TORCH_INTERNAL_ASSERT(catchallKernel_.isValid(), "Tried to remove the catch-all kernel for operator ", operatorName_," but there is no catch-all kernel registered.");
-    catchallKernel_ = {};
+    TORCH_INTERNAL_ASSERT(catchallKernel_ != nullptr, "Tried to remove the catch-all kernel for operator ", operatorName_," but there is no catch-all kernel registered.");
+    catchallKernel_ = nullptr;
+    updateAllDispatchTable_();
+  }
+
+  /**
+   * Set (or with nullptr, clear) the dispatcher-wide fallback kernel for a
+   * dispatch key, which is used when this operator has no kernel of its own
+   * for that key. The same lifetime rules as for setKernel apply.
+   */
+  void setBackendFallbackKernel(DispatchKey dispatchKey, const KernelFunction* kernel) {
+    backendFallbackKernels_[static_cast<uint8_t>(dispatchKey)] = kernel;
+    updateDispatchTable_(static_cast<uint8_t>(dispatchKey));
   }
 
   bool isEmpty() const {
-    return !catchallKernel_.isValid() && kernels_.size() == 0;
+    return catchallKernel_ == nullptr && kernelCount_ == 0;
   }
 
   std::string listAllDispatchKeys() const {
@@ -140,8 +125,8 @@ class DispatchTable final {
     str << "[";
 
     bool has_kernels = false;
-    for (uint8_t iter = 0; iter != static_cast<uint8_t>(DispatchKey::NumDispatchKeys); ++iter) {
-      if (!kernels_[static_cast<DispatchKey>(iter)].isValid()) {
+    for (uint8_t iter = 0; iter != kNumDispatchKeys; ++iter) {
+      if (kernels_[iter] == nullptr) {
         continue;
       }
       if (has_kernels) {
@@ -151,7 +136,7 @@ class DispatchTable final {
       has_kernels = true;
     }
 
-    if (catchallKernel_.isValid()) {
+    if (catchallKernel_ != nullptr) {
       if (has_kernels) {
         str << ", ";
       }
@@ -161,21 +146,14 @@ class DispatchTable final {
     return str.str();
   }
 
-  const KernelFunction* lookup(DispatchKey dispatchKey) const {
-    auto& slot = kernels_[dispatchKey];
-    if (slot.isValid()) {
-      return &slot;
-    } else {
-      return nullptr;
-    }
-  }
-
-  const KernelFunction* lookupCatchallKernel() const {
-    if (!catchallKernel_.isValid()) {
-      return nullptr;
-    }
-
-    return &catchallKernel_;
+  /**
+   * The kernel to call for the given dispatch key (nullopt if the arguments
+   * had none), or nullptr if there is none. This already takes backend
+   * fallback and catch-all kernels into account.
+   */
+  const KernelFunction* lookup(c10::optional<DispatchKey> dispatchKey) const {
+    const uint8_t index = dispatchKey.has_value() ? static_cast<uint8_t>(*dispatchKey) : kNoDispatchKey;
+    return dispatchTable_[index].load(std::memory_order_acquire);
   }
 
   const DispatchKeyExtractor& dispatchKeyExtractor() const {
@@ -187,9 +165,45 @@ class DispatchTable final {
   }
 
 private:
+  static constexpr uint8_t kNumDispatchKeys = static_cast<uint8_t>(DispatchKey::NumDispatchKeys);
+  // Slot of dispatchTable_ used when the arguments have no dispatch key.
+  static constexpr uint8_t kNoDispatchKey = kNumDispatchKeys;
+
+  // Re-resolves dispatchTable_[index] from the registered kernels.
+  void updateDispatchTable_(uint8_t index) {
+    const KernelFunction* kernel = nullptr;
+    if (index != kNoDispatchKey) {
+      kernel = kernels_[index];
+      if (kernel == nullptr) {
+        kernel = backendFallbackKernels_[index];
+      }
+    }
+    if (kernel == nullptr) {
+      kernel = catchallKernel_;
+    }
+    dispatchTable_[index].store(kernel, std::memory_order_release);
+  }
+
+  void updateAllDispatchTable_() {
+    for (uint8_t index = 0; index <= kNoDispatchKey; ++index) {
+      updateDispatchTable_(index);
+    }
+  }
+
+  // Registered kernels, only touched by registration (which the caller
+  // serializes).
+  std::array<const KernelFunction*, kNumDispatchKeys> kernels_;
+  size_t kernelCount_;
+  const KernelFunction* catchallKernel_;
+  std::array<const KernelFunction*, kNumDispatchKeys> backendFallbackKernels_;
+
+  // The kernel each dispatch key resolves to, read on every call. Registration
+  // never modifies a KernelFunction in place; it only publishes a pointer to
+  // a new one here. A call therefore costs one load of this table and needs
+  // no lock or read-modify-write, and a concurrent registration can at worst
+  // make it see the kernel from just before the change.
+  std::array<std::atomic<const KernelFunction*>, kNumDispatchKeys + 1> dispatchTable_;
 
-  impl::KernelFunctionTable kernels_;
-  KernelFunction catchallKernel_;
   DispatchKeyExtractor dispatchKeyExtractor_;
   std::string operatorName_;
 };
@@ -73,6 +73,11 @@ OperatorHandle Dispatcher::findOrRegisterSchema_(FunctionSchema&& schema, Operat
   OperatorName op_name = schema.operator_name();
   operators_.emplace_back(std::move(schema), std::move(options));
   OperatorHandle handle(--operators_.end());
+  for (uint8_t key = 0; key != backendFallbackKernels_.size(); ++key) {
+    if (backendFallbackKernels_[key] != nullptr) {
+      handle.operatorIterator_->op.updateBackendFallbackKernel(static_cast<DispatchKey>(key), backendFallbackKernels_[key]);
+    }
+  }
   operatorLookupTable_.write([&] (ska::flat_hash_map<OperatorName, OperatorHandle>& operatorLookupTable) {
     operatorLookupTable.emplace(op_name, handle);
   });
@@ -122,8 +127,15 @@ void Dispatcher::deregisterSchema_(const OperatorHandle& op, const OperatorName&
 }
 
 RegistrationHandleRAII Dispatcher::registerBackendFallbackKernel(DispatchKey dispatchKey, KernelFunction kernel) {
-  auto inserted = backendFallbackKernels_.setKernel(dispatchKey, std::move(kernel));
-  TORCH_CHECK(inserted == impl::KernelFunctionTable::SetKernelResult::ADDED_NEW_KERNEL, "Tried to register a backend fallback kernel for ", dispatchKey, " but there was already one registered.");
+  // we need a lock to avoid concurrent writes and to keep operators_ stable
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto& slot = backendFallbackKernels_[static_cast<uint8_t>(dispatchKey)];
+  TORCH_CHECK(slot == nullptr, "Tried to register a backend fallback kernel for ", dispatchKey, " but there was already one registered.");
+  slot = std::make_shared<const KernelFunction>(std::move(kernel));
+  for (auto& op : operators_) {
+    op.op.updateBackendFallbackKernel(dispatchKey, slot);
+  }
 
   return RegistrationHandleRAII([this, dispatchKey] {
     deregisterBackendFallbackKernel_(dispatchKey);
@@ -131,8 +143,14 @@ RegistrationHandleRAII Dispatcher::registerBackendFallbackKernel(DispatchKey dis
 }
 
 void Dispatcher::deregisterBackendFallbackKernel_(DispatchKey dispatchKey) {
-  auto result = backendFallbackKernels_.removeKernelIfExists(dispatchKey);
-  TORCH_INTERNAL_ASSERT(result == impl::KernelFunctionTable::RemoveKernelIfExistsResult::REMOVED_KERNEL, "Tried to deregister a backend fallback kernel for ", dispatchKey, " but there was none registered.");
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto& slot = backendFallbackKernels_[static_cast<uint8_t>(dispatchKey)];
+  TORCH_INTERNAL_ASSERT(slot != nullptr, "Tried to deregister a backend fallback kernel for ", dispatchKey, " but there was none registered.");
+  slot = nullptr;
+  for (auto& op : operators_) {
+    op.op.updateBackendFallbackKernel(dispatchKey, nullptr);
+  }
 }
 
 RegistrationHandleRAII Dispatcher::registerKernel(const OperatorHandle& op, DispatchKey dispatch_key, KernelFunction kernel) {
@@ -145,6 +163,22 @@ RegistrationHandleRAII Dispatcher::registerCatchallKernel(const OperatorHandle&
   return op.operatorIterator_->op.registerCatchallKernel(std::move(kernel));
 }
 
+void Dispatcher::reportMissingKernel_(const DispatchTable& dispatchTable, c10::optional<DispatchKey> dispatchKey) const {
+  if (!dispatchKey.has_value() || *dispatchKey == DispatchKey::UndefinedTensorId) {
+    TORCH_CHECK(false,
+          "There were no tensor arguments to this function (e.g., you passed an "
+          "empty list of Tensors), but no fallback function is registered for schema ", dispatchTable.operatorName(),
+          ".  This usually means that this function requires a non-empty list of Tensors.  "
+          "Available functions are ", dispatchTable.listAllDispatchKeys())
+  }
+
+  const std::string dispatchKeyStr = toString(*dispatchKey);
+  TORCH_CHECK(false, "Could not run '", dispatchTable.operatorName(), "' with arguments",
+          " from the '", dispatchKeyStr, "' backend. '",
+          dispatchTable.operatorName(), "' is only available for these backends: ",
+          dispatchTable.listAllDispatchKeys(), ".");
+}
+
 void Dispatcher::addRegistrationListener(std::unique_ptr<OpRegistrationListener> listener) {
   std::lock_guard<std::mutex> lock(mutex_);
 
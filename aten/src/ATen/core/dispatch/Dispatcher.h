@@ -121,10 +121,14 @@ private:
   void deregisterBackendFallbackKernel_(DispatchKey dispatchKey);
 
   const KernelFunction& dispatch_(const DispatchTable& dispatchTable, c10::optional<DispatchKey> dispatch_key) const;
+  [[noreturn]] void reportMissingKernel_(const DispatchTable& dispatchTable, c10::optional<DispatchKey> dispatch_key) const;
 
   std::list<OperatorDef> operators_;
   LeftRight<ska::flat_hash_map<OperatorName, OperatorHandle>> operatorLookupTable_;
-  impl::KernelFunctionTable backendFallbackKernels_;
+  // Backend fallback kernels are shared with every operator's dispatch table.
+  // Operators keep a deregistered fallback kernel alive, like their own
+  // deregistered kernels, until their schema is deregistered.
+  std::array<std::shared_ptr<const KernelFunction>, static_cast<uint8_t>(DispatchKey::NumDispatchKeys)> backendFallbackKernels_;
   std::unique_ptr<detail::RegistrationListenerList> listeners_;
   std::mutex mutex_;
 };
@@ -188,38 +192,11 @@ inline void Dispatcher::callBoxed(const OperatorHandle& op, Stack* stack) const
 }
 
 inline const KernelFunction& Dispatcher::dispatch_(const DispatchTable& dispatchTable, c10::optional<DispatchKey> dispatchKey) const {
-  if (C10_LIKELY(dispatchKey.has_value())) {
-
-    const KernelFunction* backendKernel = dispatchTable.lookup(*dispatchKey);
-
-    if (nullptr != backendKernel) {
-      return *backendKernel;
-    }
-
-    const auto& backendFallbackKernel = backendFallbackKernels_[*dispatchKey];
-    if (backendFallbackKernel.isValid()) {
-      return backendFallbackKernel;
-    }
-  }
-
-  const KernelFunction* catchallKernel = dispatchTable.lookupCatchallKernel();
-  if (C10_LIKELY(nullptr != catchallKernel)) {
-    return *catchallKernel;
-  }
-
-  if (!dispatchKey.has_value() || *dispatchKey == DispatchKey::UndefinedTensorId) {
-    TORCH_CHECK(false,
-          "There were no tensor arguments to this function (e.g., you passed an "
-          "empty list of Tensors), but no fallback function is registered for schema ", dispatchTable.operatorName(),
-          ".  This usually means that this function requires a non-empty list of Tensors.  "
-          "Available functions are ", dispatchTable.listAllDispatchKeys())
+  const KernelFunction* kernel = dispatchTable.lookup(dispatchKey);
+  if (C10_LIKELY(nullptr != kernel)) {
+    return *kernel;
   }
-
-  const std::string dispatchKeyStr = toString(*dispatchKey);
-  TORCH_CHECK(false, "Could not run '", dispatchTable.operatorName(), "' with arguments",
-          " from the '", dispatchKeyStr, "' backend. '",
-          dispatchTable.operatorName(), "' is only available for these backends: ",
-          dispatchTable.listAllDispatchKeys(), ".");
+  reportMissingKernel_(dispatchTable, dispatchKey);
 }
 
 } // namespace c10
@@ -22,6 +22,9 @@ OperatorEntry::OperatorEntry(FunctionSchema&& schema, OperatorOptions&& options)
 , dispatchTable_(schema_)
 , kernels_()
 , catchAllKernels_()
+, backendFallbackKernels_()
+, retiredKernels_()
+, retiredBackendFallbackKernels_()
 , options_(std::move(options)) {
 }
 
@@ -31,6 +34,12 @@ void OperatorEntry::prepareForDeregistration() {
   }
   TORCH_INTERNAL_ASSERT(kernels_.size() == 0, "If the dispatch table is empty, then the invariant says there can't be any kernels but we still have kernels for dispatch keys ", listAllDispatchKeys(kernels_), ". The operator schema is ", toString(schema_));
   TORCH_INTERNAL_ASSERT(catchAllKernels_.size() == 0, "If the dispatch table is empty, then the invariant says there can't be any kernels but we still have catch-all kernel. The operator schema is ", toString(schema_));
+
+  // Nothing can call the operator anymore, so the kernels retired over its
+  // lifetime can go.
+  std::unique_lock<std::mutex> lock(kernelsMutex_);
+  retiredKernels_.clear();
+  retiredBackendFallbackKernels_.clear();
 }
 
 RegistrationHandleRAII OperatorEntry::registerKernel(DispatchKey dispatch_key, KernelFunction kernel) {
@@ -70,13 +79,24 @@ RegistrationHandleRAII OperatorEntry::registerCatchallKernel(KernelFunction kern
   });
 }
 
+void OperatorEntry::updateBackendFallbackKernel(DispatchKey dispatch_key, std::shared_ptr<const KernelFunction> kernel) {
+  std::unique_lock<std::mutex> lock(kernelsMutex_);
+
+  dispatchTable_.setBackendFallbackKernel(dispatch_key, kernel.get());
+  auto& slot = backendFallbackKernels_[static_cast<uint8_t>(dispatch_key)];
+  if (slot != nullptr) {
+    retiredBackendFallbackKernels_.push_back(std::move(slot));
+  }
+  slot = std::move(kernel);
+}
+
 void OperatorEntry::deregisterKernel_(DispatchKey dispatch_key, std::list<KernelFunction>::iterator kernel) {
   std::unique_lock<std::mutex> lock(kernelsMutex_);
 
   auto found = kernels_.find(dispatch_key);
   TORCH_INTERNAL_ASSERT(found != kernels_.end(), "Tried to deregister a kernel for dispatch key ", toString(dispatch_key), " but there are no kernels registered for this dispatch key. The operator schema is ", toString(schema_));
   auto& k = found->second;
-  k.erase(kernel);
+  retiredKernels_.splice(retiredKernels_.end(), k, kernel);
   if (k.empty()) {
     // the invariant says we don't want empty lists but instead remove the list from the map
     kernels_.erase(found);
@@ -88,7 +108,7 @@ void OperatorEntry::deregisterKernel_(DispatchKey dispatch_key, std::list<Kernel
 void OperatorEntry::deregisterCatchallKernel_(std::list<KernelFunction>::iterator kernel) {
   std::unique_lock<std::mutex> lock(kernelsMutex_);
 
-  catchAllKernels_.erase(kernel);
+  retiredKernels_.splice(retiredKernels_.end(), catchAllKernels_, kernel);
 
   updateCatchallDispatchTable_();
 }
@@ -101,7 +121,7 @@ void OperatorEntry::updateDispatchTable_(DispatchKey dispatch_key) {
   if (k == kernels_.end()) {
     dispatchTable_.removeKernelIfExists(dispatch_key);
   } else {
-    dispatchTable_.setKernel(dispatch_key, k->second.front());
+    dispatchTable_.setKernel(dispatch_key, &k->second.front());
   }
 }
 
@@ -111,7 +131,7 @@ void OperatorEntry::updateCatchallDispatchTable_() {
   if (catchAllKernels_.size() == 0) {
     dispatchTable_.removeCatchallKernel();
   } else {
-    dispatchTable_.setCatchallKernel(catchAllKernels_.front());
+    dispatchTable_.setCatchallKernel(&catchAllKernels_.front());
   }
 }
 
@@ -4,6 +4,8 @@
 #include <ATen/core/dispatch/OperatorOptions.h>
 #include <ATen/core/dispatch/RegistrationHandleRAII.h>
 #include <list>
+#include <memory>
+#include <vector>
 
 namespace c10 {
 namespace impl {
@@ -36,6 +38,10 @@ public:
   RegistrationHandleRAII registerKernel(DispatchKey dispatch_key, KernelFunction kernel);
   RegistrationHandleRAII registerCatchallKernel(KernelFunction kernel);
 
+  // Called by the Dispatcher when a backend fallback kernel is registered or
+  // deregistered, with nullptr for the latter.
+  void updateBackendFallbackKernel(DispatchKey dispatch_key, std::shared_ptr<const KernelFunction> kernel);
+
   const OperatorOptions& options() {
     return options_;
   }
@@ -88,6 +94,20 @@ private:
   ska::flat_hash_map<DispatchKey, std::list<KernelFunction>> kernels_;
   std::list<KernelFunction> catchAllKernels_;
 
+  // The backend fallback kernels the Dispatcher gave us. The dispatch table
+  // points to them, so we share their ownership.
+  std::array<std::shared_ptr<const KernelFunction>, static_cast<uint8_t>(DispatchKey::NumDispatchKeys)> backendFallbackKernels_;
+
+  // dispatchTable_ points into the lists above, and a call may still be
+  // running a kernel when it is deregistered. Deregistered kernels and
+  // backend fallback kernels are therefore moved here instead of being
+  // destroyed, which keeps every pointer the dispatch table handed out valid
+  // for as long as the operator exists. They are freed when its schema is
+  // deregistered, since calling an operator while it is being removed isn't
+  // allowed anyway.
+  std::list<KernelFunction> retiredKernels_;
+  std::vector<std::shared_ptr<const KernelFunction>> retiredBackendFallbackKernels_;
+
   // Some metadata about the operator
   OperatorOptions options_;
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <c10/core/InferenceMode.h>
 #include <c10/macros/Macros.h>
 
 namespace at {
@@ -27,4 +28,21 @@ struct CAFFE2_API NoGradGuard : public AutoGradMode {
   NoGradGuard() : AutoGradMode(/*enabled=*/false) {}
 };
 
+// A RAII, thread local (!) guard that enables or disables inference mode upon
+// construction, and sets it back to the original value upon destruction.
+// Enabling inference mode also disables grad mode.
+// See NOTE [ Inference Mode ].
+struct CAFFE2_API AutoInferenceMode {
+  AutoInferenceMode(bool enabled = true)
+      : prev_mode(c10::InferenceMode::is_enabled()),
+        grad_mode(!enabled && GradMode::is_enabled()) {
+    c10::InferenceMode::set_enabled(enabled);
+  }
+  ~AutoInferenceMode() {
+    c10::InferenceMode::set_enabled(prev_mode);
+  }
+  bool prev_mode;
+  AutoGradMode grad_mode;
+};
+
 }
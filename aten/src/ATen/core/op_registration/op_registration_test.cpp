@@ -285,6 +285,28 @@ TEST(OperatorRegistrationTest, givenOpWithoutKernels_whenRegisteringKernelAfterw
   " backend. '_test::dummy' is only available for these backends: [].");
 }
 
+struct KernelWithResource final : OperatorKernel {
+  explicit KernelWithResource(std::shared_ptr<int> resource): resource_(std::move(resource)) {}
+
+  void operator()(Tensor) {}
+private:
+  std::shared_ptr<int> resource_;
+};
+
+TEST(OperatorRegistrationTest, givenOpWithKernelOutOfScope_whenSchemaIsDeregistered_thenKernelIsDestroyed) {
+  auto resource = std::make_shared<int>(0);
+  std::weak_ptr<int> weak_resource = resource;
+  {
+    auto registrar1 = c10::RegisterOperators().op("_test::dummy(Tensor dummy) -> ()");
+    {
+      auto registrar2 = c10::RegisterOperators().op("_test::dummy(Tensor dummy) -> ()", c10::RegisterOperators::options().kernel<KernelWithResource>(c10::DispatchKey::CPUTensorId, std::move(resource)));
+    }
+    // calls that are still running may use the deregistered kernel
+    EXPECT_FALSE(weak_resource.expired());
+  }
+  EXPECT_TRUE(weak_resource.expired());
+}
+
 TEST(OperatorRegistrationTest, givenOpWithoutKernelsWithoutTensorInputs_whenRegistering_thenRegisters) {
   // as long as we don't register non-catchall kernels, ops without tensor arguments are fine
   auto registrar = c10::RegisterOperators().op("_test::dummy() -> ()");
@@ -5,12 +5,15 @@
 #include <ATen/ExpandUtils.h>
 #include <ATen/native/Distance.h>
 
+#include <limits>
+
 namespace at { namespace native {
 
 DEFINE_DISPATCH(pdist_forward_stub);
 DEFINE_DISPATCH(pdist_backward_stub);
 DEFINE_DISPATCH(cdist_stub);
 DEFINE_DISPATCH(cdist_backward_stub);
+DEFINE_DISPATCH(cdist_topk_merge_stub);
 
 Tensor pairwise_distance(const Tensor& x1, const Tensor& x2, double p, double eps, bool keepdim) {
   return at::norm(x1 - x2 + eps, p, 1, keepdim);
@@ -25,16 +28,70 @@ Tensor pdist(const Tensor& self, const double p) {
   return at::_pdist_forward(self.contiguous(), p);
 }
 
+// Squared euclidean distance via ||a||^2 + ||b||^2 - 2 <a, b>, so that the bulk
+// of the work goes through a single (batched) GEMM. x1_norm is [..., r1, 1] and
+// x2_norm is [..., 1, r2]; both are expected to be computed from the same
+// (possibly centered) x1 and x2 that are passed in.
+//
+// The expansion suffers from catastrophic cancellation when two rows are much
+// closer to each other than to the origin. On CPU, entries that are small
+// relative to the norms they were computed from are recomputed exactly from
+// the difference of the two rows. Finding them would cost a device-to-host
+// sync on CUDA, where the centering done by callers has to do. The number of
+// exact recomputes is capped at one per input row; past that (e.g. for heavily
+// clustered data) false is returned and the caller should use the direct
+// kernel instead.
+static bool euclidean_dist_sq(const Tensor& x1, const Tensor& x2, const Tensor& x1_norm, const Tensor& x2_norm, Tensor& result) {
+  result = at::matmul(x1, x2.transpose(-2, -1)).mul_(-2).add_(x1_norm).add_(x2_norm);
+  if (result.device().type() != kCPU) {
+    result.clamp_min_(0);
+    return true;
+  }
+
+  const double tol = std::sqrt(x1.scalar_type() == kDouble ?
+      std::numeric_limits<double>::epsilon() : std::numeric_limits<float>::epsilon());
+  Tensor suspect_mask = at::le(result, (x1_norm + x2_norm).mul_(tol));
+  int64_t num_suspects = suspect_mask.sum().item<int64_t>();
+  if (num_suspects > 0) {
+    int64_t max_suspects = (result.numel() / (result.size(-2) * result.size(-1))) *
+                           (result.size(-2) + result.size(-1));
+    if (num_suspects > max_suspects) {
+      return false;
+    }
+    Tensor suspect = suspect_mask.nonzero();
+    // x1 and x2 may have fewer (broadcast) batch dims than result
+    auto batch = result.sizes().slice(0, result.dim() - 2);
+    std::vector<int64_t> x1_size(batch.begin(), batch.end());
+    x1_size.insert(x1_size.end(), {x1.size(-2), x1.size(-1)});
+    std::vector<int64_t> x2_size(batch.begin(), batch.end());
+    x2_size.insert(x2_size.end(), {x2.size(-2), x2.size(-1)});
+
+    std::vector<Tensor> idx = suspect.unbind(1);
+    std::vector<Tensor> idx1(idx.begin(), idx.end() - 1);
+    std::vector<Tensor> idx2(idx.begin(), idx.end() - 2);
+    idx2.push_back(idx.back());
+    Tensor exact = (x1.expand(x1_size).index(idx1) - x2.expand(x2_size).index(idx2)).pow_(2).sum(-1);
+    result.index_put_(idx, exact);
+  }
+  result.clamp_min_(0);
+  return true;
+}
+
+// Returns an undefined tensor if the direct kernel has to be used instead, see
+// euclidean_dist_sq.
 Tensor euclidean_dist_out(const Tensor& x1, const Tensor& x2) {
-  Tensor x1_norm = x1.pow(2).sum(-1, true);
-  Tensor x1_pad = at::ones_like(x1_norm, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
-  Tensor x2_norm = x2.pow(2).sum(-1, true);
-  Tensor x2_pad = at::ones_like(x2_norm, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
-  Tensor x1_ = at::cat({x1.mul(-2), x1_norm, x1_pad}, -1);
-  Tensor x2_ = at::cat({x2, x2_pad, x2_norm}, -1);
-  Tensor result = x1_.matmul(x2_.transpose(-2, -1));
-  result.clamp_min_(0).sqrt_();
-  return result;
+  // Distances are translation invariant; centering both sets on the mean of x2
+  // keeps the norms (and with them the cancellation error) small.
+  Tensor mean = x2.mean(-2, true);
+  Tensor x1_c = x1 - mean;
+  Tensor x2_c = x2 - mean;
+  Tensor x1_norm = x1_c.pow(2).sum(-1, true);
+  Tensor x2_norm = x2_c.pow(2).sum(-1, true).transpose(-2, -1);
+  Tensor result;
+  if (!euclidean_dist_sq(x1_c, x2_c, x1_norm, x2_norm, result)) {
+    return Tensor();
+  }
+  return result.sqrt_();
 }
 
 static Tensor cdist_impl(const Tensor& x1, const Tensor& x2, const double p, c10::optional<int64_t> compute_mode) {
@@ -89,8 +146,11 @@ static Tensor cdist_impl(const Tensor& x1, const Tensor& x2, const double p, c10
   } else if (p == 2 && (mode == 1 || (mode == 0 && (r1 > 25 || r2 > 25)))) {
     Tensor dist = (expand_batch_product == 1) ? euclidean_dist_out(x1, x2) :
                   euclidean_dist_out(tensor1_expanded, tensor2_expanded);
-    result = dist.view(output_shape);
-  } else {
+    if (dist.defined()) {
+      result = dist.view(output_shape);
+    }
+  }
+  if (!result.defined()) {
     result = at::empty(output_shape, x1.options());
     cdist_stub(device1, result, tensor1_expanded, tensor2_expanded, p);
   }
@@ -128,6 +188,98 @@ Tensor _cdist_backward(const Tensor& grad, const Tensor& x1, const Tensor& x2, c
   return grad_x1;
 }
 
+// Streams over blocks of x2, merging each block of distances into a running
+// per-row top-k, so that at most a kTopkQueryBlock x kTopkKeyBlock tile of the
+// distance matrix is alive at any time.
+std::tuple<Tensor, Tensor> _cdist_topk_cpu(const Tensor& x1, const Tensor& x2, int64_t k, const double p, bool largest) {
+  constexpr int64_t kTopkQueryBlock = 512;
+  constexpr int64_t kTopkKeyBlock = 4096;
+
+  TORCH_CHECK(x1.dim() >= 2, "_cdist_topk only supports at least 2D tensors, X1 got: ", x1.dim(), "D");
+  TORCH_CHECK(x2.dim() >= 2, "_cdist_topk only supports at least 2D tensors, X2 got: ", x2.dim(), "D");
+  TORCH_CHECK(x1.size(-1) == x2.size(-1), "X1 and X2 must have the same number of columns. X1: ", x1.size(-1), " X2: ", x2.size(-1));
+  TORCH_CHECK(at::isFloatingType(x1.scalar_type()), "_cdist_topk only supports floating-point dtypes, X1 got: ", x1.scalar_type());
+  TORCH_CHECK(x1.scalar_type() == x2.scalar_type(), "X1 and X2 must have the same dtype. X1: ", x1.scalar_type(), " X2: ", x2.scalar_type());
+  TORCH_CHECK(p >= 0, "_cdist_topk only supports non-negative p values");
+  int64_t r1 = x1.size(-2);
+  int64_t r2 = x2.size(-2);
+  int64_t c = x1.size(-1);
+  TORCH_CHECK(k >= 0 && k <= r2, "_cdist_topk: k (", k, ") must be in the range [0, ", r2, "]");
+
+  IntArrayRef batch_tensor1(x1.sizes().data(), x1.dim() - 2);
+  IntArrayRef batch_tensor2(x2.sizes().data(), x2.dim() - 2);
+  std::vector<int64_t> expand_batch_portion = infer_size(batch_tensor1, batch_tensor2);
+  std::vector<int64_t> tensor1_expand_size(expand_batch_portion);
+  tensor1_expand_size.insert(tensor1_expand_size.end(), {r1, c});
+  std::vector<int64_t> tensor2_expand_size(expand_batch_portion);
+  tensor2_expand_size.insert(tensor2_expand_size.end(), {r2, c});
+  int64_t expand_batch_product = std::accumulate(expand_batch_portion.begin(), expand_batch_portion.end(), 1, std::multiplies<int64_t>());
+  Tensor tensor1_expanded = x1.expand(tensor1_expand_size).contiguous().view({expand_batch_product, r1, c});
+  Tensor tensor2_expanded = x2.expand(tensor2_expand_size).contiguous().view({expand_batch_product, r2, c});
+
+  std::vector<int64_t> output_shape(expand_batch_portion);
+  output_shape.insert(output_shape.end(), {r1, k});
+  Tensor values = at::empty({expand_batch_product, r1, k}, x1.options());
+  Tensor indices = at::empty({expand_batch_product, r1, k}, x1.options().dtype(kLong));
+  if (values.numel() == 0) {
+    return std::make_tuple(values.view(output_shape), indices.view(output_shape));
+  }
+
+  // For p = 2 the selection is done on squared distances; the square root is
+  // only taken of the k winners.
+  const bool use_mm = p == 2 && c > 0;
+  for (int64_t b = 0; b < expand_batch_product; b++) {
+    Tensor queries = tensor1_expanded[b];
+    Tensor keys = tensor2_expanded[b];
+    Tensor queries_norm, keys_norm;
+    if (use_mm) {
+      Tensor mean = keys.mean(0, true);
+      queries = queries - mean;
+      keys = keys - mean;
+      queries_norm = queries.pow(2).sum(-1, true);
+      keys_norm = keys.pow(2).sum(-1, true).t();
+    }
+    Tensor values_b = values[b];
+    Tensor indices_b = indices[b];
+
+    for (int64_t q0 = 0; q0 < r1; q0 += kTopkQueryBlock) {
+      int64_t qn = std::min(kTopkQueryBlock, r1 - q0);
+      Tensor query_block = queries.narrow(0, q0, qn);
+      Tensor values_block = values_b.narrow(0, q0, qn);
+      Tensor indices_block = indices_b.narrow(0, q0, qn);
+      int64_t filled = 0;
+
+      for (int64_t k0 = 0; k0 < r2; k0 += kTopkKeyBlock) {
+        int64_t kn = std::min(kTopkKeyBlock, r2 - k0);
+        Tensor key_block = keys.narrow(0, k0, kn);
+        Tensor dist;
+        if (c == 0) {
+          dist = at::zeros({qn, kn}, x1.options());
+        } else if (!use_mm ||
+                   !euclidean_dist_sq(query_block, key_block,
+                                      queries_norm.narrow(0, q0, qn), keys_norm.narrow(1, k0, kn), dist)) {
+          dist = at::empty({1, qn, kn}, x1.options());
+          cdist_stub(kCPU, dist, query_block.unsqueeze(0), key_block.unsqueeze(0), p);
+          dist = dist[0];
+          if (use_mm) {
+            dist.pow_(2);
+          }
+        }
+        cdist_topk_merge_stub(kCPU, values_block, indices_block, dist.contiguous(), k0, filled, largest);
+        filled = std::min(k, filled + kn);
+      }
+    }
+  }
+
+  if (use_mm) {
+    values.sqrt_();
+  }
+  Tensor sorted_values, order;
+  std::tie(sorted_values, order) = values.sort(-1, largest);
+  indices = indices.gather(-1, order);
+  return std::make_tuple(sorted_values.view(output_shape), indices.view(output_shape));
+}
+
 Tensor _pdist_forward(const Tensor& self, const double p) {
   TORCH_CHECK(self.is_contiguous(), "_pdist_forward requires contiguous input");
   auto device = self.device().type();
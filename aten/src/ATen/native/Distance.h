@@ -9,10 +9,15 @@ using pdist_forward_fn = void(*)(Tensor&, const Tensor&, const double p);
 using pdist_backward_fn = void(*)(Tensor&, const Tensor&, const Tensor&, const double p, const Tensor&);
 using cdist_fn = void(*)(Tensor&, const Tensor&, const Tensor&, const double p);
 using cdist_backward_fn = void(*)(Tensor&, const Tensor&, const Tensor&, const Tensor&, const double p, const Tensor&);
+// Merges a [rows, n] block of distances whose first column is key `offset`
+// into per-row heaps of the k best (values, indices) seen so far, of which
+// the first `filled` entries are valid.
+using cdist_topk_merge_fn = void(*)(Tensor& values, Tensor& indices, const Tensor& dist, int64_t offset, int64_t filled, bool largest);
 
 DECLARE_DISPATCH(pdist_forward_fn, pdist_forward_stub);
 DECLARE_DISPATCH(pdist_backward_fn, pdist_backward_stub);
 DECLARE_DISPATCH(cdist_fn, cdist_stub);
 DECLARE_DISPATCH(cdist_backward_fn, cdist_backward_stub);
+DECLARE_DISPATCH(cdist_topk_merge_fn, cdist_topk_merge_stub);
 
 }} // namespace at::native
@@ -1,6 +1,7 @@
 #include <ATen/ATen.h>
 #include <ATen/CPUApplyUtils.h>
 #include <ATen/Config.h>
+#include <ATen/LegacyTHFunctionsCPU.h>
 #include <ATen/Dispatch.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/NativeFunctions.h>
@@ -116,6 +117,9 @@ DEFINE_DISPATCH(bernoulli_mkl_stub);
 DEFINE_DISPATCH(cauchy_stub);
 DEFINE_DISPATCH(multinomial_stub);
 DEFINE_DISPATCH(geometric_stub);
+DEFINE_DISPATCH(uniform_philox_stub);
+DEFINE_DISPATCH(normal_philox_stub);
+DEFINE_DISPATCH(bernoulli_scalar_philox_stub);
 
 Tensor bernoulli(const Tensor& self, Generator* gen) {
   return at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT).bernoulli_(self, gen);
@@ -165,6 +169,12 @@ Tensor& bernoulli_tensor_cpu_(Tensor& self, const Tensor& p_, Generator* gen) {
 
 Tensor& bernoulli_scalar_cpu_(Tensor& self, double p, Generator* gen) {
   TORCH_CHECK(0 <= p && p <= 1, "bernoulli_ expects p to be in [0, 1], but got p=", p);
+  CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
+  if (generator->philox_mode()) {
+    auto iter = TensorIterator::nullary_op(self);
+    bernoulli_scalar_philox_stub(iter.device_type(), iter, p, generator);
+    return self;
+  }
 #if AT_MKL_ENABLED()
   if (cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
     bernoulli_mkl_stub(kCPU, self, p, gen);
@@ -172,7 +182,6 @@ Tensor& bernoulli_scalar_cpu_(Tensor& self, double p, Generator* gen) {
   }
 #endif
   AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, self.scalar_type(), "bernoulli_scalar_cpu_", [&] {
-    CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
     // See Note [Acquire lock when using random generators]
     std::lock_guard<std::mutex> lock(generator->mutex_);
     CPU_tensor_apply1<scalar_t>(
@@ -184,6 +193,29 @@ Tensor& bernoulli_scalar_cpu_(Tensor& self, double p, Generator* gen) {
   return self;
 }
 
+Tensor& uniform_cpu_(Tensor& self, double from, double to, Generator* gen) {
+  CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
+  if (!generator->philox_mode()) {
+    return legacy::cpu::_th_uniform_(self, from, to, gen);
+  }
+  TORCH_CHECK(from <= to,
+    "uniform_ expects to return a [from, to) range, but found from=", from,
+    " > to=", to);
+  auto iter = TensorIterator::nullary_op(self);
+  uniform_philox_stub(iter.device_type(), iter, from, to, generator);
+  return self;
+}
+
+Tensor& normal_cpu_(Tensor& self, double mean, double std, Generator* gen) {
+  CPUGenerator* generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
+  if (!generator->philox_mode()) {
+    return legacy::cpu::_th_normal_(self, mean, std, gen);
+  }
+  TORCH_CHECK(std > 0.0, "normal_ expects std > 0.0, but found std=", std);
+  auto iter = TensorIterator::nullary_op(self);
+  normal_philox_stub(iter.device_type(), iter, mean, std, generator);
+  return self;
+}
 
 Tensor& cauchy_(Tensor& self, double median, double sigma, Generator* gen) {
   auto iter = TensorIterator::nullary_op(self);
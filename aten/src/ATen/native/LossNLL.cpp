@@ -3,6 +3,7 @@
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
 #include <ATen/TensorUtils.h>
+#include <ATen/native/cpu/SoftmaxKernel.h>
 
 namespace at {
 namespace native {
@@ -393,5 +394,164 @@ Tensor nll_loss_backward_cpu(
   return grad_input;
 }
 
+Tensor _log_softmax_nll_loss(
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t reduction,
+    int64_t ignore_index) {
+  // The fused kernel only exists for dense CPU tensors; every other backend
+  // goes through log_softmax and nll_loss.
+  if (self.device().type() != at::kCPU || self.layout() != at::kStrided ||
+      self.dim() != 2 || target.dim() != 1 ||
+      self.size(0) != target.size(0)) {
+    return at::nll_loss(
+        at::log_softmax(self, 1), target, weight, reduction, ignore_index);
+  }
+  return std::get<0>(at::_log_softmax_nll_loss_forward(
+      self, target, weight, reduction, ignore_index));
+}
+
+// nll_loss(log_softmax(self, 1), ...) without materializing the
+// log-probabilities. logsumexp holds the normalizer of every row, which is
+// all the backward pass needs to recompute the softmax.
+std::tuple<Tensor, Tensor, Tensor> log_softmax_nll_loss_forward_cpu(
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t reduction,
+    int64_t ignore_index) {
+  TORCH_CHECK(self.dim() == 2, "input tensor should be 2D");
+  TORCH_CHECK(
+      target.dim() == 1,
+      "1D target tensor expected, multi-target not supported");
+  TORCH_CHECK(
+      self.size(0) == target.size(0),
+      "size mismatch (got input: ",
+      self.sizes(),
+      ", target: ",
+      target.sizes(),
+      ")");
+  const auto n_classes = self.size(1);
+  TORCH_CHECK(
+      !weight.defined() || weight.numel() == n_classes,
+      "weight tensor should be defined either for all ",
+      n_classes,
+      " classes or no classes"
+      " but got weight tensor of shape: ",
+      weight.sizes());
+
+  auto input = self.contiguous();
+  auto target_contiguous = target.contiguous();
+  auto weight_contiguous = optional_contiguous(weight);
+  const auto batch_size = input.size(0);
+
+  // BFloat16 losses and normalizers are accumulated in float, as
+  // log_softmax and nll_loss do.
+  auto acc_options = input.options().dtype(
+      input.scalar_type() == kBFloat16 ? kFloat : input.scalar_type());
+  Tensor losses = at::empty({batch_size}, acc_options);
+  Tensor row_weight = at::empty({batch_size}, acc_options);
+  Tensor logsumexp = at::empty({batch_size}, acc_options);
+  if (batch_size > 0) {
+    TORCH_CHECK(n_classes > 0, "input tensor should have at least one class");
+    log_softmax_nll_loss_kernel(
+        kCPU,
+        losses,
+        row_weight,
+        logsumexp,
+        input,
+        target_contiguous,
+        weight_contiguous,
+        ignore_index);
+  }
+
+  if (reduction == Reduction::None) {
+    return std::make_tuple(
+        losses.to(input.scalar_type()),
+        at::zeros({}, input.options()),
+        logsumexp);
+  }
+  Tensor total_weight = row_weight.sum();
+  Tensor output = losses.sum();
+  if (reduction == Reduction::Mean &&
+      (total_weight.item<double>() != 0 || input.numel() == 0)) {
+    // allow NaN result for total_weight == 0 case, see #15870
+    output.div_(total_weight);
+  }
+  return std::make_tuple(
+      output.to(input.scalar_type()),
+      total_weight.to(input.scalar_type()),
+      logsumexp);
+}
+
+Tensor log_softmax_nll_loss_backward_cpu(
+    const Tensor& grad_output,
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t reduction,
+    int64_t ignore_index,
+    const Tensor& total_weight,
+    const Tensor& logsumexp) {
+  TORCH_CHECK(self.dim() == 2, "input tensor should be 2D");
+  TORCH_CHECK(
+      target.dim() == 1,
+      "1D target tensor expected, multi-target not supported");
+  const auto batch_size = self.size(0);
+  TORCH_CHECK(
+      target.size(0) == batch_size && logsumexp.numel() == batch_size,
+      "size mismatch (got input: ",
+      self.sizes(),
+      ", target: ",
+      target.sizes(),
+      ", logsumexp: ",
+      logsumexp.sizes(),
+      ")");
+  TORCH_CHECK(
+      !weight.defined() || weight.numel() == self.size(1),
+      "weight tensor should be defined either for all or no classes");
+
+  auto input = self.contiguous();
+  auto target_contiguous = target.contiguous();
+  Tensor grad_input = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  if (batch_size == 0) {
+    return grad_input;
+  }
+
+  // Scale of the gradient of every row's loss, zero for ignored targets.
+  auto ignored = target_contiguous == ignore_index;
+  Tensor row_scale = weight.defined()
+      ? weight.contiguous().index_select(0, target_contiguous.masked_fill(ignored, 0))
+      : at::ones({batch_size}, input.options());
+  row_scale.masked_fill_(ignored, 0);
+  if (reduction == Reduction::None) {
+    check_dim_size(grad_output, 1, 0, batch_size);
+    row_scale.mul_(grad_output);
+  } else {
+    TORCH_CHECK(
+        grad_output.dim() <= 1 && grad_output.numel() == 1,
+        "Expected a single element grad_output tensor, but got: ",
+        grad_output.sizes());
+    if (reduction == Reduction::Mean && total_weight.item<double>() <= 0) {
+      row_scale.zero_();
+    } else if (reduction == Reduction::Mean) {
+      row_scale.mul_(grad_output / total_weight);
+    } else {
+      row_scale.mul_(grad_output);
+    }
+  }
+
+  log_softmax_nll_loss_backward_kernel(
+      kCPU,
+      grad_input,
+      input,
+      target_contiguous,
+      row_scale,
+      logsumexp.contiguous(),
+      ignore_index);
+  return grad_input;
+}
+
 } // namespace native
 } // namespace at
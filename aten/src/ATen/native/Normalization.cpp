@@ -7,6 +7,7 @@
 
 #include <ATen/detail/CUDAHooksInterface.h>
 #include <ATen/native/TensorIterator.h>
+#include <ATen/native/batch_norm.h>
 #include <ATen/native/cpu/Loops.h>
 
 #include <vector>
@@ -15,6 +16,10 @@ static const int MIOPEN_DIM_MAX = 4;
 
 namespace at { namespace native {
 
+DEFINE_DISPATCH(batch_norm_cpu_collect_stats_stub);
+DEFINE_DISPATCH(batch_norm_cpu_stub);
+DEFINE_DISPATCH(batch_norm_cpu_backward_stub);
+
 namespace {
   void check_dims_match_num_input_features(const char* arg_name, int64_t expected, int64_t actual){
     TORCH_CHECK(actual == expected,
@@ -38,6 +43,13 @@ static TensorAccessor<scalar_t, 1> conditional_accessor_1d(const Tensor& t) {
   return t.accessor<scalar_t, 1>();
 }
 
+// Whether the fused batch norm kernels in native/cpu/batch_norm_kernel.cpp
+// apply, i.e. the input is non empty and contiguous in some memory format.
+static inline bool batch_norm_use_fused_kernel(const Tensor& input) {
+  return input.numel() != 0 &&
+      (input.is_contiguous() || input.is_contiguous(at::MemoryFormat::ChannelsLast));
+}
+
 template<typename T>
 struct InvStd {
   T operator()(T var, double epsilon) const {
@@ -225,6 +237,12 @@ std::tuple<Tensor,Tensor,Tensor> batch_norm_cpu_transform_input_template(
     return std::make_tuple(output, save_mean, save_invstd);
   }
 
+  if (train && batch_norm_use_fused_kernel(input)) {
+    Tensor output = at::empty_like(input, input.suggest_memory_format());
+    batch_norm_cpu_stub(kCPU, output, input, weight, bias, save_mean, save_invstd);
+    return std::make_tuple(output, save_mean, save_invstd);
+  }
+
   Tensor output = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
 
   int64_t n_input = input.size(1);
@@ -280,6 +298,35 @@ std::tuple<Tensor,Tensor> batch_norm_cpu_update_stats_template(
   auto running_mean_a = conditional_accessor_1d<scalar_t>(running_mean);
   auto running_var_a = conditional_accessor_1d<scalar_t>(running_var);
 
+  auto update_stats = [&](int64_t f, accscalar_t mean, accscalar_t var_sum) {
+    save_mean_a[f] = mean;
+    save_var_transform_a[f] = VarTransform<accscalar_t>{}(var_sum / n, eps);
+
+    // update running averages
+    if (running_mean.defined()) {
+      running_mean_a[f] = momentum * mean + (1 - momentum) * running_mean_a[f];
+    }
+    if (running_var.defined()) {
+      accscalar_t unbiased_var = var_sum / (n - 1);
+      running_var_a[f] = momentum * unbiased_var + (1 - momentum) * running_var_a[f];
+    }
+  };
+
+  if (batch_norm_use_fused_kernel(input)) {
+    // mean and sum of squared deviations in a single pass over the input
+    auto acc_options =
+        input.options().dtype(caffe2::TypeMeta::Make<accscalar_t>());
+    Tensor mean = at::empty({n_input}, acc_options);
+    Tensor var_sum = at::empty({n_input}, acc_options);
+    batch_norm_cpu_collect_stats_stub(kCPU, mean, var_sum, input);
+    auto mean_a = mean.accessor<accscalar_t, 1>();
+    auto var_sum_a = var_sum.accessor<accscalar_t, 1>();
+    for (int64_t f = 0; f < n_input; ++f) {
+      update_stats(f, mean_a[f], var_sum_a[f]);
+    }
+    return std::make_tuple(save_mean, save_var_transform);
+  }
+
   parallel_for(0, n_input, 1, [&](int64_t b_begin, int64_t b_end) {
     for (int64_t f = b_begin; f < b_end; ++f) {
       Tensor in = input.select(1, f);
@@ -293,7 +340,6 @@ std::tuple<Tensor,Tensor> batch_norm_cpu_update_stats_template(
         sum += i;
       });
       scalar_t mean = sum / n;
-      save_mean_a[f] = mean;
 
       // compute variance per input
       iter = TensorIterator();
@@ -303,16 +349,7 @@ std::tuple<Tensor,Tensor> batch_norm_cpu_update_stats_template(
       cpu_serial_kernel(iter, [&](const scalar_t i) -> void {
         var_sum += (i - mean) * (i - mean);
       });
-      save_var_transform_a[f] = VarTransform<accscalar_t>{}(var_sum / n, eps);
-
-      // update running averages
-      if (running_mean.defined()) {
-        running_mean_a[f] = momentum * mean + (1 - momentum) * running_mean_a[f];
-      }
-      if (running_var.defined()) {
-        accscalar_t unbiased_var = var_sum / (n - 1);
-        running_var_a[f] = momentum * unbiased_var + (1 - momentum) * running_var_a[f];
-      }
+      update_stats(f, mean, var_sum);
     }
   });
   return std::make_tuple(save_mean, save_var_transform);
@@ -326,11 +363,18 @@ std::tuple<Tensor, Tensor, Tensor> batch_norm_backward_cpu_template(const Tensor
 
   using accscalar_t = at::acc_type<scalar_t, false>;
 
+  // grad_out has to be in the memory format of input for the fused kernel
+  const bool use_fused_kernel = train && batch_norm_use_fused_kernel(input) &&
+      (input.is_contiguous() ? grad_out_.is_contiguous()
+                             : grad_out_.is_contiguous(at::MemoryFormat::ChannelsLast));
+
   Tensor grad_input;
   Tensor grad_weight;
   Tensor grad_bias;
   if (grad_input_mask[0]) {
-    grad_input = at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    grad_input = use_fused_kernel
+        ? at::empty_like(input, input.suggest_memory_format())
+        : at::empty_like(input, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   }
   if (grad_input_mask[1]) {
     grad_weight = at::empty_like(weight, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
@@ -339,6 +383,12 @@ std::tuple<Tensor, Tensor, Tensor> batch_norm_backward_cpu_template(const Tensor
     grad_bias = at::empty_like(weight, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   }
 
+  if (use_fused_kernel) {
+    batch_norm_cpu_backward_stub(kCPU, grad_input, grad_weight, grad_bias,
+        grad_out_, input, weight, save_mean, save_invstd);
+    return std::make_tuple(grad_input, grad_weight, grad_bias);
+  }
+
   auto weight_a = conditional_accessor_1d<scalar_t>(weight);
   auto grad_weight_a = conditional_accessor_1d<scalar_t>(grad_weight);
   auto grad_bias_a = conditional_accessor_1d<scalar_t>(grad_bias);
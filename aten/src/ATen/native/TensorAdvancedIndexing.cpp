@@ -70,6 +70,10 @@ DEFINE_DISPATCH(index_stub);
 DEFINE_DISPATCH(index_put_stub);
 DEFINE_DISPATCH(index_put_accum_stub);
 REGISTER_NO_CPU_DISPATCH(index_put_accum_stub, index_put_accum_fn);
+DEFINE_DISPATCH(gather_stub);
+DEFINE_DISPATCH(scatter_stub);
+DEFINE_DISPATCH(scatter_fill_stub);
+DEFINE_DISPATCH(scatter_add_stub);
 
 static bool all_strides_match(TensorList tensors) {
   TORCH_CHECK(tensors.size() >= 1);
@@ -486,6 +490,101 @@ Tensor index_fill(const Tensor & self, int64_t dim, const Tensor & index, const
   return self.clone(at::MemoryFormat::Preserve).index_fill_(dim, index, source);
 }
 
+// Scalars count as 1-d tensors of size 1 in the shape checks of gather and
+// scatter, as they did in TH.
+static int64_t ensure_nonempty_dim(int64_t dim) {
+  return std::max<int64_t>(dim, 1);
+}
+
+static int64_t ensure_nonempty_size(const Tensor& t, int64_t dim) {
+  return t.dim() == 0 ? 1 : t.size(dim);
+}
+
+// index must have the shape of self, except along dim.
+static void gather_shape_check(const Tensor& self, int64_t dim, const Tensor& index) {
+  auto self_dims = ensure_nonempty_dim(self.dim());
+  TORCH_CHECK(self_dims == ensure_nonempty_dim(index.dim()),
+              "Index tensor must have same dimensions as input tensor");
+  for (int64_t i = 0; i < self_dims; ++i) {
+    if (i != dim) {
+      TORCH_CHECK(ensure_nonempty_size(index, i) == ensure_nonempty_size(self, i),
+                  "Expected index ", index.sizes(), " and input ", self.sizes(),
+                  " to have the same size apart from dimension ", dim);
+    }
+  }
+}
+
+// index must be no larger than src, and no larger than self except along dim.
+static void scatter_shape_check(const Tensor& self, int64_t dim, const Tensor& index, const Tensor& src) {
+  auto self_dims = ensure_nonempty_dim(self.dim());
+  TORCH_CHECK(index.numel() == 0 || ensure_nonempty_dim(index.dim()) == self_dims,
+              "Index tensor must be either empty or have same dimensions as output tensor");
+  if (!src.defined()) {
+    if (index.numel() > 0) {
+      for (int64_t i = 0; i < self_dims; ++i) {
+        TORCH_CHECK(i == dim || ensure_nonempty_size(index, i) <= ensure_nonempty_size(self, i),
+                    "Expected index ", index.sizes(), " to be smaller than self ", self.sizes(),
+                    " apart from dimension ", dim);
+      }
+    }
+    return;
+  }
+  TORCH_CHECK(ensure_nonempty_dim(src.dim()) == self_dims,
+              "Input tensor must have same dimensions as output tensor");
+  if (index.numel() > 0) {
+    for (int64_t i = 0; i < self_dims; ++i) {
+      TORCH_CHECK(ensure_nonempty_size(index, i) <= ensure_nonempty_size(src, i) &&
+                  (i == dim || ensure_nonempty_size(index, i) <= ensure_nonempty_size(self, i)),
+                  "Expected index ", index.sizes(), " to be smaller size than src ", src.sizes(),
+                  " and to be smaller than self ", self.sizes(), " apart from dimension ", dim);
+    }
+  }
+}
+
+Tensor & gather_out_cpu(Tensor & result, const Tensor & self, int64_t dim, const Tensor & index, bool sparse_grad) {
+  dim = maybe_wrap_dim(dim, self.dim());
+  TORCH_CHECK(index.scalar_type() == ScalarType::Long, "gather(): Expected dtype int64 for index");
+  TORCH_CHECK(self.scalar_type() == result.scalar_type(),
+              "gather(): self and result must have the same scalar type");
+  gather_shape_check(self, dim, index);
+  result.resize_(index.sizes());
+  gather_stub(result.device().type(), result, self, dim, index);
+  return result;
+}
+
+Tensor gather_cpu(const Tensor & self, int64_t dim, const Tensor & index, bool sparse_grad) {
+  Tensor result = at::empty({0}, self.options());
+  return gather_out_cpu(result, self, dim, index, sparse_grad);
+}
+
+Tensor & scatter_cpu_(Tensor & self, int64_t dim, const Tensor & index, const Tensor & src) {
+  dim = maybe_wrap_dim(dim, self.dim());
+  TORCH_CHECK(index.scalar_type() == ScalarType::Long, "scatter_(): Expected dtype int64 for index");
+  TORCH_CHECK(self.scalar_type() == src.scalar_type(),
+              "scatter_(): self and source must have the same scalar type");
+  scatter_shape_check(self, dim, index, src);
+  scatter_stub(self.device().type(), self, dim, index, src);
+  return self;
+}
+
+Tensor & scatter_fill_cpu_(Tensor & self, int64_t dim, const Tensor & index, Scalar src) {
+  dim = maybe_wrap_dim(dim, self.dim());
+  TORCH_CHECK(index.scalar_type() == ScalarType::Long, "scatter_(): Expected dtype int64 for index");
+  scatter_shape_check(self, dim, index, Tensor());
+  scatter_fill_stub(self.device().type(), self, dim, index, src);
+  return self;
+}
+
+Tensor & scatter_add_cpu_(Tensor & self, int64_t dim, const Tensor & index, const Tensor & src) {
+  dim = maybe_wrap_dim(dim, self.dim());
+  TORCH_CHECK(index.scalar_type() == ScalarType::Long, "scatter_add_(): Expected dtype int64 for index");
+  TORCH_CHECK(self.scalar_type() == src.scalar_type(),
+              "scatter_add_(): self and source must have the same scalar type");
+  scatter_shape_check(self, dim, index, src);
+  scatter_add_stub(self.device().type(), self, dim, index, src);
+  return self;
+}
+
 Tensor scatter(const Tensor & self, int64_t dim, const Tensor & index, const Tensor & source) {
   return self.clone(at::MemoryFormat::Preserve).scatter_(dim, index, source);
 }
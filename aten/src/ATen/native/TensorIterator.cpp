@@ -527,7 +527,16 @@ int TensorIterator::num_reduce_dims() const {
   }
 
 void TensorIterator::for_each(loop_t loop) {
-  for_each(LOOP_WRAPPER(ntensors(), loop));
+  int64_t numel = this->numel();
+  if (numel == 0) {
+    return;
+  } else if (numel < internal::GRAIN_SIZE || at::get_num_threads() == 1) {
+    return serial_for_each(loop, {0, numel});
+  } else {
+    at::parallel_for(0, numel, internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      serial_for_each(loop, {begin, end});
+    });
+  }
 }
 
 void TensorIterator::for_each(loop2d_t loop) {
@@ -554,7 +563,20 @@ StrideVector TensorIterator::get_strides() const {
 }
 
 void TensorIterator::serial_for_each(loop_t loop, Range range) const {
-  serial_for_each(LOOP_WRAPPER(ntensors(), loop), range);
+  if (ndim() > 1) {
+    return serial_for_each(LOOP_WRAPPER(ntensors(), loop), range);
+  }
+  // 1-d iteration, which is what fast_set_up produces: call the loop directly
+  // instead of through the 2-d loop wrapper.
+  if (range.size() == 0) {
+    return;
+  }
+  auto strides = get_inner_strides();
+  auto ptrs = get_base_ptrs();
+  for (int arg = 0; arg < ntensors(); arg++) {
+    ptrs[arg] += range.begin * strides[arg];
+  }
+  loop(ptrs.data(), strides.data(), range.size());
 }
 
 void TensorIterator::serial_for_each(loop2d_t loop, Range range) const {
@@ -905,22 +927,35 @@ int TensorIterator::get_dim_to_split() const {
   return dim_to_split;
 }
 
-void TensorIterator::fast_set_up() {
-  //this function is called if all the inputs are contiguous to avoid needless reordering of dimensions
-  //and tracking output strides
+void TensorIterator::fast_set_up(FastSetUpType setup_type) {
+  //this function is called if all the operands share the same dense layout to avoid needless reordering of dimensions
+  //and tracking output strides. 0-dim inputs are broadcast with a zero stride.
   //TODO enable fast handling for reductions
-  //TODO enable fast handling for channels_last
 
-  //allocate contiguous tensor for output
+  //allocate the outputs with the layout of the inputs
+  const Tensor* layout_tensor = nullptr;
+  if (setup_type == FastSetUpType::NON_OVERLAPPING_DENSE) {
+    for (auto& op : operands_) {
+      if (op.tensor.defined() && op.tensor.dim() == ndim()) {
+        layout_tensor = &op.tensor;
+        break;
+      }
+    }
+    TORCH_INTERNAL_ASSERT(layout_tensor);
+  }
   for (int i = 0; i < num_outputs_; i++){
       auto& op = operands_[i];
       if (!op.tensor.defined()) {
         TORCH_INTERNAL_ASSERT(op.is_type_defined(), "no type for operand", i);
-        op.tensor = at::empty(shape_, op.options());
+        if (layout_tensor) {
+          op.tensor = at::empty_strided(shape_, layout_tensor->strides(), op.options());
+        } else {
+          op.tensor = at::empty(shape_, op.options());
+        }
       }
       op.current_dtype = op.target_dtype;
   }
-  //coalescing dimensions consists of collapsing dimensions to 1 (we are limited to contiguous no-broadcast cases here)
+  //coalescing dimensions consists of collapsing dimensions to 1 (we are limited to dense no-broadcast cases here)
   if (ndim() > 1){
     has_coalesced_dimensions_ = true;
   }
@@ -932,24 +967,42 @@ void TensorIterator::fast_set_up() {
     auto element_size_in_bytes = op.tensor.element_size();
     op.stride_bytes.resize(ndim());
     if (ndim()>0) {
-      op.stride_bytes[0] = element_size_in_bytes;
+      op.stride_bytes[0] = op.tensor.dim() == 0 ? 0 : element_size_in_bytes;
     }
   }
 }
 
-bool TensorIterator::can_use_fast_set_up() {
-  if (is_reduction_) return false;
-  if (!all_ops_same_shape_) {
-    return false;
-  }
+FastSetUpType TensorIterator::compute_fast_setup_type() {
+  if (is_reduction_) return FastSetUpType::NONE;
+  bool is_contiguous = true;
+  bool is_non_overlapping_and_dense = true;
+  const Tensor* layout_tensor = nullptr;
   for (auto& op : operands_) {
-    if (op.tensor.defined()) {
-      if (!op.tensor.is_contiguous()) {
-        return false;
+    if (!op.tensor.defined()) continue;
+    if (!all_ops_same_shape_ && !op.tensor.sizes().equals(shape_)) {
+      // 0-dim inputs are the only operands the fast path can broadcast
+      if (op.is_output || op.tensor.dim() != 0) {
+        return FastSetUpType::NONE;
       }
+      continue;
+    }
+    is_contiguous &= op.tensor.is_contiguous();
+    if (!layout_tensor) {
+      layout_tensor = &op.tensor;
+      is_non_overlapping_and_dense =
+          op.tensor.unsafeGetTensorImpl()->is_non_overlapping_and_dense();
+    } else {
+      is_non_overlapping_and_dense &=
+          op.tensor.strides().equals(layout_tensor->strides());
     }
   }
-  return true;
+  if (is_contiguous) {
+    return FastSetUpType::CONTIGUOUS;
+  }
+  if (is_non_overlapping_and_dense) {
+    return FastSetUpType::NON_OVERLAPPING_DENSE;
+  }
+  return FastSetUpType::NONE;
 }
 
 void TensorIterator::build() {
@@ -966,8 +1019,10 @@ void TensorIterator::build() {
   compute_shape();
   // compute the result dtype and device
   compute_types();
-  if (can_use_fast_set_up()) {
-    fast_set_up();
+  // try to skip the stride computation and coalescing of dimensions
+  auto fast_setup_type = compute_fast_setup_type();
+  if (fast_setup_type != FastSetUpType::NONE) {
+    fast_set_up(fast_setup_type);
   } else {
     // compute each tensor's stride after broadcasting
     compute_strides();
@@ -132,6 +132,16 @@ struct CAFFE2_API OperandInfo {
 
 struct SplitUntil32Bit;
 
+// How TensorIterator::build can skip the stride computation, reordering and
+// coalescing of dimensions: when every operand has the broadcast shape (or is
+// a 0-dim input) and all of them share the same dense memory layout, the
+// operation can be iterated as a single dimension in memory order.
+enum class FastSetUpType : uint8_t {
+  NONE,
+  CONTIGUOUS, // all the operands are contiguous
+  NON_OVERLAPPING_DENSE // e.g. channels last, or the same permutation
+};
+
 enum class CommonDTypeStrategy : uint8_t {
   NONE, // Do not compute a common dtype
   CHECK, // Compute and validate a common dtype but don't promote.
@@ -358,8 +368,8 @@ protected:
   void compute_types();
   std::tuple<Device, ScalarType, bool> compute_common_type();
   void allocate_outputs();
-  void fast_set_up();
-  bool can_use_fast_set_up();
+  void fast_set_up(FastSetUpType setup_type);
+  FastSetUpType compute_fast_setup_type();
   void compute_names();
   void propagate_names_to_outputs();
   void coalesce_dimensions();
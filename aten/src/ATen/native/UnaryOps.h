@@ -5,7 +5,7 @@
 #include <ATen/Generator.h>
 #include <stdexcept>
 
-namespace at { struct TensorIterator; }
+namespace at { struct TensorIterator; struct CPUGenerator; }
 
 namespace at { namespace native {
 
@@ -57,6 +57,10 @@ DECLARE_DISPATCH(unary_fn, lgamma_stub);
 DECLARE_DISPATCH(void(*)(Tensor&, const double, Generator *), bernoulli_mkl_stub);
 DECLARE_DISPATCH(void(*)(TensorIterator&, const double, const double, Generator *), cauchy_stub);
 DECLARE_DISPATCH(void(*)(TensorIterator&, const double, Generator *), geometric_stub);
+// Philox mode of CPUGenerator, see Note [Philox mode of CPUGenerator]
+DECLARE_DISPATCH(void(*)(TensorIterator&, const double, const double, CPUGenerator *), uniform_philox_stub);
+DECLARE_DISPATCH(void(*)(TensorIterator&, const double, const double, CPUGenerator *), normal_philox_stub);
+DECLARE_DISPATCH(void(*)(TensorIterator&, const double, CPUGenerator *), bernoulli_scalar_philox_stub);
 DECLARE_DISPATCH(void(*)(TensorIterator&, const int64_t), polygamma_stub);
 DECLARE_DISPATCH(void(*)(TensorIterator&, Scalar a, Scalar b), clamp_stub);
 DECLARE_DISPATCH(void(*)(Tensor&, const Tensor&, int64_t, bool, Generator *), multinomial_stub);
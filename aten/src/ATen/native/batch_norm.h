@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at {
+namespace native {
+
+// The kernels below take an input that is contiguous either in the
+// contiguous or in the channels last memory format. All the other tensors
+// have the memory format of the input or are 1-d of size C. The mean and
+// var_sum computed by batch_norm_cpu_collect_stats_stub have the CPU
+// accumulate type of the input.
+
+using batch_norm_collect_stats_fn = void (*)(
+    Tensor& /* mean */,
+    Tensor& /* var_sum */,
+    const Tensor& /* input */);
+
+using batch_norm_fn = void (*)(
+    Tensor& /* output */,
+    const Tensor& /* input */,
+    const Tensor& /* weight */,
+    const Tensor& /* bias */,
+    const Tensor& /* mean */,
+    const Tensor& /* invstd */);
+
+using batch_norm_backward_fn = void (*)(
+    Tensor& /* grad_input */,
+    Tensor& /* grad_weight */,
+    Tensor& /* grad_bias */,
+    const Tensor& /* grad_output */,
+    const Tensor& /* input */,
+    const Tensor& /* weight */,
+    const Tensor& /* mean */,
+    const Tensor& /* invstd */);
+
+DECLARE_DISPATCH(batch_norm_collect_stats_fn, batch_norm_cpu_collect_stats_stub);
+DECLARE_DISPATCH(batch_norm_fn, batch_norm_cpu_stub);
+DECLARE_DISPATCH(batch_norm_backward_fn, batch_norm_cpu_backward_stub);
+
+} // namespace native
+} // namespace at
@@ -193,8 +193,15 @@ struct Dist {
     }
   }
 
+  // The output is computed in tiles of kRowTile rows of t1 against as many
+  // rows of t2 as fit in kTileBytes, so that the t2 tile stays in cache while
+  // it is reused for every row of t1. Each pair is reduced over the feature
+  // dimension with Vec256.
   template <typename F>
   static void run_parallel_cdist(Tensor& result, const Tensor& t1, const Tensor& t2, const scalar_t p) {
+    constexpr int64_t kRowTile = 16;
+    constexpr int64_t kTileBytes = 128 * 1024;
+
     const scalar_t * const t1_start = t1.data_ptr<scalar_t>();
     const scalar_t * const t2_start = t2.data_ptr<scalar_t>();
     int64_t d = t1.size(0);
@@ -203,40 +210,31 @@ struct Dist {
     int64_t m = t1.size(-1);
 
     scalar_t * const res_start = result.data_ptr<scalar_t>();
-    int64_t combs = r1 * r2;
     int64_t size1 = r1 * m;
     int64_t size2 = r2 * m;
+    int64_t row_tiles = (r1 + kRowTile - 1) / kRowTile;
+    int64_t col_tile = std::max<int64_t>(1, kTileBytes / static_cast<int64_t>(m * sizeof(scalar_t)));
 
-    parallel_for(0, combs * d, internal::GRAIN_SIZE / (16 * m), [=](int64_t start, int64_t end) {
-      scalar_t * res = res_start + start;
-      const scalar_t * const res_end = res_start + end;
-      int64_t l = start / combs;
-      int64_t k = start % combs;
-      int64_t i = k / r2;
-      int64_t j = k % r2;
-      i = i * m;
-      j = j * m;
-
-      while (res != res_end) {
-        const scalar_t * self_i = t1_start + size1 * l + i;
-        const scalar_t * self_j = t2_start + size2 * l + j;
-
-        scalar_t agg = 0;
-        for (int x = 0; x < m; x++) {
-          scalar_t a = *(self_i + x);
-          scalar_t b = *(self_j + x);
-          agg = F::red(agg, F::map(std::abs(a-b), p));
-        }
-        *res = F::finish(agg, p);
-
-        res += 1;
-        j += m;
-        if (j == size2) {
-          j = 0;
-          i += m;
-          if (i == size1) {
-            i = 0;
-            l += 1;
+    parallel_for(0, d * row_tiles, internal::GRAIN_SIZE / (16 * m * kRowTile * r2) + 1, [=](int64_t start, int64_t end) {
+      const Vec pvec(p);
+      for (int64_t tile = start; tile < end; tile++) {
+        int64_t l = tile / row_tiles;
+        int64_t i_begin = (tile % row_tiles) * kRowTile;
+        int64_t i_end = std::min(i_begin + kRowTile, r1);
+        const scalar_t * const t1_l = t1_start + size1 * l;
+        const scalar_t * const t2_l = t2_start + size2 * l;
+        scalar_t * const res_l = res_start + r1 * r2 * l;
+
+        for (int64_t j_begin = 0; j_begin < r2; j_begin += col_tile) {
+          int64_t j_end = std::min(j_begin + col_tile, r2);
+          for (int64_t i = i_begin; i < i_end; i++) {
+            const scalar_t * self_i = t1_l + i * m;
+            scalar_t * res = res_l + i * r2;
+            for (int64_t j = j_begin; j < j_end; j++) {
+              res[j] = F::finish(vec256::map2_reduce_all<scalar_t>(
+                [&pvec](Vec a, Vec b) { return F::map((a - b).abs(), pvec); },
+                F::red, self_i, t2_l + j * m, m), p);
+            }
           }
         }
       }
@@ -245,15 +243,15 @@ struct Dist {
 
   static void apply_cdist(Tensor& result, const Tensor& x1, const Tensor& x2, const scalar_t p) {
     if (p == 0.0) {
-      run_parallel_cdist<zdist_calc<scalar_t>>(result, x1, x2, p);
+      run_parallel_cdist<zdist_calc<Vec>>(result, x1, x2, p);
     } else if (p == 1.0) {
-      run_parallel_cdist<odist_calc<scalar_t>>(result, x1, x2, p);
+      run_parallel_cdist<odist_calc<Vec>>(result, x1, x2, p);
     } else if (p == 2.0) {
-      run_parallel_cdist<tdist_calc<scalar_t>>(result, x1, x2, p);
+      run_parallel_cdist<tdist_calc<Vec>>(result, x1, x2, p);
     } else if (std::isinf(p)) {
-      run_parallel_cdist<idist_calc<scalar_t>>(result, x1, x2, p);
+      run_parallel_cdist<idist_calc<Vec>>(result, x1, x2, p);
     } else {
-      run_parallel_cdist<pdist_calc<scalar_t>>(result, x1, x2, p);
+      run_parallel_cdist<pdist_calc<Vec>>(result, x1, x2, p);
     }
   }
 
@@ -408,6 +406,89 @@ struct Dist {
 
 };
 
+// Per-row heaps for cdist_topk. The root of each heap is the worst of the k
+// candidates kept so far, so a new candidate only has to be compared against
+// it. NaN distances rank below every number.
+template <typename scalar_t>
+struct TopkHeap {
+  scalar_t* vals;
+  int64_t* idx;
+  bool largest;
+
+  inline bool better(scalar_t a, scalar_t b) const {
+    if (std::isnan(b)) {
+      return !std::isnan(a);
+    }
+    return largest ? a > b : a < b;
+  }
+
+  inline void swap(int64_t a, int64_t b) {
+    std::swap(vals[a], vals[b]);
+    std::swap(idx[a], idx[b]);
+  }
+
+  void push(int64_t size, scalar_t val, int64_t index) {
+    vals[size] = val;
+    idx[size] = index;
+    int64_t pos = size;
+    while (pos > 0) {
+      int64_t parent = (pos - 1) / 2;
+      if (!better(vals[parent], vals[pos])) {
+        break;
+      }
+      swap(parent, pos);
+      pos = parent;
+    }
+  }
+
+  void replace_top(int64_t size, scalar_t val, int64_t index) {
+    vals[0] = val;
+    idx[0] = index;
+    int64_t pos = 0;
+    while (true) {
+      int64_t worst = 2 * pos + 1;
+      if (worst >= size) {
+        break;
+      }
+      if (worst + 1 < size && better(vals[worst], vals[worst + 1])) {
+        worst += 1;
+      }
+      if (!better(vals[pos], vals[worst])) {
+        break;
+      }
+      swap(pos, worst);
+      pos = worst;
+    }
+  }
+};
+
+static void cdist_topk_merge_kernel_impl(Tensor& values, Tensor& indices, const Tensor& dist, int64_t offset, int64_t filled, bool largest) {
+  const int64_t rows = dist.size(0);
+  const int64_t n = dist.size(1);
+  const int64_t k = values.size(1);
+  AT_DISPATCH_FLOATING_TYPES(values.scalar_type(), "cdist_topk", [&] {
+    scalar_t * const values_start = values.data_ptr<scalar_t>();
+    int64_t * const indices_start = indices.data_ptr<int64_t>();
+    const scalar_t * const dist_start = dist.data_ptr<scalar_t>();
+    parallel_for(0, rows, internal::GRAIN_SIZE / std::max<int64_t>(n, 1) + 1, [&](int64_t start, int64_t end) {
+      for (int64_t r = start; r < end; r++) {
+        TopkHeap<scalar_t> heap{values_start + r * k, indices_start + r * k, largest};
+        const scalar_t * d = dist_start + r * n;
+        int64_t size = filled;
+        int64_t j = 0;
+        for (; j < n && size < k; j++, size++) {
+          heap.push(size, d[j], offset + j);
+        }
+        for (; j < n; j++) {
+          if (heap.better(d[j], heap.vals[0])) {
+            heap.replace_top(k, d[j], offset + j);
+          }
+        }
+      }
+    });
+  });
+}
+
 void pdist_forward_kernel_impl(Tensor& result, const Tensor& self, const double p) {
   AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "pdist", [&] {
     Dist<scalar_t>::apply_pdist(result, self, p);
@@ -439,5 +520,6 @@ REGISTER_DISPATCH(pdist_forward_stub, &pdist_forward_kernel_impl);
 REGISTER_DISPATCH(pdist_backward_stub, &pdist_backward_kernel_impl);
 REGISTER_DISPATCH(cdist_stub, &cdist_kernel_impl);
 REGISTER_DISPATCH(cdist_backward_stub, &cdist_backward_kernel_impl);
+REGISTER_DISPATCH(cdist_topk_merge_stub, &cdist_topk_merge_kernel_impl);
 
 }}  // namespace at::native
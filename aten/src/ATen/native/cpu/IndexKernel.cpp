@@ -1,7 +1,9 @@
 #include <ATen/native/TensorAdvancedIndexing.h>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <vector>
 #include <ATen/Dispatch.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/Parallel.h>
@@ -92,6 +94,127 @@ void cpu_index_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef
   }
 }
 
+// index_put_ with accumulate=true. Several elements may add to the same
+// destination, so elements are first bucketed by destination address with a
+// stable counting sort. Buckets cover disjoint address ranges and are reduced
+// in parallel: the updates of each destination are summed in a register,
+// starting from its current value and in their original order, then written
+// once. Elements are handled in blocks of consecutive iterations, which bounds
+// the scratch memory, and a block whose destinations mostly fall in a single
+// bucket is added serially. Every destination sees the same sequence of
+// additions as in the serial loop, so the result is bitwise identical whatever
+// the number of threads.
+template <typename scalar_t>
+void cpu_index_put_accumulate_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef index_stride) {
+  const int64_t numel = iter.numel();
+  if (numel < internal::GRAIN_SIZE || at::get_num_threads() == 1) {
+    cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
+      *(scalar_t*)(dst + offset) += *(scalar_t*)src;
+    }, /*serial_execution=*/true);
+    return;
+  }
+
+  // At most 24 bytes of scratch per element of a block
+  constexpr int64_t kMaxBlockSize = 1 << 20;
+  const int64_t block_size = std::min(numel, kMaxBlockSize);
+  const int64_t max_buckets = at::get_num_threads() * 4;
+  const int64_t chunk_size = internal::GRAIN_SIZE;
+  int ntensor = iter.ntensors();
+  std::vector<char*> dst_ptrs(block_size);
+  std::vector<char*> src_ptrs(block_size);
+  std::vector<int64_t> order(block_size);
+  std::vector<int64_t> offsets(((block_size + chunk_size - 1) / chunk_size) * max_buckets);
+  std::vector<int64_t> bucket_begin(max_buckets + 1);
+
+  for (int64_t block_begin = 0; block_begin < numel; block_begin += block_size) {
+    const int64_t n = std::min(block_size, numel - block_begin);
+
+    // Destination and source of every element of the block, in iteration
+    // order. Out of bounds indices throw here, before the block is written.
+    at::parallel_for(block_begin, block_begin + n, internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      int64_t pos = begin - block_begin;
+      auto loop = [&](char** data, const int64_t* strides, int64_t m) {
+        auto indexer = Indexer(ntensor - 2, &data[2], &strides[2], index_size, index_stride);
+        for (int64_t i = 0; i < m; i++, pos++) {
+          dst_ptrs[pos] = data[0] + strides[0] * i + indexer.get(i);
+          src_ptrs[pos] = data[1] + strides[1] * i;
+        }
+      };
+      iter.serial_for_each(loop, {begin, end});
+    });
+
+    auto minmax = std::minmax_element(dst_ptrs.begin(), dst_ptrs.begin() + n);
+    const uintptr_t lowest = reinterpret_cast<uintptr_t>(*minmax.first);
+    const uintptr_t range = reinterpret_cast<uintptr_t>(*minmax.second) - lowest + 1;
+    const int64_t num_buckets = std::min<int64_t>(max_buckets, range);
+    auto bucket_of = [&](const char* ptr) {
+      return static_cast<int64_t>((reinterpret_cast<uintptr_t>(ptr) - lowest) * num_buckets / range);
+    };
+
+    // Counting sort of the elements by bucket. Chunks of elements are counted
+    // in parallel, the offsets are laid out bucket by bucket with chunks in
+    // order inside each bucket, which keeps the sort stable.
+    const int64_t num_chunks = (n + chunk_size - 1) / chunk_size;
+    std::fill(offsets.begin(), offsets.begin() + num_chunks * num_buckets, 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* chunk_counts = offsets.data() + c * num_buckets;
+        for (int64_t e = c * chunk_size; e < std::min(n, (c + 1) * chunk_size); e++) {
+          chunk_counts[bucket_of(dst_ptrs[e])]++;
+        }
+      }
+    });
+    int64_t total = 0;
+    int64_t largest_bucket = 0;
+    for (int64_t b = 0; b < num_buckets; b++) {
+      bucket_begin[b] = total;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        int64_t count = offsets[c * num_buckets + b];
+        offsets[c * num_buckets + b] = total;
+        total += count;
+      }
+      largest_bucket = std::max(largest_bucket, total - bucket_begin[b]);
+    }
+    bucket_begin[num_buckets] = total;
+
+    if (largest_bucket > n / 2) {
+      // A hot destination range leaves little to run in parallel, and its
+      // bucket would be sorted by a single thread.
+      for (int64_t e = 0; e < n; e++) {
+        *(scalar_t*)dst_ptrs[e] += *(scalar_t*)src_ptrs[e];
+      }
+      continue;
+    }
+
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* chunk_offsets = offsets.data() + c * num_buckets;
+        for (int64_t e = c * chunk_size; e < std::min(n, (c + 1) * chunk_size); e++) {
+          order[chunk_offsets[bucket_of(dst_ptrs[e])]++] = e;
+        }
+      }
+    });
+
+    at::parallel_for(0, num_buckets, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; b++) {
+        auto first = order.begin() + bucket_begin[b];
+        auto last = order.begin() + bucket_begin[b + 1];
+        std::stable_sort(first, last, [&](int64_t x, int64_t y) {
+          return dst_ptrs[x] < dst_ptrs[y];
+        });
+        for (auto it = first; it != last;) {
+          char* dst = dst_ptrs[*it];
+          scalar_t acc = *(scalar_t*)dst;
+          for (; it != last && dst_ptrs[*it] == dst; ++it) {
+            acc += *(scalar_t*)src_ptrs[*it];
+          }
+          *(scalar_t*)dst = acc;
+        }
+      }
+    });
+  }
+}
+
 void index_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef index_stride) {
   AT_DISPATCH_ALL_TYPES_AND3(at::ScalarType::Half, at::ScalarType::Bool, at::ScalarType::BFloat16,
     iter.dtype(), "index_cpu", [&] {
@@ -106,11 +229,7 @@ void index_put_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef
   AT_DISPATCH_ALL_TYPES_AND3(at::ScalarType::Half, at::ScalarType::Bool, at::ScalarType::BFloat16,
     iter.dtype(), "index_put", [&] {
     if (accumulate) {
-      // TODO: investigate parallelization of the accumulate kernel. Unlike the non-accumulate case,
-      // this needs to be thread-safe.
-      cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
-        *(scalar_t*)(dst + offset) += *(scalar_t*)src;
-      }, /*serial_execution=*/true);
+      cpu_index_put_accumulate_kernel<scalar_t>(iter, index_size, index_stride);
     } else {
       cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
         *(scalar_t*)(dst + offset) = *(scalar_t*)src;
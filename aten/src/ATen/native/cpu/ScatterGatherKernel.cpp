@@ -0,0 +1,200 @@
+#include <ATen/native/TensorAdvancedIndexing.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/TensorIterator.h>
+
+#include <utility>
+#include <vector>
+
+namespace at { namespace native {
+namespace {
+
+// gather, scatter and scatter_add visit index one slice along `dim` at a
+// time. Every operand is restrided to the shape of index with size 1 along
+// `dim`, so TensorIterator walks all the other dimensions once and the loops
+// below walk `dim` with the original strides.
+//
+// Two slices never write to the same element, so slices run in parallel.
+// When there are too few slices to occupy all the threads (e.g. 1-d index),
+// the destination positions along `dim` are partitioned between threads
+// instead. For scatter, a single pass over index sorts the updates by the
+// range their destination falls in, and every thread applies the updates of
+// its own range. scatter_add stays free of atomics and applies the updates
+// of every element in the same order as a serial loop, so the result is
+// deterministic.
+
+static Tensor restride_dim(const Tensor& src, int64_t dim, IntArrayRef replacement_shape) {
+  auto sizes = replacement_shape.vec();
+  sizes[dim] = 1;
+  return src.as_strided(sizes, src.strides());
+}
+
+// `self` is the tensor indexed by index along `dim`: the destination of
+// scatter, the source of gather. `src` is the other one, or undefined when
+// every update copies `*value`.
+template <bool is_scatter_like, typename scalar_t, typename func_t>
+static void cpu_scatter_gather_base_kernel(
+    const Tensor& self_,
+    int64_t dim,
+    const Tensor& index_,
+    const Tensor& src_,
+    const scalar_t* value,
+    const char* method_name,
+    const func_t& f) {
+  if (index_.numel() == 0) {
+    return;
+  }
+  // TH treated scalars as 1-d tensors of size 1.
+  auto self = self_.dim() == 0 ? self_.view({1}) : self_;
+  auto index = index_.dim() == 0 ? index_.view({1}) : index_;
+  auto src = (src_.defined() && src_.dim() == 0) ? src_.view({1}) : src_;
+  // written: scatter writes into self, gather into its result (src).
+  auto& dst = is_scatter_like ? self : src;
+
+  auto iter = TensorIterator();
+  iter.dont_compute_common_dtype();
+  iter.dont_resize_outputs();
+  iter.add_output(restride_dim(dst, dim, index.sizes()));
+  iter.add_input(restride_dim(index, dim, index.sizes()));
+  if (is_scatter_like && src.defined()) {
+    iter.add_input(restride_dim(src, dim, index.sizes()));
+  } else if (!is_scatter_like) {
+    iter.add_input(restride_dim(self, dim, index.sizes()));
+  }
+  iter.build();
+  const bool has_source = iter.ntensors() == 3;
+
+  const int64_t index_dim_size = index.size(dim);
+  const int64_t index_dim_stride = index.stride(dim);
+  const int64_t dst_dim_stride = dst.stride(dim);
+  const int64_t source_dim_stride = has_source ? (is_scatter_like ? src : self).stride(dim) : 0;
+  const int64_t index_upper_bound = self.size(dim);
+  // Positions along dim written by the updates: index values for scatter,
+  // positions in index for gather.
+  const int64_t dst_dim_size = is_scatter_like ? self.size(dim) : index_dim_size;
+
+  // Checks the index value of the updates of slices [slice_begin, slice_end)
+  // at positions [i_begin, i_end) along dim of index, and calls
+  // visit(dst_pos, dst_elem, source_elem) for each of them in the order of a
+  // serial loop.
+  auto for_each_update = [&](int64_t slice_begin, int64_t slice_end,
+                             int64_t i_begin, int64_t i_end, const auto& visit) {
+    auto loop = [&](char** data, const int64_t* strides, int64_t n) {
+      auto apply = [&](int64_t k, int64_t i) {
+        const int64_t idx = *reinterpret_cast<int64_t*>(
+            data[1] + k * strides[1] + i * index_dim_stride * sizeof(int64_t));
+        TORCH_CHECK(idx >= 0 && idx < index_upper_bound,
+                    "Invalid index in ", method_name, ": index ", idx,
+                    " is out of bounds for dimension ", dim, " with size ", index_upper_bound);
+        const int64_t dst_pos = is_scatter_like ? idx : i;
+        const int64_t source_pos = is_scatter_like ? i : idx;
+        scalar_t* dst_elem = reinterpret_cast<scalar_t*>(data[0] + k * strides[0]) + dst_pos * dst_dim_stride;
+        const scalar_t* source_elem = has_source
+            ? reinterpret_cast<scalar_t*>(data[2] + k * strides[2]) + source_pos * source_dim_stride
+            : value;
+        visit(dst_pos, dst_elem, source_elem);
+      };
+
+      if (index_dim_stride == 1) {
+        // dim is the innermost dimension of index: walk slices one by one.
+        for (int64_t k = 0; k < n; ++k) {
+          for (int64_t i = i_begin; i < i_end; ++i) {
+            apply(k, i);
+          }
+        }
+      } else {
+        // The inner loop of the iterator is the contiguous one: walk all the
+        // slices at once, one position along dim at a time.
+        for (int64_t i = i_begin; i < i_end; ++i) {
+          for (int64_t k = 0; k < n; ++k) {
+            apply(k, i);
+          }
+        }
+      }
+    };
+    iter.serial_for_each(loop, {slice_begin, slice_end});
+  };
+  auto apply_update = [&](int64_t /* dst_pos */, scalar_t* dst_elem, const scalar_t* source_elem) {
+    f(dst_elem, source_elem);
+  };
+
+  const int64_t num_slices = iter.numel();
+  if (num_slices >= at::get_num_threads() || dst_dim_size < 2 ||
+      index.numel() < at::internal::GRAIN_SIZE) {
+    const int64_t grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / index_dim_size);
+    at::parallel_for(0, num_slices, grain_size, [&](int64_t begin, int64_t end) {
+      for_each_update(begin, end, 0, index_dim_size, apply_update);
+    });
+  } else if (!is_scatter_like) {
+    // gather writes position i of its result from position i of index, so
+    // every thread only reads the index values of its own positions.
+    at::parallel_for(0, dst_dim_size, 1, [&](int64_t begin, int64_t end) {
+      for_each_update(0, num_slices, begin, end, apply_update);
+    });
+  } else {
+    // One pass over index checks the bounds and sorts the updates into a
+    // bucket per range of destination positions, keeping the order of a
+    // serial loop. Every thread then applies the updates of its own buckets.
+    const int64_t num_buckets = std::min<int64_t>(at::get_num_threads(), dst_dim_size);
+    const int64_t bucket_size = (dst_dim_size + num_buckets - 1) / num_buckets;
+    std::vector<std::vector<std::pair<scalar_t*, const scalar_t*>>> buckets(num_buckets);
+    for (auto& bucket : buckets) {
+      bucket.reserve(index.numel() / num_buckets);
+    }
+    for_each_update(0, num_slices, 0, index_dim_size,
+                    [&](int64_t dst_pos, scalar_t* dst_elem, const scalar_t* source_elem) {
+      buckets[dst_pos / bucket_size].emplace_back(dst_elem, source_elem);
+    });
+    at::parallel_for(0, num_buckets, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; ++b) {
+        for (const auto& update : buckets[b]) {
+          f(update.first, update.second);
+        }
+      }
+    });
+  }
+}
+
+static void gather_kernel(Tensor& result, const Tensor& self, int64_t dim, const Tensor& index) {
+  AT_DISPATCH_ALL_TYPES_AND(ScalarType::Bool, self.scalar_type(), "gather_cpu", [&] {
+    cpu_scatter_gather_base_kernel</*is_scatter_like=*/false, scalar_t>(
+        self, dim, index, result, nullptr, "gather",
+        [](scalar_t* dst_elem, const scalar_t* src_elem) { *dst_elem = *src_elem; });
+  });
+}
+
+static void scatter_kernel(Tensor& self, int64_t dim, const Tensor& index, const Tensor& src) {
+  AT_DISPATCH_ALL_TYPES_AND(ScalarType::Bool, self.scalar_type(), "scatter_cpu", [&] {
+    cpu_scatter_gather_base_kernel</*is_scatter_like=*/true, scalar_t>(
+        self, dim, index, src, nullptr, "scatter",
+        [](scalar_t* dst_elem, const scalar_t* src_elem) { *dst_elem = *src_elem; });
+  });
+}
+
+static void scatter_fill_kernel(Tensor& self, int64_t dim, const Tensor& index, Scalar value_scalar) {
+  AT_DISPATCH_ALL_TYPES_AND(ScalarType::Bool, self.scalar_type(), "scatter_fill_cpu", [&] {
+    const scalar_t value = value_scalar.to<scalar_t>();
+    cpu_scatter_gather_base_kernel</*is_scatter_like=*/true, scalar_t>(
+        self, dim, index, Tensor(), &value, "scatter",
+        [](scalar_t* dst_elem, const scalar_t* src_elem) { *dst_elem = *src_elem; });
+  });
+}
+
+static void scatter_add_kernel(Tensor& self, int64_t dim, const Tensor& index, const Tensor& src) {
+  AT_DISPATCH_ALL_TYPES_AND(ScalarType::Bool, self.scalar_type(), "scatter_add_cpu", [&] {
+    cpu_scatter_gather_base_kernel</*is_scatter_like=*/true, scalar_t>(
+        self, dim, index, src, nullptr, "scatter_add",
+        [](scalar_t* dst_elem, const scalar_t* src_elem) { *dst_elem += *src_elem; });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(gather_stub, &gather_kernel);
+REGISTER_DISPATCH(scatter_stub, &scatter_kernel);
+REGISTER_DISPATCH(scatter_fill_stub, &scatter_fill_kernel);
+REGISTER_DISPATCH(scatter_add_stub, &scatter_add_kernel);
+
+}} // namespace at::native
@@ -3,7 +3,10 @@
 #include <algorithm>
 #include <iterator>
 #include <numeric>
+#include <type_traits>
+#include <vector>
 
+#include <ATen/AccumulateType.h>
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/functional.h>
@@ -184,6 +187,320 @@ inline void _vec_host_softmax_backward_lastdim(
       });
 }
 
+// Type the non-last-dim kernels compute in: BFloat16 is widened to float, so
+// that max, exp and the sums aren't rounded to BFloat16 at every step. The
+// CUDA accumulate types are used since they keep float as float.
+template <typename scalar_t>
+using softmax_acc_t = acc_type<scalar_t, /*is_cuda=*/true>;
+
+// Loads/stores the first `size` elements of a vector of accscalar_t from/to
+// scalar_t memory, where `size` is Vec::size() for all but the last chunk of
+// the inner dimension.
+template <typename accscalar_t, typename scalar_t>
+inline vec256::Vec256<accscalar_t> _load_chunk(const scalar_t* ptr, int64_t size) {
+  using Vec = vec256::Vec256<accscalar_t>;
+  if (std::is_same<scalar_t, accscalar_t>::value) {
+    return size == Vec::size() ? Vec::loadu(ptr) : Vec::loadu(ptr, size);
+  }
+  accscalar_t buffer[Vec::size()];
+  for (int64_t k = 0; k < size; k++) {
+    buffer[k] = static_cast<accscalar_t>(ptr[k]);
+  }
+  return Vec::loadu(buffer, size);
+}
+
+template <typename accscalar_t, typename scalar_t>
+inline void _store_chunk(const vec256::Vec256<accscalar_t>& vec, scalar_t* ptr, int64_t size) {
+  using Vec = vec256::Vec256<accscalar_t>;
+  if (std::is_same<scalar_t, accscalar_t>::value) {
+    vec.store(ptr, size);
+    return;
+  }
+  accscalar_t buffer[Vec::size()];
+  vec.store(buffer, size);
+  for (int64_t k = 0; k < size; k++) {
+    ptr[k] = static_cast<scalar_t>(buffer[k]);
+  }
+}
+
+// Softmax over a dimension that is not the innermost one. Elements along the
+// softmax dimension are dim_stride (= inner_size) apart, but consecutive
+// elements of the inner dimension are contiguous, so every task handles
+// Vec::size() independent softmax computations at once, one per vector lane.
+template <typename scalar_t, bool log_softmax>
+inline void _vec_softmax(
+    scalar_t* input_data_base,
+    scalar_t* output_data_base,
+    int64_t outer_size,
+    int64_t inner_size,
+    int64_t dim_size) {
+  using accscalar_t = softmax_acc_t<scalar_t>;
+  using Vec = vec256::Vec256<accscalar_t>;
+  int64_t dim_stride = inner_size;
+  int64_t outer_stride = dim_size * dim_stride;
+  int64_t vec_size = Vec::size();
+  int64_t num_chunks = (inner_size + vec_size - 1) / vec_size;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size * vec_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size * num_chunks,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          int64_t outer_idx = i / num_chunks;
+          int64_t inner_idx = (i % num_chunks) * vec_size;
+          int64_t size = std::min(vec_size, inner_size - inner_idx);
+          scalar_t* input_data =
+              input_data_base + outer_idx * outer_stride + inner_idx;
+          scalar_t* output_data =
+              output_data_base + outer_idx * outer_stride + inner_idx;
+
+          Vec max_input = _load_chunk<accscalar_t>(input_data, size);
+          for (int64_t d = 1; d < dim_size; d++) {
+            max_input = vec256::maximum(
+                max_input, _load_chunk<accscalar_t>(input_data + d * dim_stride, size));
+          }
+          Vec tmp_sum(0);
+          for (int64_t d = 0; d < dim_size; d++) {
+            Vec z = (_load_chunk<accscalar_t>(input_data + d * dim_stride, size) - max_input).exp();
+            if (!log_softmax && std::is_same<scalar_t, accscalar_t>::value) {
+              _store_chunk(z, output_data + d * dim_stride, size);
+            }
+            tmp_sum = tmp_sum + z;
+          }
+          if (log_softmax) {
+            // Same order of operations as in _vec_log_softmax_lastdim
+            tmp_sum = tmp_sum.log();
+            for (int64_t d = 0; d < dim_size; d++) {
+              Vec x = _load_chunk<accscalar_t>(input_data + d * dim_stride, size);
+              _store_chunk(x - max_input - tmp_sum, output_data + d * dim_stride, size);
+            }
+          } else {
+            tmp_sum = Vec(1) / tmp_sum;
+            for (int64_t d = 0; d < dim_size; d++) {
+              // Reduced precision outputs would round the stored exponentials
+              // before they are normalized, so they are recomputed instead.
+              Vec z = std::is_same<scalar_t, accscalar_t>::value
+                  ? _load_chunk<accscalar_t>(output_data + d * dim_stride, size)
+                  : (_load_chunk<accscalar_t>(input_data + d * dim_stride, size) - max_input).exp();
+              _store_chunk(z * tmp_sum, output_data + d * dim_stride, size);
+            }
+          }
+        }
+      });
+}
+
+template <typename scalar_t, bool log_softmax>
+inline void _vec_softmax_backward(
+    scalar_t* grad_input_data_base,
+    scalar_t* grad_data_base,
+    scalar_t* output_data_base,
+    int64_t outer_size,
+    int64_t inner_size,
+    int64_t dim_size) {
+  using accscalar_t = softmax_acc_t<scalar_t>;
+  using Vec = vec256::Vec256<accscalar_t>;
+  int64_t dim_stride = inner_size;
+  int64_t outer_stride = dim_size * dim_stride;
+  int64_t vec_size = Vec::size();
+  int64_t num_chunks = (inner_size + vec_size - 1) / vec_size;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size * vec_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size * num_chunks,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          int64_t outer_idx = i / num_chunks;
+          int64_t inner_idx = (i % num_chunks) * vec_size;
+          int64_t size = std::min(vec_size, inner_size - inner_idx);
+          int64_t offset = outer_idx * outer_stride + inner_idx;
+          scalar_t* grad_input_data = grad_input_data_base + offset;
+          scalar_t* grad_data = grad_data_base + offset;
+          scalar_t* output_data = output_data_base + offset;
+
+          Vec sum(0);
+          for (int64_t d = 0; d < dim_size; d++) {
+            Vec grad = _load_chunk<accscalar_t>(grad_data + d * dim_stride, size);
+            if (log_softmax) {
+              sum = sum + grad;
+            } else {
+              sum = sum + grad * _load_chunk<accscalar_t>(output_data + d * dim_stride, size);
+            }
+          }
+          for (int64_t d = 0; d < dim_size; d++) {
+            Vec grad = _load_chunk<accscalar_t>(grad_data + d * dim_stride, size);
+            Vec output = _load_chunk<accscalar_t>(output_data + d * dim_stride, size);
+            if (log_softmax) {
+              _store_chunk(grad - output.exp() * sum, grad_input_data + d * dim_stride, size);
+            } else {
+              _store_chunk((grad - sum) * output, grad_input_data + d * dim_stride, size);
+            }
+          }
+        }
+      });
+}
+
+// Returns the row as accscalar_t, widened into buffer for reduced precision
+// inputs.
+template <typename scalar_t>
+inline scalar_t* _acc_row(
+    scalar_t* row,
+    int64_t /* size */,
+    std::vector<scalar_t>* /* buffer */) {
+  return row;
+}
+
+template <typename accscalar_t, typename scalar_t>
+inline accscalar_t* _acc_row(
+    scalar_t* row,
+    int64_t size,
+    std::vector<accscalar_t>* buffer) {
+  buffer->resize(size);
+  for (int64_t k = 0; k < size; k++) {
+    (*buffer)[k] = static_cast<accscalar_t>(row[k]);
+  }
+  return buffer->data();
+}
+
+// Fused log_softmax + nll_loss over the last dimension of a 2-d input. Only
+// the per-row log-sum-exp is kept around for the backward pass, the
+// log-probabilities themselves are never materialized. The log-sum-exp and
+// the losses are computed in accscalar_t, float for BFloat16 inputs.
+template <typename scalar_t>
+inline void _vec_log_softmax_nll_loss(
+    scalar_t* input_data_base,
+    int64_t* target_data,
+    scalar_t* weight_data,
+    softmax_acc_t<scalar_t>* loss_data,
+    softmax_acc_t<scalar_t>* row_weight_data,
+    softmax_acc_t<scalar_t>* logsumexp_data,
+    int64_t outer_size,
+    int64_t dim_size,
+    int64_t ignore_index) {
+  using accscalar_t = softmax_acc_t<scalar_t>;
+  using Vec = vec256::Vec256<accscalar_t>;
+  static constexpr int64_t CHUNK_SIZE =
+      (128 / sizeof(accscalar_t)) * Vec::size();
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size * CHUNK_SIZE);
+  if (grain_size < CHUNK_SIZE)
+    grain_size = CHUNK_SIZE;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        std::vector<accscalar_t> row_buffer;
+        for (int64_t ii = begin; ii < end; ii += CHUNK_SIZE) {
+          accscalar_t tmp_sum_scalar[CHUNK_SIZE];
+          accscalar_t max_input_arr[CHUNK_SIZE];
+          int64_t loop_end = CHUNK_SIZE;
+          if (ii + CHUNK_SIZE > end)
+            loop_end = end - ii;
+          for (int64_t j = 0; j < loop_end; j++) {
+            int64_t i = ii + j;
+            accscalar_t* input_data =
+                _acc_row(input_data_base + i * dim_size, dim_size, &row_buffer);
+            accscalar_t max_input = vec256::reduce_all<accscalar_t>(
+                [](Vec& x, Vec& y) { return vec256::maximum(x, y); },
+                input_data,
+                dim_size);
+            max_input_arr[j] = max_input;
+            tmp_sum_scalar[j] = vec256::map_reduce_all<accscalar_t>(
+                [max_input](Vec x) { return (x - Vec(max_input)).exp(); },
+                [](Vec x, Vec y) { return x + y; },
+                input_data,
+                dim_size);
+          }
+          // See [Note AVX-SSE transitions] for why this should call the
+          // vectorized version (aside from perf improvements).
+          vec256::map(
+              [](Vec x) { return x.log(); },
+              tmp_sum_scalar,
+              tmp_sum_scalar,
+              loop_end);
+          for (int64_t j = 0; j < loop_end; j++) {
+            int64_t i = ii + j;
+            accscalar_t tmp_sum = tmp_sum_scalar[j];
+            accscalar_t max_input = max_input_arr[j];
+            logsumexp_data[i] = max_input + tmp_sum;
+
+            int64_t cur_target = target_data[i];
+            if (cur_target == ignore_index) {
+              loss_data[i] = 0;
+              row_weight_data[i] = 0;
+              continue;
+            }
+            TORCH_CHECK_INDEX(
+                cur_target >= 0 && cur_target < dim_size,
+                "Target ",
+                cur_target,
+                " is out of bounds.");
+            accscalar_t cur_weight = weight_data != nullptr
+                ? static_cast<accscalar_t>(weight_data[cur_target])
+                : static_cast<accscalar_t>(1);
+            accscalar_t x = static_cast<accscalar_t>(
+                input_data_base[i * dim_size + cur_target]);
+            // Keep the order of operations of _vec_log_softmax_lastdim
+            loss_data[i] = -(x - max_input - tmp_sum) * cur_weight;
+            row_weight_data[i] = cur_weight;
+          }
+        }
+      });
+}
+
+template <typename scalar_t>
+inline void _vec_log_softmax_nll_loss_backward(
+    scalar_t* grad_input_data_base,
+    scalar_t* input_data_base,
+    int64_t* target_data,
+    scalar_t* row_scale_data,
+    softmax_acc_t<scalar_t>* logsumexp_data,
+    int64_t outer_size,
+    int64_t dim_size,
+    int64_t ignore_index) {
+  using accscalar_t = softmax_acc_t<scalar_t>;
+  using Vec = vec256::Vec256<accscalar_t>;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          scalar_t* grad_input_data = grad_input_data_base + i * dim_size;
+          scalar_t* input_data = input_data_base + i * dim_size;
+          int64_t cur_target = target_data[i];
+          if (cur_target == ignore_index) {
+            std::fill(grad_input_data, grad_input_data + dim_size, scalar_t(0));
+            continue;
+          }
+          // d(loss)/d(input) = scale * (softmax(input) - one_hot(target))
+          accscalar_t scale = static_cast<accscalar_t>(row_scale_data[i]);
+          accscalar_t logsumexp = logsumexp_data[i];
+          for (int64_t d = 0; d < dim_size; d += Vec::size()) {
+            int64_t size = std::min<int64_t>(Vec::size(), dim_size - d);
+            Vec x = _load_chunk<accscalar_t>(input_data + d, size);
+            _store_chunk(
+                (x - Vec(logsumexp)).exp() * Vec(scale),
+                grad_input_data + d,
+                size);
+          }
+          grad_input_data[cur_target] -= static_cast<scalar_t>(scale);
+        }
+      });
+}
+
 template <typename scalar_t, bool LogSoftMax>
 struct vec_host_softmax_lastdim {
   static void apply(Tensor& output, const Tensor& input) {
@@ -223,6 +540,50 @@ struct vec_host_softmax_backward_lastdim {
   }
 };
 
+template <typename scalar_t, bool LogSoftMax>
+struct vec_host_softmax {
+  static void apply(Tensor& output, const Tensor& input, int64_t dim) {
+    int64_t outer_size = 1;
+    int64_t dim_size = input.size(dim);
+    int64_t inner_size = 1;
+    for (int64_t i = 0; i < dim; ++i)
+      outer_size *= input.size(i);
+    for (int64_t i = dim + 1; i < input.dim(); ++i)
+      inner_size *= input.size(i);
+    scalar_t* input_data_base = input.data_ptr<scalar_t>();
+    scalar_t* output_data_base = output.data_ptr<scalar_t>();
+    _vec_softmax<scalar_t, LogSoftMax>(
+        input_data_base, output_data_base, outer_size, inner_size, dim_size);
+  }
+};
+
+template <typename scalar_t, bool LogSoftMax>
+struct vec_host_softmax_backward {
+  static void apply(
+      Tensor& grad_input,
+      const Tensor& grad,
+      const Tensor& output,
+      int64_t dim) {
+    int64_t outer_size = 1;
+    int64_t dim_size = grad.size(dim);
+    int64_t inner_size = 1;
+    for (int64_t i = 0; i < dim; ++i)
+      outer_size *= grad.size(i);
+    for (int64_t i = dim + 1; i < grad.dim(); ++i)
+      inner_size *= grad.size(i);
+    scalar_t* grad_input_data_base = grad_input.data_ptr<scalar_t>();
+    scalar_t* grad_data_base = grad.data_ptr<scalar_t>();
+    scalar_t* output_data_base = output.data_ptr<scalar_t>();
+    _vec_softmax_backward<scalar_t, LogSoftMax>(
+        grad_input_data_base,
+        grad_data_base,
+        output_data_base,
+        outer_size,
+        inner_size,
+        dim_size);
+  }
+};
+
 static void softmax_lastdim_kernel_impl(Tensor& result, const Tensor& self) {
   AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "softmax_lastdim_kernel_impl", [&] {
     vec_host_softmax_lastdim<scalar_t, false>::apply(result, self);
@@ -261,6 +622,95 @@ static void log_softmax_backward_lastdim_kernel_impl(
       });
 }
 
+static void softmax_kernel_impl(Tensor& result, const Tensor& self, int64_t dim) {
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "softmax_kernel_impl", [&] {
+    vec_host_softmax<scalar_t, false>::apply(result, self, dim);
+  });
+}
+
+static void log_softmax_kernel_impl(
+    Tensor& result,
+    const Tensor& self,
+    int64_t dim) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, self.scalar_type(),
+      "log_softmax_kernel_impl",
+      [&] { vec_host_softmax<scalar_t, true>::apply(result, self, dim); });
+}
+
+static void softmax_backward_kernel_impl(
+    Tensor& grad_input,
+    const Tensor& grad,
+    const Tensor& output,
+    int64_t dim) {
+  AT_DISPATCH_FLOATING_TYPES(
+      grad.scalar_type(), "softmax_backward_kernel_impl", [&] {
+        vec_host_softmax_backward<scalar_t, false>::apply(
+            grad_input, grad, output, dim);
+      });
+}
+
+static void log_softmax_backward_kernel_impl(
+    Tensor& grad_input,
+    const Tensor& grad,
+    const Tensor& output,
+    int64_t dim) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, grad.scalar_type(),
+      "log_softmax_backward_kernel_impl", [&] {
+        vec_host_softmax_backward<scalar_t, true>::apply(
+            grad_input, grad, output, dim);
+      });
+}
+
+static void log_softmax_nll_loss_kernel_impl(
+    Tensor& loss,
+    Tensor& row_weight,
+    Tensor& logsumexp,
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& weight,
+    int64_t ignore_index) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, self.scalar_type(),
+      "log_softmax_nll_loss_kernel_impl", [&] {
+        using accscalar_t = softmax_acc_t<scalar_t>;
+        _vec_log_softmax_nll_loss<scalar_t>(
+            self.data_ptr<scalar_t>(),
+            target.data_ptr<int64_t>(),
+            weight.defined() ? weight.data_ptr<scalar_t>() : nullptr,
+            loss.data_ptr<accscalar_t>(),
+            row_weight.data_ptr<accscalar_t>(),
+            logsumexp.data_ptr<accscalar_t>(),
+            self.size(0),
+            self.size(1),
+            ignore_index);
+      });
+}
+
+static void log_softmax_nll_loss_backward_kernel_impl(
+    Tensor& grad_input,
+    const Tensor& self,
+    const Tensor& target,
+    const Tensor& row_scale,
+    const Tensor& logsumexp,
+    int64_t ignore_index) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, self.scalar_type(),
+      "log_softmax_nll_loss_backward_kernel_impl", [&] {
+        using accscalar_t = softmax_acc_t<scalar_t>;
+        _vec_log_softmax_nll_loss_backward<scalar_t>(
+            grad_input.data_ptr<scalar_t>(),
+            self.data_ptr<scalar_t>(),
+            target.data_ptr<int64_t>(),
+            row_scale.data_ptr<scalar_t>(),
+            logsumexp.data_ptr<accscalar_t>(),
+            self.size(0),
+            self.size(1),
+            ignore_index);
+      });
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(softmax_lastdim_kernel, &softmax_lastdim_kernel_impl);
@@ -272,4 +722,17 @@ REGISTER_DISPATCH(
     log_softmax_backward_lastdim_kernel,
     &log_softmax_backward_lastdim_kernel_impl);
 
+REGISTER_DISPATCH(softmax_kernel, &softmax_kernel_impl);
+REGISTER_DISPATCH(log_softmax_kernel, &log_softmax_kernel_impl);
+REGISTER_DISPATCH(softmax_backward_kernel, &softmax_backward_kernel_impl);
+REGISTER_DISPATCH(
+    log_softmax_backward_kernel,
+    &log_softmax_backward_kernel_impl);
+REGISTER_DISPATCH(
+    log_softmax_nll_loss_kernel,
+    &log_softmax_nll_loss_kernel_impl);
+REGISTER_DISPATCH(
+    log_softmax_nll_loss_backward_kernel,
+    &log_softmax_nll_loss_backward_kernel_impl);
+
 }} // namespace at::native
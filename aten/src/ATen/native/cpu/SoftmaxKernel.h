@@ -8,11 +8,26 @@ namespace native {
 
 using forward_fn = void(*)(Tensor &, const Tensor &);
 using backward_fn = void(*)(Tensor &, const Tensor &, const Tensor&);
+using forward_fn_with_dim = void(*)(Tensor &, const Tensor &, int64_t);
+using backward_fn_with_dim = void(*)(Tensor &, const Tensor &, const Tensor&, int64_t);
+// (loss, row_weight, logsumexp, self, target, weight, ignore_index)
+// loss, row_weight and logsumexp are float for BFloat16 inputs.
+using log_softmax_nll_loss_fn = void(*)(Tensor &, Tensor &, Tensor &, const Tensor &, const Tensor &, const Tensor &, int64_t);
+// (grad_input, self, target, row_scale, logsumexp, ignore_index)
+using log_softmax_nll_loss_backward_fn = void(*)(Tensor &, const Tensor &, const Tensor &, const Tensor &, const Tensor &, int64_t);
 
 DECLARE_DISPATCH(forward_fn, softmax_lastdim_kernel);
 DECLARE_DISPATCH(forward_fn, log_softmax_lastdim_kernel);
 DECLARE_DISPATCH(backward_fn, softmax_backward_lastdim_kernel);
 DECLARE_DISPATCH(backward_fn, log_softmax_backward_lastdim_kernel);
 
+DECLARE_DISPATCH(forward_fn_with_dim, softmax_kernel);
+DECLARE_DISPATCH(forward_fn_with_dim, log_softmax_kernel);
+DECLARE_DISPATCH(backward_fn_with_dim, softmax_backward_kernel);
+DECLARE_DISPATCH(backward_fn_with_dim, log_softmax_backward_kernel);
+
+DECLARE_DISPATCH(log_softmax_nll_loss_fn, log_softmax_nll_loss_kernel);
+DECLARE_DISPATCH(log_softmax_nll_loss_backward_fn, log_softmax_nll_loss_backward_kernel);
+
 }
 }
@@ -333,6 +333,77 @@ static void geometric_kernel(TensorIterator& iter, double p, Generator* gen) {
   });
 }
 
+// Fills the output of iter with sampler(engine), where engine is the philox
+// engine of the subsequence given by the linear index of the element. Every
+// sampler draws at most four 32 bit values, i.e. a single 128 bit value of its
+// subsequence, so each call advances the offset of the generator by one.
+// See Note [Philox mode of CPUGenerator]
+template <typename scalar_t, typename sampler_t>
+void cpu_philox_kernel(TensorIterator& iter, CPUGenerator* generator, const sampler_t& sampler) {
+  std::pair<uint64_t, uint64_t> rng_engine_inputs;
+  {
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(generator->mutex_);
+    rng_engine_inputs = generator->philox_engine_inputs(1);
+  }
+  const uint64_t seed = rng_engine_inputs.first;
+  const uint64_t offset = rng_engine_inputs.second;
+  at::parallel_for(0, iter.numel(), at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    uint64_t linear_index = begin;
+    iter.serial_for_each([&](char** data, const int64_t* strides, int64_t n) {
+      char* out = data[0];
+      for (int64_t i = 0; i < n; i++, linear_index++) {
+        at::philox_engine engine(seed, linear_index, offset);
+        *reinterpret_cast<scalar_t*>(out + i * strides[0]) = sampler(engine);
+      }
+    }, {begin, end});
+  });
+}
+
+// Same bits as uniform_real_distribution, from one 32 bit value for float
+// and two for double.
+template <typename scalar_t>
+inline scalar_t philox_standard_uniform(at::philox_engine& engine) {
+  if (std::is_same<scalar_t, double>::value) {
+    uint64_t hi = engine();
+    uint64_t lo = engine();
+    return ((hi << 32 | lo) & DOUBLE_MASK) * DOUBLE_DIVISOR;
+  }
+  return (engine() & FLOAT_MASK) * FLOAT_DIVISOR;
+}
+
+static void uniform_philox_kernel(TensorIterator& iter, double from, double to, CPUGenerator* generator) {
+  AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "uniform_philox_cpu", [&]() {
+    const scalar_t from_ = static_cast<scalar_t>(from);
+    const scalar_t range = static_cast<scalar_t>(to - from);
+    cpu_philox_kernel<scalar_t>(iter, generator, [from_, range](at::philox_engine& engine) -> scalar_t {
+      return philox_standard_uniform<scalar_t>(engine) * range + from_;
+    });
+  });
+}
+
+static void normal_philox_kernel(TensorIterator& iter, double mean, double std, CPUGenerator* generator) {
+  AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "normal_philox_cpu", [&]() {
+    // Box-Muller as in normal_distribution, without caching the second
+    // sample so that every element only depends on its own subsequence.
+    cpu_philox_kernel<scalar_t>(iter, generator, [mean, std](at::philox_engine& engine) -> scalar_t {
+      const double u1 = philox_standard_uniform<double>(engine);
+      const double u2 = philox_standard_uniform<double>(engine);
+      const double r = ::sqrt(-2 * ::log(1 - u2));
+      const double theta = 2.0 * M_PI * u1;
+      return static_cast<scalar_t>(r * ::cos(theta) * std + mean);
+    });
+  });
+}
+
+static void bernoulli_scalar_philox_kernel(TensorIterator& iter, double p, CPUGenerator* generator) {
+  AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, iter.dtype(), "bernoulli_scalar_philox_cpu", [&]() {
+    cpu_philox_kernel<scalar_t>(iter, generator, [p](at::philox_engine& engine) -> scalar_t {
+      return static_cast<scalar_t>(philox_standard_uniform<double>(engine) < p);
+    });
+  });
+}
+
 static void rsqrt_kernel(TensorIterator& iter) {
   AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(iter.dtype(), "rsqrt_cpu", [&] {
     cpu_kernel_vec(
@@ -415,6 +486,9 @@ REGISTER_DISPATCH(sigmoid_stub, &sigmoid_kernel);
 REGISTER_DISPATCH(bernoulli_mkl_stub, &bernoulli_mkl_kernel);
 REGISTER_DISPATCH(cauchy_stub, &cauchy_kernel);
 REGISTER_DISPATCH(geometric_stub, &geometric_kernel);
+REGISTER_DISPATCH(uniform_philox_stub, &uniform_philox_kernel);
+REGISTER_DISPATCH(normal_philox_stub, &normal_philox_kernel);
+REGISTER_DISPATCH(bernoulli_scalar_philox_stub, &bernoulli_scalar_philox_kernel);
 REGISTER_DISPATCH(abs_stub, &abs_kernel);
 REGISTER_DISPATCH(angle_stub, &angle_kernel);
 REGISTER_DISPATCH(real_stub, &real_kernel);
@@ -0,0 +1,577 @@
+#include <ATen/native/batch_norm.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at {
+namespace native {
+
+namespace {
+
+// The input of batch norm is viewed either as N planes per channel, i.e.
+// (N, C, image_size) with contiguous images, or as rows of channels, i.e.
+// (N * image_size, C). The latter is used for channels last inputs and for
+// inputs without spatial dimensions.
+//
+// Statistics and gradient sums are accumulated in a single pass over the
+// input. In the planes layout every channel is reduced by one thread with
+// vectors running along the images, in chunks of at most kChunkRows vectors
+// of an image. In the rows layout vectors run along the channels, the rows are
+// split in chunks reduced in parallel. In both layouts the partial results of
+// the chunks are merged in the accumulate type.
+
+// Rows of a chunk in the rows layout, and vectors of a chunk of an image in the
+// planes layout. This bounds the number of values added in scalar_t before
+// moving to the accumulate type.
+constexpr int64_t kChunkRows = 1024;
+
+inline bool batch_norm_use_rows_layout(const Tensor& input) {
+  const int64_t image_size = input.numel() / input.size(0) / input.size(1);
+  return !input.is_contiguous() || image_size == 1;
+}
+
+inline int64_t batch_norm_num_chunks(int64_t n_rows) {
+  const int64_t chunk_rows = std::min(
+      kChunkRows, divup(n_rows, static_cast<int64_t>(at::get_num_threads())));
+  return divup(n_rows, chunk_rows);
+}
+
+template <typename T>
+inline void welford_update(T& mean, T& m2, const T& x, const T& inv_n) {
+  const T delta = x - mean;
+  mean = mean + delta * inv_n;
+  m2 = m2 + delta * (x - mean);
+}
+
+// Merges the statistics of n_b other samples into those of n samples.
+template <typename acc_t>
+inline void welford_merge(
+    int64_t& n,
+    acc_t& mean,
+    acc_t& m2,
+    int64_t n_b,
+    acc_t mean_b,
+    acc_t m2_b) {
+  if (n_b == 0) {
+    return;
+  }
+  const int64_t n_ab = n + n_b;
+  const acc_t delta = mean_b - mean;
+  const acc_t ratio = static_cast<acc_t>(n_b) / static_cast<acc_t>(n_ab);
+  mean += delta * ratio;
+  m2 += m2_b + delta * delta * static_cast<acc_t>(n) * ratio;
+  n = n_ab;
+}
+
+template <typename T, typename acc_t>
+void batch_norm_collect_stats_planes(
+    const T* input_data,
+    int64_t n_batch,
+    int64_t n_channel,
+    int64_t image_size,
+    acc_t* mean_data,
+    acc_t* var_sum_data) {
+  using Vec = vec256::Vec256<T>;
+  const int64_t vec_end = image_size - image_size % Vec::size();
+  const int64_t chunk_size = kChunkRows * Vec::size();
+  at::parallel_for(0, n_channel, 1, [&](int64_t start, int64_t end) {
+    for (int64_t c = start; c < end; ++c) {
+      acc_t mean_val = 0;
+      acc_t m2_val = 0;
+      int64_t n_val = 0;
+      for (int64_t n = 0; n < n_batch; ++n) {
+        const T* x_ptr = input_data + (n * n_channel + c) * image_size;
+        for (int64_t chunk = 0; chunk < vec_end; chunk += chunk_size) {
+          // All the lanes of the vector see the same number of samples.
+          const int64_t chunk_end = std::min(vec_end, chunk + chunk_size);
+          Vec mean_vec(0);
+          Vec m2_vec(0);
+          int64_t n_vec = 0;
+          for (int64_t d = chunk; d < chunk_end; d += Vec::size()) {
+            ++n_vec;
+            welford_update(
+                mean_vec, m2_vec, Vec::loadu(x_ptr + d), Vec(T(1) / n_vec));
+          }
+          T mean_arr[Vec::size()];
+          T m2_arr[Vec::size()];
+          mean_vec.store(mean_arr);
+          m2_vec.store(m2_arr);
+          for (int64_t j = 0; j < Vec::size(); ++j) {
+            welford_merge<acc_t>(
+                n_val, mean_val, m2_val, n_vec, mean_arr[j], m2_arr[j]);
+          }
+        }
+        // The tails of the images go to the scalar statistics.
+        for (int64_t d = vec_end; d < image_size; ++d) {
+          ++n_val;
+          welford_update(
+              mean_val, m2_val, static_cast<acc_t>(x_ptr[d]), acc_t(1) / n_val);
+        }
+      }
+      mean_data[c] = mean_val;
+      var_sum_data[c] = m2_val;
+    }
+  });
+}
+
+template <typename T, typename acc_t>
+void batch_norm_collect_stats_rows(
+    const T* input_data,
+    int64_t n_rows,
+    int64_t n_channel,
+    acc_t* mean_data,
+    acc_t* var_sum_data) {
+  using Vec = vec256::Vec256<T>;
+  const int64_t vec_end = n_channel - n_channel % Vec::size();
+  const int64_t n_chunks = batch_norm_num_chunks(n_rows);
+  // Statistics of every chunk, all the channels of a chunk see the same
+  // number of samples.
+  std::vector<T> chunk_mean(n_chunks * n_channel, T(0));
+  std::vector<T> chunk_m2(n_chunks * n_channel, T(0));
+  at::parallel_for(0, n_chunks, 1, [&](int64_t start, int64_t end) {
+    for (int64_t chunk = start; chunk < end; ++chunk) {
+      T* mean_ptr = chunk_mean.data() + chunk * n_channel;
+      T* m2_ptr = chunk_m2.data() + chunk * n_channel;
+      const int64_t row_begin = chunk * n_rows / n_chunks;
+      const int64_t row_end = (chunk + 1) * n_rows / n_chunks;
+      for (int64_t r = row_begin; r < row_end; ++r) {
+        const T* x_ptr = input_data + r * n_channel;
+        const T inv_n = T(1) / (r - row_begin + 1);
+        int64_t d = 0;
+        for (; d < vec_end; d += Vec::size()) {
+          Vec mean_vec = Vec::loadu(mean_ptr + d);
+          Vec m2_vec = Vec::loadu(m2_ptr + d);
+          welford_update(mean_vec, m2_vec, Vec::loadu(x_ptr + d), Vec(inv_n));
+          mean_vec.store(mean_ptr + d);
+          m2_vec.store(m2_ptr + d);
+        }
+        for (; d < n_channel; ++d) {
+          welford_update(mean_ptr[d], m2_ptr[d], x_ptr[d], inv_n);
+        }
+      }
+    }
+  });
+  for (int64_t c = 0; c < n_channel; ++c) {
+    acc_t mean_val = 0;
+    acc_t m2_val = 0;
+    int64_t n_val = 0;
+    for (int64_t chunk = 0; chunk < n_chunks; ++chunk) {
+      const int64_t rows =
+          (chunk + 1) * n_rows / n_chunks - chunk * n_rows / n_chunks;
+      welford_merge<acc_t>(
+          n_val,
+          mean_val,
+          m2_val,
+          rows,
+          chunk_mean[chunk * n_channel + c],
+          chunk_m2[chunk * n_channel + c]);
+    }
+    mean_data[c] = mean_val;
+    var_sum_data[c] = m2_val;
+  }
+}
+
+void batch_norm_cpu_collect_stats_kernel(
+    Tensor& mean,
+    Tensor& var_sum,
+    const Tensor& input) {
+  const int64_t n_batch = input.size(0);
+  const int64_t n_channel = input.size(1);
+  const int64_t image_size = input.numel() / n_batch / n_channel;
+  const bool rows_layout = batch_norm_use_rows_layout(input);
+  AT_DISPATCH_FLOATING_TYPES(
+      input.scalar_type(), "batch_norm_cpu_collect_stats", [&]() {
+        using acc_t = at::acc_type<scalar_t, false>;
+        if (rows_layout) {
+          batch_norm_collect_stats_rows<scalar_t, acc_t>(
+              input.data_ptr<scalar_t>(),
+              n_batch * image_size,
+              n_channel,
+              mean.data_ptr<acc_t>(),
+              var_sum.data_ptr<acc_t>());
+        } else {
+          batch_norm_collect_stats_planes<scalar_t, acc_t>(
+              input.data_ptr<scalar_t>(),
+              n_batch,
+              n_channel,
+              image_size,
+              mean.data_ptr<acc_t>(),
+              var_sum.data_ptr<acc_t>());
+        }
+      });
+}
+
+// Applies y = x * alpha[c] + beta[c], and with x2 non null
+// y = x * alpha[c] + x2 * gamma[c] + beta[c].
+template <typename T>
+void batch_norm_apply_affine(
+    T* output_data,
+    const T* input_data,
+    const T* input2_data,
+    const T* alpha,
+    const T* gamma,
+    const T* beta,
+    int64_t n_batch,
+    int64_t n_channel,
+    int64_t image_size,
+    bool rows_layout) {
+  using Vec = vec256::Vec256<T>;
+  if (!rows_layout) {
+    const int64_t vec_end = image_size - image_size % Vec::size();
+    const int64_t grain_size =
+        std::max<int64_t>(1, at::internal::GRAIN_SIZE / image_size);
+    at::parallel_for(
+        0, n_batch * n_channel, grain_size, [&](int64_t start, int64_t end) {
+          for (int64_t i = start; i < end; ++i) {
+            const int64_t c = i % n_channel;
+            const T* x_ptr = input_data + i * image_size;
+            const T* x2_ptr =
+                input2_data == nullptr ? nullptr : input2_data + i * image_size;
+            T* y_ptr = output_data + i * image_size;
+            const Vec alpha_vec(alpha[c]);
+            const Vec beta_vec(beta[c]);
+            int64_t d = 0;
+            if (x2_ptr == nullptr) {
+              for (; d < vec_end; d += Vec::size()) {
+                Vec y = Vec::loadu(x_ptr + d) * alpha_vec + beta_vec;
+                y.store(y_ptr + d);
+              }
+              for (; d < image_size; ++d) {
+                y_ptr[d] = x_ptr[d] * alpha[c] + beta[c];
+              }
+            } else {
+              const Vec gamma_vec(gamma[c]);
+              for (; d < vec_end; d += Vec::size()) {
+                Vec y = Vec::loadu(x_ptr + d) * alpha_vec +
+                    Vec::loadu(x2_ptr + d) * gamma_vec + beta_vec;
+                y.store(y_ptr + d);
+              }
+              for (; d < image_size; ++d) {
+                y_ptr[d] = x_ptr[d] * alpha[c] + x2_ptr[d] * gamma[c] + beta[c];
+              }
+            }
+          }
+        });
+  } else {
+    const int64_t vec_end = n_channel - n_channel % Vec::size();
+    const int64_t grain_size =
+        std::max<int64_t>(1, at::internal::GRAIN_SIZE / n_channel);
+    at::parallel_for(
+        0, n_batch * image_size, grain_size, [&](int64_t start, int64_t end) {
+          for (int64_t r = start; r < end; ++r) {
+            const T* x_ptr = input_data + r * n_channel;
+            const T* x2_ptr =
+                input2_data == nullptr ? nullptr : input2_data + r * n_channel;
+            T* y_ptr = output_data + r * n_channel;
+            int64_t d = 0;
+            if (x2_ptr == nullptr) {
+              for (; d < vec_end; d += Vec::size()) {
+                Vec y = Vec::loadu(x_ptr + d) * Vec::loadu(alpha + d) +
+                    Vec::loadu(beta + d);
+                y.store(y_ptr + d);
+              }
+              for (; d < n_channel; ++d) {
+                y_ptr[d] = x_ptr[d] * alpha[d] + beta[d];
+              }
+            } else {
+              for (; d < vec_end; d += Vec::size()) {
+                Vec y = Vec::loadu(x_ptr + d) * Vec::loadu(alpha + d) +
+                    Vec::loadu(x2_ptr + d) * Vec::loadu(gamma + d) +
+                    Vec::loadu(beta + d);
+                y.store(y_ptr + d);
+              }
+              for (; d < n_channel; ++d) {
+                y_ptr[d] = x_ptr[d] * alpha[d] + x2_ptr[d] * gamma[d] + beta[d];
+              }
+            }
+          }
+        });
+  }
+}
+
+template <typename T>
+void batch_norm_cpu_kernel_impl(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    const Tensor& mean,
+    const Tensor& invstd) {
+  const int64_t n_batch = input.size(0);
+  const int64_t n_channel = input.size(1);
+  const int64_t image_size = input.numel() / n_batch / n_channel;
+  const auto weight_a = weight.defined() ? weight.accessor<T, 1>()
+                                         : TensorAccessor<T, 1>(nullptr, nullptr, nullptr);
+  const auto bias_a = bias.defined() ? bias.accessor<T, 1>()
+                                     : TensorAccessor<T, 1>(nullptr, nullptr, nullptr);
+  const auto mean_a = mean.accessor<T, 1>();
+  const auto invstd_a = invstd.accessor<T, 1>();
+
+  // output = (input - mean) * invstd * weight + bias
+  //        = input * alpha + beta
+  std::vector<T> alpha(n_channel);
+  std::vector<T> beta(n_channel);
+  for (int64_t c = 0; c < n_channel; ++c) {
+    const T weight_v = weight.defined() ? weight_a[c] : T(1);
+    const T bias_v = bias.defined() ? bias_a[c] : T(0);
+    alpha[c] = invstd_a[c] * weight_v;
+    beta[c] = bias_v - mean_a[c] * alpha[c];
+  }
+  batch_norm_apply_affine<T>(
+      output.data_ptr<T>(),
+      input.data_ptr<T>(),
+      nullptr,
+      alpha.data(),
+      nullptr,
+      beta.data(),
+      n_batch,
+      n_channel,
+      image_size,
+      batch_norm_use_rows_layout(input));
+}
+
+void batch_norm_cpu_kernel(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    const Tensor& mean,
+    const Tensor& invstd) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_cpu", [&]() {
+    batch_norm_cpu_kernel_impl<scalar_t>(
+        output, input, weight, bias, mean, invstd);
+  });
+}
+
+// Computes sum(grad_output) and sum((input - mean) * grad_output) per
+// channel.
+template <typename T>
+void batch_norm_backward_reduce_planes(
+    const T* grad_output_data,
+    const T* input_data,
+    const T* mean_data,
+    int64_t n_batch,
+    int64_t n_channel,
+    int64_t image_size,
+    at::acc_type<T, false>* sum_data,
+    at::acc_type<T, false>* dotp_data) {
+  using acc_t = at::acc_type<T, false>;
+  using Vec = vec256::Vec256<T>;
+  const int64_t vec_end = image_size - image_size % Vec::size();
+  at::parallel_for(0, n_channel, 1, [&](int64_t start, int64_t end) {
+    for (int64_t c = start; c < end; ++c) {
+      const T mean_v = mean_data[c];
+      const Vec mean_vec(mean_v);
+      acc_t sum = 0;
+      acc_t dotp = 0;
+      for (int64_t n = 0; n < n_batch; ++n) {
+        const int64_t offset = (n * n_channel + c) * image_size;
+        const T* dy_ptr = grad_output_data + offset;
+        const T* x_ptr = input_data + offset;
+        Vec sum_vec(0);
+        Vec dotp_vec(0);
+        int64_t d = 0;
+        for (; d < vec_end; d += Vec::size()) {
+          const Vec dy = Vec::loadu(dy_ptr + d);
+          sum_vec = sum_vec + dy;
+          dotp_vec = dotp_vec + (Vec::loadu(x_ptr + d) - mean_vec) * dy;
+        }
+        for (; d < image_size; ++d) {
+          sum += dy_ptr[d];
+          dotp += (x_ptr[d] - mean_v) * dy_ptr[d];
+        }
+        T sum_arr[Vec::size()];
+        T dotp_arr[Vec::size()];
+        sum_vec.store(sum_arr);
+        dotp_vec.store(dotp_arr);
+        for (int64_t j = 0; j < Vec::size(); ++j) {
+          sum += sum_arr[j];
+          dotp += dotp_arr[j];
+        }
+      }
+      sum_data[c] = sum;
+      dotp_data[c] = dotp;
+    }
+  });
+}
+
+template <typename T>
+void batch_norm_backward_reduce_rows(
+    const T* grad_output_data,
+    const T* input_data,
+    const T* mean_data,
+    int64_t n_rows,
+    int64_t n_channel,
+    at::acc_type<T, false>* sum_data,
+    at::acc_type<T, false>* dotp_data) {
+  using acc_t = at::acc_type<T, false>;
+  using Vec = vec256::Vec256<T>;
+  const int64_t vec_end = n_channel - n_channel % Vec::size();
+  const int64_t n_chunks = batch_norm_num_chunks(n_rows);
+  std::vector<T> chunk_sum(n_chunks * n_channel, T(0));
+  std::vector<T> chunk_dotp(n_chunks * n_channel, T(0));
+  at::parallel_for(0, n_chunks, 1, [&](int64_t start, int64_t end) {
+    for (int64_t chunk = start; chunk < end; ++chunk) {
+      T* sum_ptr = chunk_sum.data() + chunk * n_channel;
+      T* dotp_ptr = chunk_dotp.data() + chunk * n_channel;
+      const int64_t row_begin = chunk * n_rows / n_chunks;
+      const int64_t row_end = (chunk + 1) * n_rows / n_chunks;
+      for (int64_t r = row_begin; r < row_end; ++r) {
+        const T* dy_ptr = grad_output_data + r * n_channel;
+        const T* x_ptr = input_data + r * n_channel;
+        int64_t d = 0;
+        for (; d < vec_end; d += Vec::size()) {
+          const Vec dy = Vec::loadu(dy_ptr + d);
+          const Vec sum_vec = Vec::loadu(sum_ptr + d) + dy;
+          const Vec dotp_vec = Vec::loadu(dotp_ptr + d) +
+              (Vec::loadu(x_ptr + d) - Vec::loadu(mean_data + d)) * dy;
+          sum_vec.store(sum_ptr + d);
+          dotp_vec.store(dotp_ptr + d);
+        }
+        for (; d < n_channel; ++d) {
+          sum_ptr[d] += dy_ptr[d];
+          dotp_ptr[d] += (x_ptr[d] - mean_data[d]) * dy_ptr[d];
+        }
+      }
+    }
+  });
+  for (int64_t c = 0; c < n_channel; ++c) {
+    acc_t sum = 0;
+    acc_t dotp = 0;
+    for (int64_t chunk = 0; chunk < n_chunks; ++chunk) {
+      sum += chunk_sum[chunk * n_channel + c];
+      dotp += chunk_dotp[chunk * n_channel + c];
+    }
+    sum_data[c] = sum;
+    dotp_data[c] = dotp;
+  }
+}
+
+template <typename T>
+void batch_norm_cpu_backward_kernel_impl(
+    Tensor& grad_input,
+    Tensor& grad_weight,
+    Tensor& grad_bias,
+    const Tensor& grad_output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& mean,
+    const Tensor& invstd) {
+  using acc_t = at::acc_type<T, false>;
+  const int64_t n_batch = input.size(0);
+  const int64_t n_channel = input.size(1);
+  const int64_t image_size = input.numel() / n_batch / n_channel;
+  const int64_t n = n_batch * image_size;
+  const bool rows_layout = batch_norm_use_rows_layout(input);
+  const Tensor mean_contig = mean.contiguous();
+  const T* mean_data = mean_contig.data_ptr<T>();
+  const auto invstd_a = invstd.accessor<T, 1>();
+  const auto weight_a = weight.defined() ? weight.accessor<T, 1>()
+                                         : TensorAccessor<T, 1>(nullptr, nullptr, nullptr);
+
+  std::vector<acc_t> sum(n_channel);
+  std::vector<acc_t> dotp(n_channel);
+  if (rows_layout) {
+    batch_norm_backward_reduce_rows<T>(
+        grad_output.data_ptr<T>(),
+        input.data_ptr<T>(),
+        mean_data,
+        n,
+        n_channel,
+        sum.data(),
+        dotp.data());
+  } else {
+    batch_norm_backward_reduce_planes<T>(
+        grad_output.data_ptr<T>(),
+        input.data_ptr<T>(),
+        mean_data,
+        n_batch,
+        n_channel,
+        image_size,
+        sum.data(),
+        dotp.data());
+  }
+
+  if (grad_weight.defined()) {
+    auto grad_weight_a = grad_weight.accessor<T, 1>();
+    for (int64_t c = 0; c < n_channel; ++c) {
+      grad_weight_a[c] = dotp[c] * invstd_a[c];
+    }
+  }
+  if (grad_bias.defined()) {
+    auto grad_bias_a = grad_bias.accessor<T, 1>();
+    for (int64_t c = 0; c < n_channel; ++c) {
+      grad_bias_a[c] = sum[c];
+    }
+  }
+  if (!grad_input.defined()) {
+    return;
+  }
+
+  // Q(X) = X - E[x] ; i.e. input centered to zero mean
+  // Y = Q(X) / sigma    ; i.e. BN output before weight and bias
+  // dL/dX = (Q(dL/dY) - dot(Y, dL/dY) * Y) / sigma * w
+  //       = dL/dY * alpha + X * gamma + beta
+  std::vector<T> alpha(n_channel);
+  std::vector<T> gamma(n_channel);
+  std::vector<T> beta(n_channel);
+  for (int64_t c = 0; c < n_channel; ++c) {
+    const acc_t invstd_v = invstd_a[c];
+    const acc_t w = weight.defined() ? weight_a[c] : T(1);
+    const acc_t k = dotp[c] * invstd_v * invstd_v / n;
+    const acc_t grad_mean = sum[c] / n;
+    alpha[c] = invstd_v * w;
+    gamma[c] = -k * invstd_v * w;
+    beta[c] = (mean_data[c] * k - grad_mean) * invstd_v * w;
+  }
+  batch_norm_apply_affine<T>(
+      grad_input.data_ptr<T>(),
+      grad_output.data_ptr<T>(),
+      input.data_ptr<T>(),
+      alpha.data(),
+      gamma.data(),
+      beta.data(),
+      n_batch,
+      n_channel,
+      image_size,
+      rows_layout);
+}
+
+void batch_norm_cpu_backward_kernel(
+    Tensor& grad_input,
+    Tensor& grad_weight,
+    Tensor& grad_bias,
+    const Tensor& grad_output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& mean,
+    const Tensor& invstd) {
+  AT_DISPATCH_FLOATING_TYPES(
+      input.scalar_type(), "batch_norm_cpu_backward", [&]() {
+        batch_norm_cpu_backward_kernel_impl<scalar_t>(
+            grad_input,
+            grad_weight,
+            grad_bias,
+            grad_output,
+            input,
+            weight,
+            mean,
+            invstd);
+      });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(batch_norm_cpu_collect_stats_stub, &batch_norm_cpu_collect_stats_kernel);
+REGISTER_DISPATCH(batch_norm_cpu_stub, &batch_norm_cpu_kernel);
+REGISTER_DISPATCH(batch_norm_cpu_backward_stub, &batch_norm_cpu_backward_kernel);
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/mkl/Descriptors.h>
+#include <ATen/native/utils/ParamsHash.h>
+
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace at { namespace native { namespace detail {
+
+constexpr int mkl_fft_max_rank = 3;
+
+// This POD struct holds everything a committed DFTI descriptor depends on.
+// It will be the **key** to the plan cache. Strides and distances are in
+// units of the (real or complex) MKL data type.
+struct MKLFFTParams
+{
+  at::ScalarType scalar_type_;
+  uint8_t signal_ndim_;  // between 1 and mkl_fft_max_rank
+  bool complex_input_;
+  bool complex_output_;
+  bool inverse_;
+  bool normalized_;
+  bool single_threaded_;  // whether the descriptor runs inside at::parallel_for
+  int64_t signal_sizes_[mkl_fft_max_rank];
+  int64_t batch_;
+  int64_t input_distance_;
+  int64_t output_distance_;
+  int64_t input_strides_[mkl_fft_max_rank];
+  int64_t output_strides_[mkl_fft_max_rank];
+};
+
+// NB: This can't be a constructor, because then MKLFFTParams
+// would not be a POD anymore.
+static inline void setMKLFFTParams(MKLFFTParams* params,
+    at::ScalarType scalar_type, int64_t signal_ndim, bool complex_input,
+    bool complex_output, bool inverse, bool normalized, bool single_threaded,
+    IntArrayRef checked_signal_sizes, int64_t batch,
+    int64_t input_distance, int64_t output_distance,
+    IntArrayRef input_strides, IntArrayRef output_strides) {
+
+  memset(params, 0, sizeof(MKLFFTParams));
+  params->scalar_type_ = scalar_type;
+  params->signal_ndim_ = (uint8_t) signal_ndim;
+  params->complex_input_ = complex_input;
+  params->complex_output_ = complex_output;
+  params->inverse_ = inverse;
+  params->normalized_ = normalized;
+  params->single_threaded_ = single_threaded;
+  for (int64_t i = 0; i < signal_ndim; ++i) {
+    params->signal_sizes_[i] = checked_signal_sizes[i];
+    params->input_strides_[i] = input_strides[i];
+    params->output_strides_[i] = output_strides[i];
+  }
+  params->batch_ = batch;
+  params->input_distance_ = input_distance;
+  params->output_distance_ = output_distance;
+}
+
+// Creates and commits the descriptor described by params. Defined in
+// native/mkl/SpectralOps.cpp.
+std::shared_ptr<DftiDescriptor> make_mkl_fft_descriptor(const MKLFFTParams& params);
+
+// The default max cache size is arbitrary, as for cuFFT. Users can always
+// configure it via torch.backends.mkl.fft_plan_cache.max_size.
+constexpr size_t MKL_FFT_DEFAULT_CACHE_SIZE = 4096;
+
+// LRU cache of committed DFTI descriptors, the CPU counterpart of
+// CuFFTParamsLRUCache in native/cuda/CuFFTPlanCache.h.
+//
+// Unlike the cuFFT cache, this one is thread-safe and hands out shared
+// ownership of the descriptors, so that the lock is only held for the lookup
+// and not while the transform runs. A committed descriptor can be used to
+// compute several transforms concurrently, and one evicted while in use is
+// freed when its last user is done with it.
+class MKLFFTParamsLRUCache {
+public:
+  using kv_t = typename std::pair<MKLFFTParams, std::shared_ptr<DftiDescriptor>>;
+  using map_t = typename std::unordered_map<std::reference_wrapper<MKLFFTParams>,
+                                            typename std::list<kv_t>::iterator,
+                                            ParamsHash<MKLFFTParams>,
+                                            ParamsEqual<MKLFFTParams>>;
+  using map_kkv_iter_t = typename map_t::iterator;
+
+  MKLFFTParamsLRUCache() : MKLFFTParamsLRUCache(MKL_FFT_DEFAULT_CACHE_SIZE) {}
+
+  MKLFFTParamsLRUCache(int64_t max_size) {
+    _set_max_size(max_size);
+  }
+
+  // If params is in this cache, return the cached descriptor. Otherwise,
+  // create it and, unless the cache is disabled, emplace it in this cache.
+  //
+  // Committing a descriptor is slow, so it is done without holding the lock.
+  // Another thread may create and insert the same descriptor meanwhile, in
+  // which case its entry is kept and returned.
+  std::shared_ptr<DftiDescriptor> get_or_create(const MKLFFTParams& params) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      map_kkv_iter_t map_it = _cache_map.find(const_cast<MKLFFTParams&>(params));
+      // Hit, put to list front
+      if (map_it != _cache_map.end()) {
+        _usage_list.splice(_usage_list.begin(), _usage_list, map_it->second);
+        return map_it->second->second;
+      }
+    }
+
+    // Miss
+    auto descriptor = make_mkl_fft_descriptor(params);
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (_max_size == 0) {
+      return descriptor;
+    }
+    // insert at list front, then insert into _cache_map
+    _usage_list.emplace_front(params, descriptor);
+    auto kv_it = _usage_list.begin();
+    auto inserted = _cache_map.emplace(std::piecewise_construct,
+                std::forward_as_tuple(kv_it->first),
+                std::forward_as_tuple(kv_it));
+    if (!inserted.second) {
+      // Another thread inserted params first, keep its entry
+      _usage_list.pop_front();
+      auto existing = inserted.first->second;
+      _usage_list.splice(_usage_list.begin(), _usage_list, existing);
+      return existing->second;
+    }
+
+    // remove if needed
+    if (_usage_list.size() > _max_size) {
+      auto last = _usage_list.end();
+      last--;
+      _cache_map.erase(last->first);
+      _usage_list.pop_back();
+    }
+    return descriptor;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    _cache_map.clear();
+    _usage_list.clear();
+  }
+
+  void resize(int64_t new_size) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    _set_max_size(new_size);
+    auto cur_size = _usage_list.size();
+    if (cur_size > _max_size) {
+      auto delete_it = _usage_list.end();
+      for (size_t i = 0; i < cur_size - _max_size; i++) {
+        delete_it--;
+        _cache_map.erase(delete_it->first);
+      }
+      _usage_list.erase(delete_it, _usage_list.end());
+    }
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return _cache_map.size();
+  }
+
+  size_t max_size() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return _max_size;
+  }
+
+private:
+  // Only sets size and does value check. Does not resize the data structures.
+  void _set_max_size(int64_t new_size) {
+    TORCH_CHECK(new_size >= 0,
+             "MKL FFT plan cache size must be non-negative, but got ", new_size);
+    _max_size = static_cast<size_t>(new_size);
+  }
+
+  std::mutex mutex_;
+  std::list<kv_t> _usage_list;
+  map_t _cache_map;
+  size_t _max_size;
+};
+
+}}} // namespace at::native::detail
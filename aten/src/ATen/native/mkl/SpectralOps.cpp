@@ -15,6 +15,20 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
   AT_ERROR("fft: ATen not compiled with MKL support");
 }
 
+int64_t _mkl_fft_get_plan_cache_size() {
+  return 0;
+}
+
+int64_t _mkl_fft_get_plan_cache_max_size() {
+  return 0;
+}
+
+void _mkl_fft_set_plan_cache_max_size(int64_t max_size) {
+  AT_ERROR("fft: ATen not compiled with MKL support");
+}
+
+void _mkl_fft_clear_plan_cache() {}
+
 }}
 
 #else // AT_MKL_ENABLED
@@ -27,6 +41,7 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
 #include <ATen/Utils.h>
 
 #include <algorithm>
+#include <functional>
 #include <vector>
 #include <numeric>
 #include <cmath>
@@ -35,6 +50,7 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
 #include <ATen/mkl/Exceptions.h>
 #include <ATen/mkl/Descriptors.h>
 #include <ATen/mkl/Limits.h>
+#include <ATen/native/mkl/MKLFFTPlanCache.h>
 
 
 namespace at { namespace native {
@@ -144,6 +160,85 @@ static inline void _fft_fill_with_conjugate_symmetry_(Tensor& input,
   });
 }
 
+namespace detail {
+
+std::shared_ptr<DftiDescriptor> make_mkl_fft_descriptor(const MKLFFTParams& params) {
+  // precision
+  DFTI_CONFIG_VALUE prec = params.scalar_type_ == ScalarType::Double ? DFTI_DOUBLE : DFTI_SINGLE;
+  // signal type
+  bool complex_signal = params.inverse_ ? params.complex_output_ : params.complex_input_;
+  DFTI_CONFIG_VALUE signal_type = complex_signal ? DFTI_COMPLEX : DFTI_REAL;
+  // create descriptor with signal size
+  int64_t signal_ndim = params.signal_ndim_;
+  std::vector<MKL_LONG> mkl_signal_sizes(params.signal_sizes_, params.signal_sizes_ + signal_ndim);
+  auto descriptor = std::make_shared<DftiDescriptor>();
+  descriptor->init(prec, signal_type, signal_ndim, mkl_signal_sizes.data());
+  // out of place FFT
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
+  // batch mode
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_NUMBER_OF_TRANSFORMS, (MKL_LONG) params.batch_));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_INPUT_DISTANCE, (MKL_LONG) params.input_distance_));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_OUTPUT_DISTANCE, (MKL_LONG) params.output_distance_));
+  // signal strides
+  // first val is offset, set to zero (ignored)
+  std::vector<MKL_LONG> mkl_istrides(1 + signal_ndim, 0), mkl_ostrides(1 + signal_ndim, 0);
+  for (int64_t i = 0; i < signal_ndim; i++) {
+    mkl_istrides[i + 1] = params.input_strides_[i];
+    mkl_ostrides[i + 1] = params.output_strides_[i];
+  }
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
+  // if conjugate domain of real is involved, set standard CCE storage type
+  // this will become default in MKL in future
+  if (!params.complex_input_ || !params.complex_output_) {
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
+  }
+  // rescale if needed by normalized flag or inverse transform
+  if (params.normalized_ || params.inverse_) {
+    auto signal_numel = std::accumulate(params.signal_sizes_, params.signal_sizes_ + signal_ndim,
+                                        (int64_t) 1, std::multiplies<int64_t>());
+    double double_scale;
+    if (params.normalized_) {
+      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
+    } else {
+      double_scale = 1.0 / static_cast<double>(signal_numel);
+    }
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(),
+      params.inverse_ ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
+      prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
+  }
+  // chunks of a batch are already run in parallel by the caller
+  if (params.single_threaded_) {
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_THREAD_LIMIT, (MKL_LONG) 1));
+  }
+  // finalize
+  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor->get()));
+  return descriptor;
+}
+
+} // namespace detail
+
+static detail::MKLFFTParamsLRUCache& mkl_fft_plan_cache() {
+  static detail::MKLFFTParamsLRUCache plan_cache;
+  return plan_cache;
+}
+
+int64_t _mkl_fft_get_plan_cache_size() {
+  return mkl_fft_plan_cache().size();
+}
+
+int64_t _mkl_fft_get_plan_cache_max_size() {
+  return mkl_fft_plan_cache().max_size();
+}
+
+void _mkl_fft_set_plan_cache_max_size(int64_t max_size) {
+  mkl_fft_plan_cache().resize(max_size);
+}
+
+void _mkl_fft_clear_plan_cache() {
+  mkl_fft_plan_cache().clear();
+}
+
 // MKL DFTI
 Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
                 bool complex_input, bool complex_output,
@@ -194,75 +289,57 @@ Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
   }
   Tensor output = at::empty(output_sizes, input.options());
 
-  // precision
-  DFTI_CONFIG_VALUE prec;
-  if (input.scalar_type() == ScalarType::Float) {
-    prec = DFTI_SINGLE;
-  } else if (input.scalar_type() == ScalarType::Double) {
-    prec = DFTI_DOUBLE;
-  } else {
+  if (input.scalar_type() != ScalarType::Float && input.scalar_type() != ScalarType::Double) {
     std::ostringstream ss;
     ss << "MKL FFT doesn't support tensor of type: "
        << toString(input.scalar_type());
     AT_ERROR(ss.str());
   }
-  // signal type
-  DFTI_CONFIG_VALUE signal_type;
-  if (!inverse) {
-    signal_type = complex_input ? DFTI_COMPLEX : DFTI_REAL;
-  } else {
-    signal_type = complex_output ? DFTI_COMPLEX : DFTI_REAL;
-  }
-  // create descriptor with signal size
-  std::vector<MKL_LONG> mkl_signal_sizes(checked_signal_sizes.begin(), checked_signal_sizes.end());
-  DftiDescriptor descriptor;
-  descriptor.init(prec, signal_type, signal_ndim, mkl_signal_sizes.data());
-  // out of place FFT
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
-  // batch mode
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_NUMBER_OF_TRANSFORMS, batch));
 
   auto istrides = input.strides();
   auto ostrides = output.strides();
   // batch dim stride, i.e., dist between each data
   MKL_LONG idist = complex_input ? istrides[0] >> 1 : istrides[0];
   MKL_LONG odist = complex_output ? ostrides[0] >> 1 : ostrides[0];
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_DISTANCE, idist));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_DISTANCE, odist));
   // signal strides
-  // first val is offset, set to zero (ignored)
-  std::vector<MKL_LONG> mkl_istrides(1 + signal_ndim, 0), mkl_ostrides(1 + signal_ndim, 0);
+  std::vector<int64_t> mkl_istrides(signal_ndim), mkl_ostrides(signal_ndim);
   for (int64_t i = 1; i <= signal_ndim; i++) {
-    mkl_istrides[i] = complex_input ? istrides[i] >> 1 : istrides[i];
-    mkl_ostrides[i] = complex_output ? ostrides[i] >> 1 : ostrides[i];
-  }
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
-  // if conjugate domain of real is involved, set standard CCE storage type
-  // this will become default in MKL in future
-  if (!complex_input || !complex_output) {
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
+    mkl_istrides[i - 1] = complex_input ? istrides[i] >> 1 : istrides[i];
+    mkl_ostrides[i - 1] = complex_output ? ostrides[i] >> 1 : ostrides[i];
   }
-  // rescale if needed by normalized flag or inverse transform
-  if (normalized || inverse) {
-    auto signal_numel = at::prod_intlist(checked_signal_sizes);
-    double double_scale;
-    if (normalized) {
-      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
+
+  // Transforms signals [begin, end) of the batch with a descriptor from the
+  // plan cache. See NOTE [ MKL FFT Batch Parallelism ].
+  auto run = [&](int64_t begin, int64_t end, bool single_threaded) {
+    detail::MKLFFTParams params;
+    detail::setMKLFFTParams(&params, input.scalar_type(), signal_ndim,
+        complex_input, complex_output, inverse, normalized, single_threaded,
+        checked_signal_sizes, end - begin, idist, odist, mkl_istrides, mkl_ostrides);
+    auto descriptor = mkl_fft_plan_cache().get_or_create(params);
+    auto in_data = static_cast<char*>(input.data_ptr()) + begin * istrides[0] * input.element_size();
+    auto out_data = static_cast<char*>(output.data_ptr()) + begin * ostrides[0] * output.element_size();
+    if (!inverse) {
+      MKL_DFTI_CHECK(DftiComputeForward(descriptor->get(), in_data, out_data));
     } else {
-      double_scale = 1.0 / static_cast<double>(signal_numel);
+      MKL_DFTI_CHECK(DftiComputeBackward(descriptor->get(), in_data, out_data));
     }
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(),
-      inverse ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
-      prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
-  }
-  // finalize
-  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor.get()));
-  // run
-  if (!inverse) {
-    MKL_DFTI_CHECK(DftiComputeForward(descriptor.get(), input.data_ptr(), output.data_ptr()));
-  } else {
-    MKL_DFTI_CHECK(DftiComputeBackward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+  };
+
+  // NOTE [ MKL FFT Batch Parallelism ]
+  // MKL only parallelizes a batched transform when a single signal is large
+  // enough, so batches of small signals (e.g., stft frames) run on one thread.
+  // Those are split between threads instead, each thread using a single
+  // threaded descriptor for its chunk of the batch. There are at most two
+  // chunk sizes, hence at most two descriptors in the cache per geometry.
+  auto signal_numel = at::prod_intlist(checked_signal_sizes);
+  if (batch > 1 && at::get_num_threads() > 1 &&
+      batch * signal_numel >= at::internal::GRAIN_SIZE &&
+      signal_numel < at::internal::GRAIN_SIZE) {
+    at::parallel_for(0, batch, 1, [&](int64_t begin, int64_t end) {
+      run(begin, end, /* single_threaded */ true);
+    });
+  } else if (batch > 0) {
+    run(0, batch, /* single_threaded */ false);
   }
   // now if needed, fill out the other half using Hermitian symmetry dim
   if (!complex_input && complex_output && !onesided) {
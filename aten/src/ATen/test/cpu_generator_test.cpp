@@ -3,6 +3,7 @@
 #include <ATen/ATen.h>
 #include <ATen/Utils.h>
 #include <ATen/CPUGenerator.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/PhiloxRNGEngine.h>
 #include <thread>
 #include <limits>
@@ -120,6 +121,42 @@ TEST(CPUGenerator, TestRNGForking) {
   ASSERT_EQ(target_value.sum().item<double>(), forked_value.sum().item<double>());
 }
 
+TEST(CPUGenerator, TestPhiloxModeReproducibility) {
+  // Test Description:
+  //   Check that random kernels in philox mode give the same
+  //   results whatever the number of threads, and that seeding
+  //   the generator restarts its philox sequence.
+  // See Note [Philox mode of CPUGenerator]
+  auto gen = at::detail::createCPUGenerator(42);
+  gen->set_philox_mode(true);
+  auto num_threads = at::get_num_threads();
+  auto sample = [&]() {
+    gen->set_current_seed(42);
+    auto u = at::empty({100000}).uniform_(-2, 3, gen.get());
+    auto n = at::empty({100000}, at::kDouble).normal_(1, 2, gen.get());
+    auto b = at::empty({100000}).bernoulli_(0.3, gen.get());
+    return std::make_tuple(u, n, b);
+  };
+  at::set_num_threads(1);
+  auto serial = sample();
+  at::set_num_threads(num_threads > 1 ? num_threads : 4);
+  auto parallel = sample();
+  at::set_num_threads(num_threads);
+  ASSERT_TRUE(at::equal(std::get<0>(serial), std::get<0>(parallel)));
+  ASSERT_TRUE(at::equal(std::get<1>(serial), std::get<1>(parallel)));
+  ASSERT_TRUE(at::equal(std::get<2>(serial), std::get<2>(parallel)));
+  ASSERT_GE(std::get<0>(serial).min().item<float>(), -2);
+  ASSERT_LT(std::get<0>(serial).max().item<float>(), 3);
+  ASSERT_NEAR(std::get<1>(serial).mean().item<double>(), 1, 0.05);
+  ASSERT_NEAR(std::get<1>(serial).std().item<double>(), 2, 0.05);
+  ASSERT_NEAR(std::get<2>(serial).mean().item<float>(), 0.3, 0.01);
+
+  // Consecutive calls don't reuse the same randoms
+  auto u1 = at::empty({1000}).uniform_(0, 1, gen.get());
+  auto u2 = at::empty({1000}).uniform_(0, 1, gen.get());
+  ASSERT_FALSE(at::equal(u1, u2));
+}
+
 /** 
  * Philox CPU Engine Tests
  */
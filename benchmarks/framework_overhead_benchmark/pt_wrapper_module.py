@@ -19,9 +19,13 @@ class WrapperModule(object):
             - Whether debug mode is enabled.
         save:
             - In graph mode, whether graph is to be saved.
+        inference_mode:
+            - Whether to run under torch.autograd.inference_mode instead of
+              torch.no_grad.
     """
-    def __init__(self, wrapped_type, module_config, debug, save=False):
+    def __init__(self, wrapped_type, module_config, debug, save=False, inference_mode=False):
         pt_fn = module_config.pt_fn
+        self.inference_mode = inference_mode
         self.module = wrapped_type(pt_fn)
         self.tensor_inputs = []
         self.module_name = wrapped_type.__name__
@@ -39,6 +43,7 @@ class WrapperModule(object):
             print(self.module.code)
 
     def forward(self, niters):
-        with torch.no_grad():
+        grad_mode = torch.autograd.inference_mode() if self.inference_mode else torch.no_grad()
+        with grad_mode:
             for _ in range(niters):
                 self.module.forward(*self.tensor_inputs)
@@ -53,6 +53,29 @@ op_bench.generate_pt_test(add_long_configs + add_short_configs, AddBenchmark)
 op_bench.generate_pt_gradient_test(add_long_configs + add_short_configs, AddBenchmark)
 
 
+# Small tensors, where the setup of TensorIterator dominates
+add_scalar_configs = op_bench.cross_product_configs(
+    N=[16, 256],
+    channels_last=[False, True],
+    device=['cpu'],
+    tags=["short"]
+)
+
+
+class AddScalarBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, N, channels_last, device):
+        self.input_one = torch.rand(1, 4, 2, N // 8, device=device)
+        if channels_last:
+            self.input_one = self.input_one.contiguous(memory_format=torch.channels_last)
+        self.set_module_name("add_scalar")
+
+    def forward(self):
+        return torch.add(self.input_one, 1)
+
+
+op_bench.generate_pt_test(add_scalar_configs, AddScalarBenchmark)
+
+
 """Mircobenchmark for addmm operator."""
 class AddmmBenchmark(op_bench.TorchBenchmarkBase):
     def init(self, M, N, K, device):
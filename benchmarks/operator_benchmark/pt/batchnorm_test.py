@@ -48,5 +48,41 @@ op_bench.generate_pt_test(batchnorm_configs_short + batchnorm_configs_long, Batc
 op_bench.generate_pt_gradient_test(batchnorm_configs_short + batchnorm_configs_long, BatchNormBenchmark)
 
 
+# Training mode on common CNN shapes, in both memory formats
+batchnorm_training_configs = op_bench.config_list(
+    attr_names=["N", "C", "H", "W"],
+    attrs=[
+        [32, 64, 56, 56],
+        [32, 256, 14, 14],
+        [32, 512, 7, 7],
+        [128, 1024, 1, 1],
+    ],
+    cross_product_configs={
+        'channels_last': [False, True],
+        'device': ['cpu'],
+    },
+    tags=["training"]
+)
+
+
+class BatchNormTrainingBenchmark(op_bench.TorchBenchmarkBase):
+    def init(self, N, C, H, W, channels_last, device):
+        memory_format = torch.channels_last if channels_last else torch.contiguous_format
+        self.input_one = torch.rand(N, C, H, W, device=device).contiguous(
+            memory_format=memory_format).requires_grad_(self.auto_set())
+        self.mean = torch.rand(C, device=device)
+        self.var = torch.rand(C, device=device)
+        self.weight = torch.rand(C, device=device)
+        self.bias = torch.rand(C, device=device)
+        self.set_module_name("batchnorm_training")
+
+    def forward(self):
+        return F.batch_norm(self.input_one, self.mean, self.var, self.weight, self.bias, training=True)
+
+
+op_bench.generate_pt_test(batchnorm_training_configs, BatchNormTrainingBenchmark)
+op_bench.generate_pt_gradient_test(batchnorm_training_configs, BatchNormTrainingBenchmark)
+
+
 if __name__ == "__main__":
     op_bench.benchmark_runner.main()
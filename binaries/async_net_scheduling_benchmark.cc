@@ -0,0 +1,90 @@
+// Compares the scheduling overhead of the async_scheduling net executor with
+// its default thread pools and with work stealing (the "work_stealing" net
+// argument), on a layered net of many small ops in which every op depends on
+// two ops of the previous layer, so that ops can't be fused into chains.
+// Set --trace to instrument the runs with net_async_tracing.
+
+#include "benchmark/benchmark.h"
+
+#include "c10/util/Flags.h"
+#include "caffe2/core/init.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/utils/proto_utils.h"
+
+C10_DEFINE_int(width, 16, "Number of ops per layer");
+C10_DEFINE_int(num_workers, 4, "Number of executor threads");
+C10_DEFINE_bool(trace, false, "Enable net_async_tracing for the nets");
+C10_DEFINE_string(trace_dir, "/tmp", "Directory for the traces");
+
+namespace {
+
+caffe2::NetDef layeredNet(int depth, bool work_stealing) {
+  caffe2::NetDef net_def;
+  net_def.set_name(
+      work_stealing ? "work_stealing_benchmark" : "async_benchmark");
+  net_def.set_type("async_scheduling");
+  net_def.set_num_workers(FLAGS_num_workers);
+  *net_def.add_arg() = caffe2::MakeArgument<int>("work_stealing", work_stealing);
+  if (FLAGS_trace) {
+    *net_def.add_arg() = caffe2::MakeArgument<int>("enable_tracing", 1);
+    *net_def.add_arg() =
+        caffe2::MakeArgument<std::string>("tracing_filepath", FLAGS_trace_dir);
+  }
+
+  auto name = [](int layer, int i) {
+    return "x_" + c10::to_string(layer) + "_" + c10::to_string(i);
+  };
+  for (int i = 0; i < FLAGS_width; ++i) {
+    auto* op = net_def.add_op();
+    *op = caffe2::CreateOperatorDef(
+        "ConstantFill",
+        "",
+        std::vector<std::string>{},
+        std::vector<std::string>{name(0, i)},
+        std::vector<caffe2::Argument>{
+            caffe2::MakeArgument<std::vector<int64_t>>("shape", {4}),
+            caffe2::MakeArgument<float>("value", 1.0f)});
+  }
+  for (int layer = 1; layer < depth; ++layer) {
+    const int stride = 1 << ((layer - 1) % 4);
+    for (int i = 0; i < FLAGS_width; ++i) {
+      *net_def.add_op() = caffe2::CreateOperatorDef(
+          "Sum",
+          "",
+          std::vector<std::string>{name(layer - 1, i),
+                                   name(layer - 1, (i + stride) % FLAGS_width)},
+          std::vector<std::string>{name(layer, i)});
+    }
+  }
+  return net_def;
+}
+
+void runNet(benchmark::State& state, bool work_stealing) {
+  caffe2::Workspace ws;
+  auto* net = ws.CreateNet(layeredNet(state.range(0), work_stealing));
+  CAFFE_ENFORCE(net);
+  for (auto _ : state) {
+    CAFFE_ENFORCE(net->Run());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * FLAGS_width);
+}
+
+static void BM_AsyncScheduling(benchmark::State& state) {
+  runNet(state, false);
+}
+BENCHMARK(BM_AsyncScheduling)->Arg(16)->Arg(128)->UseRealTime();
+
+static void BM_AsyncSchedulingWorkStealing(benchmark::State& state) {
+  runNet(state, true);
+}
+BENCHMARK(BM_AsyncSchedulingWorkStealing)->Arg(16)->Arg(128)->UseRealTime();
+
+} // namespace
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  caffe2::GlobalInit(&argc, &argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
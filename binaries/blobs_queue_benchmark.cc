@@ -0,0 +1,92 @@
+// Contention benchmark for BlobsQueue: half of the benchmark threads enqueue
+// records and the other half dequeue them, one at a time or in batches.
+
+#include "benchmark/benchmark.h"
+
+#include <memory>
+#include <vector>
+
+#include "caffe2/core/workspace.h"
+#include "caffe2/queue/blobs_queue.h"
+
+namespace {
+
+constexpr size_t kCapacity = 64;
+constexpr size_t kNumBlobs = 2;
+constexpr size_t kBatch = 16;
+
+caffe2::Workspace* gWorkspace = nullptr;
+std::shared_ptr<caffe2::BlobsQueue> gQueue;
+
+void setUp() {
+  gWorkspace = new caffe2::Workspace();
+  gQueue = std::make_shared<caffe2::BlobsQueue>(
+      gWorkspace, "bench_queue", kCapacity, kNumBlobs, true);
+}
+
+void tearDown() {
+  gQueue.reset();
+  delete gWorkspace;
+  gWorkspace = nullptr;
+}
+
+struct Records {
+  explicit Records(size_t count) : blobs(count), pointers(count) {
+    for (size_t i = 0; i < count; ++i) {
+      blobs[i] = std::vector<caffe2::Blob>(kNumBlobs);
+      for (auto& blob : blobs[i]) {
+        pointers[i].push_back(&blob);
+      }
+    }
+  }
+
+  std::vector<std::vector<caffe2::Blob>> blobs;
+  std::vector<std::vector<caffe2::Blob*>> pointers;
+};
+
+static void BM_BlobsQueue(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    setUp();
+  }
+  const bool writer = state.thread_index % 2 == 0;
+  Records record(1);
+  while (state.KeepRunning()) {
+    if (writer) {
+      gQueue->blockingWrite(record.pointers[0]);
+    } else {
+      gQueue->blockingRead(record.pointers[0]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  if (state.thread_index == 0) {
+    tearDown();
+  }
+}
+BENCHMARK(BM_BlobsQueue)->ThreadRange(2, 32)->UseRealTime();
+
+static void BM_BlobsQueueBatch(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    setUp();
+  }
+  const bool writer = state.thread_index % 2 == 0;
+  Records records(kBatch);
+  c10::ArrayRef<std::vector<caffe2::Blob*>> pointers(records.pointers);
+  while (state.KeepRunning()) {
+    if (writer) {
+      gQueue->blockingWriteMany(pointers);
+    } else {
+      for (size_t read = 0; read < kBatch;) {
+        read += gQueue->blockingReadMany(pointers.slice(read));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kBatch);
+  if (state.thread_index == 0) {
+    tearDown();
+  }
+}
+BENCHMARK(BM_BlobsQueueBatch)->ThreadRange(2, 32)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,69 @@
+// Measures the framework overhead of calling an operator through the c10
+// dispatcher, i.e. dispatch key extraction plus kernel lookup, with a kernel
+// that does no work.
+
+#include "benchmark/benchmark.h"
+
+#include <ATen/ATen.h>
+#include <ATen/core/dispatch/Dispatcher.h>
+#include <ATen/core/op_registration/op_registration.h>
+
+#if defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+namespace {
+
+NOINLINE int64_t noop_kernel(at::Tensor self) {
+  return self.dim();
+}
+
+NOINLINE int64_t noop_catchall_kernel(int64_t a) {
+  return a + 1;
+}
+
+static auto registry = c10::RegisterOperators()
+  .op("_bench::noop(Tensor self) -> int", c10::RegisterOperators::options()
+    .impl_unboxedOnlyKernel<decltype(noop_kernel), &noop_kernel>(c10::DispatchKey::CPUTensorId))
+  .op("_bench::noop_catchall(int a) -> int", c10::RegisterOperators::options()
+    .catchAllKernel<decltype(noop_catchall_kernel), &noop_catchall_kernel>());
+
+static void BM_DispatchBackendKernel(benchmark::State& state) {
+  auto op = c10::Dispatcher::singleton().findSchema({"_bench::noop", ""});
+  CAFFE_ENFORCE(op.has_value());
+  at::AutoNonVariableTypeMode non_var_type_mode(true);
+  at::Tensor t = at::empty({1});
+  int64_t result = 0;
+  for (auto _ : state) {
+    result += c10::Dispatcher::singleton().callUnboxed<int64_t, at::Tensor>(*op, t);
+  }
+  benchmark::DoNotOptimize(result);
+}
+BENCHMARK(BM_DispatchBackendKernel);
+
+static void BM_DispatchCatchallKernel(benchmark::State& state) {
+  auto op = c10::Dispatcher::singleton().findSchema({"_bench::noop_catchall", ""});
+  CAFFE_ENFORCE(op.has_value());
+  int64_t result = 0;
+  for (auto _ : state) {
+    result = c10::Dispatcher::singleton().callUnboxed<int64_t, int64_t>(*op, result);
+  }
+  benchmark::DoNotOptimize(result);
+}
+BENCHMARK(BM_DispatchCatchallKernel);
+
+static void BM_NoDispatch(benchmark::State& state) {
+  at::Tensor t = at::empty({1});
+  int64_t result = 0;
+  for (auto _ : state) {
+    result += noop_kernel(t);
+  }
+  benchmark::DoNotOptimize(result);
+}
+BENCHMARK(BM_NoDispatch);
+
+} // namespace
+
+BENCHMARK_MAIN();
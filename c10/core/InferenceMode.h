@@ -0,0 +1,59 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+namespace c10 {
+
+// NOTE [ Inference Mode ]
+//
+// Inference mode is a thread local mode for code that will never run
+// backward, e.g. a model being served.  It is a stronger version of
+// NoGradGuard: while it is enabled
+//
+//  - VariableTensorId is excluded from dispatch, so every operator goes
+//    straight to its backend kernel and skips the VariableType bookkeeping
+//    (history recording, version counter bumps, view tracking, profiling and
+//    tracing hooks), for all tensors, not only for inference tensors.
+//
+//  - Tensors created by TensorImpl's constructor are *inference tensors*:
+//    they don't have VariableTensorId in their key set and they don't
+//    allocate a version counter.  They never allocate an AutogradMeta
+//    either, as they can't require grad.  Storages allocated in the mode are
+//    marked as inference storages.
+//
+// Inference tensors stay inference tensors once the mode is exited, and ops
+// that only take inference tensors still skip VariableType, in-place ones
+// included.  Autograd stays sound because no normal tensor that autograd
+// relies on can observe such an update:
+//
+//  - Every tensor viewing an inference storage is an inference tensor, even
+//    if it is created outside of the mode (views, shallow copies such as
+//    detach() and .data).  Functional ops on inference tensors outside of
+//    the mode allocate new storage and give normal tensors.
+//
+//  - Views of normal tensors created in the mode don't share the version
+//    counter of their base, as view tracking is skipped.  They have no
+//    version counter but keep VariableTensorId, so that in-place updates to
+//    them outside of the mode go through VariableType, which raises an error
+//    before anything is written.
+//
+//  - Inference tensors can't require grad, and neither they nor any other
+//    tensor aliasing an inference storage (e.g. through set_()) can be saved
+//    for backward.  In-place updates to inference tensors that go through
+//    VariableType (because they involve normal tensors) outside of inference
+//    mode raise an error, as there is no version counter to bump.  Use
+//    clone() to get a normal tensor.
+//
+//  - In-place updates to normal tensors inside of inference mode don't bump
+//    their version counters, in the same way as under
+//    AutoNonVariableTypeMode.  Don't update tensors that have been saved for
+//    backward inside of inference mode.
+//
+// at::AutoInferenceMode is the RAII guard for this mode; it also disables
+// grad mode.
+struct C10_API InferenceMode {
+  static bool is_enabled();
+  static void set_enabled(bool enabled);
+};
+
+} // namespace c10
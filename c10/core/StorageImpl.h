@@ -1,6 +1,7 @@
 #pragma once
 
 #include <c10/core/Allocator.h>
+#include <c10/core/InferenceMode.h>
 #include <c10/core/ScalarType.h>
 
 #include <c10/util/intrusive_ptr.h>
@@ -20,6 +21,7 @@ struct C10_API StorageImpl final : public c10::intrusive_ptr_target {
         numel_(numel),
         resizable_(resizable),
         received_cuda_(false),
+        inference_(InferenceMode::is_enabled()),
         allocator_(allocator) {
     if (resizable) {
       AT_ASSERTM(
@@ -221,6 +223,12 @@ struct C10_API StorageImpl final : public c10::intrusive_ptr_target {
     return received_cuda_;
   }
 
+  // True if the storage was allocated in inference mode. Every tensor viewing
+  // it is an inference tensor, see NOTE [ Inference Mode ].
+  bool is_inference() const {
+    return inference_;
+  }
+
  private:
   caffe2::TypeMeta data_type_;
   DataPtr data_ptr_;
@@ -229,6 +237,7 @@ struct C10_API StorageImpl final : public c10::intrusive_ptr_target {
   // Identifies that Storage was received from another process and doesn't have
   // local to process cuda memory allocation
   bool received_cuda_;
+  bool inference_;
   Allocator* allocator_;
 };
 } // namespace c10
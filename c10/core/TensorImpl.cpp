@@ -53,12 +53,28 @@ TensorImpl::TensorImpl(DispatchKeySet key_set, const caffe2::TypeMeta& data_type
 TensorImpl::TensorImpl(Storage&& storage, DispatchKeySet key_set, const caffe2::TypeMeta& data_type,
                        c10::optional<c10::Device> device_opt)
     : storage_(std::move(storage)),
+      // Tensors created in inference mode, or viewing a storage allocated in
+      // inference mode, are inference tensors, see NOTE [ Inference Mode ].
+      version_counter_(
+          C10_UNLIKELY(
+              InferenceMode::is_enabled() ||
+              (storage_ && storage_.unsafeGetStorageImpl()->is_inference()))
+              ? VariableVersion(VariableVersion::DISABLED)
+              : VariableVersion(/*version=*/0)),
       sizes_{0},
       storage_offset_(0),
       numel_(0),
       data_type_(data_type),
       device_opt_(device_opt),
-      key_set_(key_set.add(DispatchKey::VariableTensorId)) {
+      // Views of normal tensors created in inference mode have no version
+      // counter either, but they keep VariableTensorId: an in-place update
+      // through them outside of the mode would change the normal base behind
+      // autograd's back, and VariableType rejects it.
+      key_set_(
+          is_inference() &&
+                  !(storage_ && !storage_.unsafeGetStorageImpl()->is_inference())
+              ? key_set.remove(DispatchKey::VariableTensorId)
+              : key_set.add(DispatchKey::VariableTensorId)) {
   if (!key_set.empty()) {
     AT_ASSERT(data_type.id() ==  caffe2::TypeIdentifier::uninitialized() ||
               device_opt_.has_value());
@@ -267,7 +283,13 @@ void TensorImpl::copy_tensor_metadata(
   dest_impl->is_non_overlapping_and_dense_ = src_impl->is_non_overlapping_and_dense_;
   dest_impl->is_wrapped_number_ = src_impl->is_wrapped_number_;
   dest_impl->reserved_ = src_impl->reserved_;
-  dest_impl->set_version_counter(version_counter);
+  // Shallow copies of an inference tensor are inference tensors as well,
+  // consistently with the key set copied above.
+  if (src_impl->is_inference()) {
+    dest_impl->set_version_counter(src_impl->version_counter_);
+  } else {
+    dest_impl->set_version_counter(version_counter);
+  }
   dest_impl->set_allow_tensor_metadata_change(allow_tensor_metadata_change);
   if (src_impl->named_tensor_meta_ != nullptr) {
     dest_impl->named_tensor_meta_ = src_impl->named_tensor_meta_->clone();
@@ -9,6 +9,7 @@
 #include <c10/core/Storage.h>
 #include <c10/core/TensorOptions.h>
 #include <c10/core/DispatchKeySet.h>
+#include <c10/core/InferenceMode.h>
 #include <c10/core/impl/LocalDispatchKeySet.h>
 #include <c10/core/CopyBytes.h>
 
@@ -215,6 +216,10 @@ struct C10_API NamedTensorMetaInterface {
 // when saving a tensor can introduce race conditions when we are running the forward
 // pass in multi-thread scenarios, thus making the forward pass not thread-safe anymore,
 // which breaks the invariant.
+//
+// Inference tensors are the exception: they are created with a disabled
+// version counter, which doesn't allocate anything, and they can't be saved
+// for backward.  See NOTE [ Inference Mode ].
 struct C10_API VariableVersion {
  private:
   struct VersionCounter : intrusive_ptr_target {
@@ -233,11 +238,30 @@ struct C10_API VariableVersion {
   VariableVersion(uint32_t version = 0)
       : version_counter_(c10::make_intrusive<VersionCounter>(version)) {}
 
-  void bump() noexcept {
-    ++version_counter_->version_;
+  enum Disabled { DISABLED };
+  // The version counter of inference tensors.
+  explicit VariableVersion(Disabled) {}
+
+  bool enabled() const noexcept {
+    return version_counter_.defined();
+  }
+
+  void bump() {
+    if (C10_LIKELY(version_counter_.defined())) {
+      ++version_counter_->version_;
+      return;
+    }
+    TORCH_CHECK(
+        InferenceMode::is_enabled(),
+        "Inplace update to inference tensor outside InferenceMode is not "
+        "allowed. You can make a clone to get a normal tensor before doing "
+        "inplace update.");
   }
 
-  uint32_t current_version() const noexcept {
+  uint32_t current_version() const {
+    TORCH_CHECK(
+        version_counter_.defined(),
+        "Inference tensors do not track version counter.");
     return version_counter_->version_;
   }
 };
@@ -412,6 +436,15 @@ struct C10_API TensorImpl : public c10::intrusive_ptr_target {
     return version_counter_.unique();
   }
 
+  /**
+   * True if the tensor was created in inference mode, in which case it has
+   * no version counter and does not participate in autograd.
+   * See NOTE [ Inference Mode ].
+   */
+  bool is_inference() const noexcept {
+    return !version_counter_.enabled();
+  }
+
   /**
    * Whether or not a tensor is laid out in contiguous memory.
    *
@@ -941,7 +974,7 @@ struct C10_API TensorImpl : public c10::intrusive_ptr_target {
     return version_counter_;
   }
 
-  void bump_version() noexcept {
+  void bump_version() {
     version_counter_.bump();
   }
 
@@ -1604,6 +1637,8 @@ protected:
   // distinction between plain tensors and variables), but because
   // we merged Variable and Tensor, this invariant now always holds.
   // This invariant is currently enforced in the constructor of TensorImpl.
+  // The only exception are inference tensors, which skip the autograd
+  // codepath altogether (see NOTE [ Inference Mode ]).
   //
   // You might be wondering why we don't just not include VariableTensorId
   // from the type set, if it is always set.  The answer is, we still need
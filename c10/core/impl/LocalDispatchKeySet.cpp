@@ -1,4 +1,5 @@
 #include <c10/core/impl/LocalDispatchKeySet.h>
+#include <c10/core/InferenceMode.h>
 
 #include <iostream>
 
@@ -31,6 +32,13 @@ LocalDispatchKeySet tls_local_dispatch_key_set() {
       raw_local_dispatch_key_set.excluded().add(
         DispatchKey::VariableTensorId));
   }
+  // Inference mode excludes VariableTensorId without touching the raw state,
+  // so that it nests with the guards below, see NOTE [ Inference Mode ].
+  if (InferenceMode::is_enabled()) {
+    LocalDispatchKeySet local = raw_local_dispatch_key_set;
+    local.excluded_ = local.excluded_.add(DispatchKey::VariableTensorId);
+    return local;
+  }
   return raw_local_dispatch_key_set;
 }
 
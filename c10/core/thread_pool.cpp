@@ -129,6 +129,137 @@ void ThreadPool::main_loop(std::size_t index) {
   } // while running_
 }
 
+namespace {
+// The work stealing pool the current thread belongs to, if any, and the
+// thread's index in it.
+thread_local WorkStealingThreadPool* current_work_stealing_pool = nullptr;
+thread_local std::size_t current_work_stealing_index = 0;
+} // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id,
+      std::function<void()> init_thread)
+    : threads_(pool_size < 0 ? defaultNumThreads() : pool_size),
+      next_worker_(0),
+      pending_(0),
+      available_(threads_.size()),
+      running_(true),
+      sleeping_(0) {
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    workers_.emplace_back(new Worker());
+  }
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i] = std::thread([this, i, init_thread](){
+      if (init_thread) {
+        init_thread();
+      }
+      this->main_loop(i);
+    });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    running_ = false;
+    sleep_condition_.notify_all();
+  }
+
+  for (auto& t : threads_) {
+    try {
+      t.join();
+    } catch (const std::exception&) {
+    }
+  }
+}
+
+size_t WorkStealingThreadPool::size() const {
+  return threads_.size();
+}
+
+size_t WorkStealingThreadPool::numAvailable() const {
+  return available_;
+}
+
+bool WorkStealingThreadPool::inThreadPool() const {
+  return current_work_stealing_pool == this;
+}
+
+void WorkStealingThreadPool::run(const std::function<void()>& func) {
+  if (threads_.size() == 0) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  if (current_work_stealing_pool == this) {
+    auto& worker = *workers_[current_work_stealing_index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.tasks.push_front(func);
+  } else {
+    auto& worker = *workers_[next_worker_++ % workers_.size()];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.tasks.push_back(func);
+  }
+  // Pairs with main_loop: a worker going to sleep either sees the new task
+  // or is seen here.
+  ++pending_;
+  if (sleeping_ > 0) {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    sleep_condition_.notify_one();
+  }
+}
+
+bool WorkStealingThreadPool::tryPop(
+    std::size_t index,
+    std::function<void()>* task) {
+  {
+    auto& own = *workers_[index];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      *task = std::move(own.tasks.front());
+      own.tasks.pop_front();
+      return true;
+    }
+  }
+  for (std::size_t k = 1; k < workers_.size(); ++k) {
+    auto& victim = *workers_[(index + k) % workers_.size()];
+    std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+    if (lock.owns_lock() && !victim.tasks.empty()) {
+      *task = std::move(victim.tasks.back());
+      victim.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::main_loop(std::size_t index) {
+  current_work_stealing_pool = this;
+  current_work_stealing_index = index;
+  while (running_) {
+    std::function<void()> task;
+    if (tryPop(index, &task)) {
+      --pending_;
+      --available_;
+      try {
+        task();
+      } catch (const std::exception&) {
+      }
+      ++available_;
+      continue;
+    }
+
+    // Nothing to run or steal (a victim whose lock was busy counts as empty,
+    // pending_ makes us look again), go to sleep until a task is submitted.
+    ++sleeping_;
+    {
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      sleep_condition_.wait(
+          lock, [this]() { return pending_ > 0 || !running_; });
+    }
+    --sleeping_;
+  }
+}
+
 C10_DEFINE_SHARED_REGISTRY(
     ThreadPoolRegistry,
     TaskThreadPoolBase,
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -115,6 +118,66 @@ class C10_API TaskThreadPool : public c10::ThreadPool {
       }) {}
 };
 
+// A thread pool in which every worker has its own task deque instead of
+// sharing one queue. A task submitted from one of the pool's own threads goes
+// to the front of that thread's deque, so the worker that produced it runs it
+// next (LIFO, with its inputs still in cache); tasks submitted from outside
+// are spread round-robin. Idle workers steal from the back of other workers'
+// deques, so submitting and taking tasks rarely contend on the same lock.
+class C10_API WorkStealingThreadPool : public c10::TaskThreadPoolBase {
+ public:
+  WorkStealingThreadPool() = delete;
+
+  explicit WorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id = -1,
+      std::function<void()> init_thread = nullptr);
+
+  ~WorkStealingThreadPool();
+
+  size_t size() const override;
+
+  size_t numAvailable() const override;
+
+  bool inThreadPool() const override;
+
+  void run(const std::function<void()>& func) override;
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  bool tryPop(std::size_t index, std::function<void()>* task);
+
+  // @brief Entry point for pool threads.
+  void main_loop(std::size_t index);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<std::size_t> next_worker_;
+  // number of queued, not yet started tasks
+  std::atomic<std::size_t> pending_;
+  std::atomic<std::size_t> available_;
+  std::atomic_bool running_;
+  // only used to put idle workers to sleep
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+  std::atomic<int> sleeping_;
+};
+
+class C10_API WorkStealingTaskThreadPool : public c10::WorkStealingThreadPool {
+ public:
+  explicit WorkStealingTaskThreadPool(
+      std::size_t pool_size,
+      int numa_node_id = -1)
+      : WorkStealingThreadPool(pool_size, numa_node_id, [numa_node_id](){
+        setThreadName("CaffeTaskThread");
+        NUMABind(numa_node_id);
+      }) {}
+};
+
 C10_DECLARE_SHARED_REGISTRY(
     ThreadPoolRegistry,
     TaskThreadPoolBase,
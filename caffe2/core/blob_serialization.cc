@@ -21,6 +21,12 @@ C10_DEFINE_bool(
     false,
     "Serialize FLOAT16 tensors using byte_data field");
 
+C10_DEFINE_bool(
+    caffe2_serialize_using_raw_data,
+    false,
+    "Serialize tensors of fixed-size types as little-endian bytes in the "
+    "raw_data field");
+
 namespace caffe2 {
 /**
  * @brief StringSerializer is the serializer for String.
@@ -63,6 +69,131 @@ class StringDeserializer : public BlobDeserializerBase {
 };
 
 namespace {
+// Field numbers used to write and find raw tensor payloads.
+constexpr uint32_t kBlobProtoTensorField = 3;
+constexpr uint32_t kTensorProtoRawDataField = 13;
+constexpr uint32_t kTensorProtoRawDataPaddingField = 15;
+constexpr uint32_t kLengthDelimited = 2;
+// Raw payloads start at a multiple of this many bytes into the serialized
+// BlobProto.
+constexpr size_t kRawDataAlignment = 64;
+
+bool IsLittleEndian() {
+  const int kValue = 1;
+  return reinterpret_cast<const char*>(&kValue)[0] == 1;
+}
+
+bool CanSerializeAsRawData(TensorProto::DataType data_type) {
+  switch (data_type) {
+    case TensorProto_DataType_FLOAT:
+    case TensorProto_DataType_INT32:
+    case TensorProto_DataType_BOOL:
+    case TensorProto_DataType_UINT8:
+    case TensorProto_DataType_INT8:
+    case TensorProto_DataType_UINT16:
+    case TensorProto_DataType_INT16:
+    case TensorProto_DataType_INT64:
+    case TensorProto_DataType_FLOAT16:
+    case TensorProto_DataType_DOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+size_t VarintSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+// Key and length of a length-delimited protobuf field.
+void AppendFieldHeader(uint32_t field, uint64_t length, std::string* out) {
+  AppendVarint((field << 3) | kLengthDelimited, out);
+  AppendVarint(length, out);
+}
+
+size_t FieldHeaderSize(uint32_t field, uint64_t length) {
+  return VarintSize((field << 3) | kLengthDelimited) + VarintSize(length);
+}
+
+bool ReadVarint(const char** p, const char* end, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64 && *p < end; shift += 7) {
+    const auto byte = static_cast<uint8_t>(*(*p)++);
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Scans the fields of a message in [*p, end) for a single length-delimited
+// field with the given number. On success, [*field_begin, *field_end) is the
+// whole field and [*value_begin, *field_end) its value.
+bool FindUniqueField(
+    const char* p,
+    const char* end,
+    uint32_t field,
+    const char** field_begin,
+    const char** value_begin,
+    const char** field_end) {
+  int found = 0;
+  while (p < end) {
+    const char* begin = p;
+    uint64_t key = 0;
+    if (!ReadVarint(&p, end, &key)) {
+      return false;
+    }
+    uint64_t length = 0;
+    switch (key & 7) {
+      case 0:
+        if (!ReadVarint(&p, end, &length)) {
+          return false;
+        }
+        length = 0;
+        break;
+      case 1:
+        length = 8;
+        break;
+      case kLengthDelimited:
+        if (!ReadVarint(&p, end, &length)) {
+          return false;
+        }
+        break;
+      case 5:
+        length = 4;
+        break;
+      default:
+        // groups are not used by caffe2 protos
+        return false;
+    }
+    if (length > static_cast<uint64_t>(end - p)) {
+      return false;
+    }
+    if ((key >> 3) == field && (key & 7) == kLengthDelimited) {
+      ++found;
+      *field_begin = begin;
+      *value_begin = p;
+      *field_end = p + length;
+    }
+    p += length;
+  }
+  return found == 1;
+}
+
 void SerializeBlob(
     const void* pointer,
     TypeMeta typeMeta,
@@ -130,11 +261,17 @@ void TensorSerializer::SerializeWithChunkSize(
     blob_proto.set_type(kTensorBlobType);
     TensorProto& proto = *blob_proto.mutable_tensor();
     proto.set_name(name);
+    const auto key = c10::str(name, kChunkIdSeparator, chunkStart / chunk_size);
+    if (FLAGS_caffe2_serialize_using_raw_data &&
+        CanSerializeAsRawData(TypeMetaToDataType(tensor.dtype()))) {
+      acceptor(
+          key,
+          this->SerializeRawChunk(tensor, &blob_proto, chunkStart, chunk_size));
+      return;
+    }
     this->Serialize(
         tensor, name, blob_proto.mutable_tensor(), chunkStart, chunk_size);
-    acceptor(
-        c10::str(name, kChunkIdSeparator, chunkStart / chunk_size),
-        SerializeBlobProtoAsString_EnforceCheck(blob_proto));
+    acceptor(key, SerializeBlobProtoAsString_EnforceCheck(blob_proto));
   };
 
 #ifndef __ANDROID__
@@ -183,7 +320,7 @@ void TensorSerializer::SerializeWithChunkSize(
 #endif
 }
 
-void TensorSerializer::Serialize(
+int32_t TensorSerializer::SerializeHeader(
     const Tensor& input,
     const string& name,
     TensorProto* proto_ptr,
@@ -220,9 +357,79 @@ void TensorSerializer::Serialize(
   for (int i = 0; i < input.dim(); ++i) {
     proto.add_dims(input.size(i));
   }
-  const TensorProto::DataType data_type = TypeMetaToDataType(input.dtype());
-  proto.set_data_type(data_type);
+  proto.set_data_type(TypeMetaToDataType(input.dtype()));
   StoreDeviceDetail(input, &proto);
+  return chunkSize;
+}
+
+string TensorSerializer::SerializeRawChunk(
+    const Tensor& input,
+    BlobProto* blob_proto,
+    size_t chunkBegin,
+    int32_t chunkSize) {
+  CAFFE_ENFORCE(
+      IsLittleEndian(),
+      "Serialization of raw data on big endian platform is not written yet.");
+  auto* proto = blob_proto->mutable_tensor();
+  chunkSize =
+      SerializeHeader(input, blob_proto->name(), proto, chunkBegin, chunkSize);
+  proto->set_storage_type(TensorProto_StorageType_RAW);
+  const size_t nbytes = chunkSize * input.itemsize();
+
+  // The payload goes last in the tensor, and the tensor goes last in the
+  // BlobProto, so that the payload can be written without building it into
+  // a proto first. Protobuf accepts the fields in any order.
+  const auto tensor_header =
+      SerializeAsString_EnforceCheck(*proto, blob_proto->name().c_str());
+  blob_proto->clear_tensor();
+  auto out = SerializeBlobProtoAsString_EnforceCheck(*blob_proto);
+  // A raw_data_padding field goes right before the payload to align it.
+  const size_t raw_data_header_size =
+      FieldHeaderSize(kTensorProtoRawDataField, nbytes);
+  size_t padding = 0;
+  size_t tensor_size = 0;
+  for (;; ++padding) {
+    tensor_size = tensor_header.size() +
+        FieldHeaderSize(kTensorProtoRawDataPaddingField, padding) + padding +
+        raw_data_header_size + nbytes;
+    const size_t offset = out.size() +
+        FieldHeaderSize(kBlobProtoTensorField, tensor_size) + tensor_size -
+        nbytes;
+    if (offset % kRawDataAlignment == 0) {
+      break;
+    }
+  }
+  out.reserve(
+      out.size() + FieldHeaderSize(kBlobProtoTensorField, tensor_size) +
+      tensor_size);
+  AppendFieldHeader(kBlobProtoTensorField, tensor_size, &out);
+  out.append(tensor_header);
+  AppendFieldHeader(kTensorProtoRawDataPaddingField, padding, &out);
+  out.append(padding, '\0');
+  AppendFieldHeader(kTensorProtoRawDataField, nbytes, &out);
+  const size_t offset = out.size();
+  out.resize(offset + nbytes);
+  if (nbytes > 0) {
+    auto context = CreateContext(input.GetDevice());
+    context->CopyBytesToCPU(
+        nbytes,
+        static_cast<const char*>(input.raw_data()) +
+            chunkBegin * input.itemsize(),
+        &out[offset]);
+    context->FinishDeviceComputation();
+  }
+  return out;
+}
+
+void TensorSerializer::Serialize(
+    const Tensor& input,
+    const string& name,
+    TensorProto* proto_ptr,
+    size_t chunkBegin,
+    int32_t chunkSize) {
+  chunkSize = SerializeHeader(input, name, proto_ptr, chunkBegin, chunkSize);
+  TensorProto& proto = *proto_ptr;
+  const TensorProto::DataType data_type = proto.data_type();
   // TODO: use CUDAGuard here instead of context and employ explicit sync
   // copy
   auto uniq_ptr = CreateContext(input.GetDevice());
@@ -372,6 +579,52 @@ void DeserializeBlob(const string& content, Blob* result) {
   DeserializeBlob(blob_proto, result);
 }
 
+bool ParseBlobProtoWithRawPayload(
+    const string& content,
+    BlobProto* proto,
+    size_t* payload_offset,
+    size_t* payload_size) {
+  *payload_offset = 0;
+  *payload_size = 0;
+  const char* begin = content.data();
+  const char* end = begin + content.size();
+  const char* tensor_field = nullptr;
+  const char* tensor_begin = nullptr;
+  const char* tensor_end = nullptr;
+  const char* raw_field = nullptr;
+  const char* raw_begin = nullptr;
+  const char* raw_end = nullptr;
+  if (!FindUniqueField(
+          begin,
+          end,
+          kBlobProtoTensorField,
+          &tensor_field,
+          &tensor_begin,
+          &tensor_end) ||
+      !FindUniqueField(
+          tensor_begin,
+          tensor_end,
+          kTensorProtoRawDataField,
+          &raw_field,
+          &raw_begin,
+          &raw_end)) {
+    return proto->ParseFromString(content);
+  }
+  // Everything but the payload is small, parse it with protobuf.
+  std::string blob_header(begin, tensor_field);
+  blob_header.append(tensor_end, end);
+  std::string tensor_header(tensor_begin, raw_field);
+  tensor_header.append(raw_end, tensor_end);
+  if (!proto->ParseFromString(blob_header) ||
+      !proto->mutable_tensor()->ParseFromString(tensor_header)) {
+    return false;
+  }
+  proto->mutable_tensor()->clear_raw_data_padding();
+  *payload_offset = raw_begin - begin;
+  *payload_size = raw_end - raw_begin;
+  return true;
+}
+
 void DeserializeBlob(const BlobProto& blob_proto, Blob* result) {
   if (blob_proto.type() == kTensorBlobType) {
     // This is a tensor object. Depending on the device type, we will
@@ -482,6 +735,17 @@ void TensorDeserializer::Deserialize(const BlobProto& blob_proto, Blob* blob) {
   }
 }
 
+Tensor* DeserializeTensorHeader(const TensorProto& tensor_proto, Blob* blob) {
+  CAFFE_ENFORCE(
+      NumelFromTensorProto(tensor_proto) == 0 ||
+          tensor_proto.data_type() != TensorProto_DataType_UNDEFINED,
+      "Tensor with elements but without a data type");
+  return BlobGetMutableTensor(
+      blob,
+      DimsFromTensorProto(tensor_proto),
+      TensorOptionsFromProto(tensor_proto));
+}
+
 void TensorDeserializer::DeserializeToTensor(
     const TensorProto& tensor_proto,
     Tensor* tensor) {
@@ -511,6 +775,26 @@ void TensorDeserializer::DeserializeToTensor(
       tensor->numel());
   auto chunkSize = chunkEnd - chunkBegin;
 
+  if (tensor_proto.storage_type() == TensorProto_StorageType_RAW) {
+    CAFFE_ENFORCE(
+        IsLittleEndian(),
+        "Deserialization of raw data on big endian platform is not written "
+        "yet.");
+    CAFFE_ENFORCE_EQ(
+        chunkSize * tensor->itemsize(),
+        tensor_proto.raw_data().size(),
+        "Incorrect proto field size.");
+    if (chunkSize > 0) {
+      context->CopyBytesFromCPU(
+          tensor_proto.raw_data().size(),
+          tensor_proto.raw_data().data(),
+          static_cast<char*>(tensor->raw_mutable_data()) +
+              chunkBegin * tensor->itemsize());
+    }
+    context->FinishDeviceComputation();
+    return;
+  }
+
   switch (tensor_proto.data_type()) {
     case TensorProto_DataType_FLOAT:
       detail::CopyFromProtoAsIs(
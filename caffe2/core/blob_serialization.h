@@ -16,6 +16,7 @@
 C10_DECLARE_int(caffe2_tensor_chunk_size);
 C10_DECLARE_int(caffe2_max_tensor_serializer_threads);
 C10_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
+C10_DECLARE_bool(caffe2_serialize_using_raw_data);
 
 namespace caffe2 {
 
@@ -55,6 +56,28 @@ CAFFE2_API string SerializeBlob(const Blob& blob, const string& name);
 CAFFE2_API void DeserializeBlob(const string& content, Blob* result);
 CAFFE2_API void DeserializeBlob(const BlobProto& proto, Blob* result);
 
+/**
+ * Parses a string containing a BlobProto like BlobProto::ParseFromString, but
+ * leaves the raw_data of a tensor stored in the RAW format out of the parsed
+ * proto. Instead, *payload_offset and *payload_size tell where the payload is
+ * in content, so that it can be copied straight into the tensor storage.
+ * *payload_size is 0 if there is no such payload. Payloads written by the
+ * serializer start at a multiple of 64 bytes into content.
+ */
+CAFFE2_API bool ParseBlobProtoWithRawPayload(
+    const string& content,
+    BlobProto* proto,
+    size_t* payload_offset,
+    size_t* payload_size);
+
+/*
+ * Gives the tensor in blob the shape and type described by proto, like the
+ * tensor deserializer does, but leaves its data uninitialized. Used to load
+ * raw payloads split off by ParseBlobProtoWithRawPayload straight into CPU
+ * tensors.
+ */
+CAFFE2_API Tensor* DeserializeTensorHeader(const TensorProto& proto, Blob* blob);
+
 /*
  * Get an empty Tensor from the TensorProto given the meta data in proto (data
  * type and size of the Tensor) without actually filling in the data.
@@ -111,6 +134,21 @@ class CAFFE2_API TensorSerializer : public BlobSerializerBase {
       int32_t chunkSize);
 
  private:
+  // Fills everything but the data of the chunk into proto and returns the
+  // number of elements in the chunk.
+  int32_t SerializeHeader(
+      const Tensor& input,
+      const string& name,
+      TensorProto* proto,
+      size_t chunkBegin,
+      int32_t chunkSize);
+  // Serializes a chunk in the RAW storage format. The payload is copied
+  // once, from the tensor straight into the returned string.
+  string SerializeRawChunk(
+      const Tensor& input,
+      BlobProto* blob_proto,
+      size_t chunkBegin,
+      int32_t chunkSize);
   // A utility function to store the device context detauls.
   void StoreDeviceDetail(const Tensor& input, TensorProto* proto);
   unique_ptr<BaseContext> context_;
@@ -12,6 +12,7 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/core/qtensor.h"
 #include "caffe2/core/qtensor_serialization.h"
+#include "caffe2/core/scope_guard.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/core/types.h"
 #include "caffe2/core/workspace.h"
@@ -21,6 +22,7 @@
 C10_DEFINE_int64(caffe2_test_big_tensor_size, 100000000, "");
 C10_DECLARE_int(caffe2_tensor_chunk_size);
 C10_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
+C10_DECLARE_bool(caffe2_serialize_using_raw_data);
 
 namespace caffe2 {
 using namespace ::caffe2::db;
@@ -1062,6 +1064,130 @@ TEST(CustomChunkSize, BigTensorSerialization) {
   EXPECT_EQ(counter, 1);
 }
 
+TEST(RawDataSerialization, ChunkedRoundTrip) {
+  const bool old_flag = FLAGS_caffe2_serialize_using_raw_data;
+  FLAGS_caffe2_serialize_using_raw_data = true;
+  auto restore_flag = MakeGuard(
+      [old_flag]() { FLAGS_caffe2_serialize_using_raw_data = old_flag; });
+
+  Blob blob;
+  TensorCPU* tensor = BlobGetMutableTensor(&blob, CPU);
+  tensor->Resize(7, 11);
+  for (int i = 0; i < tensor->numel(); ++i) {
+    tensor->mutable_data<int64_t>()[i] = i * 3;
+  }
+  std::mutex mutex;
+  std::vector<std::string> values;
+  SerializeBlob(
+      blob,
+      "test",
+      [&](const std::string& /*key*/, const std::string& value) {
+        std::lock_guard<std::mutex> guard(mutex);
+        values.push_back(value);
+      },
+      10);
+  ASSERT_EQ(values.size(), 8);
+
+  Blob new_blob;
+  for (const auto& value : values) {
+    // The whole value is a regular BlobProto...
+    BlobProto proto;
+    ASSERT_TRUE(proto.ParseFromString(value));
+    EXPECT_EQ(proto.tensor().storage_type(), TensorProto_StorageType_RAW);
+    const auto chunk_size =
+        proto.tensor().segment().end() - proto.tensor().segment().begin();
+    EXPECT_EQ(proto.tensor().raw_data().size(), chunk_size * sizeof(int64_t));
+
+    // ...whose payload can be found without parsing it.
+    BlobProto header;
+    size_t payload_offset = 0;
+    size_t payload_size = 0;
+    ASSERT_TRUE(ParseBlobProtoWithRawPayload(
+        value, &header, &payload_offset, &payload_size));
+    EXPECT_FALSE(header.tensor().has_raw_data());
+    EXPECT_EQ(
+        header.tensor().segment().begin(), proto.tensor().segment().begin());
+    EXPECT_EQ(payload_size, proto.tensor().raw_data().size());
+    EXPECT_EQ(payload_offset % 64, 0);
+    EXPECT_EQ(
+        value.substr(payload_offset, payload_size), proto.tensor().raw_data());
+
+    DeserializeBlob(proto, &new_blob);
+  }
+  const auto& new_tensor = new_blob.Get<TensorCPU>();
+  EXPECT_EQ(new_tensor.sizes(), tensor->sizes());
+  for (int i = 0; i < tensor->numel(); ++i) {
+    EXPECT_EQ(new_tensor.data<int64_t>()[i], i * 3);
+  }
+}
+
+TEST(RawDataSerialization, LoadOp) {
+  const bool old_flag = FLAGS_caffe2_serialize_using_raw_data;
+  FLAGS_caffe2_serialize_using_raw_data = true;
+  auto restore_flag = MakeGuard(
+      [old_flag]() { FLAGS_caffe2_serialize_using_raw_data = old_flag; });
+
+  string db_source = (string)std::tmpnam(nullptr);
+  StringMap data;
+  {
+    Blob blob;
+    TensorCPU* tensor = BlobGetMutableTensor(&blob, CPU);
+    tensor->Resize(13, 7);
+    for (int i = 0; i < tensor->numel(); ++i) {
+      tensor->mutable_data<float>()[i] = i * 0.5f;
+    }
+    std::mutex mutex;
+    auto acceptor = [&](const std::string& key, const std::string& value) {
+      std::lock_guard<std::mutex> guard(mutex);
+      data.emplace_back(key, value);
+    };
+    // Several chunks, so that several payloads are copied in parallel.
+    SerializeBlob(blob, "test", acceptor, 10);
+    EXPECT_EQ(data.size(), 10);
+  }
+
+  for (bool load_all : {false, true}) {
+    // The data is dropped when the DB is closed.
+    VectorDB::registerData(db_source, StringMap(data));
+    DeviceOption option;
+    option.set_device_type(PROTO_CPU);
+    std::vector<Argument> args{MakeArgument<string>("db_type", "vector_db"),
+                               MakeArgument<string>("db", db_source),
+                               MakeArgument<bool>("absolute_path", true)};
+    std::vector<string> outputs{"test"};
+    if (load_all) {
+      args.push_back(MakeArgument<int>("load_all", 1));
+      outputs.clear();
+    }
+    auto op_def = CreateOperatorDef(
+        "Load", "", std::vector<string>{}, outputs, args, option);
+    Workspace ws;
+    auto load_op = CreateOperator(op_def, &ws);
+    ASSERT_TRUE(load_op != nullptr);
+    ASSERT_TRUE(load_op->Run());
+    auto* new_blob = ws.GetBlob("test");
+    ASSERT_TRUE(BlobIsTensorType(*new_blob, CPU));
+    const auto& new_tensor = new_blob->Get<TensorCPU>();
+    EXPECT_EQ(new_tensor.sizes(), (std::vector<int64_t>{13, 7}));
+    for (int i = 0; i < new_tensor.numel(); ++i) {
+      EXPECT_EQ(new_tensor.data<float>()[i], i * 0.5f);
+    }
+  }
+}
+
+TEST(RawDataSerialization, NoContentIsNotData) {
+  // A proto without the tensor data must not deserialize to a tensor with
+  // uninitialized data.
+  BlobProto proto;
+  proto.set_name("test");
+  proto.set_type("Tensor");
+  proto.mutable_tensor()->add_dims(3);
+  proto.mutable_tensor()->set_data_type(TensorProto_DataType_FLOAT);
+  proto.mutable_tensor()->set_storage_type(TensorProto_StorageType_NO_CONTENT);
+  Blob blob;
+  EXPECT_THROW(DeserializeBlob(proto, &blob), EnforceNotMet);
+}
+
 TEST(QTensor, QTensorSizingTest) {
   vector<int> dims(3);
   dims[0] = 2;
@@ -1,6 +1,10 @@
 #include "caffe2/core/db.h"
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <mutex>
+#include <thread>
 
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/core/logging.h"
@@ -171,6 +175,158 @@ class MiniDB : public DB {
 REGISTER_CAFFE2_DB(MiniDB, MiniDB);
 REGISTER_CAFFE2_DB(minidb, MiniDB);
 
+// Background reading for DBReader. Stream j owns a cursor positioned on
+// record j (counting from where the reader was) and then steps over
+// num_cursors records at a time, so reading the streams round-robin returns
+// the records in their original order.
+class DBReader::Readahead {
+ public:
+  Readahead(
+      const DBReader& reader,
+      int num_cursors,
+      size_t buffer_size)
+      : reader_(reader), bufferSize_(buffer_size) {
+    CAFFE_ENFORCE_GT(num_cursors, 0);
+    CAFFE_ENFORCE_GT(buffer_size, 0);
+    CAFFE_ENFORCE(
+        num_cursors == 1 || reader.cursor_->SupportsSeek(),
+        "Reading ahead with more than one cursor needs a db that supports "
+        "seeking.");
+    const bool startValid = reader.cursor_->Valid();
+    const string startKey = startValid ? reader.cursor_->key() : string();
+    for (int j = 0; j < num_cursors; ++j) {
+      streams_.emplace_back(new Stream());
+      auto& stream = *streams_.back();
+      if (j == 0) {
+        // The first stream continues with the reader's own cursor, which
+        // also keeps dbs that allow only one cursor at a time working.
+        stream.cursor = reader.cursor_.get();
+      } else {
+        stream.ownedCursor = reader.db_->NewCursor();
+        stream.cursor = stream.ownedCursor.get();
+        if (startValid) {
+          stream.cursor->Seek(startKey);
+        } else {
+          MoveToBeginning(stream.cursor);
+        }
+        Advance(stream.cursor, j);
+      }
+    }
+    for (int j = 0; j < num_cursors; ++j) {
+      streams_[j]->thread = std::thread([this, j]() { Fill(*streams_[j]); });
+    }
+  }
+
+  ~Readahead() {
+    for (auto& stream : streams_) {
+      std::lock_guard<std::mutex> lock(stream->mutex);
+      stream->stop = true;
+      stream->notFull.notify_all();
+    }
+    for (auto& stream : streams_) {
+      stream->thread.join();
+    }
+  }
+
+  void Read(size_t n, string* keys, string* values) {
+    for (size_t i = 0; i < n; ++i) {
+      auto& stream = *streams_[next_];
+      next_ = (next_ + 1) % streams_.size();
+      std::unique_lock<std::mutex> lock(stream.mutex);
+      stream.notEmpty.wait(
+          lock, [&stream]() { return !stream.records.empty() || stream.error; });
+      if (stream.records.empty()) {
+        std::rethrow_exception(stream.error);
+      }
+      keys[i] = std::move(stream.records.front().first);
+      values[i] = std::move(stream.records.front().second);
+      stream.records.pop_front();
+      stream.notFull.notify_one();
+    }
+  }
+
+ private:
+  struct Stream {
+    Cursor* cursor = nullptr;
+    unique_ptr<Cursor> ownedCursor;
+    std::deque<std::pair<string, string>> records;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    bool stop = false;
+    std::exception_ptr error;
+    std::thread thread;
+  };
+
+  void MoveToBeginning(Cursor* cursor) const {
+    cursor->SeekToFirst();
+    for (uint32_t s = 0; s < reader_.shard_id_; s++) {
+      cursor->Next();
+      CAFFE_ENFORCE(
+          cursor->Valid(),
+          "Db has fewer rows than shard id: ",
+          s,
+          reader_.shard_id_);
+    }
+  }
+
+  // Moves the cursor forward by count records of the reader's shard, going
+  // back to the beginning of the shard at the end of the db.
+  void Advance(Cursor* cursor, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      for (uint32_t s = 0; s < reader_.num_shards_; s++) {
+        cursor->Next();
+        if (!cursor->Valid()) {
+          MoveToBeginning(cursor);
+          break;
+        }
+      }
+    }
+  }
+
+  void Fill(Stream& stream) {
+    try {
+      for (;;) {
+        std::pair<string, string> record(
+            stream.cursor->key(), stream.cursor->value());
+        Advance(stream.cursor, streams_.size());
+
+        std::unique_lock<std::mutex> lock(stream.mutex);
+        stream.notFull.wait(lock, [this, &stream]() {
+          return stream.stop || stream.records.size() < bufferSize_;
+        });
+        if (stream.stop) {
+          return;
+        }
+        stream.records.push_back(std::move(record));
+        stream.notEmpty.notify_one();
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(stream.mutex);
+      stream.error = std::current_exception();
+      stream.notEmpty.notify_all();
+    }
+  }
+
+  const DBReader& reader_;
+  const size_t bufferSize_;
+  std::vector<unique_ptr<Stream>> streams_;
+  // Stream to take the next record from; protected by the reader's mutex.
+  size_t next_ = 0;
+};
+
+void DBReader::StartReadaheadLocked(int num_cursors, size_t buffer_size)
+    const {
+  readahead_ = std::make_shared<Readahead>(*this, num_cursors, buffer_size);
+  readahead_num_cursors_ = num_cursors;
+  readahead_buffer_size_ = buffer_size;
+}
+
+void DBReader::ReadFromReadahead(size_t n, string* keys, string* values)
+    const {
+  readahead_->Read(n, keys, values);
+}
+
 void DBReaderSerializer::Serialize(
     const void* pointer,
     TypeMeta typeMeta,
@@ -182,7 +338,10 @@ void DBReaderSerializer::Serialize(
   proto.set_name(name);
   proto.set_source(reader.source_);
   proto.set_db_type(reader.db_type_);
-  if (reader.cursor() && reader.cursor()->SupportsSeek()) {
+  // While reading ahead the cursor is in use by a background thread, and its
+  // position doesn't match what has been read anyway.
+  if (reader.cursor() && !reader.readahead_ &&
+      reader.cursor()->SupportsSeek()) {
     proto.set_key(reader.cursor()->key());
   }
   BlobProto blob_proto;
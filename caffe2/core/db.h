@@ -182,6 +182,7 @@ class CAFFE2_API DBReader {
       const int32_t shard_id = 0) {
     // Note(jiayq): resetting is needed when we re-open e.g. leveldb where no
     // concurrent access is allowed.
+    StopReadahead();
     cursor_.reset();
     db_.reset();
     db_type_ = db_type;
@@ -201,6 +202,7 @@ class CAFFE2_API DBReader {
       unique_ptr<DB>&& db,
       const int32_t num_shards = 1,
       const int32_t shard_id = 0) {
+    StopReadahead();
     cursor_.reset();
     db_.reset();
     db_ = std::move(db);
@@ -228,16 +230,30 @@ class CAFFE2_API DBReader {
   void Read(string* key, string* value) const {
     CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
     std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
-    *key = cursor_->key();
-    *value = cursor_->value();
+    if (readahead_) {
+      ReadFromReadahead(1, key, value);
+      return;
+    }
+    ReadAndAdvance(key, value);
+  }
 
-    // In sharded mode, each read skips num_shards_ records
-    for (uint32_t s = 0; s < num_shards_; s++) {
-      cursor_->Next();
-      if (!cursor_->Valid()) {
-        MoveToBeginning();
-        break;
-      }
+  /**
+   * Reads the next n records, with the same semantics as n calls to Read(),
+   * except that the records are guaranteed to be consecutive even if other
+   * threads are reading at the same time. keys and values are resized to n.
+   * Thread safe.
+   */
+  void Read(size_t n, vector<string>* keys, vector<string>* values) const {
+    CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
+    keys->resize(n);
+    values->resize(n);
+    std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    if (readahead_) {
+      ReadFromReadahead(n, keys->data(), values->data());
+      return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      ReadAndAdvance(&(*keys)[i], &(*values)[i]);
     }
   }
 
@@ -247,9 +263,40 @@ class CAFFE2_API DBReader {
   void SeekToFirst() const {
     CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
     std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    if (readahead_) {
+      // the background threads need to be stopped before touching cursor_
+      readahead_.reset();
+      MoveToBeginning();
+      StartReadaheadLocked(readahead_num_cursors_, readahead_buffer_size_);
+      return;
+    }
     MoveToBeginning();
   }
 
+  /**
+   * Starts reading ahead in the background: num_cursors threads, each with
+   * its own cursor over every num_cursors-th record of this reader's shard,
+   * keep up to buffer_size records each ready for Read(). Records are
+   * returned in the same order as without readahead, starting from the
+   * current cursor position.
+   *
+   * num_cursors > 1 requires a db that supports seeking (e.g. leveldb or
+   * lmdb). While reading ahead the reader's own cursor belongs to the first
+   * background thread, so cursor() must not be used; after StopReadahead()
+   * its position is unspecified until the next SeekToFirst().
+   */
+  void StartReadahead(int num_cursors, size_t buffer_size) {
+    CAFFE_ENFORCE(cursor_ != nullptr, "Reader not initialized.");
+    std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    readahead_.reset();
+    StartReadaheadLocked(num_cursors, buffer_size);
+  }
+
+  void StopReadahead() {
+    std::unique_lock<std::mutex> mutex_lock(reader_mutex_);
+    readahead_.reset();
+  }
+
   /**
    * Returns the underlying cursor of the db reader.
    *
@@ -283,6 +330,28 @@ class CAFFE2_API DBReader {
     }
   }
 
+  void ReadAndAdvance(string* key, string* value) const {
+    *key = cursor_->key();
+    *value = cursor_->value();
+
+    // In sharded mode, each read skips num_shards_ records
+    for (uint32_t s = 0; s < num_shards_; s++) {
+      cursor_->Next();
+      if (!cursor_->Valid()) {
+        MoveToBeginning();
+        break;
+      }
+    }
+  }
+
+  class Readahead;
+
+  // Defined in db.cc. Both must be called with reader_mutex_ held; readers
+  // are serialized on it to keep the records in order, but the background
+  // threads do the actual reading without it.
+  void StartReadaheadLocked(int num_cursors, size_t buffer_size) const;
+  void ReadFromReadahead(size_t n, string* keys, string* values) const;
+
   string db_type_;
   string source_;
   unique_ptr<DB> db_;
@@ -290,6 +359,12 @@ class CAFFE2_API DBReader {
   mutable std::mutex reader_mutex_;
   uint32_t num_shards_{};
   uint32_t shard_id_{};
+  // Background readers, if StartReadahead was called. Declared after db_ so
+  // that they are stopped before the db is closed. (A shared_ptr only so
+  // that Readahead can stay incomplete here.)
+  mutable std::shared_ptr<Readahead> readahead_;
+  mutable int readahead_num_cursors_{0};
+  mutable size_t readahead_buffer_size_{0};
 
   C10_DISABLE_COPY_AND_ASSIGN(DBReader);
 };
@@ -1,8 +1,11 @@
 #include "caffe2/core/memonger.h"
 
+#include <algorithm>
+#include <limits>
 #include <set>
 #include <unordered_set>
 
+#include "caffe2/core/types.h"
 #include "caffe2/utils/proto_utils.h"
 
 namespace caffe2 {
@@ -589,5 +592,246 @@ NetDef compute_blob_recycling_for_dag(
       blob_shapes);
 }
 
+namespace {
+
+// Ops whose output shares the storage of their first input.
+bool isAliasingOp(const OperatorDef& op) {
+  return op.type() == "Alias" || op.type() == "AliasWithName";
+}
+
+bool hasSubnets(const OperatorDef& op) {
+  for (const auto& arg : op.arg()) {
+    if (arg.has_n() || arg.nets_size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Size in bytes of a blob with the given shape, or 0 if it can't live in an
+// arena: unknown shape or type, or a type that needs construction.
+int64_t arenaBlobBytes(const TensorShape& shape) {
+  if (shape.unknown_shape() || shape.unknown_dims_size() > 0 ||
+      shape.data_type() == TensorProto_DataType_UNDEFINED) {
+    return 0;
+  }
+  const auto& meta = DataTypeToTypeMeta(shape.data_type());
+  if (meta.placementNew() != nullptr || meta.itemsize() == 0) {
+    return 0;
+  }
+  int64_t numel = 1;
+  for (const auto d : shape.dims()) {
+    if (d < 0) {
+      return 0;
+    }
+    numel *= d;
+  }
+  return numel * meta.itemsize();
+}
+
+} // namespace
+
+MemoryArenaPlan plan_memory_arena(
+    const NetDef& net,
+    const std::set<string>& static_blobs,
+    const std::unordered_map<string, TensorShape>& blob_shapes,
+    int64_t alignment) {
+  CAFFE_ENFORCE_GT(alignment, 0);
+  MemoryArenaPlan plan;
+  // Lifetimes are op indices, which only describe the execution of nets that
+  // run their ops one after the other.
+  if (net.type() != "" && net.type() != "simple") {
+    LOG(INFO) << "Cannot plan memory for nets of type: " << net.type();
+    return plan;
+  }
+
+  std::unordered_set<string> excluded(static_blobs.begin(), static_blobs.end());
+  excluded.insert(net.external_input().begin(), net.external_input().end());
+  excluded.insert(net.external_output().begin(), net.external_output().end());
+
+  // Step 1: lifetime of each blob written by the net, and the alias classes.
+  std::unordered_map<string, std::pair<int, int>> ranges;
+  std::unordered_map<string, string> alias_parent;
+  for (int i = 0; i < net.op_size(); i++) {
+    const auto& op = net.op(i);
+    if (op.type() == "RecurrentNetwork" || hasSubnets(op)) {
+      LOG(INFO) << "Cannot plan memory for nets with op " << op.type()
+                << " that runs its own nets";
+      return plan;
+    }
+    const auto& device = op.has_device_option() ? op.device_option()
+                                                : net.device_option();
+    for (const auto& inp : op.input()) {
+      auto rit = ranges.find(inp);
+      if (rit != ranges.end()) {
+        rit->second.second = i;
+      } else {
+        // read before the net writes it, so it comes from outside
+        excluded.insert(inp);
+      }
+    }
+    for (const auto& outp : op.output()) {
+      if (device.device_type() != PROTO_CPU) {
+        excluded.insert(outp);
+      }
+      auto rit = ranges.find(outp);
+      if (rit == ranges.end()) {
+        ranges[outp] = std::make_pair(i, i);
+      } else {
+        rit->second.second = i;
+      }
+    }
+    if (isAliasingOp(op) && op.input_size() > 0 && op.output_size() > 0 &&
+        op.input(0) != op.output(0)) {
+      alias_parent[op.output(0)] = op.input(0);
+    }
+  }
+
+  // Step 2: merge the aliases into the blob that owns the storage, so that it
+  // stays alive as long as any of its aliases. An alias class with an
+  // excluded member is excluded as a whole.
+  auto root_of = [&alias_parent](string b) {
+    for (auto it = alias_parent.find(b); it != alias_parent.end();
+         it = alias_parent.find(b)) {
+      b = it->second;
+    }
+    return b;
+  };
+  for (const auto& kv : alias_parent) {
+    const auto root = root_of(kv.first);
+    if (excluded.count(kv.first)) {
+      excluded.insert(root);
+    }
+    auto rit = ranges.find(root);
+    if (rit == ranges.end()) {
+      excluded.insert(root);
+      continue;
+    }
+    const auto& alias_range = ranges.at(kv.first);
+    rit->second.first = std::min(rit->second.first, alias_range.first);
+    rit->second.second = std::max(rit->second.second, alias_range.second);
+  }
+
+  struct Candidate {
+    string blob;
+    int first;
+    int last;
+    int64_t size;
+  };
+  std::vector<Candidate> candidates;
+  for (const auto& kv : ranges) {
+    if (alias_parent.count(kv.first) || excluded.count(kv.first)) {
+      continue;
+    }
+    auto sit = blob_shapes.find(kv.first);
+    if (sit == blob_shapes.end()) {
+      continue;
+    }
+    const int64_t bytes = arenaBlobBytes(sit->second);
+    if (bytes == 0) {
+      continue;
+    }
+    const int64_t size = (bytes + alignment - 1) / alignment * alignment;
+    candidates.push_back(
+        Candidate{kv.first, kv.second.first, kv.second.second, size});
+  }
+
+  // Step 3: greedy by size, best fit. Place the largest blobs first; every
+  // blob goes into the smallest gap between the blobs already placed that are
+  // alive at the same time, or after all of them if no gap is large enough.
+  std::sort(
+      candidates.begin(),
+      candidates.end(),
+      [](const Candidate& a, const Candidate& b) {
+        if (a.size != b.size) {
+          return a.size > b.size;
+        }
+        if (a.first != b.first) {
+          return a.first < b.first;
+        }
+        return a.blob < b.blob;
+      });
+  std::vector<int64_t> offsets(candidates.size());
+  for (size_t i = 0; i < candidates.size(); i++) {
+    const auto& c = candidates[i];
+    std::vector<std::pair<int64_t, int64_t>> busy;
+    for (size_t j = 0; j < i; j++) {
+      const auto& p = candidates[j];
+      if (p.first <= c.last && c.first <= p.last) {
+        busy.emplace_back(offsets[j], offsets[j] + p.size);
+      }
+    }
+    std::sort(busy.begin(), busy.end());
+    int64_t best_offset = -1;
+    int64_t best_gap = std::numeric_limits<int64_t>::max();
+    int64_t end = 0;
+    for (const auto& b : busy) {
+      const int64_t gap = b.first - end;
+      if (gap >= c.size && gap < best_gap) {
+        best_gap = gap;
+        best_offset = end;
+      }
+      end = std::max(end, b.second);
+    }
+    offsets[i] = best_offset >= 0 ? best_offset : end;
+
+    plan.blobs.push_back(c.blob);
+    plan.offsets.push_back(offsets[i]);
+    plan.sizes.push_back(c.size);
+    plan.arena_size = std::max(plan.arena_size, offsets[i] + c.size);
+    plan.naive_size += c.size;
+  }
+
+  if (plan.naive_size > 0) {
+    LOG(INFO) << "Memory arena for net " << net.name() << ": "
+              << plan.blobs.size() << " blobs in " << plan.arena_size
+              << " bytes instead of " << plan.naive_size << " bytes ("
+              << 100 - plan.arena_size * 100 / plan.naive_size
+              << "% saved)";
+  }
+  return plan;
+}
+
+NetDef apply_memory_arena_plan(
+    const NetDef& net,
+    const MemoryArenaPlan& plan,
+    const std::unordered_map<string, TensorShape>& blob_shapes,
+    const string& arena_blob) {
+  if (plan.blobs.empty()) {
+    return net;
+  }
+  std::vector<int64_t> dims;
+  std::vector<int64_t> ranks;
+  std::vector<int64_t> dtypes;
+  for (const auto& blob : plan.blobs) {
+    const auto& shape = blob_shapes.at(blob);
+    dims.insert(dims.end(), shape.dims().begin(), shape.dims().end());
+    ranks.push_back(shape.dims_size());
+    dtypes.push_back(shape.data_type());
+  }
+  std::vector<string> outputs{arena_blob};
+  outputs.insert(outputs.end(), plan.blobs.begin(), plan.blobs.end());
+
+  NetDef planned_net = net;
+  planned_net.mutable_op()->Clear();
+  auto* bind = planned_net.add_op();
+  *bind = CreateOperatorDef(
+      "MemoryArenaBind",
+      "",
+      std::vector<string>{},
+      outputs,
+      std::vector<Argument>{
+          MakeArgument<int64_t>("arena_size", plan.arena_size),
+          MakeArgument<vector<int64_t>>("offsets", plan.offsets),
+          MakeArgument<vector<int64_t>>("sizes", plan.sizes),
+          MakeArgument<vector<int64_t>>("dims", dims),
+          MakeArgument<vector<int64_t>>("ranks", ranks),
+          MakeArgument<vector<int64_t>>("dtypes", dtypes)});
+  for (const auto& op : net.op()) {
+    planned_net.add_op()->CopyFrom(op);
+  }
+  return planned_net;
+}
+
 } // memonger
 } // caffe2
@@ -1,6 +1,8 @@
 #ifndef CAFFE2_CORE_MEMONGER_H_
 #define CAFFE2_CORE_MEMONGER_H_
 
+#include <set>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "caffe2/core/common.h"
@@ -23,6 +25,43 @@ CAFFE2_API NetDef compute_blob_recycling_for_dag(
     const std::unordered_set<string>& dont_share_blob_names,
     const std::unordered_map<string, vector<int>>& blob_shapes);
 
+// Placement of the intermediate blobs of a net inside one preallocated
+// buffer. Blobs whose lifetimes overlap get disjoint byte ranges, blobs that
+// are never alive at the same time may share bytes.
+struct CAFFE2_API MemoryArenaPlan {
+  // Blobs placed in the arena, with their byte offsets and (aligned) sizes.
+  std::vector<string> blobs;
+  std::vector<int64_t> offsets;
+  std::vector<int64_t> sizes;
+  // Bytes needed by the arena, and bytes the same blobs take when every one
+  // of them has its own allocation.
+  int64_t arena_size = 0;
+  int64_t naive_size = 0;
+};
+
+// Computes the lifetime of every blob produced by the net, from the op that
+// first writes it to the op that last reads or writes it, and packs the
+// blobs into an arena by placing the largest blobs first, each one into the
+// smallest gap left by the already placed blobs it overlaps with. Works on
+// the combined forward and backward ops of a training net.
+//
+// Blobs in static_blobs, external inputs and outputs of the net, and blobs
+// without a known fixed-size shape in blob_shapes are left alone.
+CAFFE2_API MemoryArenaPlan plan_memory_arena(
+    const NetDef& net,
+    const std::set<string>& static_blobs,
+    const std::unordered_map<string, TensorShape>& blob_shapes,
+    int64_t alignment = 64);
+
+// Returns a copy of the net that starts with a MemoryArenaBind op, which
+// allocates the arena into arena_blob and points the planned blobs at their
+// offsets on every run.
+CAFFE2_API NetDef apply_memory_arena_plan(
+    const NetDef& net,
+    const MemoryArenaPlan& plan,
+    const std::unordered_map<string, TensorShape>& blob_shapes,
+    const string& arena_blob);
+
 } // memonger
 } // caffe2
 
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include "caffe2/core/memonger.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+namespace {
+
+class MemongerArenaTestOp final : public Operator<CPUContext> {
+ public:
+  MemongerArenaTestOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws) {}
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+
+  bool RunOnDevice() override {
+    const auto& X = Input(0);
+    auto* Y = Output(0, X.sizes(), at::dtype<float>());
+    const auto* x = X.data<float>();
+    auto* y = Y->mutable_data<float>();
+    for (int64_t i = 0; i < X.numel(); ++i) {
+      y[i] = x[i] + 1;
+    }
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(MemongerArenaTest, MemongerArenaTestOp);
+
+OPERATOR_SCHEMA(MemongerArenaTest).NumInputs(1).NumOutputs(1);
+
+NetDef chainNet() {
+  NetDef net;
+  net.set_name("chain");
+  net.add_external_input("x");
+  net.add_external_output("d");
+  const std::vector<std::pair<string, string>> edges{
+      {"x", "a"}, {"a", "b"}, {"b", "c"}, {"c", "d"}};
+  for (const auto& edge : edges) {
+    net.add_op()->CopyFrom(CreateOperatorDef(
+        "MemongerArenaTest",
+        "",
+        std::vector<string>{edge.first},
+        std::vector<string>{edge.second}));
+  }
+  return net;
+}
+
+std::unordered_map<string, TensorShape> chainShapes() {
+  std::unordered_map<string, TensorShape> shapes;
+  for (const auto& name : {"x", "a", "b", "c", "d"}) {
+    TensorShape shape;
+    shape.add_dims(10);
+    shape.add_dims(100);
+    shape.set_data_type(TensorProto_DataType_FLOAT);
+    shapes[name] = shape;
+  }
+  return shapes;
+}
+
+int64_t offsetOf(const memonger::MemoryArenaPlan& plan, const string& blob) {
+  for (size_t i = 0; i < plan.blobs.size(); ++i) {
+    if (plan.blobs[i] == blob) {
+      return plan.offsets[i];
+    }
+  }
+  return -1;
+}
+
+// Forward and backward ops of a ResNet-18 style training net with a batch of
+// 8: a stem and four stages of two residual blocks. The backward ops read
+// the saved activations in reverse order. Weights are left out, they are
+// external inputs that the planner skips anyway.
+NetDef resnetTrainingNet(std::unordered_map<string, TensorShape>* shapes) {
+  NetDef net;
+  net.set_name("resnet");
+  net.add_external_input("data");
+  auto addShape = [shapes](const string& name, int channels, int size) {
+    TensorShape shape;
+    for (const int d : {8, channels, size, size}) {
+      shape.add_dims(d);
+    }
+    shape.set_data_type(TensorProto_DataType_FLOAT);
+    (*shapes)[name] = shape;
+  };
+  auto addOp = [&net](
+                   const string& type,
+                   const std::vector<string>& inputs,
+                   const std::vector<string>& outputs) {
+    net.add_op()->CopyFrom(CreateOperatorDef(type, "", inputs, outputs));
+  };
+
+  struct Block {
+    string in, conv1, relu1, conv2, proj, out;
+  };
+  std::vector<Block> blocks;
+  addShape("data", 3, 112);
+  addOp("Conv", {"data"}, {"stem"});
+  addShape("stem", 64, 56);
+  string x = "stem";
+  int in_channels = 64;
+  const std::vector<std::pair<int, int>> stages{
+      {64, 56}, {128, 28}, {256, 14}, {512, 7}};
+  for (const auto& stage : stages) {
+    for (int b = 0; b < 2; ++b) {
+      const string prefix = "res" + c10::to_string(blocks.size());
+      Block block{x,
+                  prefix + "_conv1",
+                  prefix + "_relu1",
+                  prefix + "_conv2",
+                  "",
+                  prefix + "_sum"};
+      for (const auto& name : {block.conv1, block.relu1, block.conv2,
+                               block.out}) {
+        addShape(name, stage.first, stage.second);
+      }
+      addOp("Conv", {x}, {block.conv1});
+      addOp("Relu", {block.conv1}, {block.relu1});
+      addOp("Conv", {block.relu1}, {block.conv2});
+      string skip = x;
+      if (in_channels != stage.first) {
+        block.proj = prefix + "_proj";
+        addShape(block.proj, stage.first, stage.second);
+        addOp("Conv", {x}, {block.proj});
+        skip = block.proj;
+      }
+      addOp("Sum", {block.conv2, skip}, {block.out});
+      in_channels = stage.first;
+      x = block.out;
+      blocks.push_back(block);
+    }
+  }
+  addOp("AveragedLoss", {x}, {"loss"});
+  net.add_external_output("loss");
+
+  auto grad = [](const string& name) { return name + "_grad"; };
+  addOp("AveragedLossGradient", {x, "loss"}, {grad(x)});
+  for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+    const auto& block = *it;
+    for (const auto& name : {block.in, block.relu1, block.conv1}) {
+      (*shapes)[grad(name)] = shapes->at(name);
+    }
+    addOp("ConvGradient", {block.relu1, grad(block.out)}, {grad(block.relu1)});
+    addOp(
+        "ReluGradient", {block.relu1, grad(block.relu1)}, {grad(block.conv1)});
+    const string main_grad = block.in + "_main_grad";
+    (*shapes)[main_grad] = shapes->at(block.in);
+    addOp("ConvGradient", {block.in, grad(block.conv1)}, {main_grad});
+    string skip_grad = grad(block.out);
+    if (!block.proj.empty()) {
+      skip_grad = grad(block.proj);
+      (*shapes)[skip_grad] = shapes->at(block.in);
+      addOp("ConvGradient", {block.in, grad(block.out)}, {skip_grad});
+    }
+    addOp("Sum", {main_grad, skip_grad}, {grad(block.in)});
+  }
+  addOp("ConvGradient", {"data", grad("stem")}, {"stem_w_grad"});
+  net.add_external_output("stem_w_grad");
+  return net;
+}
+
+} // namespace
+
+TEST(MemongerTest, PlanMemoryArena) {
+  const auto plan =
+      memonger::plan_memory_arena(chainNet(), {}, chainShapes(), 64);
+  // x and d are external, a and c are never alive at the same time.
+  ASSERT_EQ(plan.blobs.size(), 3);
+  EXPECT_EQ(offsetOf(plan, "x"), -1);
+  EXPECT_EQ(offsetOf(plan, "d"), -1);
+  EXPECT_EQ(offsetOf(plan, "a"), offsetOf(plan, "c"));
+  EXPECT_NE(offsetOf(plan, "a"), offsetOf(plan, "b"));
+  EXPECT_EQ(plan.naive_size, 3 * 4032);
+  EXPECT_EQ(plan.arena_size, 2 * 4032);
+}
+
+TEST(MemongerTest, PlanMemoryArenaStaticBlobs) {
+  const auto plan =
+      memonger::plan_memory_arena(chainNet(), {"b"}, chainShapes(), 64);
+  EXPECT_EQ(offsetOf(plan, "b"), -1);
+  EXPECT_EQ(plan.blobs.size(), 2);
+  EXPECT_EQ(plan.arena_size, 4032);
+}
+
+TEST(MemongerTest, PlanMemoryArenaResNet) {
+  std::unordered_map<string, TensorShape> shapes;
+  const auto net = resnetTrainingNet(&shapes);
+  const auto plan = memonger::plan_memory_arena(net, {}, shapes, 64);
+  LOG(INFO) << "ResNet training net: arena of " << plan.arena_size
+            << " bytes, " << plan.naive_size << " bytes without it";
+  ASSERT_FALSE(plan.blobs.empty());
+  EXPECT_LT(plan.arena_size, plan.naive_size);
+
+  // Blobs alive at the same time must not share bytes, so the arena is at
+  // least as large as the peak of the live blobs.
+  std::unordered_map<string, std::pair<int, int>> ranges;
+  for (int i = 0; i < net.op_size(); ++i) {
+    for (const auto& names : {net.op(i).input(), net.op(i).output()}) {
+      for (const auto& name : names) {
+        auto it = ranges.emplace(name, std::make_pair(i, i)).first;
+        it->second.second = i;
+      }
+    }
+  }
+  int64_t peak = 0;
+  for (int i = 0; i < net.op_size(); ++i) {
+    int64_t live = 0;
+    for (size_t j = 0; j < plan.blobs.size(); ++j) {
+      const auto& range = ranges.at(plan.blobs[j]);
+      if (range.first <= i && i <= range.second) {
+        live += plan.sizes[j];
+      }
+    }
+    peak = std::max(peak, live);
+  }
+  EXPECT_GE(plan.arena_size, peak);
+  for (size_t j = 0; j < plan.blobs.size(); ++j) {
+    const auto& a = ranges.at(plan.blobs[j]);
+    for (size_t k = 0; k < j; ++k) {
+      const auto& b = ranges.at(plan.blobs[k]);
+      if (a.first <= b.second && b.first <= a.second) {
+        EXPECT_TRUE(
+            plan.offsets[j] + plan.sizes[j] <= plan.offsets[k] ||
+            plan.offsets[k] + plan.sizes[k] <= plan.offsets[j])
+            << plan.blobs[j] << " overlaps " << plan.blobs[k];
+      }
+    }
+  }
+}
+
+TEST(MemongerTest, RunWithMemoryArena) {
+  const auto net = chainNet();
+  const auto shapes = chainShapes();
+  const auto plan = memonger::plan_memory_arena(net, {}, shapes, 64);
+  const auto planned_net =
+      memonger::apply_memory_arena_plan(net, plan, shapes, "arena");
+  ASSERT_EQ(planned_net.op_size(), net.op_size() + 1);
+  EXPECT_EQ(planned_net.op(0).type(), "MemoryArenaBind");
+
+  Workspace ws;
+  auto* x = BlobGetMutableTensor(
+      ws.CreateBlob("x"), {10, 100}, at::dtype<float>());
+  for (int64_t i = 0; i < x->numel(); ++i) {
+    x->mutable_data<float>()[i] = i;
+  }
+  for (int iter = 0; iter < 2; ++iter) {
+    ASSERT_TRUE(ws.RunNetOnce(planned_net));
+    const auto& d = ws.GetBlob("d")->Get<Tensor>();
+    for (int64_t i = 0; i < d.numel(); ++i) {
+      EXPECT_EQ(d.data<float>()[i], i + 4);
+    }
+    const auto& arena = ws.GetBlob("arena")->Get<Tensor>();
+    EXPECT_EQ(arena.numel(), plan.arena_size);
+    for (const auto& blob : plan.blobs) {
+      const auto& tensor = ws.GetBlob(blob)->Get<Tensor>();
+      const auto* data = static_cast<const uint8_t*>(tensor.raw_data());
+      EXPECT_EQ(data, arena.data<uint8_t>() + offsetOf(plan, blob));
+    }
+  }
+}
+
+} // namespace caffe2
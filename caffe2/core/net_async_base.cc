@@ -56,6 +56,12 @@ C10_DEFINE_bool(
     false,
     "Run root tasks in current thread instread of scheduling to threadpool");
 
+C10_DEFINE_bool(
+    caffe2_net_async_work_stealing,
+    false,
+    "Use work stealing CPU thread pools and continue with a successor task "
+    "on the thread that finished its parent");
+
 namespace caffe2 {
 
 std::vector<int>& AsyncNetBase::getStreamCounters() {
@@ -156,8 +162,10 @@ TaskThreadPoolBase* AsyncNetBase::poolGetter(
   std::unique_lock<std::mutex> pools_lock(pools_mutex_);
   auto pool = pools[device_id][pool_size];
   if (!pool) {
+    const bool work_stealing =
+        options_.use_work_stealing_ && IsCPUDeviceType(device_type);
     pool = c10::ThreadPoolRegistry()->Create(
-        DeviceTypeName(device_type),
+        work_stealing ? "WorkStealingCPU" : DeviceTypeName(device_type),
         device_id,
         pool_size,
         options_.use_per_net_pools_);
@@ -582,6 +590,10 @@ ExecutionOptions::ExecutionOptions(
   }
 
   use_dfs_scheduling_ = false;
+  use_work_stealing_ = false;
+  if (net_type != kDag && net_type != kProfDag && net_type != kAsyncDag) {
+    use_work_stealing_ = FLAGS_caffe2_net_async_work_stealing;
+  }
 
   for (int arg_idx = 0; arg_idx < net_def->arg_size(); ++arg_idx) {
     auto& arg = net_def->arg(arg_idx);
@@ -593,6 +605,10 @@ ExecutionOptions::ExecutionOptions(
       CAFFE_ENFORCE(arg.has_i(), "deferrable_mode should be an int");
       use_dfs_scheduling_ = arg.i() == 1; // corr. to DFS scheduling
     }
+    if (arg.has_name() && arg.name() == "work_stealing") {
+      CAFFE_ENFORCE(arg.has_i(), "work_stealing should be an int");
+      use_work_stealing_ = arg.i() == 1;
+    }
   }
 
   if (FLAGS_caffe2_net_async_profile_operators) {
@@ -609,6 +625,12 @@ C10_REGISTER_CREATOR(
     ThreadPoolRegistry,
     CPU,
     caffe2::GetAsyncNetThreadPool<TaskThreadPool, caffe2::PROTO_CPU>);
+C10_REGISTER_CREATOR(
+    ThreadPoolRegistry,
+    WorkStealingCPU,
+    caffe2::GetAsyncNetThreadPool<
+        WorkStealingTaskThreadPool,
+        caffe2::PROTO_CPU>);
 C10_REGISTER_CREATOR(
     ThreadPoolRegistry,
     CUDA,
@@ -23,6 +23,7 @@ C10_DECLARE_bool(caffe2_net_async_check_stream_status);
 C10_DECLARE_bool(caffe2_net_async_use_single_pool);
 C10_DECLARE_bool(caffe2_net_async_use_per_net_pools);
 C10_DECLARE_bool(caffe2_net_async_run_root_tasks_inline);
+C10_DECLARE_bool(caffe2_net_async_work_stealing);
 C10_DECLARE_bool(caffe2_net_async_profile_operators);
 
 namespace caffe2 {
@@ -55,6 +56,9 @@ struct ExecutionOptions {
   bool use_dfs_scheduling_ = false;
   // run net's root tasks in RunAsync thread instead of in thread pool
   bool run_root_tasks_inline_ = false;
+  // use work stealing CPU pools and run one ready child of a finished task
+  // inline on the same thread, leaving the others to be stolen
+  bool use_work_stealing_ = false;
 };
 
 class CAFFE2_API AsyncNetBase : public NetBase {
@@ -681,6 +681,61 @@ TEST(NetTest, ExecutorOverride) {
   }
 }
 
+TEST(NetTest, WorkStealingScheduling) {
+  // a fork into four branches joined at the end; one branch continues on the
+  // thread of the root task, the others are left to be stolen
+  const auto spec = R"DOC(
+        name: "example"
+        type: "async_scheduling"
+        arg {
+          name: "work_stealing"
+          i: 1
+        }
+        external_input: "in"
+        op {
+          input: "in"
+          output: "root"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "root"
+          output: "out1"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "root"
+          output: "out2"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "root"
+          output: "out3"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "root"
+          output: "out4"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "out1"
+          input: "out2"
+          input: "out3"
+          input: "out4"
+          output: "out"
+          type: "NetTestDummy"
+        }
+)DOC";
+
+  Workspace ws;
+  ws.CreateBlob("in");
+  NetDef net_def;
+  CAFFE_ENFORCE(TextFormat::ParseFromString(spec, &net_def));
+  net_def.set_num_workers(kTestPoolSize);
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  testExecution(net, net_def.op().size());
+}
+
 TEST(NetTest, AsyncEmptyNet) {
   const auto spec = R"DOC(
         name: "example"
@@ -3,7 +3,17 @@
 namespace caffe2 {
 REGISTER_CPU_OPERATOR(CreateDB, CreateDBOp<CPUContext>);
 
-OPERATOR_SCHEMA(CreateDB).NumInputs(0).NumOutputs(1);
+OPERATOR_SCHEMA(CreateDB)
+    .NumInputs(0)
+    .NumOutputs(1)
+    .Arg(
+        "readahead_cursors",
+        "(int, default 0) If positive, read the db ahead in the background "
+        "with this many cursors, each in its own thread")
+    .Arg(
+        "readahead_buffer_size",
+        "(int, default 64) Number of records each readahead cursor keeps "
+        "ready");
 
 NO_GRADIENT(CreateDB);
 }  // namespace caffe2
@@ -196,5 +196,34 @@ TEST(DBReaderShardedTest, Reader) {
   EXPECT_EQ(value, "05");
 }
 
+TEST(DBReaderReadaheadTest, Reader) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("leveldb", name);
+
+  // Shard 1 of 3 holds 01, 04 and 07; reading it ahead with two cursors must
+  // give the same sequence as reading it directly, including the wrap around.
+  std::unique_ptr<DBReader> reader(new DBReader("leveldb", name, 3, 1));
+  reader->StartReadahead(2, 2);
+  const std::vector<string> expected = {"01", "04", "07", "01", "04", "07"};
+  string key;
+  string value;
+  reader->Read(&key, &value);
+  EXPECT_EQ(key, expected[0]);
+  EXPECT_EQ(value, expected[0]);
+  vector<string> keys;
+  vector<string> values;
+  reader->Read(expected.size() - 1, &keys, &values);
+  ASSERT_EQ(keys.size(), expected.size() - 1);
+  for (size_t i = 1; i < expected.size(); ++i) {
+    EXPECT_EQ(keys[i - 1], expected[i]);
+    EXPECT_EQ(values[i - 1], expected[i]);
+  }
+
+  reader->SeekToFirst();
+  reader->Read(&key, &value);
+  EXPECT_EQ(key, "01");
+  reader->StopReadahead();
+}
+
 }  // namespace db
 }  // namespace caffe2
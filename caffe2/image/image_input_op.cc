@@ -26,10 +26,18 @@ OPERATOR_SCHEMA(ImageInput)
       int batch_size = helper.GetSingleArgument<int>("batch_size", 0);
       int crop = helper.GetSingleArgument<int>("crop", -1);
       int color = helper.GetSingleArgument<int>("color", 1);
+      const string output_order =
+          helper.GetSingleArgument<string>("output_order", "NHWC");
       CHECK_GT(crop, 0);
-      out[0] = CreateTensorShape(
-          vector<int>{batch_size, crop, crop, color ? 3 : 1},
-          TensorProto::FLOAT);
+      if (output_order == "NCHW") {
+        out[0] = CreateTensorShape(
+            vector<int>{batch_size, color ? 3 : 1, crop, crop},
+            TensorProto::FLOAT);
+      } else {
+        out[0] = CreateTensorShape(
+            vector<int>{batch_size, crop, crop, color ? 3 : 1},
+            TensorProto::FLOAT);
+      }
       out[1] =
           CreateTensorShape(vector<int>{1, batch_size}, TensorProto::INT32);
       return out;
@@ -135,6 +143,18 @@ The dimension of the output image will always be cropxcrop
         "Number of CPU decode/transform threads."
         " Defaults to 4")
     .Arg("output_type", "If gpu_transform, can set to FLOAT or FLOAT16.")
+    .Arg(
+        "output_order",
+        "NHWC (default) or NCHW, layout of the output images. NCHW images are "
+        "written directly by the decode threads. Can't be set with "
+        "use_gpu_transform, which always outputs NCHW")
+    .Arg(
+        "reduced_decode",
+        "1 if JPEGs may be decoded at 1/2, 1/4 or 1/8 of their size when the "
+        "shortest side stays at least scale. Much faster for large images, but "
+        "the result differs slightly from a full decode followed by a resize. "
+        "Only applies with scale, without random_scale, scale jittering or "
+        "bounding boxes. Defaults to 0")
     .Arg("db", "Name of the database (if not passed as input)")
     .Arg(
         "db_type",
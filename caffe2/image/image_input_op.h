@@ -10,6 +10,8 @@
 #include "c10/core/thread_pool.h"
 #include "caffe2/core/common.h"
 #include "caffe2/core/db.h"
+#include "caffe2/core/stats.h"
+#include "caffe2/core/timer.h"
 #include "caffe2/image/transform_gpu.h"
 #include "caffe2/operators/prefetch_op.h"
 #include "caffe2/proto/caffe2_legacy.pb.h"
@@ -80,6 +82,11 @@ class ImageInputOp final : public PrefetchOperator<Context> {
       PerImageArg& info,
       int item_id,
       std::mt19937* randgen);
+  // Decodes an encoded image, at a reduced scale when the image is going to
+  // be downscaled to at least that size anyway.
+  cv::Mat DecodeImage(const char* data, int size, const PerImageArg& info);
+  int ReducedDecodeFactor(int height, int width, const PerImageArg& info)
+      const;
   void DecodeAndTransform(
       const std::string& value,
       float* image_data,
@@ -158,6 +165,23 @@ class ImageInputOp final : public PrefetchOperator<Context> {
   std::atomic<long> num_decode_errors_in_batch_{0};
   // opencv exceptions tolerance
   float max_decode_error_ratio_;
+
+  // Layout of the output images, NHWC or NCHW
+  StorageOrder output_order_;
+  // Whether JPEGs may be decoded at 1/2, 1/4 or 1/8 of their size
+  bool reduced_decode_;
+  // Scratch HWC buffer per decode thread, for the color jitter path when
+  // the output is NCHW
+  std::vector<std::vector<float>> transform_buffer_per_thread_;
+
+  struct ImageInputOpStats {
+    CAFFE_STAT_CTOR(ImageInputOpStats);
+    CAFFE_AVG_EXPORTED_STAT(decode_time_ns);
+    CAFFE_EXPORTED_STAT(reduced_decodes);
+    CAFFE_AVG_EXPORTED_STAT(resize_time_ns);
+    CAFFE_AVG_EXPORTED_STAT(transform_time_ns);
+    CAFFE_AVG_EXPORTED_STAT(batch_time_ns);
+  } stats_;
 };
 
 template <class Context>
@@ -218,7 +242,14 @@ ImageInputOp<Context>::ImageInputOp(
           {-1, -1})),
       max_decode_error_ratio_(OperatorBase::template GetSingleArgument<float>(
           "max_decode_error_ratio",
-          1.0)) {
+          1.0)),
+      output_order_(StringToStorageOrder(
+          OperatorBase::template GetSingleArgument<string>(
+              "output_order",
+              "NHWC"))),
+      reduced_decode_(
+          OperatorBase::template GetSingleArgument<int>("reduced_decode", 0)),
+      stats_("image_input_op/" + operator_def.output(0)) {
   if ((random_scale_[0] == -1) || (random_scale_[1] == -1)) {
     random_scaling_ = false;
   } else {
@@ -311,6 +342,13 @@ ImageInputOp<Context>::ImageInputOp(
   CAFFE_ENFORCE(
       !use_caffe_datum_ || OutputSize() == 2,
       "There can only be 2 outputs if the Caffe datum format is used");
+  CAFFE_ENFORCE(
+      output_order_ == StorageOrder::NHWC ||
+          output_order_ == StorageOrder::NCHW,
+      "output_order must be NHWC or NCHW");
+  CAFFE_ENFORCE(
+      !gpu_transform_ || output_order_ == StorageOrder::NHWC,
+      "The GPU transform always outputs NCHW, output_order can't be set");
 
   CAFFE_ENFORCE(
       random_scale_.size() == 2, "Must provide [scale_min, scale_max]");
@@ -369,6 +407,9 @@ ImageInputOp<Context>::ImageInputOp(
   LOG(INFO) << "    " << (is_test_ ? "Central" : "Random")
             << " cropping image to " << crop_
             << (mirror_ ? " with " : " without ") << "random mirroring;";
+  if (reduced_decode_) {
+    LOG(INFO) << "    Decoding JPEGs at reduced scale when possible;";
+  }
   LOG(INFO) << "Label Type: " << label_type_;
   LOG(INFO) << "Num Labels: " << num_labels_;
 
@@ -390,13 +431,24 @@ ImageInputOp<Context>::ImageInputOp(
   for (int i = 0; i < num_decode_threads_; ++i) {
     randgen_per_thread_.emplace_back(meta_randgen());
   }
-  ReinitializeTensor(
-      &prefetched_image_,
-      {int64_t(batch_size_),
-       int64_t(crop_),
-       int64_t(crop_),
-       int64_t(color_ ? 3 : 1)},
-      at::dtype<uint8_t>().device(CPU));
+  transform_buffer_per_thread_.resize(num_decode_threads_);
+  if (output_order_ == StorageOrder::NCHW) {
+    ReinitializeTensor(
+        &prefetched_image_,
+        {int64_t(batch_size_),
+         int64_t(color_ ? 3 : 1),
+         int64_t(crop_),
+         int64_t(crop_)},
+        at::dtype<uint8_t>().device(CPU));
+  } else {
+    ReinitializeTensor(
+        &prefetched_image_,
+        {int64_t(batch_size_),
+         int64_t(crop_),
+         int64_t(crop_),
+         int64_t(color_ ? 3 : 1)},
+        at::dtype<uint8_t>().device(CPU));
+  }
   std::vector<int64_t> sizes;
   if (label_type_ != SINGLE_LABEL && label_type_ != SINGLE_LABEL_WEIGHTED) {
     sizes = std::vector<int64_t>{int64_t(batch_size_), int64_t(num_labels_)};
@@ -469,23 +521,7 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
     prefetched_label_.mutable_data<int>()[item_id] = datum.label();
     if (datum.encoded()) {
       // encoded image in datum.
-      // count the number of exceptions from opencv imdecode
-      try {
-        src = cv::imdecode(
-            cv::Mat(
-                1,
-                datum.data().size(),
-                CV_8UC1,
-                const_cast<char*>(datum.data().data())),
-            color_ ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
-        if (src.rows == 0 || src.cols == 0) {
-          num_decode_errors_in_batch_++;
-          src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-        }
-      } catch (cv::Exception& e) {
-        num_decode_errors_in_batch_++;
-        src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-      }
+      src = DecodeImage(datum.data().data(), datum.data().size(), info);
     } else {
       // Raw image in datum.
       CAFFE_ENFORCE(datum.channels() == 3 || datum.channels() == 1);
@@ -542,25 +578,8 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
       // encoded image string.
       DCHECK_EQ(image_proto.string_data_size(), 1);
       const string& encoded_image_str = image_proto.string_data(0);
-      int encoded_size = encoded_image_str.size();
-      // We use a cv::Mat to wrap the encoded str so we do not need a copy.
-      // count the number of exceptions from opencv imdecode
-      try {
-        src = cv::imdecode(
-            cv::Mat(
-                1,
-                &encoded_size,
-                CV_8UC1,
-                const_cast<char*>(encoded_image_str.data())),
-            color_ ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
-        if (src.rows == 0 || src.cols == 0) {
-          num_decode_errors_in_batch_++;
-          src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-        }
-      } catch (cv::Exception& e) {
-        num_decode_errors_in_batch_++;
-        src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
-      }
+      src = DecodeImage(
+          encoded_image_str.data(), encoded_image_str.size(), info);
     } else if (image_proto.data_type() == TensorProto::BYTE) {
       // raw image content.
       int src_c = (image_proto.dims_size() == 3) ? image_proto.dims(2) : 1;
@@ -732,6 +751,7 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
     // LOG(INFO) << "No bounding\n";
   }
 
+  Timer resize_timer;
   cv::Mat scaled_img;
   bool inception_scale_jitter = false;
   if (scale_jitter_type_ == INCEPTION_STYLE) {
@@ -783,11 +803,139 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
       *img = scaled_img;
     }
   }
+  CAFFE_EVENT(stats_, resize_time_ns, resize_timer.NanoSeconds());
 
   // TODO(Yangqing): return false if any error happens.
   return true;
 }
 
+namespace {
+
+// Reads the size of a JPEG image from its SOF segment, without decoding it.
+inline bool GetJpegSize(
+    const uint8_t* data,
+    size_t size,
+    int* height,
+    int* width) {
+  if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+    return false;
+  }
+  size_t pos = 2;
+  while (pos + 4 <= size) {
+    if (data[pos] != 0xFF) {
+      return false;
+    }
+    const uint8_t marker = data[pos + 1];
+    if (marker == 0xFF) {
+      // fill byte
+      ++pos;
+      continue;
+    }
+    pos += 2;
+    if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+      // markers without a payload
+      continue;
+    }
+    if (marker == 0xD9 || marker == 0xDA) {
+      // end of image or start of scan before any frame header
+      return false;
+    }
+    const size_t length = (data[pos] << 8) | data[pos + 1];
+    if (length < 2) {
+      return false;
+    }
+    // SOF0 to SOF15, except DHT, JPG and DAC which share the range
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 &&
+        marker != 0xC8 && marker != 0xCC) {
+      if (pos + 7 > size) {
+        return false;
+      }
+      *height = (data[pos + 3] << 8) | data[pos + 4];
+      *width = (data[pos + 5] << 8) | data[pos + 6];
+      return *height > 0 && *width > 0;
+    }
+    pos += length;
+  }
+  return false;
+}
+
+} // namespace
+
+template <class Context>
+int ImageInputOp<Context>::ReducedDecodeFactor(
+    int height,
+    int width,
+    const PerImageArg& info) const {
+  // Only when every image gets resized to scale_: with minsize_ large images
+  // are kept as is, inception style jittering crops from the full image and
+  // bounding boxes are given in full resolution pixels.
+  if (!reduced_decode_ || scale_ <= 0 || random_scaling_ ||
+      scale_jitter_type_ != NO_SCALE_JITTER || info.bounding_params.valid) {
+    return 1;
+  }
+  // libjpeg scales with a ceil division. Both the warped and the aspect
+  // preserving resizes need the shortest side to stay at least scale_.
+  for (int factor : {8, 4, 2}) {
+    const int reduced_height = (height + factor - 1) / factor;
+    const int reduced_width = (width + factor - 1) / factor;
+    if (std::min(reduced_height, reduced_width) >= scale_) {
+      return factor;
+    }
+  }
+  return 1;
+}
+
+template <class Context>
+cv::Mat ImageInputOp<Context>::DecodeImage(
+    const char* data,
+    int size,
+    const PerImageArg& info) {
+  Timer decode_timer;
+  int flags = color_ ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE;
+#if CV_VERSION_MAJOR > 3 || (CV_VERSION_MAJOR == 3 && CV_VERSION_MINOR >= 2)
+  int height, width;
+  if (reduced_decode_ &&
+      GetJpegSize(
+          reinterpret_cast<const uint8_t*>(data), size, &height, &width)) {
+    switch (ReducedDecodeFactor(height, width, info)) {
+      case 8:
+        flags = color_ ? cv::IMREAD_REDUCED_COLOR_8
+                       : cv::IMREAD_REDUCED_GRAYSCALE_8;
+        break;
+      case 4:
+        flags = color_ ? cv::IMREAD_REDUCED_COLOR_4
+                       : cv::IMREAD_REDUCED_GRAYSCALE_4;
+        break;
+      case 2:
+        flags = color_ ? cv::IMREAD_REDUCED_COLOR_2
+                       : cv::IMREAD_REDUCED_GRAYSCALE_2;
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+  cv::Mat src;
+  // We use a cv::Mat to wrap the encoded str so we do not need a copy.
+  // count the number of exceptions from opencv imdecode
+  try {
+    src = cv::imdecode(
+        cv::Mat(1, &size, CV_8UC1, const_cast<char*>(data)), flags);
+    if (src.rows == 0 || src.cols == 0) {
+      num_decode_errors_in_batch_++;
+      src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
+    }
+  } catch (cv::Exception& e) {
+    num_decode_errors_in_batch_++;
+    src = cv::Mat::zeros(cv::Size(224, 224), CV_8UC3);
+  }
+  if (flags != cv::IMREAD_COLOR && flags != cv::IMREAD_GRAYSCALE) {
+    CAFFE_EVENT(stats_, reduced_decodes);
+  }
+  CAFFE_EVENT(stats_, decode_time_ns, decode_timer.NanoSeconds());
+  return src;
+}
+
 // assume HWC order and color channels BGR
 template <class Context>
 void Saturation(
@@ -891,11 +1039,9 @@ void ColorJitter(
   }
 }
 
-// assume HWC order and color channels BGR
+// Draws the per channel RGB offset of PCA lighting noise
 template <class Context>
-void ColorLighting(
-    float* img,
-    const int img_size,
+std::vector<float> ColorLightingDelta(
     const float alpha_std,
     const std::vector<std::vector<float>>& eigvecs,
     const std::vector<float>& eigvals,
@@ -912,6 +1058,20 @@ void ColorLighting(
       delta_rgb[i] += eigvecs[i][j] * eigvals[j] * alphas[j];
     }
   }
+  return delta_rgb;
+}
+
+// assume HWC order and color channels BGR
+template <class Context>
+void ColorLighting(
+    float* img,
+    const int img_size,
+    const float alpha_std,
+    const std::vector<std::vector<float>>& eigvecs,
+    const std::vector<float>& eigvals,
+    std::mt19937* randgen) {
+  const std::vector<float> delta_rgb =
+      ColorLightingDelta<Context>(alpha_std, eigvecs, eigvals, randgen);
 
   int p = 0;
   for (int h = 0; h < img_size; ++h) {
@@ -943,6 +1103,110 @@ void ColorNormalization(
   }
 }
 
+// Copies the crop region of an uint8 HWC image into a float HWC buffer
+inline void CropImage(
+    const cv::Mat& scaled_img,
+    const int channels,
+    const int height_offset,
+    const int width_offset,
+    const int crop,
+    const bool mirror_image,
+    float* image_data_ptr) {
+  if (mirror_image) {
+    // Copy mirrored image.
+    for (int h = height_offset; h < height_offset + crop; ++h) {
+      for (int w = width_offset + crop - 1; w >= width_offset; --w) {
+        const uint8_t* cv_data = scaled_img.ptr(h) + w * channels;
+        for (int c = 0; c < channels; ++c) {
+          *(image_data_ptr++) = static_cast<float>(cv_data[c]);
+        }
+      }
+    }
+  } else {
+    // Copy normally.
+    for (int h = height_offset; h < height_offset + crop; ++h) {
+      for (int w = width_offset; w < width_offset + crop; ++w) {
+        const uint8_t* cv_data = scaled_img.ptr(h) + w * channels;
+        for (int c = 0; c < channels; ++c) {
+          *(image_data_ptr++) = static_cast<float>(cv_data[c]);
+        }
+      }
+    }
+  }
+}
+
+// Crops, mirrors, subtracts the mean and scales in a single pass over the
+// uint8 image, writing the result in the given storage order.
+// buffer holds the per row mean and scale patterns of the HWC inner loop.
+inline void CropNormalizeImage(
+    const cv::Mat& scaled_img,
+    const int channels,
+    const int height_offset,
+    const int width_offset,
+    const int crop,
+    const bool mirror_image,
+    const std::vector<float>& mean,
+    const std::vector<float>& std,
+    const StorageOrder order,
+    std::vector<float>* buffer,
+    float* image_data) {
+  if (order == StorageOrder::NCHW) {
+    const int plane_size = crop * crop;
+    for (int h = 0; h < crop; ++h) {
+      const uint8_t* cv_row =
+          scaled_img.ptr(height_offset + h) + width_offset * channels;
+      for (int c = 0; c < channels; ++c) {
+        float* out = image_data + c * plane_size + h * crop;
+        const float m = mean[c];
+        const float s = std[c];
+        if (mirror_image) {
+          const uint8_t* cv_data = cv_row + (crop - 1) * channels + c;
+          for (int w = 0; w < crop; ++w) {
+            out[w] = (static_cast<float>(cv_data[-w * channels]) - m) * s;
+          }
+        } else {
+          const uint8_t* cv_data = cv_row + c;
+          for (int w = 0; w < crop; ++w) {
+            out[w] = (static_cast<float>(cv_data[w * channels]) - m) * s;
+          }
+        }
+      }
+    }
+    return;
+  }
+
+  const int row_size = crop * channels;
+  if (mirror_image) {
+    float* out = image_data;
+    for (int h = height_offset; h < height_offset + crop; ++h) {
+      for (int w = width_offset + crop - 1; w >= width_offset; --w) {
+        const uint8_t* cv_data = scaled_img.ptr(h) + w * channels;
+        for (int c = 0; c < channels; ++c) {
+          *(out++) = (static_cast<float>(cv_data[c]) - mean[c]) * std[c];
+        }
+      }
+    }
+    return;
+  }
+  // A cropped row is contiguous in the source image: repeat mean and scale
+  // along the row so the inner loop is a plain vectorizable loop.
+  buffer->resize(2 * row_size);
+  float* row_mean = buffer->data();
+  float* row_std = row_mean + row_size;
+  for (int i = 0; i < row_size; ++i) {
+    row_mean[i] = mean[i % channels];
+    row_std[i] = std[i % channels];
+  }
+  for (int h = 0; h < crop; ++h) {
+    const uint8_t* cv_data =
+        scaled_img.ptr(height_offset + h) + width_offset * channels;
+    float* out = image_data + h * row_size;
+    for (int i = 0; i < row_size; ++i) {
+      out[i] = (static_cast<float>(cv_data[i]) - row_mean[i]) * row_std[i];
+    }
+  }
+}
+
 // Factored out image transformation
 template <class Context>
 void TransformImage(
@@ -963,6 +1227,8 @@ void TransformImage(
     const std::vector<float>& std,
     std::mt19937* randgen,
     std::bernoulli_distribution* mirror_this_image,
+    const StorageOrder order,
+    std::vector<float>* buffer,
     bool is_test = false) {
   CAFFE_ENFORCE_GE(
       scaled_img.rows, crop, "Image height must be bigger than crop.");
@@ -980,47 +1246,89 @@ void TransformImage(
     height_offset =
         std::uniform_int_distribution<>(0, scaled_img.rows - crop)(*randgen);
   }
+  const bool mirror_image =
+      !is_test && mirror && (*mirror_this_image)(*randgen);
 
-  float* image_data_ptr = image_data;
-  if (!is_test && mirror && (*mirror_this_image)(*randgen)) {
-    // Copy mirrored image.
-    for (int h = height_offset; h < height_offset + crop; ++h) {
-      for (int w = width_offset + crop - 1; w >= width_offset; --w) {
-        const uint8_t* cv_data = scaled_img.ptr(h) + w * channels;
-        for (int c = 0; c < channels; ++c) {
-          *(image_data_ptr++) = static_cast<float>(cv_data[c]);
-        }
-      }
+  if (color_jitter && channels == 3 && !is_test) {
+    // Color jittering depends on statistics of the whole cropped image, so it
+    // runs as separate passes over a float HWC copy.
+    float* hwc_data = image_data;
+    if (order == StorageOrder::NCHW) {
+      buffer->resize(crop * crop * channels);
+      hwc_data = buffer->data();
     }
-  } else {
-    // Copy normally.
-    for (int h = height_offset; h < height_offset + crop; ++h) {
-      for (int w = width_offset; w < width_offset + crop; ++w) {
-        const uint8_t* cv_data = scaled_img.ptr(h) + w * channels;
+    CropImage(
+        scaled_img,
+        channels,
+        height_offset,
+        width_offset,
+        crop,
+        mirror_image,
+        hwc_data);
+    ColorJitter<Context>(
+        hwc_data, crop, saturation, brightness, contrast, randgen);
+    if (color_lighting) {
+      ColorLighting<Context>(
+          hwc_data,
+          crop,
+          color_lighting_std,
+          color_lighting_eigvecs,
+          color_lighting_eigvals,
+          randgen);
+    }
+
+    // Color normalization
+    // Mean subtraction and scaling.
+    ColorNormalization<Context>(hwc_data, crop, channels, mean, std);
+    if (order == StorageOrder::NCHW) {
+      const int plane_size = crop * crop;
+      for (int p = 0; p < plane_size; ++p) {
         for (int c = 0; c < channels; ++c) {
-          *(image_data_ptr++) = static_cast<float>(cv_data[c]);
+          image_data[c * plane_size + p] = hwc_data[p * channels + c];
         }
       }
     }
+    return;
   }
 
-  if (color_jitter && channels == 3 && !is_test) {
-    ColorJitter<Context>(
-        image_data, crop, saturation, brightness, contrast, randgen);
-  }
+  // Otherwise color lighting is a constant offset per channel, which folds
+  // into the mean subtracted in the single normalization pass.
   if (color_lighting && channels == 3 && !is_test) {
-    ColorLighting<Context>(
-        image_data,
-        crop,
+    const std::vector<float> delta_rgb = ColorLightingDelta<Context>(
         color_lighting_std,
         color_lighting_eigvecs,
         color_lighting_eigvals,
         randgen);
+    std::vector<float> lighting_mean(mean);
+    for (int c = 0; c < 3; ++c) {
+      lighting_mean[c] -= delta_rgb[2 - c];
+    }
+    CropNormalizeImage(
+        scaled_img,
+        channels,
+        height_offset,
+        width_offset,
+        crop,
+        mirror_image,
+        lighting_mean,
+        std,
+        order,
+        buffer,
+        image_data);
+  } else {
+    CropNormalizeImage(
+        scaled_img,
+        channels,
+        height_offset,
+        width_offset,
+        crop,
+        mirror_image,
+        mean,
+        std,
+        order,
+        buffer,
+        image_data);
   }
-
-  // Color normalization
-  // Mean subtraction and scaling.
-  ColorNormalization<Context>(image_data, crop, channels, mean, std);
 }
 
 // Only crop / transose the image
@@ -1095,6 +1403,7 @@ void ImageInputOp<Context>::DecodeAndTransform(
   CHECK(
       GetImageAndLabelAndInfoFromDBValue(value, &img, info, item_id, randgen));
   // Factor out the image transformation
+  Timer transform_timer;
   TransformImage<Context>(
       img,
       channels,
@@ -1113,7 +1422,10 @@ void ImageInputOp<Context>::DecodeAndTransform(
       std_,
       randgen,
       &mirror_this_image,
+      output_order_,
+      &transform_buffer_per_thread_[thread_index],
       is_test_);
+  CAFFE_EVENT(stats_, transform_time_ns, transform_timer.NanoSeconds());
 }
 
 template <class Context>
@@ -1154,6 +1466,7 @@ bool ImageInputOp<Context>::Prefetch() {
     // pointer.
     reader_ = &OperatorBase::Input<db::DBReader>(0);
   }
+  Timer batch_timer;
   const int channels = color_ ? 3 : 1;
   // Call mutable_data() once to allocate the underlying memory.
   if (gpu_transform_) {
@@ -1273,6 +1586,7 @@ bool ImageInputOp<Context>::Prefetch() {
   }
 
   num_decode_errors_in_batch_ = 0;
+  CAFFE_EVENT(stats_, batch_time_ns, batch_timer.NanoSeconds());
 
   return true;
 }
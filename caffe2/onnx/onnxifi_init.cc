@@ -1,5 +1,6 @@
 #include "caffe2/onnx/onnxifi_init.h"
 
+#include <atomic>
 #include <mutex>
 
 #include "caffe2/core/logging.h"
@@ -7,7 +8,14 @@
 namespace caffe2 {
 namespace onnx {
 
+namespace {
+std::atomic<onnxifi_library*> override_lib{nullptr};
+} // namespace
+
 onnxifi_library* initOnnxifiLibrary() {
+  if (auto* lib = override_lib.load()) {
+    return lib;
+  }
   static std::once_flag once;
   static onnxifi_library core{};
   std::call_once(once, []() {
@@ -18,5 +26,9 @@ onnxifi_library* initOnnxifiLibrary() {
   });
   return &core;
 }
+
+void overrideOnnxifiLibrary(onnxifi_library* lib) {
+  override_lib = lib;
+}
 } // namespace onnx
 } // namespace caffe2
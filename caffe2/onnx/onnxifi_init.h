@@ -6,5 +6,10 @@ namespace caffe2 {
 namespace onnx {
 
 onnxifi_library* initOnnxifiLibrary();
+
+// Makes initOnnxifiLibrary() return lib instead of the loaded ONNXIFI
+// library, until it is called again with nullptr. For testing against a fake
+// backend.
+void overrideOnnxifiLibrary(onnxifi_library* lib);
 } // namespace onnx
 } // namespace caffe2
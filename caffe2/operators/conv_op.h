@@ -23,6 +23,18 @@ class ConvOp final : public ConvPoolOpBase<Context> {
          std::is_same<Context, CPUContext>::value),
         "Group convolution only supports NCHW order or CPUContext right now.");
 
+    // Same argument as the NNPACK engine, set by the opt::fuseConvRelu pass.
+    const std::string activation =
+        this->template GetSingleArgument<std::string>("activation", "identity");
+    CAFFE_ENFORCE(
+        activation == "identity" || activation == "Relu",
+        "Unsupported activation: ",
+        activation);
+    fuse_relu_ = activation == "Relu";
+    CAFFE_ENFORCE(
+        (!fuse_relu_ || std::is_same<Context, CPUContext>::value),
+        "Fused Relu is only supported on CPUContext.");
+
     // Create shared buffer mutex in the constructor
     // to avoid race-condition in DAGNet.
     if (FLAGS_caffe2_force_shared_col_buffer || shared_buffer_) {
@@ -55,6 +67,11 @@ class ConvOp final : public ConvPoolOpBase<Context> {
       const T* bias,
       T* Y);
 
+  // Applies the fused activation in place, right after the output has been
+  // computed so that it is still in cache.
+  void RunActivation(const int size, T* Y);
+
+  bool fuse_relu_;
   Tensor col_buffer_{Context::GetDeviceType()};
   Tensor bias_multiplier_{Context::GetDeviceType()};
   Tensor img_shape_device_{Context::GetDeviceType()};
@@ -175,6 +175,7 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNCHW() {
             Y_data,
             &context_);
       }
+      RunActivation(Y_stride, Y_data);
       X_data += X_stride;
       Y_data += Y_stride;
     }
@@ -348,6 +349,7 @@ bool ConvOp<T, Context>::RunOnDeviceWithOrderNHWC() {
             Y_data,
             &context_);
       }
+      RunActivation(output_offset, Y_data);
       X_data += input_offset;
       Y_data += output_offset;
     }
@@ -439,6 +441,7 @@ bool ConvOp<T, Context>::Run1x1ConvOnDeviceWithOrderNCHW(
         M * HxW,
         &context_);
   }
+  RunActivation(N * M * HxW, Y);
   return true;
 }
 
@@ -486,9 +489,18 @@ bool ConvOp<T, Context>::Run1x1ConvOnDeviceWithOrderNHWC(
         Y,
         &context_);
   }
+  RunActivation(N * HxW * M, Y);
   return true;
 }
 
+template <typename T, class Context>
+void ConvOp<T, Context>::RunActivation(const int size, T* Y) {
+  if (fuse_relu_) {
+    EigenVectorArrayMap<T>(Y, size) =
+        ConstEigenVectorArrayMap<T>(Y, size).cwiseMax(T(0));
+  }
+}
+
 template <typename T, class Context>
 bool ConvGradientOp<T, Context>::RunOnDeviceWithOrderNCHW() {
   auto& X = Input(INPUT);
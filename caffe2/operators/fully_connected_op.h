@@ -27,7 +27,19 @@ class FullyConnectedOp final : public Operator<Context> {
         axis_(this->template GetSingleArgument<int32_t>("axis", 1)),
         axis_w_(this->template GetSingleArgument<int32_t>("axis_w", 1)),
         float16_compute_(
-            this->template GetSingleArgument<bool>("float16_compute", false)) {}
+            this->template GetSingleArgument<bool>("float16_compute", false)) {
+    // Set by the opt::fuseFCRelu pass.
+    const std::string activation =
+        this->template GetSingleArgument<std::string>("activation", "identity");
+    CAFFE_ENFORCE(
+        activation == "identity" || activation == "Relu",
+        "Unsupported activation: ",
+        activation);
+    fuse_relu_ = activation == "Relu";
+    CAFFE_ENFORCE(
+        (!fuse_relu_ || std::is_same<Context, CPUContext>::value),
+        "Fused Relu is only supported on CPUContext.");
+  }
   ~FullyConnectedOp() {}
 
   template <
@@ -140,6 +152,20 @@ class FullyConnectedOp final : public Operator<Context> {
     }
 #endif
     // Add bias term
+    if (fuse_relu_) {
+      // Bias and activation in a single pass over Y.
+      const T_B* b_data = b.template data<T_B>();
+      T_Y* Y_data = Y->template mutable_data<T_Y>();
+      for (int64_t i = 0; i < M; ++i) {
+        T_Y* Y_row = Y_data + i * N;
+        for (int j = 0; j < N; ++j) {
+          const float y =
+              static_cast<float>(Y_row[j]) + static_cast<float>(b_data[j]);
+          Y_row[j] = static_cast<T_Y>(std::max(y, 0.0f));
+        }
+      }
+      return true;
+    }
     if (!bias_multiplier_.has_value()) {
       bias_multiplier_ =
           caffe2::empty({M}, at::dtype<T_B>().device(Context::GetDeviceType()));
@@ -201,6 +227,7 @@ class FullyConnectedOp final : public Operator<Context> {
   c10::optional<Tensor> bias_multiplier_;
 
   bool float16_compute_;
+  bool fuse_relu_;
 };
 
 template <
@@ -0,0 +1,397 @@
+#include "caffe2/operators/fused_elementwise_op.h"
+
+#include <algorithm>
+
+#include "caffe2/operators/elementwise_ops_utils.h"
+#include "caffe2/utils/eigen_utils.h"
+#include "caffe2/utils/math.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Number of elements evaluated through the whole chain at a time. Small
+// enough for a block of the running value and of every extra input to stay
+// in L1.
+constexpr int kBlockSize = 2048;
+
+} // namespace
+
+FusedElementwiseOp::FusedElementwiseOp(
+    const OperatorDef& operator_def,
+    Workspace* ws)
+    : Operator<CPUContext>(operator_def, ws) {
+  const auto ops = this->template GetRepeatedArgument<std::string>("ops");
+  const auto swap = this->template GetRepeatedArgument<int>("swap");
+  CAFFE_ENFORCE(!ops.empty(), "FusedElementwise needs at least one op.");
+  CAFFE_ENFORCE(
+      swap.empty() || swap.size() == ops.size(),
+      "swap must have one entry per op.");
+  int next_input = 1;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    Step step;
+    CAFFE_ENFORCE(
+        ParseStepType(ops[i], &step.type), "Unsupported op: ", ops[i]);
+    step.binary = step.type == StepType::ADD || step.type == StepType::SUB ||
+        step.type == StepType::MUL || step.type == StepType::DIV;
+    step.input = step.binary ? next_input++ : -1;
+    step.swap = step.binary && !swap.empty() && swap[i] != 0;
+    steps_.push_back(step);
+  }
+  CAFFE_ENFORCE_EQ(
+      next_input,
+      InputSize(),
+      "FusedElementwise needs one extra input per binary op.");
+}
+
+bool FusedElementwiseOp::ParseStepType(
+    const std::string& name,
+    StepType* type) {
+  static const std::vector<std::pair<std::string, StepType>> kTypes = {
+      {"Relu", StepType::RELU},
+      {"Sigmoid", StepType::SIGMOID},
+      {"Tanh", StepType::TANH},
+      {"Exp", StepType::EXP},
+      {"Abs", StepType::ABS},
+      {"Neg", StepType::NEG},
+      {"Add", StepType::ADD},
+      {"Sub", StepType::SUB},
+      {"Mul", StepType::MUL},
+      {"Div", StepType::DIV},
+  };
+  for (const auto& entry : kTypes) {
+    if (entry.first == name) {
+      *type = entry.second;
+      return true;
+    }
+  }
+  return false;
+}
+
+// The unary steps use the same kernels as the standalone operators so that
+// fusing doesn't change the results.
+void FusedElementwiseOp::RunUnaryStep(
+    const Step& step,
+    const int n,
+    const float* X,
+    float* Y) {
+  switch (step.type) {
+    case StepType::RELU:
+      EigenVectorMap<float>(Y, n) =
+          ConstEigenVectorMap<float>(X, n).cwiseMax(0.f);
+      break;
+    case StepType::SIGMOID:
+      EigenVectorArrayMap<float>(Y, n) =
+          1.f / (1.f + (-ConstEigenVectorArrayMap<float>(X, n)).exp());
+      break;
+    case StepType::TANH:
+      math::Tanh<float, CPUContext>(n, X, Y, &context_);
+      break;
+    case StepType::EXP:
+      math::Exp<float, CPUContext>(n, X, Y, &context_);
+      break;
+    case StepType::ABS:
+      math::Abs<float, CPUContext>(n, X, Y, &context_);
+      break;
+    case StepType::NEG:
+      math::Neg<float, CPUContext>(n, X, Y, &context_);
+      break;
+    default:
+      CAFFE_THROW("Not a unary step.");
+  }
+}
+
+void FusedElementwiseOp::RunBinaryStep(
+    const Step& step,
+    const int n,
+    const float* X,
+    const float* B,
+    const bool scalar,
+    float* Y) {
+  if (!scalar) {
+    const float* A = step.swap ? B : X;
+    const float* C = step.swap ? X : B;
+    switch (step.type) {
+      case StepType::ADD:
+        math::Add<float, CPUContext>(n, A, C, Y, &context_);
+        break;
+      case StepType::SUB:
+        math::Sub<float, CPUContext>(n, A, C, Y, &context_);
+        break;
+      case StepType::MUL:
+        math::Mul<float, CPUContext>(n, A, C, Y, &context_);
+        break;
+      case StepType::DIV:
+        math::Div<float, CPUContext>(n, A, C, Y, &context_);
+        break;
+      default:
+        CAFFE_THROW("Not a binary step.");
+    }
+    return;
+  }
+  const float b = *B;
+  ConstEigenVectorArrayMap<float> X_arr(X, n);
+  EigenVectorArrayMap<float> Y_arr(Y, n);
+  switch (step.type) {
+    case StepType::ADD:
+      Y_arr = X_arr + b;
+      break;
+    case StepType::SUB:
+      if (step.swap) {
+        Y_arr = b - X_arr;
+      } else {
+        Y_arr = X_arr - b;
+      }
+      break;
+    case StepType::MUL:
+      Y_arr = X_arr * b;
+      break;
+    case StepType::DIV:
+      if (step.swap) {
+        Y_arr = b / X_arr;
+      } else {
+        Y_arr = X_arr / b;
+      }
+      break;
+    default:
+      CAFFE_THROW("Not a binary step.");
+  }
+}
+
+bool FusedElementwiseOp::RunOnDevice() {
+  for (int i = 0; i < InputSize(); ++i) {
+    if (!Input(i).template IsType<float>()) {
+      return RunUnfused();
+    }
+  }
+  // The chain can be evaluated in place when no extra input changes the shape
+  // of the running value, and Y doesn't overwrite an extra input that later
+  // blocks still have to read.
+  const auto& X = Input(0);
+  for (const auto& step : steps_) {
+    if (!step.binary) {
+      continue;
+    }
+    const auto& B = Input(step.input);
+    const bool scalar = B.numel() == 1 && B.dim() <= X.dim();
+    if (!scalar && B.sizes() != X.sizes()) {
+      return RunWithBroadcast();
+    }
+    if (!scalar && Inputs()[step.input] == Outputs()[0]) {
+      return RunWithBroadcast();
+    }
+  }
+  return RunBlocked();
+}
+
+bool FusedElementwiseOp::RunBlocked() {
+  // Y may share its blob with one of the scalar inputs, which is reallocated
+  // by Output(), so copy them first.
+  const int num_inputs = InputSize();
+  const auto& X = Input(0);
+  std::vector<bool> is_scalar(num_inputs, false);
+  scalars_.resize(num_inputs);
+  for (const auto& step : steps_) {
+    if (step.binary) {
+      const auto& B = Input(step.input);
+      is_scalar[step.input] = B.sizes() != X.sizes();
+      if (is_scalar[step.input]) {
+        scalars_[step.input] = B.template data<float>()[0];
+      }
+    }
+  }
+
+  const int N = X.numel();
+  auto* Y = Output(0, X.sizes(), at::dtype<float>());
+  float* Y_data = Y->template mutable_data<float>();
+  std::vector<const float*> inputs(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    inputs[i] =
+        is_scalar[i] ? &scalars_[i] : Input(i).template data<float>();
+  }
+
+  for (int begin = 0; begin < N; begin += kBlockSize) {
+    const int n = std::min(kBlockSize, N - begin);
+    const float* src = inputs[0] + begin;
+    float* dst = Y_data + begin;
+    for (const auto& step : steps_) {
+      if (step.binary) {
+        const bool scalar = is_scalar[step.input];
+        const float* B = scalar ? inputs[step.input]
+                                : inputs[step.input] + begin;
+        RunBinaryStep(step, n, src, B, scalar, dst);
+      } else {
+        RunUnaryStep(step, n, src, dst);
+      }
+      src = dst;
+    }
+  }
+  return true;
+}
+
+bool FusedElementwiseOp::RunWithBroadcast() {
+  const auto& X = Input(0);
+  std::vector<int> dims(X.sizes().cbegin(), X.sizes().cend());
+  const float* src = X.template data<float>();
+  Tensor* buffers[2] = {&buffer0_, &buffer1_};
+  int current = 0;
+  for (const auto& step : steps_) {
+    Tensor* out = buffers[current];
+    current ^= 1;
+    if (!step.binary) {
+      out->Resize(dims);
+      float* dst = out->template mutable_data<float>();
+      RunUnaryStep(step, out->numel(), src, dst);
+      src = dst;
+      continue;
+    }
+    const auto& B = Input(step.input);
+    const std::vector<int> B_dims(B.sizes().cbegin(), B.sizes().cend());
+    const std::vector<int>& first_dims = step.swap ? B_dims : dims;
+    const std::vector<int>& second_dims = step.swap ? dims : B_dims;
+    const float* first = step.swap ? B.template data<float>() : src;
+    const float* second = step.swap ? src : B.template data<float>();
+    const std::vector<int> out_dims =
+        elementwise_ops_utils::ComputeBinaryBroadcastForwardDims(
+            first_dims, second_dims);
+    out->Resize(out_dims);
+    float* dst = out->template mutable_data<float>();
+    const int first_ndim = first_dims.size();
+    const int second_ndim = second_dims.size();
+    switch (step.type) {
+      case StepType::ADD:
+        math::Add<float, CPUContext>(
+            first_ndim,
+            first_dims.data(),
+            second_ndim,
+            second_dims.data(),
+            first,
+            second,
+            dst,
+            &context_);
+        break;
+      case StepType::SUB:
+        math::Sub<float, CPUContext>(
+            first_ndim,
+            first_dims.data(),
+            second_ndim,
+            second_dims.data(),
+            first,
+            second,
+            dst,
+            &context_);
+        break;
+      case StepType::MUL:
+        math::Mul<float, CPUContext>(
+            first_ndim,
+            first_dims.data(),
+            second_ndim,
+            second_dims.data(),
+            first,
+            second,
+            dst,
+            &context_);
+        break;
+      case StepType::DIV:
+        math::Div<float, CPUContext>(
+            first_ndim,
+            first_dims.data(),
+            second_ndim,
+            second_dims.data(),
+            first,
+            second,
+            dst,
+            &context_);
+        break;
+      default:
+        CAFFE_THROW("Not a binary step.");
+    }
+    dims = out_dims;
+    src = dst;
+  }
+
+  // All the inputs have been consumed, Y can now be resized even if it shares
+  // its blob with one of them.
+  const Tensor* result = buffers[current ^ 1];
+  auto* Y = Output(0, result->sizes(), at::dtype<float>());
+  context_.CopySameDevice<float>(
+      result->numel(), src, Y->template mutable_data<float>());
+  return true;
+}
+
+// The fusion pass doesn't know the types of the blobs, so chains of integer
+// or double ops are fused as well and run here.
+bool FusedElementwiseOp::RunUnfused() {
+  if (unfused_ops_.empty()) {
+    for (int i = 0; i < InputSize(); ++i) {
+      unfused_inputs_.push_back(
+          unfused_ws_.CreateBlob("input_" + caffe2::to_string(i)));
+    }
+    const auto ops = this->template GetRepeatedArgument<std::string>("ops");
+    std::string running = "input_0";
+    for (size_t i = 0; i < steps_.size(); ++i) {
+      const auto& step = steps_[i];
+      OperatorDef def;
+      def.set_type(ops[i]);
+      if (step.binary) {
+        const auto extra = "input_" + caffe2::to_string(step.input);
+        def.add_input(step.swap ? extra : running);
+        def.add_input(step.swap ? running : extra);
+      } else {
+        def.add_input(running);
+      }
+      running = i + 1 < steps_.size() ? "step_" + caffe2::to_string(i)
+                                      : std::string("output");
+      def.add_output(running);
+      unfused_ops_.push_back(CreateOperator(def, &unfused_ws_));
+    }
+  }
+
+  for (int i = 0; i < InputSize(); ++i) {
+    unfused_inputs_[i]->ShareExternal(
+        const_cast<void*>(OperatorBase::Inputs()[i]->GetRaw()),
+        OperatorBase::Inputs()[i]->meta());
+  }
+  for (auto& op : unfused_ops_) {
+    if (!op->Run()) {
+      return false;
+    }
+  }
+  // All the inputs have been consumed, Y can now take the result even if it
+  // shares its blob with one of them.
+  using std::swap;
+  swap(*OperatorBase::Outputs()[0], *unfused_ws_.GetBlob("output"));
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(FusedElementwise, FusedElementwiseOp);
+
+OPERATOR_SCHEMA(FusedElementwise)
+    .NumInputs(1, INT_MAX)
+    .NumOutputs(1)
+    .AllowInplace([](int /* in */, int /* out */) { return true; })
+    .SetDoc(R"DOC(
+Runs a chain of elementwise operators as a single operator, without writing
+the intermediate results to memory. Produced by the FuseElementwiseChains
+optimization pass, and equivalent to running the chain one operator at a time.
+
+The chain starts from input 0. Every op in `ops` is applied to the running
+value in order: unary ops (Relu, Sigmoid, Tanh, Exp, Abs, Neg) transform it,
+binary ops (Add, Sub, Mul, Div) combine it with the next extra input, with
+numpy style broadcasting. Chains with non-float inputs run one op at a time.
+)DOC")
+    .Arg(
+        "ops",
+        "(list of strings) Elementwise ops of the chain, in order.")
+    .Arg(
+        "swap",
+        "(list of ints, optional) One entry per op. For binary ops, 1 if the "
+        "extra input is the first operand, as in Sub(B, X), and 0 if it is the "
+        "second one.")
+    .Input(0, "X", "Input of the first op of the chain.")
+    .Input(1, "B_1, B_2, ...", "Extra inputs of the binary ops, in order.")
+    .Output(0, "Y", "Output of the last op of the chain.");
+
+NO_GRADIENT(FusedElementwise);
+
+} // namespace caffe2
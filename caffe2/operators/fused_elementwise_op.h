@@ -0,0 +1,88 @@
+#ifndef CAFFE2_OPERATORS_FUSED_ELEMENTWISE_OP_H_
+#define CAFFE2_OPERATORS_FUSED_ELEMENTWISE_OP_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+
+namespace caffe2 {
+
+// Runs a chain of elementwise operators as a single operator, so that the
+// intermediate results are never written back to memory. Built by the
+// opt::fuseElementwiseChains pass.
+//
+// The chain starts from input 0. Unary steps transform the running value,
+// binary steps combine it with the next extra input, with the numpy style
+// broadcasting of the standalone operators. When none of the extra inputs
+// changes the shape of the running value the chain is evaluated block by
+// block, with every block staying in cache across all the steps. Chains with
+// non-float inputs run their steps one at a time with the standalone
+// operators.
+class FusedElementwiseOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+
+  FusedElementwiseOp(const OperatorDef& operator_def, Workspace* ws);
+
+  bool RunOnDevice() override;
+
+ private:
+  enum class StepType {
+    RELU,
+    SIGMOID,
+    TANH,
+    EXP,
+    ABS,
+    NEG,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+  };
+
+  struct Step {
+    StepType type;
+    bool binary;
+    // Binary steps only: index of the extra input, and whether it is the
+    // first operand (as in Sub(B, X)) rather than the second one.
+    int input;
+    bool swap;
+  };
+
+  static bool ParseStepType(const std::string& name, StepType* type);
+
+  // Applies a unary step to n elements, X and Y may alias.
+  void RunUnaryStep(const Step& step, const int n, const float* X, float* Y);
+
+  // Applies a binary step to n elements of the running value X and either n
+  // elements of B or a single scalar B, Y may alias X.
+  void RunBinaryStep(
+      const Step& step,
+      const int n,
+      const float* X,
+      const float* B,
+      const bool scalar,
+      float* Y);
+
+  bool RunBlocked();
+  bool RunWithBroadcast();
+  bool RunUnfused();
+
+  std::vector<Step> steps_;
+  std::vector<float> scalars_;
+  // Intermediate results of RunWithBroadcast.
+  Tensor buffer0_{CPU};
+  Tensor buffer1_{CPU};
+  // Standalone operators of RunUnfused, created on its first run, and the
+  // workspace holding their inputs and intermediate results.
+  Workspace unfused_ws_;
+  std::vector<Blob*> unfused_inputs_;
+  std::vector<std::unique_ptr<OperatorBase>> unfused_ops_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_FUSED_ELEMENTWISE_OP_H_
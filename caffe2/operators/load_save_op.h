@@ -125,10 +125,17 @@ class LoadOp final : public Operator<Context> {
   bool RunOnDevice() override {
     int total_loaded_blobs = 0;
     std::unordered_map<string, load_save_op_util::BlobState> blob_states;
+    load_save_op_util::RawPayloadLoader payload_loader(
+        FLAGS_caffe2_max_tensor_serializer_threads);
     if (InputSize() > 0) {
       for (int i = 0; i < InputSize(); ++i) {
         const db::DBReader& reader = this->template Input<db::DBReader>(i);
-        extract(i, reader.cursor(), &blob_states, &total_loaded_blobs);
+        extract(
+            i,
+            reader.cursor(),
+            &blob_states,
+            &payload_loader,
+            &total_loaded_blobs);
       }
     } else {
       for (int i = 0; i < db_names_.size(); ++i) {
@@ -145,10 +152,16 @@ class LoadOp final : public Operator<Context> {
             full_db_name,
             ")");
         std::unique_ptr<Cursor> cursor(in_db->NewCursor());
-        extract(i, cursor.get(), &blob_states, &total_loaded_blobs);
+        extract(
+            i,
+            cursor.get(),
+            &blob_states,
+            &payload_loader,
+            &total_loaded_blobs);
       }
     }
 
+    payload_loader.Wait();
     load_save_op_util::validateBlobStates(blob_states);
     // Loaded all the needed blobs.
     if (!load_all_ && total_loaded_blobs == OutputSize()) {
@@ -193,23 +206,67 @@ class LoadOp final : public Operator<Context> {
       int db_id,
       Cursor* cursor,
       std::unordered_map<string, load_save_op_util::BlobState>* blob_states,
+      load_save_op_util::RawPayloadLoader* payload_loader,
       int* total_loaded_blobs) {
     if (load_all_) {
-      extractAll(db_id, cursor, blob_states, total_loaded_blobs);
+      extractAll(
+          db_id, cursor, blob_states, payload_loader, total_loaded_blobs);
     } else {
       extractFrom(
           db_id,
           cursor,
           OperatorBase::Outputs(),
           blob_states,
+          payload_loader,
           total_loaded_blobs);
     }
   }
 
+  // Deserializes one DB value into blob. Raw payloads of CPU tensors are
+  // copied straight from the value into the tensor, in the background.
+  void loadValue(
+      Blob* blob,
+      const string& key,
+      std::string&& value,
+      std::unordered_map<string, load_save_op_util::BlobState>* blob_states,
+      load_save_op_util::RawPayloadLoader* payload_loader,
+      int* loaded_blobs) {
+    BlobProto proto;
+    size_t payload_offset = 0;
+    size_t payload_size = 0;
+    CAFFE_ENFORCE(
+        ParseBlobProtoWithRawPayload(
+            value, &proto, &payload_offset, &payload_size),
+        "Couldn't parse Proto");
+    if (!keep_device_) {
+      // If we are not keeping the device as the one specified in the
+      // proto, we will set the current device.
+      SetCurrentDevice(&proto);
+    }
+    if (payload_size == 0) {
+      load_save_op_util::ProcessBlob(
+          blob, proto, blob_states, key, loaded_blobs);
+      return;
+    }
+    auto* tensor_proto = proto.mutable_tensor();
+    if (tensor_proto->device_detail().device_type() != PROTO_CPU) {
+      tensor_proto->set_raw_data(value.data() + payload_offset, payload_size);
+      load_save_op_util::ProcessBlob(
+          blob, proto, blob_states, key, loaded_blobs);
+      return;
+    }
+    // Allocates the tensor without filling it.
+    const auto& tensor = load_save_op_util::ProcessTensorHeader(
+        blob, proto, blob_states, key, loaded_blobs);
+    payload_loader->Load(
+        *tensor_proto, tensor, std::move(value), payload_offset, payload_size);
+  }
+
   void extractAll(
       int db_id,
       Cursor* cursor,
       std::unordered_map<string, load_save_op_util::BlobState>* blob_states,
+      load_save_op_util::RawPayloadLoader* payload_loader,
       int* total_loaded_blobs) {
     CAFFE_ENFORCE(cursor, "cursor is not valid");
     int loaded_blobs = 0;
@@ -222,17 +279,14 @@ class LoadOp final : public Operator<Context> {
         key_to_dbid_[key] = db_id;
       }
 
-      BlobProto proto;
-      CAFFE_ENFORCE(
-          proto.ParseFromString(cursor->value()), "Couldn't parse Proto");
-      if (!keep_device_) {
-        // If we are not keeping the device as the one specified in the
-        // proto, we will set the current device.
-        SetCurrentDevice(&proto);
-      }
       Blob* blob = ws_->CreateBlob(key);
-      load_save_op_util::ProcessBlob(
-          blob, proto, blob_states, key, &loaded_blobs);
+      loadValue(
+          blob,
+          key,
+          cursor->value(),
+          blob_states,
+          payload_loader,
+          &loaded_blobs);
     }
     *total_loaded_blobs += loaded_blobs;
   }
@@ -242,6 +296,7 @@ class LoadOp final : public Operator<Context> {
       Cursor* cursor,
       const vector<Blob*>& outputs,
       std::unordered_map<string, load_save_op_util::BlobState>* blob_states,
+      load_save_op_util::RawPayloadLoader* payload_loader,
       int* total_loaded_blobs) {
     CAFFE_ENFORCE(cursor);
     int loaded_blobs = 0;
@@ -258,17 +313,15 @@ class LoadOp final : public Operator<Context> {
         }
 
         VLOG(2) << "Deserializing blob " << key;
-        BlobProto proto;
-        CAFFE_ENFORCE(proto.ParseFromString(cursor->value()));
-        if (!keep_device_) {
-          // If we are not keeping the device as the one specified in the
-          // proto, we will set the current device.
-          SetCurrentDevice(&proto);
-        }
         auto blobIndex = output_indices_[key];
         Blob* blob = outputs.at(blobIndex);
-        load_save_op_util::ProcessBlob(
-            blob, proto, blob_states, key, &loaded_blobs);
+        loadValue(
+            blob,
+            key,
+            cursor->value(),
+            blob_states,
+            payload_loader,
+            &loaded_blobs);
 
         if (*total_loaded_blobs + loaded_blobs == OutputSize()) {
           break;
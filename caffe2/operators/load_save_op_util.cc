@@ -18,13 +18,12 @@ std::string buildBlobNameFromDbKey(
   return key;
 }
 
-void ProcessBlob(
+namespace {
+
+void ResetIfFirstChunk(
     Blob* blob,
-    const BlobProto& proto,
-    std::unordered_map<std::string, BlobState>* blob_states_ptr,
-    const std::string& key,
-    int* loaded_blobs) {
-  auto& blob_states = *blob_states_ptr;
+    const std::unordered_map<std::string, BlobState>& blob_states,
+    const std::string& key) {
   if (blob_states.count(key) == 0) {
     // We reset the blob so that any existing content is destroyed. This
     // is to guaranee correct device placement: if we are deserializing
@@ -33,7 +32,15 @@ void ProcessBlob(
     // different GPU.
     blob->Reset();
   }
-  DeserializeBlob(proto, blob);
+}
+
+// Records that the chunk in proto has been loaded.
+void UpdateBlobState(
+    const BlobProto& proto,
+    std::unordered_map<std::string, BlobState>* blob_states_ptr,
+    const std::string& key,
+    int* loaded_blobs) {
+  auto& blob_states = *blob_states_ptr;
   if (proto.has_content_num_chunks()) {
     if (!blob_states.count(key)) {
       blob_states[key] = BlobState(proto.content_num_chunks());
@@ -109,6 +116,110 @@ void ProcessBlob(
   }
 }
 
+} // namespace
+
+void ProcessBlob(
+    Blob* blob,
+    const BlobProto& proto,
+    std::unordered_map<std::string, BlobState>* blob_states,
+    const std::string& key,
+    int* loaded_blobs) {
+  ResetIfFirstChunk(blob, *blob_states, key);
+  DeserializeBlob(proto, blob);
+  UpdateBlobState(proto, blob_states, key, loaded_blobs);
+}
+
+const Tensor& ProcessTensorHeader(
+    Blob* blob,
+    const BlobProto& proto,
+    std::unordered_map<std::string, BlobState>* blob_states,
+    const std::string& key,
+    int* loaded_blobs) {
+  CAFFE_ENFORCE(proto.has_tensor(), "Not a tensor: ", key);
+  CAFFE_ENFORCE_EQ(proto.tensor().device_detail().device_type(), PROTO_CPU);
+  ResetIfFirstChunk(blob, *blob_states, key);
+  const auto& tensor = *DeserializeTensorHeader(proto.tensor(), blob);
+  UpdateBlobState(proto, blob_states, key, loaded_blobs);
+  return tensor;
+}
+
+RawPayloadLoader::RawPayloadLoader(int num_threads)
+    : num_threads_(num_threads) {}
+
+RawPayloadLoader::~RawPayloadLoader() {
+  try {
+    Wait();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Loading a tensor payload failed: " << e.what();
+  }
+}
+
+void RawPayloadLoader::Load(
+    const TensorProto& proto,
+    const Tensor& tensor,
+    std::string&& content,
+    size_t payload_offset,
+    size_t payload_size) {
+  CAFFE_ENFORCE(!done_, "Cannot load more payloads after Wait()");
+  CAFFE_ENFORCE_EQ(tensor.GetDeviceType(), CPU);
+  int64_t chunkBegin = 0;
+  int64_t chunkEnd = tensor.numel();
+  if (proto.has_segment()) {
+    chunkBegin = proto.segment().begin();
+    chunkEnd = proto.segment().end();
+  }
+  CAFFE_ENFORCE(
+      0 <= chunkBegin && chunkBegin <= chunkEnd && chunkEnd <= tensor.numel(),
+      "Invalid chunk ",
+      chunkBegin,
+      ' ',
+      chunkEnd,
+      " with total tensor size ",
+      tensor.numel());
+  CAFFE_ENFORCE_EQ(
+      (chunkEnd - chunkBegin) * tensor.itemsize(),
+      payload_size,
+      "Incorrect payload size.");
+  CAFFE_ENFORCE_LE(payload_offset + payload_size, content.size());
+
+  auto holder = std::make_shared<const std::string>(std::move(content));
+  Task task{holder,
+            std::make_shared<Tensor>(tensor.UnsafeSharedInstance()),
+            holder->data() + payload_offset,
+            static_cast<char*>(tensor.raw_mutable_data()) +
+                chunkBegin * tensor.itemsize(),
+            payload_size};
+#ifndef __ANDROID__
+  if (num_threads_ > 0) {
+    if (workers_.empty()) {
+      for (int i = 0; i < num_threads_; ++i) {
+        workers_.emplace_back(std::async(std::launch::async, [this]() {
+          Task t;
+          while (queue_.Pop(&t)) {
+            memcpy(t.dst, t.src, t.size);
+            t = Task();
+          }
+        }));
+      }
+    }
+    queue_.Push(task);
+    return;
+  }
+#endif
+  memcpy(task.dst, task.src, task.size);
+}
+
+void RawPayloadLoader::Wait() {
+  if (done_) {
+    return;
+  }
+  done_ = true;
+  queue_.NoMoreJobs();
+  for (auto& worker : workers_) {
+    worker.get();
+  }
+}
+
 void validateBlobStates(
     const std::unordered_map<std::string, BlobState>& blob_states) {
   for (const auto& iter : blob_states) {
@@ -1,12 +1,16 @@
 #ifndef CAFFE2_OPERATORS_LOAD_SAVE_OP_UTIL_H_
 #define CAFFE2_OPERATORS_LOAD_SAVE_OP_UTIL_H_
 
+#include <future>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "caffe2/core/blob.h"
 #include "caffe2/core/blob_serialization.h"
+#include "caffe2/utils/simple_queue.h"
 
 namespace caffe2 {
 namespace load_save_op_util {
@@ -40,6 +44,53 @@ CAFFE2_API void ProcessBlob(
     const std::string& key,
     int* loaded_blobs);
 
+// Like ProcessBlob, for a chunk of a CPU tensor whose data is loaded
+// separately by a RawPayloadLoader: only gives the tensor the shape and type
+// in proto.
+CAFFE2_API const Tensor& ProcessTensorHeader(
+    Blob* blob,
+    const BlobProto& proto,
+    std::unordered_map<std::string, BlobState>* blob_states,
+    const std::string& key,
+    int* loaded_blobs);
+
+// Copies raw tensor payloads, split off by ParseBlobProtoWithRawPayload, into
+// CPU tensors on background threads. The copies of different chunks run in
+// parallel with each other and with reading the next chunks from the DB.
+class CAFFE2_API RawPayloadLoader {
+ public:
+  explicit RawPayloadLoader(int num_threads);
+  ~RawPayloadLoader();
+
+  // Copies payload_size bytes at payload_offset of content into the segment
+  // of tensor described by proto. tensor must already have the shape and type
+  // of proto.
+  void Load(
+      const TensorProto& proto,
+      const Tensor& tensor,
+      std::string&& content,
+      size_t payload_offset,
+      size_t payload_size);
+
+  // Waits for all copies and rethrows the first error.
+  void Wait();
+
+ private:
+  struct Task {
+    // Keeps both the payload and the destination storage alive.
+    std::shared_ptr<const std::string> content;
+    std::shared_ptr<Tensor> tensor;
+    const char* src;
+    char* dst;
+    size_t size;
+  };
+
+  const int num_threads_;
+  SimpleQueue<Task> queue_;
+  std::vector<std::future<void>> workers_;
+  bool done_ = false;
+};
+
 CAFFE2_API void validateBlobStates(
     const std::unordered_map<std::string, BlobState>& blob_states);
 
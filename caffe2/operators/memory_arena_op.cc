@@ -0,0 +1,23 @@
+#include "caffe2/operators/memory_arena_op.h"
+
+namespace caffe2 {
+REGISTER_CPU_OPERATOR(MemoryArenaBind, MemoryArenaBindOp<CPUContext>);
+NO_GRADIENT(MemoryArenaBind);
+
+OPERATOR_SCHEMA(MemoryArenaBind)
+    .NumInputs(0)
+    .NumOutputs(1, INT_MAX)
+    .Arg("arena_size", "Size of the arena in bytes.")
+    .Arg("offsets", "Byte offset of each planned blob in the arena.")
+    .Arg("sizes", "Bytes reserved for each planned blob.")
+    .Arg("dims", "Concatenated dims of the planned blobs.")
+    .Arg("ranks", "Number of dims of each planned blob.")
+    .Arg("dtypes", "TensorProto data type of each planned blob.")
+    .SetDoc(R"DOC(
+Allocates a memory arena and binds the other outputs to slices of it, as
+planned by memonger.plan_memory_arena. Blobs whose lifetimes don't overlap
+share memory; an op writing a bound blob with the planned shape and type
+writes into the arena.)DOC")
+    .Output(0, "arena", "uint8 tensor holding the arena.")
+    .Output(1, "blobs", "Tensors bound to the arena, one per planned blob.");
+} // namespace caffe2
@@ -0,0 +1,67 @@
+#ifndef CAFFE2_OPERATORS_MEMORY_ARENA_OP_H_
+#define CAFFE2_OPERATORS_MEMORY_ARENA_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/types.h"
+
+namespace caffe2 {
+
+// MemoryArenaBindOp allocates one buffer into its first output and makes
+// every other output a tensor of the planned shape and type whose data lives
+// at the planned offset of that buffer. Ops that later write these blobs with
+// the same shape and type reuse the arena memory instead of allocating. The
+// plan comes from memonger::plan_memory_arena.
+template <class Context>
+class MemoryArenaBindOp final : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  template <class... Args>
+  explicit MemoryArenaBindOp(Args&&... args)
+      : Operator<Context>(std::forward<Args>(args)...),
+        arena_size_(this->template GetSingleArgument<int64_t>("arena_size", 0)),
+        offsets_(this->template GetRepeatedArgument<int64_t>("offsets")),
+        sizes_(this->template GetRepeatedArgument<int64_t>("sizes")) {
+    const auto num_blobs = OutputSize() - 1;
+    const auto dims = this->template GetRepeatedArgument<int64_t>("dims");
+    const auto ranks = this->template GetRepeatedArgument<int64_t>("ranks");
+    const auto dtypes = this->template GetRepeatedArgument<int>("dtypes");
+    CAFFE_ENFORCE_EQ(offsets_.size(), num_blobs);
+    CAFFE_ENFORCE_EQ(sizes_.size(), num_blobs);
+    CAFFE_ENFORCE_EQ(ranks.size(), num_blobs);
+    CAFFE_ENFORCE_EQ(dtypes.size(), num_blobs);
+
+    size_t dim_index = 0;
+    for (int i = 0; i < num_blobs; ++i) {
+      CAFFE_ENFORCE_LE(dim_index + ranks[i], dims.size());
+      dims_.emplace_back(
+          dims.begin() + dim_index, dims.begin() + dim_index + ranks[i]);
+      dim_index += ranks[i];
+      metas_.push_back(DataTypeToTypeMeta(
+          static_cast<TensorProto::DataType>(dtypes[i])));
+      CAFFE_ENFORCE_LE(offsets_[i] + sizes_[i], arena_size_);
+    }
+  }
+
+  bool RunOnDevice() override {
+    auto* arena = Output(0, {arena_size_}, at::dtype<uint8_t>());
+    auto* base = arena->template mutable_data<uint8_t>();
+    for (int i = 0; i < OutputSize() - 1; ++i) {
+      auto* output = Output(i + 1);
+      output->Resize(dims_[i]);
+      output->ShareExternalPointer(base + offsets_[i], metas_[i], sizes_[i]);
+    }
+    return true;
+  }
+
+ private:
+  const int64_t arena_size_;
+  const std::vector<int64_t> offsets_;
+  const std::vector<int64_t> sizes_;
+  std::vector<std::vector<int64_t>> dims_;
+  std::vector<TypeMeta> metas_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_MEMORY_ARENA_OP_H_
@@ -3,6 +3,10 @@
 #include "caffe2/opt/converter.h"
 #include "caffe2/opt/passes.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace caffe2 {
 namespace opt {
 
@@ -121,5 +125,292 @@ void fuseConvBN(nom::repr::NNModule* nn, caffe2::Workspace* ws) {
 
 REGISTER_WS_OPT_PASS_FROM_FUNC(FuseConvBN, fuseConvBN);
 
+namespace {
+
+const caffe2::OperatorDef* getOperatorDef(const repr::NeuralNetOperator& nnOp) {
+  const auto annotation = nnOp.getAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return nullptr;
+  }
+  return &dyn_cast<Caffe2Annotation>(annotation)->getOperatorDef();
+}
+
+// The fused kernels only exist for the default CPU implementations. Ops
+// without a device option of their own run on the device of the net.
+bool isDefaultCPUOp(
+    const caffe2::OperatorDef& op,
+    const caffe2::DeviceOption& netDeviceOption) {
+  const auto& deviceOption =
+      op.has_device_option() ? op.device_option() : netDeviceOption;
+  return op.engine().empty() &&
+      deviceOption.device_type() == caffe2::PROTO_CPU;
+}
+
+template <typename OperationT>
+bool canFuseRelu(
+    const OperationT& nnOp,
+    const caffe2::DeviceOption& netDeviceOption) {
+  const auto* op = getOperatorDef(nnOp);
+  if (!op || !isDefaultCPUOp(*op, netDeviceOption)) {
+    return false;
+  }
+  for (const auto& arg : op->arg()) {
+    if (arg.name() == "activation") {
+      return false;
+    }
+  }
+  return true;
+}
+
+void setReluActivation(repr::NNGraph::NodeRef node) {
+  auto nnOp = repr::nn::get<repr::NeuralNetOperator>(node);
+  auto annotation = nnOp->getMutableAnnotation();
+  if (!annotation || !isa<Caffe2Annotation>(annotation)) {
+    return;
+  }
+  auto* op = dyn_cast<Caffe2Annotation>(annotation)->getMutableOperatorDef();
+  auto* arg = op->add_arg();
+  arg->set_name("activation");
+  arg->set_s("Relu");
+}
+
+} // namespace
+
+void fuseConvRelu(
+    repr::NNModule* nn,
+    const caffe2::DeviceOption& netDeviceOption) {
+  fuseActivation<repr::Conv, repr::Relu>(
+      nn,
+      [&](const repr::Conv& conv) {
+        return canFuseRelu(conv, netDeviceOption);
+      },
+      setReluActivation);
+}
+
+void fuseConvRelu(repr::NNModule* nn) {
+  fuseConvRelu(nn, caffe2::DeviceOption());
+}
+
+void fuseFCRelu(
+    repr::NNModule* nn,
+    const caffe2::DeviceOption& netDeviceOption) {
+  fuseActivation<repr::FC, repr::Relu>(
+      nn,
+      [&](const repr::FC& fc) { return canFuseRelu(fc, netDeviceOption); },
+      setReluActivation);
+}
+
+void fuseFCRelu(repr::NNModule* nn) {
+  fuseFCRelu(nn, caffe2::DeviceOption());
+}
+
+REGISTER_OPT_PASS_FROM_FUNC(FuseConvRelu, fuseConvRelu);
+REGISTER_OPT_PASS_FROM_FUNC(FuseFCRelu, fuseFCRelu);
+
+namespace {
+
+// Ops supported by FusedElementwiseOp.
+const std::unordered_set<std::string>& unaryElementwiseOps() {
+  static const std::unordered_set<std::string> ops = {
+      "Relu", "Sigmoid", "Tanh", "Exp", "Abs", "Neg"};
+  return ops;
+}
+
+const std::unordered_set<std::string>& binaryElementwiseOps() {
+  static const std::unordered_set<std::string> ops = {
+      "Add", "Sub", "Mul", "Div"};
+  return ops;
+}
+
+// Returns the Caffe2 operator of node if it can be part of a fused
+// elementwise chain.
+const caffe2::OperatorDef* getFusableElementwiseOp(
+    repr::NNGraph::NodeRef node,
+    const caffe2::DeviceOption& netDeviceOption) {
+  NOM_REQUIRE_OR_RET_NULL(repr::nn::is<repr::NeuralNetOperator>(node));
+  const auto* op =
+      getOperatorDef(*repr::nn::get<repr::NeuralNetOperator>(node));
+  NOM_REQUIRE_OR_RET_NULL(op && isDefaultCPUOp(*op, netDeviceOption));
+  const bool binary = binaryElementwiseOps().count(op->type());
+  NOM_REQUIRE_OR_RET_NULL(binary || unaryElementwiseOps().count(op->type()));
+  NOM_REQUIRE_OR_RET_NULL(
+      repr::nn::getInputs(node).size() == (binary ? 2 : 1));
+  NOM_REQUIRE_OR_RET_NULL(repr::nn::getOutputs(node).size() == 1);
+  for (const auto& arg : op->arg()) {
+    // The legacy broadcast semantic is not supported by FusedElementwise.
+    NOM_REQUIRE_OR_RET_NULL(!(arg.name() == "broadcast" && arg.i() != 0));
+  }
+  return op;
+}
+
+// Whether the output of producer can be kept in registers and passed to
+// consumer within a fused chain.
+bool canChain(
+    repr::NNModule* nn,
+    repr::NNGraph::NodeRef producer,
+    repr::NNGraph::NodeRef consumer,
+    const caffe2::DeviceOption& netDeviceOption) {
+  auto output = repr::nn::getOutputs(producer).front();
+  NOM_REQUIRE_OR_RET_FALSE(!nn->outputs.count(output));
+  auto consumers = repr::nn::getConsumers(output);
+  NOM_REQUIRE_OR_RET_FALSE(
+      consumers.size() == 1 && consumers.front() == consumer);
+  auto inputs = repr::nn::getInputs(consumer);
+  NOM_REQUIRE_OR_RET_FALSE(
+      std::count(inputs.begin(), inputs.end(), output) == 1);
+  return getFusableElementwiseOp(consumer, netDeviceOption) != nullptr;
+}
+
+} // namespace
+
+void fuseElementwiseChains(
+    repr::NNModule* nn,
+    const caffe2::DeviceOption& netDeviceOption) {
+  // Position of every operator in the program: the fused operator runs at the
+  // position of the last operator of its chain.
+  std::vector<std::vector<repr::NNGraph::NodeRef>> instructions;
+  std::unordered_map<repr::NNGraph::NodeRef, std::pair<size_t, size_t>>
+      positions;
+  for (const auto& bbNode : nn->controlFlow.getMutableNodes()) {
+    instructions.emplace_back(bbNode->data().getInstructions());
+    for (size_t i = 0; i < instructions.back().size(); ++i) {
+      positions[instructions.back()[i]] =
+          std::make_pair(instructions.size() - 1, i);
+    }
+  }
+
+  std::vector<std::vector<repr::NNGraph::NodeRef>> chains;
+  std::unordered_set<repr::NNGraph::NodeRef> claimed;
+  for (auto node : nn->dataFlow.getMutableNodes()) {
+    NOM_REQUIRE_OR_CONT(
+        getFusableElementwiseOp(node, netDeviceOption) != nullptr);
+    // Chains are grown from their first operator.
+    bool isHead = true;
+    for (auto input : repr::nn::getInputs(node)) {
+      if (repr::nn::hasProducer(input)) {
+        auto producer = repr::nn::getProducer(input);
+        if (getFusableElementwiseOp(producer, netDeviceOption) &&
+            canChain(nn, producer, node, netDeviceOption)) {
+          isHead = false;
+        }
+      }
+    }
+    NOM_REQUIRE_OR_CONT(isHead);
+
+    std::vector<repr::NNGraph::NodeRef> chain = {node};
+    while (true) {
+      auto consumers =
+          repr::nn::getConsumers(repr::nn::getOutputs(chain.back()).front());
+      NOM_REQUIRE_OR_BREAK(consumers.size() == 1);
+      auto next = consumers.front();
+      NOM_REQUIRE_OR_BREAK(!claimed.count(next));
+      NOM_REQUIRE_OR_BREAK(canChain(nn, chain.back(), next, netDeviceOption));
+      chain.push_back(next);
+    }
+    NOM_REQUIRE_OR_CONT(chain.size() > 1);
+    claimed.insert(chain.begin(), chain.end());
+    chains.emplace_back(std::move(chain));
+  }
+
+  // Plan all the rewrites before mutating the graph, so that the positions
+  // stay valid.
+  struct FusedChain {
+    std::vector<repr::NNGraph::NodeRef> nodes;
+    // Operands of the fused operator: the input of the first operator, then
+    // the extra input of each binary operator.
+    std::vector<repr::NNGraph::NodeRef> inputs;
+    caffe2::OperatorDef op;
+  };
+  std::vector<FusedChain> fusedChains;
+  for (auto& chain : chains) {
+    FusedChain fused;
+    fused.op.set_type("FusedElementwise");
+    auto* opsArg = fused.op.add_arg();
+    opsArg->set_name("ops");
+    auto* swapArg = fused.op.add_arg();
+    swapArg->set_name("swap");
+    repr::NNGraph::NodeRef running = nullptr;
+    for (auto node : chain) {
+      auto nodeInputs = repr::nn::getInputs(node);
+      opsArg->add_strings(
+          getFusableElementwiseOp(node, netDeviceOption)->type());
+      if (!running) {
+        running = nodeInputs[0];
+        fused.inputs.push_back(running);
+      }
+      int swap = 0;
+      if (nodeInputs.size() == 2) {
+        swap = nodeInputs[1] == running;
+        fused.inputs.push_back(nodeInputs[swap ? 0 : 1]);
+      }
+      swapArg->add_ints(swap);
+      running = repr::nn::getOutputs(node).front();
+    }
+    const auto* lastOp =
+        getFusableElementwiseOp(chain.back(), netDeviceOption);
+    fused.op.set_name(lastOp->name());
+    if (lastOp->has_device_option()) {
+      fused.op.mutable_device_option()->CopyFrom(lastOp->device_option());
+    }
+
+    // The inputs are read at the position of the last operator, so they must
+    // not be overwritten in between.
+    NOM_REQUIRE_OR_CONT(
+        positions.count(chain.front()) && positions.count(chain.back()));
+    const auto first = positions[chain.front()];
+    const auto last = positions[chain.back()];
+    NOM_REQUIRE_OR_CONT(first.first == last.first);
+    std::unordered_set<std::string> inputNames;
+    for (auto input : fused.inputs) {
+      inputNames.insert(repr::nn::get<repr::NeuralNetData>(input)->getName());
+    }
+    const std::unordered_set<repr::NNGraph::NodeRef> chainNodes(
+        chain.begin(), chain.end());
+    bool overwritten = false;
+    for (size_t i = first.second + 1; i < last.second; ++i) {
+      auto instr = instructions[first.first][i];
+      if (chainNodes.count(instr)) {
+        continue;
+      }
+      for (auto output : repr::nn::getOutputs(instr)) {
+        if (inputNames.count(
+                repr::nn::get<repr::NeuralNetData>(output)->getName())) {
+          overwritten = true;
+        }
+      }
+    }
+    NOM_REQUIRE_OR_CONT(!overwritten);
+
+    fused.nodes = std::move(chain);
+    fusedChains.emplace_back(std::move(fused));
+  }
+
+  // Turn the last operator of each chain into the fused one and drop the
+  // others along with the intermediate results.
+  for (const auto& fused : fusedChains) {
+    auto lastNode = fused.nodes.back();
+    const std::vector<repr::NNGraph::EdgeRef> inEdges(
+        lastNode->getInEdges().begin(), lastNode->getInEdges().end());
+    for (auto edge : inEdges) {
+      nn->dataFlow.deleteEdge(edge);
+    }
+    lastNode->resetData(convertToNeuralNetOperator(fused.op));
+    for (auto input : fused.inputs) {
+      nn->dataFlow.createEdge(input, lastNode);
+    }
+    for (size_t i = 0; i + 1 < fused.nodes.size(); ++i) {
+      auto intermediate = repr::nn::getOutputs(fused.nodes[i]).front();
+      nn->dataFlow.deleteNode(fused.nodes[i]);
+      nn->dataFlow.deleteNode(intermediate);
+    }
+  }
+}
+
+void fuseElementwiseChains(repr::NNModule* nn) {
+  fuseElementwiseChains(nn, caffe2::DeviceOption());
+}
+
+REGISTER_OPT_PASS_FROM_FUNC(FuseElementwiseChains, fuseElementwiseChains);
+
 } // namespace opt
 } // namespace caffe2
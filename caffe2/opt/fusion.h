@@ -27,6 +27,26 @@ using namespace nom;
 
 CAFFE2_API void fuseConvBN(repr::NNModule* nn, caffe2::Workspace* ws);
 
+// Fuse a Relu into the preceding CPU Conv or FC by setting their activation
+// argument. Ops without a device option of their own are taken to run on the
+// device of netDeviceOption (CPU if not given).
+CAFFE2_API void fuseConvRelu(
+    repr::NNModule* nn,
+    const caffe2::DeviceOption& netDeviceOption);
+CAFFE2_API void fuseConvRelu(repr::NNModule* nn);
+CAFFE2_API void fuseFCRelu(
+    repr::NNModule* nn,
+    const caffe2::DeviceOption& netDeviceOption);
+CAFFE2_API void fuseFCRelu(repr::NNModule* nn);
+
+// Replace chains of CPU elementwise operators (Relu, Sigmoid, Tanh, Exp, Abs,
+// Neg, Add, Sub, Mul, Div) whose intermediate results are not used anywhere
+// else with a single FusedElementwise operator.
+CAFFE2_API void fuseElementwiseChains(
+    repr::NNModule* nn,
+    const caffe2::DeviceOption& netDeviceOption);
+CAFFE2_API void fuseElementwiseChains(repr::NNModule* nn);
+
 // Generic activation fusion helper.
 //
 // \tparam OperationT The operator to be fused.
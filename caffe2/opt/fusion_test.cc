@@ -0,0 +1,259 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/opt/converter.h"
+#include "caffe2/opt/fusion.h"
+#include "caffe2/opt/optimizer.h"
+#include "caffe2/utils/math.h"
+#include "caffe2/utils/proto_utils.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+caffe2::OperatorDef* addOp(
+    caffe2::NetDef* net,
+    const std::string& type,
+    const std::vector<std::string>& inputs,
+    const std::vector<std::string>& outputs) {
+  caffe2::OperatorDef* def = net->add_op();
+  def->set_type(type);
+  for (const auto& input : inputs) {
+    def->add_input(input);
+  }
+  for (const auto& output : outputs) {
+    def->add_output(output);
+  }
+  return def;
+}
+
+void fillTensor(
+    caffe2::Workspace* ws,
+    const std::string& name,
+    const std::vector<int64_t>& shape,
+    float low = -1.0f,
+    float high = 1.0f) {
+  caffe2::CPUContext context;
+  auto* tensor =
+      caffe2::BlobGetMutableTensor(ws->CreateBlob(name), caffe2::CPU);
+  tensor->Resize(shape);
+  caffe2::math::RandUniform<float, caffe2::CPUContext>(
+      tensor->numel(), low, high, tensor->mutable_data<float>(), &context);
+}
+
+// Runs net and returns a copy of its output blob.
+caffe2::Tensor runNet(
+    caffe2::Workspace* ws,
+    const caffe2::NetDef& net,
+    const std::string& output) {
+  EXPECT_TRUE(ws->RunNetOnce(net));
+  return ws->GetBlob(output)->Get<caffe2::Tensor>().Clone();
+}
+
+void expectTensorNear(const caffe2::Tensor& a, const caffe2::Tensor& b) {
+  ASSERT_EQ(a.sizes(), b.sizes());
+  const float* a_data = a.data<float>();
+  const float* b_data = b.data<float>();
+  for (int64_t i = 0; i < a.numel(); ++i) {
+    EXPECT_NEAR(a_data[i], b_data[i], 1e-4);
+  }
+}
+
+int countOps(const caffe2::NetDef& net, const std::string& type) {
+  int count = 0;
+  for (const auto& op : net.op()) {
+    count += op.type() == type;
+  }
+  return count;
+}
+
+} // namespace
+
+TEST(FusionTest, ConvBNRelu) {
+  caffe2::Workspace ws;
+  fillTensor(&ws, "X", {2, 3, 8, 8});
+  fillTensor(&ws, "W", {4, 3, 3, 3});
+  fillTensor(&ws, "b", {4});
+  fillTensor(&ws, "scale", {4});
+  fillTensor(&ws, "bias", {4});
+  fillTensor(&ws, "mean", {4});
+  fillTensor(&ws, "var", {4}, 0.5f, 1.5f);
+
+  caffe2::NetDef net;
+  auto* conv = addOp(&net, "Conv", {"X", "W", "b"}, {"C"});
+  conv->add_arg()->CopyFrom(caffe2::MakeArgument("kernel", 3));
+  conv->add_arg()->CopyFrom(caffe2::MakeArgument("pad", 1));
+  auto* bn =
+      addOp(&net, "SpatialBN", {"C", "scale", "bias", "mean", "var"}, {"D"});
+  bn->add_arg()->CopyFrom(caffe2::MakeArgument("is_test", 1));
+  addOp(&net, "Relu", {"D"}, {"Y"});
+  for (const auto& input : {"X", "W", "b", "scale", "bias", "mean", "var"}) {
+    net.add_external_input(input);
+  }
+  net.add_external_output("Y");
+
+  const auto expected = runNet(&ws, net, "Y");
+  const auto optimized_net = caffe2::opt::optimize(net, &ws, 2);
+  ASSERT_EQ(optimized_net.op().size(), 1);
+  ASSERT_EQ(optimized_net.op(0).type(), "Conv");
+  caffe2::ArgumentHelper helper(optimized_net.op(0));
+  EXPECT_EQ(helper.GetSingleArgument<std::string>("activation", ""), "Relu");
+  expectTensorNear(runNet(&ws, optimized_net, "Y"), expected);
+}
+
+TEST(FusionTest, FCRelu) {
+  caffe2::Workspace ws;
+  fillTensor(&ws, "X", {5, 16});
+  fillTensor(&ws, "W", {8, 16});
+  fillTensor(&ws, "b", {8});
+
+  caffe2::NetDef net;
+  addOp(&net, "FC", {"X", "W", "b"}, {"H"});
+  addOp(&net, "Relu", {"H"}, {"H"});
+  for (const auto& input : {"X", "W", "b"}) {
+    net.add_external_input(input);
+  }
+  net.add_external_output("H");
+
+  const auto expected = runNet(&ws, net, "H");
+  const auto optimized_net = caffe2::opt::optimize(net, 2);
+  ASSERT_EQ(optimized_net.op().size(), 1);
+  EXPECT_EQ(optimized_net.op(0).type(), "FC");
+  expectTensorNear(runNet(&ws, optimized_net, "H"), expected);
+
+  // Relu is only fused from level 2 on
+  EXPECT_EQ(caffe2::opt::optimize(net, 1).op().size(), 2);
+}
+
+TEST(FusionTest, NetDeviceOption) {
+  // Ops without a device option run on the device of the net, which has no
+  // fused Relu.
+  caffe2::NetDef net;
+  net.mutable_device_option()->set_device_type(caffe2::PROTO_CUDA);
+  addOp(&net, "FC", {"X", "W", "b"}, {"H"});
+  addOp(&net, "Relu", {"H"}, {"Y"});
+  addOp(&net, "Sigmoid", {"Y"}, {"Z"});
+  for (const auto& input : {"X", "W", "b"}) {
+    net.add_external_input(input);
+  }
+  net.add_external_output("Z");
+
+  const auto optimized_net = caffe2::opt::optimize(net, 2);
+  ASSERT_EQ(optimized_net.op().size(), 3);
+  EXPECT_EQ(countOps(optimized_net, "FusedElementwise"), 0);
+  caffe2::ArgumentHelper helper(optimized_net.op(0));
+  EXPECT_FALSE(helper.HasArgument("activation"));
+}
+
+TEST(FusionTest, ElementwiseChain) {
+  caffe2::Workspace ws;
+  // Large enough to span several blocks of FusedElementwiseOp.
+  fillTensor(&ws, "X", {3, 1000});
+  fillTensor(&ws, "A", {3, 1000});
+  fillTensor(&ws, "S", {1});
+  fillTensor(&ws, "B", {3, 1000});
+
+  caffe2::NetDef net;
+  addOp(&net, "Add", {"X", "A"}, {"T1"});
+  addOp(&net, "Mul", {"T1", "S"}, {"T2"});
+  addOp(&net, "Sigmoid", {"T2"}, {"T3"});
+  addOp(&net, "Sub", {"B", "T3"}, {"T4"});
+  addOp(&net, "Relu", {"T4"}, {"Y"});
+  for (const auto& input : {"X", "A", "S", "B"}) {
+    net.add_external_input(input);
+  }
+  net.add_external_output("Y");
+
+  const auto expected = runNet(&ws, net, "Y");
+  auto nn = caffe2::convertToNNModule(net);
+  caffe2::opt::fuseElementwiseChains(&nn);
+  const auto optimized_net = caffe2::convertToCaffe2Proto(nn, net);
+  ASSERT_EQ(optimized_net.op().size(), 1);
+  const auto& op = optimized_net.op(0);
+  EXPECT_EQ(op.type(), "FusedElementwise");
+  ASSERT_EQ(op.input().size(), 4);
+  EXPECT_EQ(op.input(0), "X");
+  EXPECT_EQ(op.input(3), "B");
+  expectTensorNear(runNet(&ws, optimized_net, "Y"), expected);
+}
+
+TEST(FusionTest, ElementwiseChainBroadcast) {
+  caffe2::Workspace ws;
+  fillTensor(&ws, "X", {2, 3, 4});
+  fillTensor(&ws, "A", {4});
+  fillTensor(&ws, "B", {5, 1, 1, 1}, 1.0f, 2.0f);
+
+  caffe2::NetDef net;
+  addOp(&net, "Tanh", {"X"}, {"T1"});
+  addOp(&net, "Add", {"A", "T1"}, {"T2"});
+  addOp(&net, "Div", {"T2", "B"}, {"Y"});
+  for (const auto& input : {"X", "A", "B"}) {
+    net.add_external_input(input);
+  }
+  net.add_external_output("Y");
+
+  const auto expected = runNet(&ws, net, "Y");
+  const auto optimized_net = caffe2::opt::optimize(net, 2);
+  ASSERT_EQ(optimized_net.op().size(), 1);
+  EXPECT_EQ(optimized_net.op(0).type(), "FusedElementwise");
+  expectTensorNear(runNet(&ws, optimized_net, "Y"), expected);
+}
+
+TEST(FusionTest, ElementwiseChainInt) {
+  // The pass doesn't know the types of the blobs, the fused operator runs
+  // integer chains with the standalone kernels.
+  caffe2::Workspace ws;
+  for (const auto& name : {"X", "A", "B"}) {
+    auto* tensor =
+        caffe2::BlobGetMutableTensor(ws.CreateBlob(name), caffe2::CPU);
+    tensor->Resize(2, 3);
+    auto* data = tensor->mutable_data<int64_t>();
+    for (int64_t i = 0; i < tensor->numel(); ++i) {
+      data[i] = (i + name[0]) % 7 - 3;
+    }
+  }
+
+  caffe2::NetDef net;
+  net.set_name("int_chain");
+  addOp(&net, "Add", {"X", "A"}, {"T1"});
+  addOp(&net, "Mul", {"T1", "B"}, {"T2"});
+  addOp(&net, "Sub", {"A", "T2"}, {"Y"});
+  for (const auto& input : {"X", "A", "B"}) {
+    net.add_external_input(input);
+  }
+  net.add_external_output("Y");
+
+  const auto expected = runNet(&ws, net, "Y");
+  const auto optimized_net = caffe2::opt::optimize(net, 2);
+  ASSERT_EQ(optimized_net.op().size(), 1);
+  EXPECT_EQ(optimized_net.op(0).type(), "FusedElementwise");
+  // The second run reuses the standalone operators.
+  ASSERT_NE(ws.CreateNet(optimized_net), nullptr);
+  for (int run = 0; run < 2; ++run) {
+    ASSERT_TRUE(ws.RunNet(optimized_net.name()));
+    const auto& actual = ws.GetBlob("Y")->Get<caffe2::Tensor>();
+    ASSERT_EQ(actual.sizes(), expected.sizes());
+    ASSERT_TRUE(actual.IsType<int64_t>());
+    for (int64_t i = 0; i < expected.numel(); ++i) {
+      EXPECT_EQ(actual.data<int64_t>()[i], expected.data<int64_t>()[i]);
+    }
+  }
+}
+
+TEST(FusionTest, ElementwiseChainInputOverwritten) {
+  // X is overwritten between the Relu and the Add, the chain can't be
+  // evaluated at the position of the Add.
+  caffe2::NetDef net;
+  addOp(&net, "Relu", {"X"}, {"T1"});
+  addOp(&net, "Copy", {"Z"}, {"X"});
+  addOp(&net, "Add", {"T1", "X"}, {"Y"});
+  for (const auto& input : {"X", "Z"}) {
+    net.add_external_input(input);
+  }
+  net.add_external_output("Y");
+
+  auto nn = caffe2::convertToNNModule(net);
+  caffe2::opt::fuseElementwiseChains(&nn);
+  const auto optimized_net = caffe2::convertToCaffe2Proto(nn, net);
+  EXPECT_EQ(countOps(optimized_net, "FusedElementwise"), 0);
+  EXPECT_EQ(optimized_net.op().size(), 3);
+}
@@ -4,6 +4,16 @@
 
 namespace caffe2 {
 
+int findBatchBucket(const std::vector<int>& batch_buckets, int64_t batch_size) {
+  // Buckets are sorted, so the first one that fits is the smallest
+  for (size_t k = 0; k < batch_buckets.size(); ++k) {
+    if (batch_size <= batch_buckets[k]) {
+      return k;
+    }
+  }
+  return -1;
+}
+
 namespace {
 
 void SetInputTensorDescriptorTypeAndBuffer(
@@ -198,6 +208,20 @@ OnnxifiOp<CPUContext>::buildInitializationList(
   return descs;
 }
 
+template <>
+const typename OnnxifiOp<CPUContext>::BatchBucket*
+OnnxifiOp<CPUContext>::selectBatchBucket() {
+  if (batch_buckets_.empty() || InputSize() == 0) {
+    return nullptr;
+  }
+  const auto& t = Input(nominal_batch_idx_);
+  if (t.dim() == 0) {
+    return nullptr;
+  }
+  const int k = findBatchBucket(batch_bucket_sizes_, t.size(0));
+  return k < 0 ? nullptr : &batch_buckets_[k];
+}
+
 template <>
 void OnnxifiOp<CPUContext>::extractOutputBatchSizes() {
   output_reshape_info_.skip = false;
@@ -206,15 +230,16 @@ void OnnxifiOp<CPUContext>::extractOutputBatchSizes() {
     return;
   }
 
-  // Get the real batch size from nominal input. If it's equal to
-  // max_batch_size, mark that we don't need to adjust batch size and return.
+  // Get the real batch size from nominal input. If it's equal to the batch
+  // size of the graph we ran, mark that we don't need to adjust batch size and
+  // return.
   // Otherwise, do a pass of shape inference to get the real shapes of the
   // outputs.
   const auto& t = Input(nominal_batch_idx_);
   const auto dims = t.sizes();
   CAFFE_ENFORCE(
       !t.sizes().empty(), input_names_[nominal_batch_idx_], " cannot be empty");
-  if (dims[0] == max_batch_size_) {
+  if (dims[0] == current_batch_size_) {
     output_reshape_info_.skip = true;
     return;
   }
@@ -301,6 +326,14 @@ void OnnxifiOp<CPUContext>::maybeAdjustOutputBatchSizes() {
 
 template <>
 bool OnnxifiOp<CPUContext>::RunOnDevice() {
+  // Pick the graph compiled for the smallest batch that fits
+  const auto* bucket = selectBatchBucket();
+  onnxBackend backend = bucket ? bucket->backend_graph->backend : backend_;
+  onnxGraph graph = bucket ? bucket->backend_graph->graph : graph_;
+  const auto& output_shape_hints =
+      bucket ? bucket->output_shape_hints : output_shape_hints_;
+  current_batch_size_ = bucket ? bucket->batch_size : max_batch_size_;
+
   CAFFE_ENFORCE_EQ(input_desc_.size(), InputSize());
   for (unsigned i = 0U; i < InputSize(); ++i) {
     const auto& input_tensor = Input(i);
@@ -321,7 +354,7 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
   for (unsigned i = 0U; i < OutputSize(); ++i) {
     tensor_dims_int64_.clear();
     std::vector<size_t> tensor_dims;
-    uint64_t type = SetOutputShapeAndType(i, &tensor_dims);
+    uint64_t type = SetOutputShapeAndType(i, output_shape_hints, &tensor_dims);
     auto& tensor_descriptor = output_desc_[i];
     tensor_descriptor.tag = ONNXIFI_TAG_TENSOR_DESCRIPTOR_V1;
     tensor_descriptor.memoryType = ONNXIFI_MEMORY_TYPE_CPU;
@@ -375,7 +408,7 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
     }
     CAFFE_ENFORCE_EQ(
         (*onnxSetIOAndRunGraphPointer_)(
-            graph_,
+            graph,
             input_desc_.size(),
             input_desc_.data(),
             output_desc_.size(),
@@ -393,7 +426,7 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
   if (!ext_supported) {
     CAFFE_ENFORCE_EQ(
         lib_->onnxSetGraphIO(
-            graph_,
+            graph,
             input_desc_.size(),
             input_desc_.data(),
             output_desc_.size(),
@@ -403,7 +436,7 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
     input_fence.tag = ONNXIFI_TAG_MEMORY_FENCE_V1;
     input_fence.type = ONNXIFI_SYNCHRONIZATION_EVENT;
     CAFFE_ENFORCE_EQ(
-        lib_->onnxInitEvent(backend_, &input_fence.event),
+        lib_->onnxInitEvent(backend, &input_fence.event),
         ONNXIFI_STATUS_SUCCESS);
     output_fence.tag = ONNXIFI_TAG_MEMORY_FENCE_V1;
     output_fence.type = ONNXIFI_SYNCHRONIZATION_EVENT;
@@ -411,7 +444,7 @@ bool OnnxifiOp<CPUContext>::RunOnDevice() {
     // Call the async run on backend, signal event on input fence and wait for
     // the event on output fence
     CAFFE_ENFORCE_EQ(
-        lib_->onnxRunGraph(graph_, &input_fence, &output_fence),
+        lib_->onnxRunGraph(graph, &input_fence, &output_fence),
         ONNXIFI_STATUS_SUCCESS);
     CAFFE_ENFORCE_EQ(
         lib_->onnxSignalEvent(input_fence.event), ONNXIFI_STATUS_SUCCESS);
@@ -446,6 +479,9 @@ OPERATOR_SCHEMA(Onnxifi)
     .Arg(
         "initializers",
         "Initialization pair indicating the mapping of the name between NetDef and ONNX model")
+    .Arg(
+        "batch_buckets",
+        "(list of ints) Batch sizes below max_batch_size with their own backend graph, built from onnx_model_bucket_<k> with output hints bucket_<k>_output_shape_hint_<i>. Runs use the smallest bucket that fits the batch of the nominal input")
     .Arg(
         "output_resize_hints",
         "A list of key/value pairs indicating which input index to look up for real batch size for the given max output batch size");
@@ -16,6 +16,12 @@
 
 namespace caffe2 {
 
+// Index of the smallest of the increasing batch_buckets that is at least
+// batch_size, or -1 if batch_size is larger than all of them.
+CAFFE2_API int findBatchBucket(
+    const std::vector<int>& batch_buckets,
+    int64_t batch_size);
+
 template <typename Context>
 class OnnxifiOp final : public Operator<Context> {
   struct TensorInfo {
@@ -33,6 +39,14 @@ class OnnxifiOp final : public Operator<Context> {
     bool skip{false};
   };
 
+  // A backend graph built for a batch size below max_batch_size
+  struct BatchBucket {
+    int batch_size;
+    std::string op_id_string;
+    onnx::SharedPtrBackendGraphInfo backend_graph;
+    std::unordered_map<int, TensorInfo> output_shape_hints;
+  };
+
  public:
   USE_OPERATOR_CONTEXT_FUNCTIONS;
   explicit OnnxifiOp(const OperatorDef& operator_def, Workspace* ws)
@@ -78,16 +92,10 @@ class OnnxifiOp final : public Operator<Context> {
 
       // For output, we try to get its output size hint
       int64_t num_dims = 0;
-      const std::string key = c10::str("output_shape_hint_", output_idx);
-      auto output_shape_hint = this->template GetRepeatedArgument<int>(key);
-      if (!output_shape_hint.empty()) {
-        TensorInfo info;
-        info.onnxifi_type = output_shape_hint.front();
-        for (size_t i = 1; i < output_shape_hint.size(); ++i) {
-          info.dims.push_back(output_shape_hint[i]);
-        }
-        num_dims = info.dims.size();
-        output_shape_hints_.emplace(output_idx, std::move(info));
+      const auto it =
+          getOutputShapeHint("", output_idx, &output_shape_hints_);
+      if (it != output_shape_hints_.end()) {
+        num_dims = it->second.dims.size();
       }
 
       // Initialize the tensors used to slice the output
@@ -121,10 +129,54 @@ class OnnxifiOp final : public Operator<Context> {
     // Subsequent call of this function with the same model id should find a
     // cached backend and therefore there is no need to repeat the above
     // process.
-    buildBackendAndGraph(ws, property_pointers, onnx_model_str);
+    op_id_string_ =
+        this->template GetSingleArgument<std::string>("model_id", "") + ":" +
+        this->template GetSingleArgument<std::string>("net_pos", "");
+    backend_graph_shared_ptr_ = buildBackendAndGraph(
+        ws, property_pointers, onnx_model_str, op_id_string_);
+    backend_id_ = backend_graph_shared_ptr_->backend_id;
+    backend_ = backend_graph_shared_ptr_->backend;
+    graph_ = backend_graph_shared_ptr_->graph;
+    input_shape_info_ = backend_graph_shared_ptr_->weight_shape_info;
+
+    getExtFunctionPointers();
+
+    // Build a backend graph for each batch bucket, from the same c2 model
+    // with shapes bound to the bucket batch size
+    batch_bucket_sizes_ =
+        this->template GetRepeatedArgument<int>("batch_buckets");
+    const auto& batch_buckets = batch_bucket_sizes_;
+    CAFFE_ENFORCE(
+        batch_buckets.empty() || !use_onnx_,
+        "Batch buckets need the c2 model");
+    for (size_t k = 0; k < batch_buckets.size(); ++k) {
+      CAFFE_ENFORCE(
+          k == 0 || batch_buckets[k - 1] < batch_buckets[k],
+          "Batch buckets must be increasing");
+      const auto bucket_model_str =
+          this->template GetSingleArgument<std::string>(
+              c10::str("onnx_model_bucket_", k), "");
+      CAFFE_ENFORCE(
+          !bucket_model_str.empty(), "Missing model of batch bucket ", k);
+      BatchBucket bucket;
+      bucket.batch_size = batch_buckets[k];
+      bucket.op_id_string =
+          c10::str(op_id_string_, ":bucket_", bucket.batch_size);
+      bucket.backend_graph = buildBackendAndGraph(
+          ws, property_pointers, bucket_model_str, bucket.op_id_string);
+      for (int i = 0; i < static_cast<int>(output_names_.size()); ++i) {
+        getOutputShapeHint(
+            c10::str("bucket_", k, "_"), i, &bucket.output_shape_hints);
+      }
+      batch_buckets_.push_back(std::move(bucket));
+    }
   }
 
   ~OnnxifiOp() {
+    for (auto& bucket : batch_buckets_) {
+      bucket.backend_graph.reset();
+      backend_graph_map_ptr_->remove(bucket.op_id_string);
+    }
     backend_graph_shared_ptr_.reset();
     backend_graph_map_ptr_->remove(op_id_string_);
 #ifdef ONNXIFI_ENABLE_EXT
@@ -144,10 +196,33 @@ class OnnxifiOp final : public Operator<Context> {
   }
 #endif
  private:
-  uint64_t SetOutputShapeAndType(int output_idx, std::vector<size_t>* dims) {
+  // Reads the <prefix>output_shape_hint_<output_idx> argument into hints.
+  // Returns the hint, or hints->end() if there's none.
+  typename std::unordered_map<int, TensorInfo>::const_iterator
+  getOutputShapeHint(
+      const std::string& prefix,
+      int output_idx,
+      std::unordered_map<int, TensorInfo>* hints) {
+    const std::string key = c10::str(prefix, "output_shape_hint_", output_idx);
+    auto output_shape_hint = this->template GetRepeatedArgument<int>(key);
+    if (output_shape_hint.empty()) {
+      return hints->end();
+    }
+    TensorInfo info;
+    info.onnxifi_type = output_shape_hint.front();
+    for (size_t i = 1; i < output_shape_hint.size(); ++i) {
+      info.dims.push_back(output_shape_hint[i]);
+    }
+    return hints->emplace(output_idx, std::move(info)).first;
+  }
+
+  uint64_t SetOutputShapeAndType(
+      int output_idx,
+      const std::unordered_map<int, TensorInfo>& output_shape_hints,
+      std::vector<size_t>* dims) {
     uint64_t type = ONNXIFI_DATATYPE_FLOAT32;
-    const auto it = output_shape_hints_.find(output_idx);
-    if (it != output_shape_hints_.end()) {
+    const auto it = output_shape_hints.find(output_idx);
+    if (it != output_shape_hints.end()) {
       std::copy(
           it->second.dims.begin(),
           it->second.dims.end(),
@@ -165,14 +240,11 @@ class OnnxifiOp final : public Operator<Context> {
     property_list->push_back(ONNXIFI_BACKEND_PROPERTY_NONE);
   }
 
-  void buildBackendAndGraph(
+  onnx::SharedPtrBackendGraphInfo buildBackendAndGraph(
       Workspace* ws,
       const std::vector<uint64_t>& property_pointers,
-      const std::string& onnx_model_str) {
-    op_id_string_ =
-        this->template GetSingleArgument<std::string>("model_id", "") + ":" +
-        this->template GetSingleArgument<std::string>("net_pos", "");
-
+      const std::string& onnx_model_str,
+      const std::string& op_id_string) {
     auto initializers =
         this->template GetRepeatedArgument<std::string>("initializers");
     // Build the Onnxifi engine
@@ -263,15 +335,7 @@ class OnnxifiOp final : public Operator<Context> {
       return std::make_shared<onnx::BackendGraphInfo>(
           backend_id, backend, graph, lib_, std::move(weight_shape_info));
     };
-    backend_graph_shared_ptr_ =
-        backend_graph_map_ptr_->insert(op_id_string_, creator);
-
-    backend_id_ = backend_graph_shared_ptr_->backend_id;
-    backend_ = backend_graph_shared_ptr_->backend;
-    graph_ = backend_graph_shared_ptr_->graph;
-    input_shape_info_ = backend_graph_shared_ptr_->weight_shape_info;
-
-    getExtFunctionPointers();
+    return backend_graph_map_ptr_->insert(op_id_string, creator);
   }
 
   /// Set up function pointer if onnxifi_ext is enabled
@@ -297,6 +361,10 @@ class OnnxifiOp final : public Operator<Context> {
 #endif
   }
 
+  // Smallest batch bucket that fits the nominal input, nullptr if there is
+  // none and the max batch size graph should be used.
+  const BatchBucket* selectBatchBucket();
+
   void extractOutputBatchSizes();
 
   // If needed, adjust output tensor shape based on the real input batch size.
@@ -354,6 +422,16 @@ class OnnxifiOp final : public Operator<Context> {
   // max batch size
   int max_batch_size_;
 
+  // batch size the graph of the current run was built for
+  int current_batch_size_{0};
+
+  // graphs built for batch sizes below max_batch_size_, by increasing batch
+  // size
+  std::vector<BatchBucket> batch_buckets_;
+
+  // batch sizes of batch_buckets_
+  std::vector<int> batch_bucket_sizes_;
+
   // max sequence lookup size
   int max_seq_size_;
 
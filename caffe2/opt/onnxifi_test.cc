@@ -0,0 +1,336 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstring>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/logging.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/onnx/onnxifi_init.h"
+#include "caffe2/opt/bound_shape_inferencer.h"
+#include "caffe2/opt/onnxifi_op.h"
+#include "caffe2/opt/onnxifi_transformer.h"
+#include "caffe2/utils/proto_utils.h"
+
+using namespace caffe2;
+namespace {
+
+ShapeInfo makeTensorInfo(
+    const std::vector<TensorBoundShape::DimType>& t,
+    const std::vector<int64_t>& dims) {
+  ShapeInfo info;
+  info.setDimType(t);
+  TensorShape& shape = info.shape;
+  for (const auto d : dims) {
+    shape.add_dims(d);
+  }
+  shape.set_data_type(TensorProto_DataType_FLOAT);
+  return info;
+}
+
+std::vector<int64_t> getDims(const ShapeInfoMap& info, const std::string& name) {
+  const auto it = info.find(name);
+  CAFFE_ENFORCE(it != info.end(), "No shape for ", name);
+  const auto& dims = it->second.shape.dims();
+  return std::vector<int64_t>(dims.begin(), dims.end());
+}
+
+// A CPU-only ONNXIFI backend. Its graphs are c2 nets, which it runs with the
+// CPU operators. Outputs are copied into the output buffers, whose shapes
+// come from the output shape hints of the Onnxifi op, and zero padded.
+int fake_backend_id;
+int fake_backend;
+
+struct FakeGraph {
+  NetDef net;
+  Workspace ws;
+  std::vector<onnxTensorDescriptorV1> inputs;
+  std::vector<onnxTensorDescriptorV1> outputs;
+};
+
+TypeMeta fakeDataType(uint64_t onnxifi_type) {
+  switch (onnxifi_type) {
+    case ONNXIFI_DATATYPE_FLOAT32:
+      return TypeMeta::Make<float>();
+    case ONNXIFI_DATATYPE_INT32:
+      return TypeMeta::Make<int32_t>();
+    case ONNXIFI_DATATYPE_INT64:
+      return TypeMeta::Make<int64_t>();
+    default:
+      CAFFE_THROW("Unsupported ONNXIFI data type: ", onnxifi_type);
+  }
+}
+
+void feedTensor(Workspace* ws, const onnxTensorDescriptorV1& desc) {
+  auto* tensor = BlobGetMutableTensor(ws->CreateBlob(desc.name), CPU);
+  tensor->Resize(
+      std::vector<int64_t>(desc.shape, desc.shape + desc.dimensions));
+  void* data = tensor->raw_mutable_data(fakeDataType(desc.dataType));
+  std::memcpy(
+      data, reinterpret_cast<const void*>(desc.buffer), tensor->nbytes());
+}
+
+void fetchTensor(Workspace* ws, const onnxTensorDescriptorV1& desc) {
+  const auto& tensor = ws->GetBlob(desc.name)->Get<TensorCPU>();
+  CAFFE_ENFORCE(tensor.dtype() == fakeDataType(desc.dataType));
+  size_t nbytes = tensor.itemsize();
+  for (uint32_t i = 0; i < desc.dimensions; ++i) {
+    nbytes *= desc.shape[i];
+  }
+  CAFFE_ENFORCE_LE(tensor.nbytes(), nbytes, "Output ", desc.name, " too big");
+  auto* buffer = reinterpret_cast<char*>(desc.buffer);
+  std::memcpy(buffer, tensor.raw_data(), tensor.nbytes());
+  std::memset(buffer + tensor.nbytes(), 0, nbytes - tensor.nbytes());
+}
+
+onnxStatus ONNXIFI_ABI
+fakeGetBackendIDs(onnxBackendID* backend_ids, size_t* num_backends) {
+  const size_t capacity = *num_backends;
+  *num_backends = 1;
+  if (backend_ids == nullptr || capacity < 1) {
+    return ONNXIFI_STATUS_FALLBACK;
+  }
+  backend_ids[0] = reinterpret_cast<onnxBackendID>(&fake_backend_id);
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus ONNXIFI_ABI fakeReleaseBackendID(onnxBackendID /* unused */) {
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus ONNXIFI_ABI fakeInitBackend(
+    onnxBackendID /* unused */,
+    const uint64_t* /* unused */,
+    onnxBackend* backend) {
+  *backend = reinterpret_cast<onnxBackend>(&fake_backend);
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus ONNXIFI_ABI fakeReleaseBackend(onnxBackend /* unused */) {
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+// Graphs run synchronously, so events are always signalled
+onnxStatus ONNXIFI_ABI
+fakeInitEvent(onnxBackend /* unused */, onnxEvent* event) {
+  *event = reinterpret_cast<onnxEvent>(new int(0));
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus ONNXIFI_ABI fakeSignalEvent(onnxEvent /* unused */) {
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus ONNXIFI_ABI fakeWaitEvent(onnxEvent /* unused */) {
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus ONNXIFI_ABI fakeReleaseEvent(onnxEvent event) {
+  delete reinterpret_cast<int*>(event);
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus ONNXIFI_ABI fakeInitGraph(
+    onnxBackend /* unused */,
+    const uint64_t* /* unused */,
+    size_t model_size,
+    const void* model,
+    uint32_t weights_count,
+    const onnxTensorDescriptorV1* weight_descriptors,
+    onnxGraph* graph,
+    uint32_t /* unused */,
+    void* /* unused */) {
+  std::unique_ptr<FakeGraph> fake_graph(new FakeGraph());
+  if (!fake_graph->net.ParseFromArray(model, model_size)) {
+    return ONNXIFI_STATUS_INVALID_PROTOBUF;
+  }
+  for (uint32_t i = 0; i < weights_count; ++i) {
+    feedTensor(&fake_graph->ws, weight_descriptors[i]);
+  }
+  *graph = reinterpret_cast<onnxGraph>(fake_graph.release());
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus ONNXIFI_ABI fakeSetGraphIO(
+    onnxGraph graph,
+    uint32_t inputs_count,
+    const onnxTensorDescriptorV1* input_descriptors,
+    uint32_t outputs_count,
+    const onnxTensorDescriptorV1* output_descriptors) {
+  auto* fake_graph = reinterpret_cast<FakeGraph*>(graph);
+  fake_graph->inputs.assign(
+      input_descriptors, input_descriptors + inputs_count);
+  fake_graph->outputs.assign(
+      output_descriptors, output_descriptors + outputs_count);
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus ONNXIFI_ABI fakeRunGraph(
+    onnxGraph graph,
+    const onnxMemoryFenceV1* /* unused */,
+    onnxMemoryFenceV1* output_fence) {
+  auto* fake_graph = reinterpret_cast<FakeGraph*>(graph);
+  for (const auto& desc : fake_graph->inputs) {
+    feedTensor(&fake_graph->ws, desc);
+  }
+  if (!fake_graph->ws.RunNetOnce(fake_graph->net)) {
+    return ONNXIFI_STATUS_INTERNAL_ERROR;
+  }
+  for (const auto& desc : fake_graph->outputs) {
+    fetchTensor(&fake_graph->ws, desc);
+  }
+  return fakeInitEvent(nullptr, &output_fence->event);
+}
+
+onnxStatus ONNXIFI_ABI fakeReleaseGraph(onnxGraph graph) {
+  delete reinterpret_cast<FakeGraph*>(graph);
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus ONNXIFI_ABI fakeGetExtensionFunctionAddress(
+    onnxBackendID /* unused */,
+    const char* /* unused */,
+    onnxExtensionFunctionPointer* /* unused */) {
+  return ONNXIFI_STATUS_UNIDENTIFIED_NAME;
+}
+
+onnxifi_library* fakeOnnxifiLibrary() {
+  static onnxifi_library lib = []() {
+    onnxifi_library l{};
+    l.onnxGetBackendIDs = fakeGetBackendIDs;
+    l.onnxReleaseBackendID = fakeReleaseBackendID;
+    l.onnxInitBackend = fakeInitBackend;
+    l.onnxReleaseBackend = fakeReleaseBackend;
+    l.onnxInitEvent = fakeInitEvent;
+    l.onnxSignalEvent = fakeSignalEvent;
+    l.onnxWaitEvent = fakeWaitEvent;
+    l.onnxReleaseEvent = fakeReleaseEvent;
+    l.onnxInitGraph = fakeInitGraph;
+    l.onnxSetGraphIO = fakeSetGraphIO;
+    l.onnxRunGraph = fakeRunGraph;
+    l.onnxReleaseGraph = fakeReleaseGraph;
+    l.onnxGetExtensionFunctionAddress = fakeGetExtensionFunctionAddress;
+    return l;
+  }();
+  return &lib;
+}
+
+} // namespace
+
+TEST(OnnxifiBatchBuckets, FindBatchBucket) {
+  const std::vector<int> buckets{4, 16, 32};
+  EXPECT_EQ(findBatchBucket(buckets, 0), 0);
+  EXPECT_EQ(findBatchBucket(buckets, 1), 0);
+  EXPECT_EQ(findBatchBucket(buckets, 4), 0);
+  EXPECT_EQ(findBatchBucket(buckets, 5), 1);
+  EXPECT_EQ(findBatchBucket(buckets, 16), 1);
+  EXPECT_EQ(findBatchBucket(buckets, 32), 2);
+  // Runs the max batch size graph
+  EXPECT_EQ(findBatchBucket(buckets, 33), -1);
+  EXPECT_EQ(findBatchBucket({}, 1), -1);
+}
+
+TEST(OnnxifiBatchBuckets, BucketShapeHints) {
+  const int max_batch_size = 20;
+  const int batch_size = 4;
+  NetDef net;
+  net.add_op()->CopyFrom(
+      CreateOperatorDef("FC", "", {"X", "W", "B"}, {"Out"}, {}));
+  ShapeInfoMap shape_hints;
+  shape_hints.emplace(
+      "X",
+      makeTensorInfo(
+          {TensorBoundShape_DimType_BATCH, TensorBoundShape_DimType_CONSTANT},
+          {max_batch_size, 1024}));
+  // A weight whose first dim happens to be the max batch size
+  shape_hints.emplace(
+      "W",
+      makeTensorInfo(
+          {TensorBoundShape_DimType_CONSTANT,
+           TensorBoundShape_DimType_CONSTANT},
+          {max_batch_size, 1024}));
+  shape_hints.emplace(
+      "B", makeTensorInfo({TensorBoundShape_DimType_CONSTANT}, {max_batch_size}));
+
+  const auto bucket_hints =
+      getBucketShapeHints(shape_hints, max_batch_size, batch_size);
+  EXPECT_EQ(getDims(bucket_hints, "X"), (std::vector<int64_t>{4, 1024}));
+  EXPECT_EQ(getDims(bucket_hints, "W"), (std::vector<int64_t>{20, 1024}));
+  EXPECT_EQ(getDims(bucket_hints, "B"), (std::vector<int64_t>{20}));
+
+  // What the transformer infers for the bucket
+  BoundShapeInferencer eng(BoundShapeSpec(batch_size, 1000));
+  eng.InferBoundShapeAndType(net, bucket_hints, nullptr);
+  const auto& out_shape = eng.shape_info();
+  EXPECT_EQ(getDims(out_shape, "Out"), (std::vector<int64_t>{4, 20}));
+
+  // And the hints the Onnxifi op gets for the outputs of the bucket graph
+  std::unordered_map<std::string, TensorShape> output_shape_hints;
+  output_shape_hints.emplace("Out", out_shape.at("Out").shape);
+  OperatorDef op;
+  op.set_type("Onnxifi");
+  op.add_output("Other");
+  op.add_output("Out");
+  addOutputShapeHints(output_shape_hints, "bucket_0_", &op);
+  ASSERT_EQ(op.arg_size(), 1);
+  const auto& arg = op.arg(0);
+  EXPECT_EQ(arg.name(), "bucket_0_output_shape_hint_1");
+  ASSERT_EQ(arg.ints_size(), 3);
+  EXPECT_EQ(arg.ints(0), ONNXIFI_DATATYPE_FLOAT32);
+  EXPECT_EQ(arg.ints(1), 4);
+  EXPECT_EQ(arg.ints(2), 20);
+}
+
+TEST(OnnxifiBatchBuckets, FakeBackendRunsBucketGraph) {
+  onnx::overrideOnnxifiLibrary(fakeOnnxifiLibrary());
+  const int max_batch_size = 32;
+  NetDef net;
+  net.add_op()->CopyFrom(CreateOperatorDef("Relu", "", {"X"}, {"Y"}, {}));
+  const auto model = net.SerializeAsString();
+  const std::vector<int> buckets{4, 16};
+  OperatorDef def = CreateOperatorDef(
+      "Onnxifi",
+      "",
+      {"X"},
+      {"Y"},
+      {MakeArgument<std::string>("onnx_model", model),
+       MakeArgument<std::vector<std::string>>("input_names", {"X"}),
+       MakeArgument<std::vector<std::string>>("output_names", {"Y"}),
+       MakeArgument<int>("max_batch_size", max_batch_size),
+       MakeArgument<std::string>("model_id", "fake_backend_buckets"),
+       MakeArgument<std::vector<int>>("batch_buckets", buckets),
+       MakeArgument<std::string>("onnx_model_bucket_0", model),
+       MakeArgument<std::string>("onnx_model_bucket_1", model),
+       MakeArgument<std::vector<int>>(
+           "output_shape_hint_0",
+           {ONNXIFI_DATATYPE_FLOAT32, max_batch_size, 3}),
+       MakeArgument<std::vector<int>>(
+           "bucket_0_output_shape_hint_0",
+           {ONNXIFI_DATATYPE_FLOAT32, buckets[0], 3}),
+       MakeArgument<std::vector<int>>(
+           "bucket_1_output_shape_hint_0",
+           {ONNXIFI_DATATYPE_FLOAT32, buckets[1], 3})});
+  Workspace ws;
+  auto* x = BlobGetMutableTensor(ws.CreateBlob("X"), CPU);
+  auto op = CreateOperator(def, &ws);
+
+  // The output of the graph that ran has the batch size of its hint
+  const std::vector<std::pair<int, int64_t>> batch_and_graph_batch{
+      {1, 4}, {4, 4}, {5, 16}, {16, 16}, {17, 32}, {32, 32}};
+  for (const auto& p : batch_and_graph_batch) {
+    x->Resize(p.first, 3);
+    float* x_data = x->mutable_data<float>();
+    for (int i = 0; i < x->numel(); ++i) {
+      x_data[i] = i % 7 - 3;
+    }
+    ASSERT_TRUE(op->Run());
+    const auto& y = ws.GetBlob("Y")->Get<TensorCPU>();
+    EXPECT_EQ(y.sizes().vec(), (std::vector<int64_t>{p.second, 3}))
+        << "batch size " << p.first;
+    const float* y_data = y.data<float>();
+    for (int i = 0; i < x->numel(); ++i) {
+      EXPECT_EQ(y_data[i], std::max(x_data[i], 0.0f));
+    }
+  }
+  op.reset();
+  onnx::overrideOnnxifiLibrary(nullptr);
+}
@@ -1,6 +1,7 @@
 #include "caffe2/opt/onnxifi_transformer.h"
 
 #include <iostream>
+#include <set>
 #include <unordered_set>
 
 #include "onnx/proto_utils.h"
@@ -195,6 +196,20 @@ int64_t getBlob1stDimSize(const ShapeInfo& shape_info) {
   }
 }
 
+std::unordered_map<std::string, TensorShape> getOutputShapeHints(
+    const NetDef& onnxifi_net,
+    const ShapeInfoMap& shape_hints) {
+  std::unordered_map<std::string, TensorShape> output_shape_hints;
+  for (const auto& o : onnxifi_net.external_output()) {
+    const auto it = shape_hints.find(o);
+    CAFFE_ENFORCE(
+        it != shape_hints.end(), "Cannot find shape info for output ", o);
+    const auto& shape = it->second.shape;
+    output_shape_hints.emplace(o, shape);
+  }
+  return output_shape_hints;
+}
+
 NetDef composeResultNet(const OperatorDef& onnxifi_op) {
   NetDef net_opt;
   net_opt.add_op()->CopyFrom(onnxifi_op);
@@ -313,6 +328,44 @@ void mergeFp32InputsAndConvertToFp16(
 
 } // namespace
 
+void addOutputShapeHints(
+    const std::unordered_map<std::string, TensorShape>& output_shape_hints,
+    const std::string& prefix,
+    OperatorDef* op) {
+  for (int i = 0; i < op->output_size(); ++i) {
+    const auto& o = op->output(i);
+    const auto it = output_shape_hints.find(o);
+    if (it != output_shape_hints.end()) {
+      const auto& shape = it->second;
+      auto* output_shape_hint_arg = op->add_arg();
+      output_shape_hint_arg->set_name(
+          c10::str(prefix, "output_shape_hint_", i));
+      output_shape_hint_arg->add_ints(onnxifiDataType(shape.data_type()));
+      for (const auto& d : shape.dims()) {
+        output_shape_hint_arg->add_ints(d);
+      }
+
+      VLOG(2) << "Adding output hint: " << prefix << o;
+    }
+  }
+}
+
+ShapeInfoMap getBucketShapeHints(
+    const ShapeInfoMap& shape_hints,
+    int max_batch_size,
+    int batch_size) {
+  ShapeInfoMap bucket_hints;
+  for (const auto& kv : shape_hints) {
+    ShapeInfo info = kv.second;
+    if (info.getDimType(0) == TensorBoundShape_DimType_BATCH &&
+        getBlob1stDimSize(info) == max_batch_size) {
+      info.shape.set_dims(0, batch_size);
+    }
+    bucket_hints.emplace(kv.first, std::move(info));
+  }
+  return bucket_hints;
+}
+
 OnnxifiTransformer::OnnxifiTransformer(const OnnxifiTransformerOptions& opts)
     : BackendTransformerBase(), opts_(opts) {
   lib_ = onnx::initOnnxifiLibrary();
@@ -396,21 +449,7 @@ OperatorDef OnnxifiTransformer::buildOnnxifiOp(
   }
 
   // Add output size hints
-  for (int i = 0; i < op.output_size(); ++i) {
-    const auto& o = op.output(i);
-    const auto it = output_shape_hints.find(o);
-    if (it != output_shape_hints.end()) {
-      const auto& shape = it->second;
-      auto* output_shape_hint_arg = op.add_arg();
-      output_shape_hint_arg->set_name(c10::str("output_shape_hint_", i));
-      output_shape_hint_arg->add_ints(onnxifiDataType(shape.data_type()));
-      for (const auto& d : shape.dims()) {
-        output_shape_hint_arg->add_ints(d);
-      }
-
-      VLOG(2) << "Adding output hint: " << o;
-    }
-  }
+  addOutputShapeHints(output_shape_hints, "", &op);
 
   // Tell Onnxifi op that the model is in onnx or c2 proto format
   AddArgument("use_onnx", opts_.use_onnx ? 1 : 0, &op);
@@ -435,6 +474,29 @@ OperatorDef OnnxifiTransformer::buildOnnxifiOp(
   return op;
 }
 
+void OnnxifiTransformer::addInputShapeInfo(
+    const std::vector<std::string>& inputs,
+    const ShapeInfoMap& shape_hints,
+    const ShapeInfoMap* fallback_shape_hints,
+    NetDef* net) const {
+  auto* shape_arg = net->add_arg();
+  auto* qshape_arg = net->add_arg();
+  shape_arg->set_name("input_shape_info");
+  qshape_arg->set_name("input_qshape_info");
+  for (const auto& i : inputs) {
+    const auto& info = fallback_shape_hints && !shape_hints.count(i)
+        ? fallback_shape_hints->at(i)
+        : shape_hints.at(i);
+    if (!info.is_quantized) {
+      shape_arg->mutable_tensors()->Add()->CopyFrom(
+          wrapShapeInfoIntoTensorProto(i, info));
+    } else {
+      qshape_arg->mutable_qtensors()->Add()->CopyFrom(
+          wrapShapeInfoIntoQTensorProto(i, info));
+    }
+  }
+}
+
 NetDef OnnxifiTransformer::SubnetToOnnxifiOpViaC2(
     const caffe2::NetDef& net,
     const std::unordered_set<std::string>& weights_in_ws,
@@ -479,32 +541,16 @@ NetDef OnnxifiTransformer::SubnetToOnnxifiOpViaC2(
       std::vector<std::string>(),
       &initialization_list,
       &total_inputs_vec);
-  auto* shape_arg = onnxifi_net.add_arg();
-  auto* qshape_arg = onnxifi_net.add_arg();
-  shape_arg->set_name("input_shape_info");
-  qshape_arg->set_name("input_qshape_info");
   onnxifi_net.clear_external_input();
   for (const auto& i : total_inputs_vec) {
     onnxifi_net.add_external_input(i);
-    auto info = shape_hints.at(i);
-    if (!info.is_quantized) {
-      shape_arg->mutable_tensors()->Add()->CopyFrom(
-          wrapShapeInfoIntoTensorProto(i, shape_hints.at(i)));
-    } else {
-      qshape_arg->mutable_qtensors()->Add()->CopyFrom(
-          wrapShapeInfoIntoQTensorProto(i, shape_hints.at(i)));
-    }
   }
+  // The bucket nets only differ from the max batch one by their shapes
+  NetDef bucket_net_base(onnxifi_net);
+  addInputShapeInfo(total_inputs_vec, shape_hints, nullptr, &onnxifi_net);
 
   // Compute output shape hints
-  std::unordered_map<std::string, TensorShape> output_shape_hints;
-  for (const auto& o : onnxifi_net.external_output()) {
-    const auto it = shape_hints.find(o);
-    CAFFE_ENFORCE(
-        it != shape_hints.end(), "Cannot find shape info for output ", o);
-    const auto& shape = it->second.shape;
-    output_shape_hints.emplace(o, shape);
-  }
+  auto output_shape_hints = getOutputShapeHints(onnxifi_net, shape_hints);
 
   // Build ONNXIFI Op
   std::vector<std::string> onnxifi_net_inputs(
@@ -521,6 +567,27 @@ NetDef OnnxifiTransformer::SubnetToOnnxifiOpViaC2(
       onnxifi_net_inputs,
       onnxifi_net_outputs,
       shape_hints);
+
+  // Add a model and output hints for each batch bucket
+  std::vector<int> batch_buckets;
+  for (const auto& bucket : bucket_shape_hints_) {
+    const int k = batch_buckets.size();
+    batch_buckets.push_back(bucket.first);
+    NetDef bucket_net(bucket_net_base);
+    addInputShapeInfo(
+        total_inputs_vec, bucket.second, &shape_hints, &bucket_net);
+    std::string bucket_model_str;
+    bucket_net.SerializeToString(&bucket_model_str);
+    AddArgument(
+        c10::str("onnx_model_bucket_", k), bucket_model_str, &onnxifi_op);
+    addOutputShapeHints(
+        getOutputShapeHints(bucket_net, bucket.second),
+        c10::str("bucket_", k, "_"),
+        &onnxifi_op);
+  }
+  if (!batch_buckets.empty()) {
+    AddArgument("batch_buckets", batch_buckets, &onnxifi_op);
+  }
   NetDef net_opt = composeResultNet(onnxifi_op);
 
   // Debugging stuff
@@ -957,6 +1024,30 @@ NetDef OnnxifiTransformer::TransformViaOnnx(
       *pred_net, onnx_supports, onnx_converter, opts_.debug);
 }
 
+void OnnxifiTransformer::inferBucketShapes(
+    Workspace* ws,
+    NetDef* pred_net,
+    const ShapeInfoMap& shape_hints_mapped) {
+  const auto max_batch_size = opts_.bound_shape_spec.max_batch_size;
+  std::set<int> buckets(
+      opts_.batch_buckets.begin(), opts_.batch_buckets.end());
+  for (const auto b : buckets) {
+    CAFFE_ENFORCE_GT(b, 0, "Batch buckets must be positive");
+    // The max batch size is covered by the main graph already
+    if (b >= max_batch_size) {
+      continue;
+    }
+    BoundShapeSpec spec(b, opts_.bound_shape_spec.max_seq_size);
+    bucket_shape_hints_.emplace_back(
+        b,
+        inferShapes(
+            ws,
+            pred_net,
+            getBucketShapeHints(shape_hints_mapped, max_batch_size, b),
+            spec));
+  }
+}
+
 // Cutting off the runnable part and replace with ONNXIFI ops. Asssume the nets
 // were topologically sorted
 void OnnxifiTransformer::transform(
@@ -1004,6 +1095,16 @@ void OnnxifiTransformer::transform(
     dumpNet(*pred_net, shape_hints, "debug_ssa_net.pb_txt");
   }
 
+  bucket_shape_hints_.clear();
+  if (!opts_.batch_buckets.empty()) {
+    if (opts_.use_onnx || opts_.merge_fp32_inputs_into_fp16) {
+      LOG(WARNING) << "Batch buckets are only supported when passing the c2 "
+                   << "model without merging fp32 inputs, ignoring them";
+    } else {
+      inferBucketShapes(&mapped_ws, pred_net, shape_hints_mapped);
+    }
+  }
+
   // Get backend id
   getBackendId();
 
@@ -31,8 +31,29 @@ struct OnnxifiTransformerOptions final : public BackendTransformOptions {
   // Whether to combine fp32 batched inputs into one tensor and convert it to
   // fp16 or not
   bool merge_fp32_inputs_into_fp16{false};
+
+  // Batch sizes below bound_shape_spec.max_batch_size for which each Onnxifi
+  // op gets an extra backend graph, built with the shapes inferred for that
+  // batch size. At run time the op runs the graph of the smallest bucket that
+  // fits the actual batch instead of padding everything to the max batch
+  // size. Only used when passing the c2 model.
+  std::vector<int> batch_buckets;
 };
 
+// Shape hints for a batch bucket: the first dim of the batch inputs that are
+// max_batch_size long is replaced with batch_size.
+CAFFE2_API ShapeInfoMap getBucketShapeHints(
+    const ShapeInfoMap& shape_hints,
+    int max_batch_size,
+    int batch_size);
+
+// Adds a <prefix>output_shape_hint_<i> arg to the Onnxifi op for each of its
+// outputs with a shape in output_shape_hints.
+CAFFE2_API void addOutputShapeHints(
+    const std::unordered_map<std::string, TensorShape>& output_shape_hints,
+    const std::string& prefix,
+    OperatorDef* op);
+
 class CAFFE2_API OnnxifiTransformer final : public BackendTransformerBase {
  public:
   explicit OnnxifiTransformer(const OnnxifiTransformerOptions& opts);
@@ -64,6 +85,19 @@ class CAFFE2_API OnnxifiTransformer final : public BackendTransformerBase {
       const std::unordered_set<std::string>& weights_in_ws,
       const ShapeInfoMap& shape_hints);
 
+  // Bound shape inference for each of opts_.batch_buckets
+  void inferBucketShapes(
+      Workspace* ws,
+      NetDef* pred_net,
+      const ShapeInfoMap& shape_hints_mapped);
+
+  // Add input_shape_info/input_qshape_info args describing inputs to net
+  void addInputShapeInfo(
+      const std::vector<std::string>& inputs,
+      const ShapeInfoMap& shape_hints,
+      const ShapeInfoMap* fallback_shape_hints,
+      NetDef* net) const;
+
   // We already have all the ops and external inputs and outputs!
   OperatorDef buildOnnxifiOp(
       const std::string& onnx_model_str,
@@ -142,5 +176,8 @@ class CAFFE2_API OnnxifiTransformer final : public BackendTransformerBase {
 
   // A cache for ONNX shape hints
   std::unordered_map<std::string, TensorShape> shape_hints_onnx_;
+
+  // Batch size and shape info of each batch bucket, by increasing batch size
+  std::vector<std::pair<int, ShapeInfoMap>> bucket_shape_hints_;
 };
 } // namespace caffe2
@@ -9,6 +9,7 @@ namespace opt {
 
 void workspaceOptimizations(nom::repr::NNModule* nn, Workspace* ws, int level) {
   switch (level) {
+    case 2:
     case 1:
       opt::fuseConvBN(nn, ws);
     case 0:
@@ -19,6 +20,7 @@ void workspaceOptimizations(nom::repr::NNModule* nn, Workspace* ws, int level) {
 
 void graphOptimzations(nom::repr::NNModule* nn, int level) {
   switch (level) {
+    case 2:
     case 1:
 #ifdef USE_NNPACK 
       opt::addNNPACK(nn, false);
@@ -30,16 +32,34 @@ void graphOptimzations(nom::repr::NNModule* nn, int level) {
   }
 }
 
+// Runs after workspaceOptimizations, so that a Relu after a BatchNorm that
+// was folded into a Conv can be fused into the Conv as well.
+void cpuFusionOptimizations(
+    nom::repr::NNModule* nn,
+    const DeviceOption& netDeviceOption,
+    int level) {
+  if (level < 2) {
+    return;
+  }
+  opt::fuseConvRelu(nn, netDeviceOption);
+  opt::fuseFCRelu(nn, netDeviceOption);
+  // FusedElementwise only runs on float tensors, which can't be checked here,
+  // so elementwise chains are only fused on request.
+  opt::fuseElementwiseChains(nn, netDeviceOption);
+}
+
 NetDef optimize(NetDef net, Workspace* ws, int level) {
   auto nn = convertToNNModule(net);
   graphOptimzations(&nn, level);
   workspaceOptimizations(&nn, ws, level);
+  cpuFusionOptimizations(&nn, net.device_option(), level);
   return convertToCaffe2Proto(nn, net);
 }
 
 NetDef optimize(NetDef net, int level) {
   auto nn = convertToNNModule(net);
   graphOptimzations(&nn, level);
+  cpuFusionOptimizations(&nn, net.device_option(), level);
   return convertToCaffe2Proto(nn, net);
 }
 
@@ -8,6 +8,8 @@
 namespace caffe2 {
 namespace opt {
 
+// Level 1 folds BatchNorm into Conv (with a workspace). Level 2 also fuses
+// Relu into CPU Conv and FC and chains of float CPU elementwise operators.
 CAFFE2_API NetDef optimize(NetDef net, Workspace* ws, int level = 1);
 CAFFE2_API NetDef optimize(NetDef net, int level = 1);
 
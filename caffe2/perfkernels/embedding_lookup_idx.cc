@@ -4,6 +4,7 @@
 #include "caffe2/core/common.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/perfkernels/common.h"
+#include "caffe2/perfkernels/embedding_lookup_idx_jit.h"
 
 namespace caffe2 {
 
@@ -74,6 +75,38 @@ static bool EmbeddingLookupGenericSlowIdx(
   return current == index_size;
 }
 
+// Runtime generated kernels only exist where the AVX2 kernels are built.
+template <typename IndexType, typename InType, bool IS_WEIGHT_POSITIONAL>
+static bool EmbeddingLookupIdxJitDispatch(
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int64_t* offsets,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out,
+    bool* success) {
+#ifdef CAFFE2_PERF_WITH_AVX2
+  return EmbeddingLookupIdxJit<IndexType, InType, IS_WEIGHT_POSITIONAL>(
+      block_size,
+      output_size,
+      index_size,
+      data_size,
+      input,
+      indices,
+      offsets,
+      weights,
+      normalize_by_lengths,
+      out,
+      success);
+#else
+  return false;
+#endif
+}
+
 // Proxy back to generic implementation
 #define EMBEDDING_IDX_SPECIALIZATION(                                                                 \
     IndexType, InTypeName, InType, OutType, IS_WEIGHT_POSITIONAL)                                     \
@@ -128,6 +161,21 @@ static bool EmbeddingLookupGenericSlowIdx(
     } else {                                                                                          \
       CAFFE_ENFORCE(scale_bias == nullptr, "scale_bias must be nullptr");                             \
     }                                                                                                 \
+    bool success;                                                                                     \
+    if (EmbeddingLookupIdxJitDispatch<IndexType, InType, IS_WEIGHT_POSITIONAL>(                       \
+            block_size,                                                                               \
+            output_size,                                                                              \
+            index_size,                                                                               \
+            data_size,                                                                                \
+            input,                                                                                    \
+            indices,                                                                                  \
+            offsets,                                                                                  \
+            weights,                                                                                  \
+            normalize_by_lengths,                                                                     \
+            out,                                                                                      \
+            &success)) {                                                                              \
+      return success;                                                                                 \
+    }                                                                                                 \
     AVX2_FMA_DO(                                                                                      \
         EmbeddingLookupIdx_##IndexType##_##InTypeName##_##OutType##_##IS_WEIGHT_POSITIONAL,           \
         block_size,                                                                                   \
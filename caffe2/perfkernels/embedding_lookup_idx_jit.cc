@@ -0,0 +1,599 @@
+#include "caffe2/perfkernels/embedding_lookup_idx_jit.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <c10/util/Flags.h>
+#include <c10/util/Half.h>
+#include "caffe2/core/logging.h"
+#include "caffe2/utils/cpuid.h"
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#define CAFFE2_EMBEDDING_LOOKUP_JIT
+#endif
+
+C10_DEFINE_bool(
+    caffe2_embedding_lookup_jit,
+    true,
+    "If set, embedding lookups with a block size that has no offline "
+    "generated AVX2 kernel use a kernel generated at runtime.");
+
+namespace caffe2 {
+
+#ifdef CAFFE2_EMBEDDING_LOOKUP_JIT
+
+namespace {
+
+// Generated kernels reduce a single segment:
+//   out[0:block_size] = scale * sum_i weights[i] * input[indices[i]]
+// for i in [0, length), weights being ignored if the kernel was generated
+// without them. Returns false if an index is out of [0, data_size).
+// Arguments are passed following the System V AMD64 ABI: length in rdi,
+// indices in rsi, weights in rdx, input in rcx, data_size in r8, out in r9
+// and scale in xmm0.
+template <typename IndexType, typename InType>
+using SegmentKernel = bool (*)(
+    int64_t length,
+    const IndexType* indices,
+    const float* weights,
+    const InType* input,
+    int64_t data_size,
+    float* out,
+    float scale);
+
+enum Reg : int {
+  rax = 0,
+  rcx = 1,
+  rdx = 2,
+  rsi = 6,
+  rdi = 7,
+  r8 = 8,
+  r9 = 9,
+  r10 = 10,
+  r11 = 11,
+};
+
+// [base + index * scale + disp], or [rip + disp] to a label if rip is set.
+struct Mem {
+  int base;
+  int index;
+  int scale;
+  int32_t disp;
+  bool rip;
+  int label;
+};
+
+Mem ptr(int base, int32_t disp = 0) {
+  return Mem{base, -1, 1, disp, false, -1};
+}
+
+Mem ptr(int base, int index, int scale, int32_t disp = 0) {
+  return Mem{base, index, scale, disp, false, -1};
+}
+
+Mem ripPtr(int label) {
+  return Mem{-1, -1, 1, 0, true, label};
+}
+
+// Just enough of an x86-64 assembler for the kernels below: a few
+// general-purpose instructions and the VEX encoded AVX/AVX2/FMA/F16C
+// instructions on xmm/ymm registers they use. Memory operands always use a
+// SIB byte and a 32-bit displacement, which avoids the special cases of the
+// ModRM encoding at the price of a few bytes.
+class Assembler {
+ public:
+  int newLabel() {
+    labels_.push_back(-1);
+    return labels_.size() - 1;
+  }
+
+  void bind(int label) {
+    labels_[label] = code_.size();
+  }
+
+  void align(size_t alignment) {
+    while (code_.size() % alignment) {
+      byte(0xCC);
+    }
+  }
+
+  void data(const void* src, size_t size) {
+    auto p = static_cast<const uint8_t*>(src);
+    code_.insert(code_.end(), p, p + size);
+  }
+
+  // General purpose instructions, on 64-bit registers.
+  void xor_(int dst, int src) {
+    rrOp(0x31, src, dst);
+  }
+  void add(int dst, int src) {
+    rrOp(0x01, src, dst);
+  }
+  // Sets the flags for a - b.
+  void cmp(int a, int b) {
+    rrOp(0x39, b, a);
+  }
+  void imul(int dst, int src, int32_t imm) {
+    rrOp(0x69, dst, src);
+    imm32(imm);
+  }
+  void inc(int reg) {
+    rrOp(0xFF, 0, reg);
+  }
+  void mov(int dst, const Mem& m) {
+    rmOp(0x8B, dst, m);
+  }
+  void movsxd(int dst, const Mem& m) {
+    rmOp(0x63, dst, m);
+  }
+  void movEax(int32_t imm) {
+    byte(0xB8);
+    imm32(imm);
+  }
+  void ret() {
+    byte(0xC3);
+  }
+  void vzeroupper() {
+    byte(0xC5);
+    byte(0xF8);
+    byte(0x77);
+  }
+  void jmp(int label) {
+    byte(0xE9);
+    rel32(label);
+  }
+  // Signed >=
+  void jge(int label) {
+    jcc(0x8D, label);
+  }
+  // Unsigned >=
+  void jae(int label) {
+    jcc(0x83, label);
+  }
+
+  // VEX encoded instructions on ymm registers unless noted otherwise.
+  void vxorps(int dst, int a, int b) {
+    vexRR(0x57, kNoPrefix, k0F, dst, a, b);
+  }
+  void vaddps(int dst, int a, int b) {
+    vexRR(0x58, kNoPrefix, k0F, dst, a, b);
+  }
+  void vaddps(int dst, int a, const Mem& m) {
+    vexRM(0x58, kNoPrefix, k0F, dst, a, m);
+  }
+  void vmulps(int dst, int a, int b) {
+    vexRR(0x59, kNoPrefix, k0F, dst, a, b);
+  }
+  void vfmadd231ps(int dst, int a, int b) {
+    vexRR(0xB8, k66, k0F38, dst, a, b);
+  }
+  void vfmadd231ps(int dst, int a, const Mem& m) {
+    vexRM(0xB8, k66, k0F38, dst, a, m);
+  }
+  // Broadcasts the low float of xmm src.
+  void vbroadcastss(int dst, int src) {
+    vexRR(0x18, k66, k0F38, dst, 0, src);
+  }
+  void vbroadcastss(int dst, const Mem& m) {
+    vexRM(0x18, k66, k0F38, dst, 0, m);
+  }
+  void vmovups(int dst, const Mem& m) {
+    vexRM(0x10, kNoPrefix, k0F, dst, 0, m);
+  }
+  void vmovups(const Mem& m, int src) {
+    vexRM(0x11, kNoPrefix, k0F, src, 0, m);
+  }
+  void vmaskmovps(int dst, int mask, const Mem& m) {
+    vexRM(0x2C, k66, k0F38, dst, mask, m);
+  }
+  void vmaskmovps(const Mem& m, int mask, int src) {
+    vexRM(0x2E, k66, k0F38, src, mask, m);
+  }
+  // Converts 8 halves from memory.
+  void vcvtph2ps(int dst, const Mem& m) {
+    vexRM(0x13, k66, k0F38, dst, 0, m);
+  }
+  // Converts the 8 halves of xmm src.
+  void vcvtph2ps(int dst, int src) {
+    vexRR(0x13, k66, k0F38, dst, 0, src);
+  }
+  // xmm dst = xmm a with word i replaced.
+  void vpinsrw(int dst, int a, const Mem& m, int i) {
+    vexRM(0xC4, k66, k0F, dst, a, m, /* l = */ false);
+    byte(i);
+  }
+
+  // Copies the code to executable memory. Returns nullptr on failure.
+  void* finalize() {
+    for (const auto& fixup : fixups_) {
+      CAFFE_ENFORCE_GE(labels_[fixup.label], 0, "Unbound label");
+      int32_t rel = labels_[fixup.label] - fixup.end;
+      memcpy(&code_[fixup.pos], &rel, sizeof(rel));
+    }
+    const size_t page = sysconf(_SC_PAGESIZE);
+    const size_t size = (code_.size() + page - 1) / page * page;
+    void* mem = mmap(
+        nullptr,
+        size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    if (mem == MAP_FAILED) {
+      return nullptr;
+    }
+    memcpy(mem, code_.data(), code_.size());
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+      munmap(mem, size);
+      return nullptr;
+    }
+    return mem;
+  }
+
+ private:
+  enum Prefix { kNoPrefix = 0, k66 = 1 };
+  enum OpcodeMap { k0F = 1, k0F38 = 2 };
+
+  struct Fixup {
+    size_t pos; // of the 32-bit displacement
+    size_t end; // of the instruction, which rip is relative to
+    int label;
+  };
+
+  void byte(int b) {
+    code_.push_back(static_cast<uint8_t>(b));
+  }
+
+  void imm32(int32_t imm) {
+    data(&imm, sizeof(imm));
+  }
+
+  void rel32(int label) {
+    fixups_.push_back({code_.size(), code_.size() + 4, label});
+    imm32(0);
+  }
+
+  void jcc(int cc, int label) {
+    byte(0x0F);
+    byte(cc);
+    rel32(label);
+  }
+
+  void rex(int reg, int index, int base) {
+    byte(0x48 | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3));
+  }
+
+  // opcode with a register operand in ModRM.rm
+  void rrOp(int opcode, int reg, int rm) {
+    rex(reg, 0, rm);
+    byte(opcode);
+    byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+  }
+
+  void rmOp(int opcode, int reg, const Mem& m) {
+    rex(reg, m.index < 0 ? 0 : m.index, m.rip ? 0 : m.base);
+    byte(opcode);
+    modrm(reg, m);
+  }
+
+  void modrm(int reg, const Mem& m) {
+    if (m.rip) {
+      byte(((reg & 7) << 3) | 0x05);
+      // Nothing follows the displacement in the instructions using rip
+      // relative operands.
+      rel32(m.label);
+      return;
+    }
+    int ss = m.scale == 8 ? 3 : m.scale == 4 ? 2 : m.scale == 2 ? 1 : 0;
+    byte(0x80 | ((reg & 7) << 3) | 0x04);
+    byte((ss << 6) | ((m.index < 0 ? 4 : m.index & 7) << 3) | (m.base & 7));
+    imm32(m.disp);
+  }
+
+  // Three-byte VEX prefix, W0. vvvv is the extra source register, 0 when
+  // the instruction doesn't have one.
+  void vex(int pp, int map, bool l, int reg, int vvvv, int index, int base) {
+    byte(0xC4);
+    byte(
+        ((~reg >> 3) & 1) << 7 | ((~index >> 3) & 1) << 6 |
+        ((~base >> 3) & 1) << 5 | map);
+    byte(((~vvvv & 15) << 3) | (l ? 4 : 0) | pp);
+  }
+
+  void vexRR(int opcode, int pp, int map, int reg, int vvvv, int rm) {
+    vex(pp, map, true, reg, vvvv, 0, rm);
+    byte(opcode);
+    byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+  }
+
+  void vexRM(
+      int opcode,
+      int pp,
+      int map,
+      int reg,
+      int vvvv,
+      const Mem& m,
+      bool l = true) {
+    vex(pp, map, l, reg, vvvv, m.index < 0 ? 0 : m.index, m.rip ? 0 : m.base);
+    byte(opcode);
+    modrm(reg, m);
+  }
+
+  std::vector<uint8_t> code_;
+  std::vector<int> labels_;
+  std::vector<Fixup> fixups_;
+};
+
+// Register allocation of the generated kernels.
+constexpr int kNumAccumulators = 12; // ymm0 - ymm11
+constexpr int kScale = 12;
+constexpr int kTailMask = 13;
+constexpr int kTmp = 14;
+constexpr int kWeight = 15;
+
+// The output row is processed in chunks of up to kNumAccumulators vectors of
+// 8 floats. For each chunk the kernel walks the indices of the segment and
+// accumulates the corresponding slice of the input rows in registers, then
+// scales and stores it. A partial last vector is loaded and stored with a
+// mask for float input, and assembled with word inserts for fp16 input so
+// that nothing past the end of a row is read.
+template <typename IndexType, typename InType>
+void* generateSegmentKernel(int64_t block_size, bool has_weights) {
+  constexpr bool kHalf = std::is_same<InType, at::Half>::value;
+  constexpr int kInSize = sizeof(InType);
+
+  Assembler a;
+  const int fail = a.newLabel();
+  const int mask_data = a.newLabel();
+  const int64_t num_vectors = (block_size + 7) / 8;
+  const int tail = block_size % 8;
+
+  a.vbroadcastss(kScale, 0);
+  if (tail) {
+    a.vmovups(kTailMask, ripPtr(mask_data));
+  }
+
+  for (int64_t chunk = 0; chunk < num_vectors; chunk += kNumAccumulators) {
+    const int n = std::min<int64_t>(kNumAccumulators, num_vectors - chunk);
+    const int loop = a.newLabel();
+    const int done = a.newLabel();
+
+    for (int v = 0; v < n; ++v) {
+      a.vxorps(v, v, v);
+    }
+    a.xor_(r10, r10);
+    a.bind(loop);
+    a.cmp(r10, rdi);
+    a.jge(done);
+    if (sizeof(IndexType) == 4) {
+      a.movsxd(r11, ptr(rsi, r10, 4));
+    } else {
+      a.mov(r11, ptr(rsi, r10, 8));
+    }
+    // Negative indices fail the unsigned comparison too.
+    a.cmp(r11, r8);
+    a.jae(fail);
+    a.imul(r11, r11, block_size * kInSize);
+    a.add(r11, rcx);
+    if (has_weights) {
+      a.vbroadcastss(kWeight, ptr(rdx, r10, 4));
+    }
+    for (int v = 0; v < n; ++v) {
+      const int64_t vector = chunk + v;
+      const int32_t offset = vector * 8 * kInSize;
+      const bool partial = tail && vector == num_vectors - 1;
+      if (!kHalf && !partial) {
+        if (has_weights) {
+          a.vfmadd231ps(v, kWeight, ptr(r11, offset));
+        } else {
+          a.vaddps(v, v, ptr(r11, offset));
+        }
+        continue;
+      }
+      if (!kHalf) {
+        a.vmaskmovps(kTmp, kTailMask, ptr(r11, offset));
+      } else if (!partial) {
+        a.vcvtph2ps(kTmp, ptr(r11, offset));
+      } else {
+        a.vxorps(kTmp, kTmp, kTmp);
+        for (int i = 0; i < tail; ++i) {
+          a.vpinsrw(kTmp, kTmp, ptr(r11, offset + 2 * i), i);
+        }
+        a.vcvtph2ps(kTmp, kTmp);
+      }
+      if (has_weights) {
+        a.vfmadd231ps(v, kWeight, kTmp);
+      } else {
+        a.vaddps(v, v, kTmp);
+      }
+    }
+    a.inc(r10);
+    a.jmp(loop);
+
+    a.bind(done);
+    for (int v = 0; v < n; ++v) {
+      const int64_t vector = chunk + v;
+      const int32_t offset = vector * 8 * sizeof(float);
+      a.vmulps(v, v, kScale);
+      if (tail && vector == num_vectors - 1) {
+        a.vmaskmovps(ptr(r9, offset), kTailMask, v);
+      } else {
+        a.vmovups(ptr(r9, offset), v);
+      }
+    }
+  }
+  a.movEax(1);
+  a.vzeroupper();
+  a.ret();
+
+  a.bind(fail);
+  a.movEax(0);
+  a.vzeroupper();
+  a.ret();
+
+  if (tail) {
+    a.align(32);
+    a.bind(mask_data);
+    int32_t mask[8];
+    for (int i = 0; i < 8; ++i) {
+      mask[i] = i < tail ? -1 : 0;
+    }
+    a.data(mask, sizeof(mask));
+  }
+  return a.finalize();
+}
+
+// Block sizes with a fully unrolled kernel in embedding_lookup_idx_avx2.cc,
+// see hp_emblookup_codegen.py.
+bool hasOfflineKernel(int64_t block_size) {
+  return block_size == 128 || block_size == 64 || block_size == 32 ||
+      block_size == 16;
+}
+
+template <typename IndexType, typename InType>
+SegmentKernel<IndexType, InType> getSegmentKernel(
+    int64_t block_size,
+    bool has_weights) {
+  static std::mutex mutex;
+  static std::map<std::tuple<int64_t, bool>, void*> cache;
+
+  std::lock_guard<std::mutex> guard(mutex);
+  auto key = std::make_tuple(block_size, has_weights);
+  auto it = cache.find(key);
+  if (it == cache.end()) {
+    // A failed generation is cached too, as nullptr.
+    it = cache
+             .emplace(
+                 key,
+                 generateSegmentKernel<IndexType, InType>(
+                     block_size, has_weights))
+             .first;
+  }
+  return reinterpret_cast<SegmentKernel<IndexType, InType>>(it->second);
+}
+
+template <typename InType>
+bool jitSupported(int64_t block_size) {
+  return FLAGS_caffe2_embedding_lookup_jit &&
+      (std::is_same<InType, float>::value ||
+       std::is_same<InType, at::Half>::value) &&
+      block_size > 0 && !hasOfflineKernel(block_size) &&
+      block_size * static_cast<int64_t>(sizeof(float)) <= (1 << 30) &&
+      GetCpuId().avx2() && GetCpuId().fma() && GetCpuId().f16c();
+}
+
+} // namespace
+
+template <typename IndexType, typename InType, bool IS_WEIGHT_POSITIONAL>
+bool EmbeddingLookupIdxJit(
+    const int64_t block_size,
+    const int64_t output_size,
+    const int64_t index_size,
+    const int64_t data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int64_t* offsets,
+    const float* weights,
+    bool normalize_by_lengths,
+    float* out,
+    bool* success) {
+  if (!jitSupported<InType>(block_size)) {
+    return false;
+  }
+  auto kernel =
+      getSegmentKernel<IndexType, InType>(block_size, weights != nullptr);
+  if (!kernel) {
+    return false;
+  }
+
+  *success = false;
+  int64_t current = 0;
+  for (int64_t m = 0; m < output_size; ++m) {
+    if (current != offsets[m]) {
+      return true;
+    }
+    int64_t end_offset = (m == output_size - 1 ? index_size : offsets[m + 1]);
+    if (end_offset > index_size) {
+      return true;
+    }
+    int64_t length = end_offset - current;
+    float scale = normalize_by_lengths && length > 0 ? 1.f / length : 1.f;
+    const float* segment_weights = nullptr;
+    if (weights) {
+      segment_weights = IS_WEIGHT_POSITIONAL ? weights : weights + current;
+    }
+    if (!kernel(
+            length,
+            indices + current,
+            segment_weights,
+            input,
+            data_size,
+            out + m * block_size,
+            scale)) {
+      return true;
+    }
+    current = std::max(current, end_offset);
+  }
+  *success = current == index_size;
+  return true;
+}
+
+#else // CAFFE2_EMBEDDING_LOOKUP_JIT
+
+template <typename IndexType, typename InType, bool IS_WEIGHT_POSITIONAL>
+bool EmbeddingLookupIdxJit(
+    const int64_t /* block_size */,
+    const int64_t /* output_size */,
+    const int64_t /* index_size */,
+    const int64_t /* data_size */,
+    const InType* /* input */,
+    const IndexType* /* indices */,
+    const int64_t* /* offsets */,
+    const float* /* weights */,
+    bool /* normalize_by_lengths */,
+    float* /* out */,
+    bool* /* success */) {
+  return false;
+}
+
+#endif // CAFFE2_EMBEDDING_LOOKUP_JIT
+
+#define EMBEDDING_IDX_JIT_INSTANTIATION(                                        \
+    IndexType, InType, IS_WEIGHT_POSITIONAL)                                    \
+  template bool EmbeddingLookupIdxJit<IndexType, InType, IS_WEIGHT_POSITIONAL>( \
+      const int64_t block_size,                                                 \
+      const int64_t output_size,                                                \
+      const int64_t index_size,                                                 \
+      const int64_t data_size,                                                  \
+      const InType* input,                                                      \
+      const IndexType* indices,                                                 \
+      const int64_t* offsets,                                                   \
+      const float* weights,                                                     \
+      bool normalize_by_lengths,                                                \
+      float* out,                                                               \
+      bool* success);
+
+EMBEDDING_IDX_JIT_INSTANTIATION(int32_t, float, false);
+EMBEDDING_IDX_JIT_INSTANTIATION(int64_t, float, false);
+EMBEDDING_IDX_JIT_INSTANTIATION(int32_t, at::Half, false);
+EMBEDDING_IDX_JIT_INSTANTIATION(int64_t, at::Half, false);
+EMBEDDING_IDX_JIT_INSTANTIATION(int32_t, uint8_t, false);
+EMBEDDING_IDX_JIT_INSTANTIATION(int64_t, uint8_t, false);
+
+EMBEDDING_IDX_JIT_INSTANTIATION(int32_t, float, true);
+EMBEDDING_IDX_JIT_INSTANTIATION(int64_t, float, true);
+EMBEDDING_IDX_JIT_INSTANTIATION(int32_t, at::Half, true);
+EMBEDDING_IDX_JIT_INSTANTIATION(int64_t, at::Half, true);
+EMBEDDING_IDX_JIT_INSTANTIATION(int32_t, uint8_t, true);
+EMBEDDING_IDX_JIT_INSTANTIATION(int64_t, uint8_t, true);
+
+#undef EMBEDDING_IDX_JIT_INSTANTIATION
+
+} // namespace caffe2
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+namespace caffe2 {
+
+/**
+ * Embedding lookup with reduction, using a kernel generated at runtime and
+ * specialized for block_size, the index and input types and the presence of
+ * weights. Same contract as EmbeddingLookupIdx.
+ *
+ * embedding_lookup_idx_avx2.cc only has fully unrolled kernels for the block
+ * sizes listed in hp_emblookup_codegen.py, every other block size goes
+ * through a loop that reloads and stores the output at every index. The
+ * generated kernels keep the output in registers for any block size.
+ * Kernels are generated once per signature and cached for the lifetime of
+ * the process.
+ *
+ * @return false if no kernel is available for this configuration (non-x86-64
+ * host, CPU without AVX2/FMA/F16C, uint8 input, block size already covered
+ * by the offline generated kernels, or the caffe2_embedding_lookup_jit flag
+ * is off). Otherwise the lookup ran and *success is set like the return
+ * value of the other implementations (false on out-of-bound index).
+ */
+template <typename IndexType, typename InType, bool IS_WEIGHT_POSITIONAL>
+bool EmbeddingLookupIdxJit(
+    const std::int64_t block_size,
+    const std::int64_t output_size,
+    const std::int64_t index_size,
+    const std::int64_t data_size,
+    const InType* input,
+    const IndexType* indices,
+    const int64_t* offsets,
+    const float* weights, // optional, can be null for non-weighted sum
+    bool normalize_by_lengths,
+    float* out,
+    bool* success);
+
+} // namespace caffe2
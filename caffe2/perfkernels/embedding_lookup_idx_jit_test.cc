@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <c10/util/Flags.h>
+#include <c10/util/Half.h>
+#include "caffe2/perfkernels/embedding_lookup_idx_jit.h"
+
+C10_DECLARE_bool(caffe2_embedding_lookup_jit);
+
+namespace caffe2 {
+
+// Base (EmbeddingLookupGenericSlowIdx) implementations, defined in
+// embedding_lookup_idx.cc.
+#define DECLARE_EMBEDDING_IDX_BASE(                                          \
+    IndexType, InTypeName, InType, IS_WEIGHT_POSITIONAL)                     \
+  bool                                                                       \
+      EmbeddingLookupIdx_##IndexType##_##InTypeName##_float_##IS_WEIGHT_POSITIONAL##__base( \
+          const int64_t block_size,                                          \
+          const int64_t output_size,                                         \
+          const int64_t index_size,                                          \
+          const int64_t data_size,                                           \
+          const InType* input,                                               \
+          const IndexType* indices,                                          \
+          const int64_t* offsets,                                            \
+          const float* weights,                                              \
+          const float* scale_bias,                                           \
+          bool normalize_by_lengths,                                         \
+          float* out);                                                       \
+  template <>                                                                \
+  struct ReferenceLookup<IndexType, InType, IS_WEIGHT_POSITIONAL> {          \
+    static constexpr auto fn =                                               \
+        &EmbeddingLookupIdx_##IndexType##_##InTypeName##_float_##IS_WEIGHT_POSITIONAL##__base; \
+  }
+
+template <typename IndexType, typename InType, bool IS_WEIGHT_POSITIONAL>
+struct ReferenceLookup;
+
+DECLARE_EMBEDDING_IDX_BASE(int32_t, float, float, false);
+DECLARE_EMBEDDING_IDX_BASE(int64_t, float, float, false);
+DECLARE_EMBEDDING_IDX_BASE(int32_t, half, at::Half, false);
+DECLARE_EMBEDDING_IDX_BASE(int64_t, half, at::Half, false);
+DECLARE_EMBEDDING_IDX_BASE(int32_t, float, float, true);
+DECLARE_EMBEDDING_IDX_BASE(int64_t, float, float, true);
+DECLARE_EMBEDDING_IDX_BASE(int32_t, half, at::Half, true);
+DECLARE_EMBEDDING_IDX_BASE(int64_t, half, at::Half, true);
+
+#undef DECLARE_EMBEDDING_IDX_BASE
+
+namespace {
+
+// Block sizes below, at and above a multiple of the vector width, as well as
+// sizes that need more than one pass over the indices of a segment.
+const int64_t kBlockSizes[] = {1, 7, 8, 9, 95, 96, 97, 200};
+
+// Segment lengths, including empty ones in the middle and at the end.
+const std::vector<int64_t> kLengths = {3, 0, 5, 1, 0, 7, 2, 0};
+
+constexpr int64_t kDataSize = 50;
+
+class EmbeddingLookupIdxJitTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    prev_flag_ = FLAGS_caffe2_embedding_lookup_jit;
+    FLAGS_caffe2_embedding_lookup_jit = true;
+  }
+
+  void TearDown() override {
+    FLAGS_caffe2_embedding_lookup_jit = prev_flag_;
+  }
+
+  // Runs the generated kernel and the base implementation on the same inputs
+  // and compares them. bad_index, if set, replaces one of the indices.
+  template <typename IndexType, typename InType, bool IS_WEIGHT_POSITIONAL>
+  void check(
+      int64_t block_size,
+      bool use_weights,
+      bool normalize_by_lengths,
+      IndexType bad_index = 0,
+      bool use_bad_index = false) {
+    std::mt19937 gen(block_size);
+    std::uniform_real_distribution<float> value(-1.f, 1.f);
+    std::uniform_int_distribution<int64_t> row(0, kDataSize - 1);
+
+    std::vector<InType> input(kDataSize * block_size);
+    for (auto& v : input) {
+      v = InType(value(gen));
+    }
+    std::vector<int64_t> offsets;
+    int64_t index_size = 0;
+    for (int64_t length : kLengths) {
+      offsets.push_back(index_size);
+      index_size += length;
+    }
+    int64_t output_size = offsets.size();
+    std::vector<IndexType> indices(index_size);
+    for (auto& i : indices) {
+      i = row(gen);
+    }
+    if (use_bad_index) {
+      indices[index_size / 2] = bad_index;
+    }
+    std::vector<float> weights(index_size);
+    for (auto& w : weights) {
+      w = value(gen);
+    }
+    const float* weights_ptr = use_weights ? weights.data() : nullptr;
+
+    std::vector<float> expected(output_size * block_size);
+    bool expected_success =
+        ReferenceLookup<IndexType, InType, IS_WEIGHT_POSITIONAL>::fn(
+            block_size,
+            output_size,
+            index_size,
+            kDataSize,
+            input.data(),
+            indices.data(),
+            offsets.data(),
+            weights_ptr,
+            nullptr,
+            normalize_by_lengths,
+            expected.data());
+
+    std::vector<float> actual(output_size * block_size, NAN);
+    bool success;
+    if (!EmbeddingLookupIdxJit<IndexType, InType, IS_WEIGHT_POSITIONAL>(
+            block_size,
+            output_size,
+            index_size,
+            kDataSize,
+            input.data(),
+            indices.data(),
+            offsets.data(),
+            weights_ptr,
+            normalize_by_lengths,
+            actual.data(),
+            &success)) {
+      // No generated kernels on this host
+      return;
+    }
+
+    ASSERT_EQ(success, expected_success) << "block_size " << block_size;
+    if (!expected_success) {
+      return;
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_NEAR(actual[i], expected[i], 1e-5 * (1 + std::abs(expected[i])))
+          << "block_size " << block_size << ", element " << i;
+    }
+  }
+
+  template <typename IndexType, typename InType, bool IS_WEIGHT_POSITIONAL>
+  void checkAll() {
+    for (int64_t block_size : kBlockSizes) {
+      for (bool use_weights : {false, true}) {
+        for (bool normalize_by_lengths : {false, true}) {
+          check<IndexType, InType, IS_WEIGHT_POSITIONAL>(
+              block_size, use_weights, normalize_by_lengths);
+        }
+      }
+      for (IndexType bad_index : {IndexType(-1), IndexType(kDataSize)}) {
+        check<IndexType, InType, IS_WEIGHT_POSITIONAL>(
+            block_size, true, false, bad_index, true);
+      }
+    }
+  }
+
+ private:
+  bool prev_flag_;
+};
+
+} // namespace
+
+TEST_F(EmbeddingLookupIdxJitTest, Int32Float) {
+  checkAll<int32_t, float, false>();
+}
+
+TEST_F(EmbeddingLookupIdxJitTest, Int64Float) {
+  checkAll<int64_t, float, false>();
+}
+
+TEST_F(EmbeddingLookupIdxJitTest, Int32Half) {
+  checkAll<int32_t, at::Half, false>();
+}
+
+TEST_F(EmbeddingLookupIdxJitTest, Int64Half) {
+  checkAll<int64_t, at::Half, false>();
+}
+
+TEST_F(EmbeddingLookupIdxJitTest, Int32FloatPositionalWeights) {
+  checkAll<int32_t, float, true>();
+}
+
+TEST_F(EmbeddingLookupIdxJitTest, Int64FloatPositionalWeights) {
+  checkAll<int64_t, float, true>();
+}
+
+TEST_F(EmbeddingLookupIdxJitTest, Int32HalfPositionalWeights) {
+  checkAll<int32_t, at::Half, true>();
+}
+
+TEST_F(EmbeddingLookupIdxJitTest, Int64HalfPositionalWeights) {
+  checkAll<int64_t, at::Half, true>();
+}
+
+} // namespace caffe2
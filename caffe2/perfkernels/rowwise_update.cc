@@ -0,0 +1,218 @@
+#include "caffe2/perfkernels/rowwise_update.h"
+
+#include <cmath>
+
+#include "caffe2/perfkernels/common.h"
+
+namespace caffe2 {
+
+namespace {
+template <typename MomentT>
+void rowwise_adam_update_row_base(
+    int N,
+    float* w,
+    const float* g,
+    MomentT* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  float m2_sum = 0.f;
+  for (auto j = 0; j < N; ++j) {
+    m2_sum += g[j] * g[j];
+  }
+  const float vi = *m2 = *m2 * beta2 + (m2_sum / N) * (1 - beta2);
+  const float scale = correction / (std::sqrt(vi) + epsilon);
+  for (auto j = 0; j < N; ++j) {
+    const float mi = beta1 * static_cast<float>(m1[j]) + (1 - beta1) * g[j];
+    m1[j] = mi;
+    const float ngi = scale * mi;
+    if (ng) {
+      ng[j] = ngi;
+    }
+    w[j] += lr * ngi;
+  }
+}
+} // namespace
+
+void rowwise_adagrad_update_row__base(
+    int N,
+    float* w,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr) {
+  float sum = 0.f;
+  for (auto j = 0; j < N; ++j) {
+    sum += g[j] * g[j];
+  }
+  const float hi = *h = *h + sum / N;
+  const float step = lr / (std::sqrt(hi) + epsilon);
+  for (auto j = 0; j < N; ++j) {
+    w[j] += g[j] * step;
+  }
+}
+
+void rowwise_adam_update_row__base(
+    int N,
+    float* w,
+    const float* g,
+    float* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  rowwise_adam_update_row_base(
+      N, w, g, m1, m2, beta1, beta2, epsilon, correction, lr, ng);
+}
+
+void rowwise_adam_fp16_update_row__base(
+    int N,
+    float* w,
+    const float* g,
+    at::Half* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  rowwise_adam_update_row_base(
+      N, w, g, m1, m2, beta1, beta2, epsilon, correction, lr, ng);
+}
+
+decltype(rowwise_adagrad_update_row__base) rowwise_adagrad_update_row__avx512;
+decltype(
+    rowwise_adagrad_update_row__base) rowwise_adagrad_update_row__avx2_fma;
+void rowwise_adagrad_update_row(
+    int N,
+    float* w,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr) {
+  AVX512_DO(rowwise_adagrad_update_row, N, w, g, h, epsilon, lr);
+  AVX2_FMA_DO(rowwise_adagrad_update_row, N, w, g, h, epsilon, lr);
+  BASE_DO(rowwise_adagrad_update_row, N, w, g, h, epsilon, lr);
+}
+
+decltype(rowwise_adam_update_row__base) rowwise_adam_update_row__avx512;
+decltype(rowwise_adam_update_row__base) rowwise_adam_update_row__avx2_fma;
+void rowwise_adam_update_row(
+    int N,
+    float* w,
+    const float* g,
+    float* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  AVX512_DO(
+      rowwise_adam_update_row,
+      N,
+      w,
+      g,
+      m1,
+      m2,
+      beta1,
+      beta2,
+      epsilon,
+      correction,
+      lr,
+      ng);
+  AVX2_FMA_DO(
+      rowwise_adam_update_row,
+      N,
+      w,
+      g,
+      m1,
+      m2,
+      beta1,
+      beta2,
+      epsilon,
+      correction,
+      lr,
+      ng);
+  BASE_DO(
+      rowwise_adam_update_row,
+      N,
+      w,
+      g,
+      m1,
+      m2,
+      beta1,
+      beta2,
+      epsilon,
+      correction,
+      lr,
+      ng);
+}
+
+decltype(
+    rowwise_adam_fp16_update_row__base) rowwise_adam_fp16_update_row__avx512;
+decltype(
+    rowwise_adam_fp16_update_row__base) rowwise_adam_fp16_update_row__avx2_fma;
+void rowwise_adam_fp16_update_row(
+    int N,
+    float* w,
+    const float* g,
+    at::Half* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  AVX512_DO(
+      rowwise_adam_fp16_update_row,
+      N,
+      w,
+      g,
+      m1,
+      m2,
+      beta1,
+      beta2,
+      epsilon,
+      correction,
+      lr,
+      ng);
+  AVX2_FMA_DO(
+      rowwise_adam_fp16_update_row,
+      N,
+      w,
+      g,
+      m1,
+      m2,
+      beta1,
+      beta2,
+      epsilon,
+      correction,
+      lr,
+      ng);
+  BASE_DO(
+      rowwise_adam_fp16_update_row,
+      N,
+      w,
+      g,
+      m1,
+      m2,
+      beta1,
+      beta2,
+      epsilon,
+      correction,
+      lr,
+      ng);
+}
+
+} // namespace caffe2
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <c10/util/Half.h>
+
+namespace caffe2 {
+
+// Kernels updating a single row of an embedding table with a row-wise
+// optimizer, i.e. an optimizer that keeps one second moment per row. They
+// are used by the RowWiseSparse* operators once the gradient rows have been
+// gathered, so that every call touches distinct memory and calls for
+// different rows can run in parallel.
+
+// Row-wise Adagrad:
+//   h += mean(g * g)
+//   w += lr / (sqrt(h) + epsilon) * g
+void rowwise_adagrad_update_row(
+    int N,
+    float* w,
+    const float* g,
+    float* h, // one value for the whole row
+    float epsilon,
+    float lr);
+
+// Row-wise Adam, with the first moment stored per element and the second
+// moment per row:
+//   m1 = beta1 * m1 + (1 - beta1) * g
+//   m2 = beta2 * m2 + (1 - beta2) * mean(g * g)
+//   ng = correction * m1 / (sqrt(m2) + epsilon)
+//   w += lr * ng
+// ng is only written if it's not null.
+void rowwise_adam_update_row(
+    int N,
+    float* w,
+    const float* g,
+    float* m1,
+    float* m2, // one value for the whole row
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng);
+
+// Same as rowwise_adam_update_row, with the first moment stored in fp16. The
+// update itself is computed in fp32.
+void rowwise_adam_fp16_update_row(
+    int N,
+    float* w,
+    const float* g,
+    at::Half* m1,
+    float* m2, // one value for the whole row
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng);
+
+} // namespace caffe2
@@ -0,0 +1,151 @@
+#include "caffe2/perfkernels/cvtsh_ss_bugfix.h"
+
+#include <c10/util/Half.h>
+#include <immintrin.h>
+
+#include <cmath>
+
+namespace caffe2 {
+
+namespace {
+constexpr int kSize = 8;
+
+inline float sum_of_squares(int N, const float* g, int* i) {
+  __m256 acc = _mm256_setzero_ps();
+  for (; *i + kSize <= N; *i += kSize) {
+    __m256 gi = _mm256_loadu_ps(g + *i);
+    acc = _mm256_fmadd_ps(gi, gi, acc);
+  }
+  __m128 sum = _mm_add_ps(
+      _mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  sum = _mm_hadd_ps(sum, sum);
+  sum = _mm_hadd_ps(sum, sum);
+  float result = _mm_cvtss_f32(sum);
+  for (; *i < N; ++*i) {
+    result += g[*i] * g[*i];
+  }
+  return result;
+}
+
+inline __m256 load_moment(const float* m) {
+  return _mm256_loadu_ps(m);
+}
+
+inline __m256 load_moment(const at::Half* m) {
+  return _mm256_cvtph_ps(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(m)));
+}
+
+inline void store_moment(float* m, __m256 v) {
+  _mm256_storeu_ps(m, v);
+}
+
+inline void store_moment(at::Half* m, __m256 v) {
+  _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(m),
+      _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+
+template <typename MomentT>
+void rowwise_adam_update_row_avx2(
+    int N,
+    float* w,
+    const float* g,
+    MomentT* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  int i = 0;
+  const float m2_sum = sum_of_squares(N, g, &i);
+  const float vi = *m2 = *m2 * beta2 + (m2_sum / N) * (1 - beta2);
+  const float scale = correction / (std::sqrt(vi) + epsilon);
+
+  const __m256 vbeta1 = _mm256_set1_ps(beta1);
+  const __m256 vbeta1c = _mm256_set1_ps(1 - beta1);
+  const __m256 vscale = _mm256_set1_ps(scale);
+  const __m256 vlr = _mm256_set1_ps(lr);
+  for (i = 0; i + kSize <= N; i += kSize) {
+    __m256 gi = _mm256_loadu_ps(g + i);
+    __m256 mi = _mm256_fmadd_ps(
+        vbeta1, load_moment(m1 + i), _mm256_mul_ps(vbeta1c, gi));
+    store_moment(m1 + i, mi);
+    __m256 ngi = _mm256_mul_ps(vscale, mi);
+    if (ng) {
+      _mm256_storeu_ps(ng + i, ngi);
+    }
+    _mm256_storeu_ps(
+        w + i, _mm256_fmadd_ps(vlr, ngi, _mm256_loadu_ps(w + i)));
+  }
+  for (; i < N; ++i) {
+    const float mi = beta1 * static_cast<float>(m1[i]) + (1 - beta1) * g[i];
+    m1[i] = mi;
+    const float ngi = scale * mi;
+    if (ng) {
+      ng[i] = ngi;
+    }
+    w[i] += lr * ngi;
+  }
+}
+} // namespace
+
+void rowwise_adagrad_update_row__avx2_fma(
+    int N,
+    float* w,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr) {
+  int i = 0;
+  const float sum = sum_of_squares(N, g, &i);
+  const float hi = *h = *h + sum / N;
+  const float step = lr / (std::sqrt(hi) + epsilon);
+
+  const __m256 vstep = _mm256_set1_ps(step);
+  for (i = 0; i + kSize <= N; i += kSize) {
+    _mm256_storeu_ps(
+        w + i,
+        _mm256_fmadd_ps(
+            _mm256_loadu_ps(g + i), vstep, _mm256_loadu_ps(w + i)));
+  }
+  for (; i < N; ++i) {
+    w[i] += g[i] * step;
+  }
+}
+
+void rowwise_adam_update_row__avx2_fma(
+    int N,
+    float* w,
+    const float* g,
+    float* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  rowwise_adam_update_row_avx2(
+      N, w, g, m1, m2, beta1, beta2, epsilon, correction, lr, ng);
+}
+
+void rowwise_adam_fp16_update_row__avx2_fma(
+    int N,
+    float* w,
+    const float* g,
+    at::Half* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  rowwise_adam_update_row_avx2(
+      N, w, g, m1, m2, beta1, beta2, epsilon, correction, lr, ng);
+}
+
+} // namespace caffe2
@@ -0,0 +1,145 @@
+#include <c10/util/Half.h>
+#include <immintrin.h>
+
+#include <cmath>
+
+namespace caffe2 {
+
+namespace {
+constexpr int kSize = 16;
+
+inline float sum_of_squares(int N, const float* g, int* i) {
+  __m512 acc = _mm512_setzero_ps();
+  for (; *i + kSize <= N; *i += kSize) {
+    __m512 gi = _mm512_loadu_ps(g + *i);
+    acc = _mm512_fmadd_ps(gi, gi, acc);
+  }
+  float result = _mm512_reduce_add_ps(acc);
+  for (; *i < N; ++*i) {
+    result += g[*i] * g[*i];
+  }
+  return result;
+}
+
+inline __m512 load_moment(const float* m) {
+  return _mm512_loadu_ps(m);
+}
+
+inline __m512 load_moment(const at::Half* m) {
+  return _mm512_cvtph_ps(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m)));
+}
+
+inline void store_moment(float* m, __m512 v) {
+  _mm512_storeu_ps(m, v);
+}
+
+inline void store_moment(at::Half* m, __m512 v) {
+  _mm256_storeu_si256(
+      reinterpret_cast<__m256i*>(m),
+      _mm512_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+
+template <typename MomentT>
+void rowwise_adam_update_row_avx512(
+    int N,
+    float* w,
+    const float* g,
+    MomentT* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  int i = 0;
+  const float m2_sum = sum_of_squares(N, g, &i);
+  const float vi = *m2 = *m2 * beta2 + (m2_sum / N) * (1 - beta2);
+  const float scale = correction / (std::sqrt(vi) + epsilon);
+
+  const __m512 vbeta1 = _mm512_set1_ps(beta1);
+  const __m512 vbeta1c = _mm512_set1_ps(1 - beta1);
+  const __m512 vscale = _mm512_set1_ps(scale);
+  const __m512 vlr = _mm512_set1_ps(lr);
+  for (i = 0; i + kSize <= N; i += kSize) {
+    __m512 gi = _mm512_loadu_ps(g + i);
+    __m512 mi = _mm512_fmadd_ps(
+        vbeta1, load_moment(m1 + i), _mm512_mul_ps(vbeta1c, gi));
+    store_moment(m1 + i, mi);
+    __m512 ngi = _mm512_mul_ps(vscale, mi);
+    if (ng) {
+      _mm512_storeu_ps(ng + i, ngi);
+    }
+    _mm512_storeu_ps(
+        w + i, _mm512_fmadd_ps(vlr, ngi, _mm512_loadu_ps(w + i)));
+  }
+  for (; i < N; ++i) {
+    const float mi = beta1 * static_cast<float>(m1[i]) + (1 - beta1) * g[i];
+    m1[i] = mi;
+    const float ngi = scale * mi;
+    if (ng) {
+      ng[i] = ngi;
+    }
+    w[i] += lr * ngi;
+  }
+}
+} // namespace
+
+void rowwise_adagrad_update_row__avx512(
+    int N,
+    float* w,
+    const float* g,
+    float* h,
+    float epsilon,
+    float lr) {
+  int i = 0;
+  const float sum = sum_of_squares(N, g, &i);
+  const float hi = *h = *h + sum / N;
+  const float step = lr / (std::sqrt(hi) + epsilon);
+
+  const __m512 vstep = _mm512_set1_ps(step);
+  for (i = 0; i + kSize <= N; i += kSize) {
+    _mm512_storeu_ps(
+        w + i,
+        _mm512_fmadd_ps(
+            _mm512_loadu_ps(g + i), vstep, _mm512_loadu_ps(w + i)));
+  }
+  for (; i < N; ++i) {
+    w[i] += g[i] * step;
+  }
+}
+
+void rowwise_adam_update_row__avx512(
+    int N,
+    float* w,
+    const float* g,
+    float* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  rowwise_adam_update_row_avx512(
+      N, w, g, m1, m2, beta1, beta2, epsilon, correction, lr, ng);
+}
+
+void rowwise_adam_fp16_update_row__avx512(
+    int N,
+    float* w,
+    const float* g,
+    at::Half* m1,
+    float* m2,
+    float beta1,
+    float beta2,
+    float epsilon,
+    float correction,
+    float lr,
+    float* ng) {
+  rowwise_adam_update_row_avx512(
+      N, w, g, m1, m2, beta1, beta2, epsilon, correction, lr, ng);
+}
+
+} // namespace caffe2
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <c10/util/Half.h>
+#include "caffe2/core/macros.h"
+#include "caffe2/perfkernels/rowwise_update.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+// Implementations for each instruction set, defined in rowwise_update*.cc.
+decltype(rowwise_adagrad_update_row) rowwise_adagrad_update_row__base;
+decltype(rowwise_adam_update_row) rowwise_adam_update_row__base;
+decltype(rowwise_adam_fp16_update_row) rowwise_adam_fp16_update_row__base;
+#ifdef CAFFE2_PERF_WITH_AVX2
+decltype(rowwise_adagrad_update_row) rowwise_adagrad_update_row__avx2_fma;
+decltype(rowwise_adam_update_row) rowwise_adam_update_row__avx2_fma;
+decltype(rowwise_adam_fp16_update_row) rowwise_adam_fp16_update_row__avx2_fma;
+#endif
+#ifdef CAFFE2_PERF_WITH_AVX512
+decltype(rowwise_adagrad_update_row) rowwise_adagrad_update_row__avx512;
+decltype(rowwise_adam_update_row) rowwise_adam_update_row__avx512;
+decltype(rowwise_adam_fp16_update_row) rowwise_adam_fp16_update_row__avx512;
+#endif
+
+namespace {
+
+struct Kernels {
+  std::string name;
+  decltype(rowwise_adagrad_update_row)* adagrad;
+  decltype(rowwise_adam_update_row)* adam;
+  decltype(rowwise_adam_fp16_update_row)* adam_fp16;
+};
+
+// The vectorized kernels this host can run
+std::vector<Kernels> getVectorizedKernels() {
+  std::vector<Kernels> kernels;
+#ifdef CAFFE2_PERF_WITH_AVX2
+  if (GetCpuId().avx2() && GetCpuId().fma()) {
+    kernels.push_back({"avx2_fma",
+                       rowwise_adagrad_update_row__avx2_fma,
+                       rowwise_adam_update_row__avx2_fma,
+                       rowwise_adam_fp16_update_row__avx2_fma});
+  }
+#endif
+#ifdef CAFFE2_PERF_WITH_AVX512
+  if (GetCpuId().avx512f() && GetCpuId().avx512dq() &&
+      GetCpuId().avx512vl()) {
+    kernels.push_back({"avx512",
+                       rowwise_adagrad_update_row__avx512,
+                       rowwise_adam_update_row__avx512,
+                       rowwise_adam_fp16_update_row__avx512});
+  }
+#endif
+  return kernels;
+}
+
+// Row sizes below, at and above multiples of the AVX2 and AVX-512 widths
+const int kBlockSizes[] = {1, 7, 8, 9, 15, 16, 17, 33, 100};
+
+std::vector<float> randomVector(int n, std::mt19937* gen) {
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> v(n);
+  for (auto& x : v) {
+    x = dist(*gen);
+  }
+  return v;
+}
+
+void expectNear(
+    const std::vector<float>& actual,
+    const std::vector<float>& expected,
+    float tolerance,
+    const std::string& what) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(
+        actual[i], expected[i], tolerance * (1 + std::abs(expected[i])))
+        << what << ", element " << i;
+  }
+}
+
+} // namespace
+
+TEST(RowWiseUpdateTest, Adagrad) {
+  for (const auto& kernels : getVectorizedKernels()) {
+    for (int N : kBlockSizes) {
+      std::mt19937 gen(N);
+      const auto w = randomVector(N, &gen);
+      const auto g = randomVector(N, &gen);
+      std::vector<float> h{0.5f};
+
+      auto expected_w = w;
+      auto expected_h = h;
+      rowwise_adagrad_update_row__base(
+          N, expected_w.data(), g.data(), expected_h.data(), 1e-5f, 0.1f);
+      auto actual_w = w;
+      auto actual_h = h;
+      kernels.adagrad(
+          N, actual_w.data(), g.data(), actual_h.data(), 1e-5f, 0.1f);
+
+      const auto what = kernels.name + ", N " + std::to_string(N);
+      expectNear(actual_h, expected_h, 1e-5f, what + ", h");
+      expectNear(actual_w, expected_w, 1e-5f, what + ", w");
+    }
+  }
+}
+
+TEST(RowWiseUpdateTest, Adam) {
+  for (const auto& kernels : getVectorizedKernels()) {
+    for (int N : kBlockSizes) {
+      for (bool output_grad : {false, true}) {
+        std::mt19937 gen(N);
+        const auto w = randomVector(N, &gen);
+        const auto g = randomVector(N, &gen);
+        const auto m1 = randomVector(N, &gen);
+        std::vector<float> m2{0.5f};
+
+        auto expected_w = w;
+        auto expected_m1 = m1;
+        auto expected_m2 = m2;
+        std::vector<float> expected_ng(N);
+        rowwise_adam_update_row__base(
+            N,
+            expected_w.data(),
+            g.data(),
+            expected_m1.data(),
+            expected_m2.data(),
+            0.9f,
+            0.999f,
+            1e-5f,
+            0.7f,
+            0.1f,
+            output_grad ? expected_ng.data() : nullptr);
+        auto actual_w = w;
+        auto actual_m1 = m1;
+        auto actual_m2 = m2;
+        std::vector<float> actual_ng(N);
+        kernels.adam(
+            N,
+            actual_w.data(),
+            g.data(),
+            actual_m1.data(),
+            actual_m2.data(),
+            0.9f,
+            0.999f,
+            1e-5f,
+            0.7f,
+            0.1f,
+            output_grad ? actual_ng.data() : nullptr);
+
+        const auto what = kernels.name + ", N " + std::to_string(N);
+        expectNear(actual_m2, expected_m2, 1e-5f, what + ", m2");
+        expectNear(actual_m1, expected_m1, 1e-5f, what + ", m1");
+        expectNear(actual_w, expected_w, 1e-5f, what + ", w");
+        expectNear(actual_ng, expected_ng, 1e-5f, what + ", ng");
+      }
+    }
+  }
+}
+
+TEST(RowWiseUpdateTest, AdamFp16Moment) {
+  // The base kernel, with the first moment in fp16 and in fp32, gives the
+  // same updates up to the rounding of the moment.
+  std::vector<Kernels> kernels = getVectorizedKernels();
+  kernels.push_back({"base",
+                     rowwise_adagrad_update_row__base,
+                     rowwise_adam_update_row__base,
+                     rowwise_adam_fp16_update_row__base});
+  for (const auto& k : kernels) {
+    for (int N : kBlockSizes) {
+      std::mt19937 gen(N);
+      const auto w = randomVector(N, &gen);
+      const auto g = randomVector(N, &gen);
+      std::vector<at::Half> m1(N);
+      std::vector<float> m1_float(N);
+      const auto m1_values = randomVector(N, &gen);
+      for (int i = 0; i < N; ++i) {
+        m1[i] = m1_values[i];
+        // The reference starts from the same, already rounded, moment
+        m1_float[i] = m1[i];
+      }
+      std::vector<float> m2{0.5f};
+
+      auto expected_w = w;
+      auto expected_m1 = m1_float;
+      auto expected_m2 = m2;
+      std::vector<float> expected_ng(N);
+      rowwise_adam_update_row__base(
+          N,
+          expected_w.data(),
+          g.data(),
+          expected_m1.data(),
+          expected_m2.data(),
+          0.9f,
+          0.999f,
+          1e-5f,
+          0.7f,
+          0.1f,
+          expected_ng.data());
+      auto actual_w = w;
+      auto actual_m1 = m1;
+      auto actual_m2 = m2;
+      std::vector<float> actual_ng(N);
+      k.adam_fp16(
+          N,
+          actual_w.data(),
+          g.data(),
+          actual_m1.data(),
+          actual_m2.data(),
+          0.9f,
+          0.999f,
+          1e-5f,
+          0.7f,
+          0.1f,
+          actual_ng.data());
+
+      const auto what = k.name + ", N " + std::to_string(N);
+      // The update uses the moment before it is rounded to fp16
+      expectNear(actual_m2, expected_m2, 1e-5f, what + ", m2");
+      expectNear(actual_w, expected_w, 1e-5f, what + ", w");
+      expectNear(actual_ng, expected_ng, 1e-5f, what + ", ng");
+      std::vector<float> actual_m1_float(actual_m1.begin(), actual_m1.end());
+      expectNear(actual_m1_float, expected_m1, 1e-3f, what + ", m1");
+    }
+  }
+}
+
+} // namespace caffe2
@@ -26,7 +26,8 @@ def onnxifi_caffe2_net(
         merge_fp32_inputs_into_fp16=False,
         adjust_batch=True,
         black_list=None,
-        weight_names=None):
+        weight_names=None,
+        batch_buckets=None):
     """
     Transform the caffe2_net by collapsing ONNXIFI-runnable nodes into Onnxifi c2 ops
     """
@@ -42,7 +43,8 @@ def onnxifi_caffe2_net(
                              adjust_batch,
                              debug,
                              merge_fp32_inputs_into_fp16,
-                             use_onnx)
+                             use_onnx,
+                             batch_buckets if batch_buckets else [])
     pred_net_cut = caffe2_pb2.NetDef()
     pred_net_cut.ParseFromString(pred_net_str)
     return pred_net_cut
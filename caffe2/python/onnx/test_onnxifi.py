@@ -107,6 +107,38 @@ class OnnxifiTest(TestCase):
         Y = workspace.FetchBlob("Y0")
         np.testing.assert_almost_equal(Y, Y_without_padding)
 
+    @unittest.skip("Need ONNXIFI backend support")
+    def test_batch_buckets(self):
+        max_batch_size = 16
+        pred_net = caffe2_pb2.NetDef()
+        pred_net.name = "pred"
+        pred_net.external_input.append("X")
+        pred_net.external_output.append("Y")
+        pred_net.op.add().CopyFrom(core.CreateOperator("Relu", ["X"], ["Y"]))
+        workspace.FeedBlob("X", np.zeros((max_batch_size, 4), dtype=np.float32))
+        pred_net_cut = onnxifi_caffe2_net(pred_net,
+                                          {"X": [max_batch_size, 4]},
+                                          max_batch_size=max_batch_size,
+                                          use_onnx=False,
+                                          batch_buckets=[1, 4])
+        onnxifi_ops = [op for op in pred_net_cut.op if op.type == "Onnxifi"]
+        self.assertEqual(len(onnxifi_ops), 1)
+        args = {arg.name: arg for arg in onnxifi_ops[0].arg}
+        self.assertEqual(list(args["batch_buckets"].ints), [1, 4])
+        self.assertEqual(list(args["bucket_0_output_shape_hint_0"].ints),
+                         [ONNXIFI_DATATYPE_FLOAT32, 1, 4])
+        self.assertEqual(list(args["bucket_1_output_shape_hint_0"].ints),
+                         [ONNXIFI_DATATYPE_FLOAT32, 4, 4])
+
+        # Every batch size runs on the smallest bucket that fits it
+        workspace.CreateNet(pred_net_cut)
+        for batch_size in [1, 3, 4, 9, max_batch_size]:
+            X = np.random.randn(batch_size, 4).astype(np.float32)
+            workspace.FeedBlob(pred_net_cut.external_input[0], X)
+            workspace.RunNet(pred_net_cut.name)
+            Y = workspace.FetchBlob(pred_net_cut.external_output[0])
+            np.testing.assert_almost_equal(Y, np.maximum(X, 0))
+
 
 class OnnxifiTransformTest(TestCase):
     def setUp(self):
@@ -216,3 +216,51 @@ class TestAdagrad(serial.SerializedTestCase):
             dc,
             row_wise=True,
         )
+
+    @given(
+        inputs=hu.tensors(n=3, min_dim=2, max_dim=2),
+        lr=st.floats(
+            min_value=0.01, max_value=0.99, allow_nan=False, allow_infinity=False
+        ),
+        epsilon=st.floats(
+            min_value=0.01, max_value=0.99, allow_nan=False, allow_infinity=False
+        ),
+        **hu.gcs_cpu_only
+    )
+    def test_row_wise_sparse_adagrad_dedup_indices(
+        self, inputs, lr, epsilon, gc, dc
+    ):
+        param, momentum, grad = inputs
+        momentum = np.abs(momentum[:, 0])
+        lr = np.array([lr], dtype=np.float32)
+        # Indices with duplicates
+        indices = np.random.randint(
+            param.shape[0], size=grad.shape[0]
+        ).astype(np.int64)
+
+        op = core.CreateOperator(
+            "RowWiseSparseAdagrad",
+            ["param", "momentum", "indices", "grad", "lr"],
+            ["param", "momentum"],
+            epsilon=epsilon,
+            dedup_indices=True,
+            device_option=gc,
+        )
+
+        def ref_dedup(param, momentum, indices, grad, lr):
+            param_out = np.copy(param)
+            momentum_out = np.copy(momentum)
+            for index in np.unique(indices):
+                param_out[index], momentum_out[index] = ref_adagrad(
+                    param[index],
+                    momentum[index],
+                    grad[indices == index].sum(axis=0),
+                    lr,
+                    epsilon,
+                    row_wise=True,
+                )
+            return (param_out, momentum_out)
+
+        self.assertReferenceChecks(
+            gc, op, [param, momentum, indices, grad, lr], ref_dedup
+        )
@@ -408,6 +408,70 @@ class TestAdam(hu.HypothesisTestCase):
                 beta1=beta1, beta2=beta2, epsilon=epsilon, output_grad=True),
             input_device_options=input_device_options)
 
+    @given(num_rows=st.integers(min_value=1, max_value=10),
+           # Covers the vectorized kernels and their remainders
+           block_size=st.sampled_from([1, 7, 8, 9, 15, 16, 17, 33]),
+           num_indices=st.integers(min_value=1, max_value=20),
+           ITER=st.integers(min_value=0, max_value=10000),
+           LR=st.floats(min_value=0.01, max_value=0.99,
+                        allow_nan=False, allow_infinity=False),
+           beta1=st.floats(min_value=0.01, max_value=0.99,
+                           allow_nan=False, allow_infinity=False),
+           beta2=st.floats(min_value=0.01, max_value=0.99,
+                           allow_nan=False, allow_infinity=False),
+           epsilon=st.floats(min_value=0.01, max_value=0.99,
+                             allow_nan=False, allow_infinity=False),
+           dedup_indices=st.booleans(),
+           fp16_moment=st.booleans(),
+           **hu.gcs_cpu_only)
+    def test_row_wise_sparse_adam_dedup_fp16(
+            self, num_rows, block_size, num_indices, ITER, LR, beta1, beta2,
+            epsilon, dedup_indices, fp16_moment, gc, dc):
+        param = np.random.randn(num_rows, block_size).astype(np.float32)
+        mom1 = np.random.randn(num_rows, block_size).astype(
+            np.float16 if fp16_moment else np.float32)
+        mom2 = np.abs(np.random.randn(num_rows)).astype(np.float32)
+        if dedup_indices:
+            # Indices with duplicates
+            indices = np.random.randint(num_rows, size=num_indices)
+        else:
+            indices = np.random.permutation(num_rows)[:num_indices]
+        indices = indices.astype(np.int64)
+        grad = np.random.randn(len(indices), block_size).astype(np.float32)
+        ITER = np.array([ITER], dtype=np.int64)
+        LR = np.array([LR], dtype=np.float32)
+
+        op = core.CreateOperator(
+            "RowWiseSparseAdam",
+            ["param", "mom1", "mom2", "indices", "grad", "lr", "iter"],
+            ["param", "mom1", "mom2"],
+            beta1=beta1, beta2=beta2, epsilon=epsilon,
+            dedup_indices=dedup_indices)
+
+        def ref_row_wise_sparse(param, mom1, mom2, indices, grad, LR, ITER):
+            param_out = np.copy(param)
+            # The update is computed in fp32 whatever the moment type
+            mom1_out = mom1.astype(np.float32)
+            mom2_out = np.copy(mom2)
+            for index in np.unique(indices):
+                param_out[index], mom1_out[index], mom2_out[index] = \
+                    self.ref_row_wise_adam(param[index],
+                                           mom1[index].astype(np.float32),
+                                           mom2[index],
+                                           grad[indices == index].sum(axis=0),
+                                           LR, ITER, beta1, beta2, epsilon)
+            return (param_out, mom1_out.astype(mom1.dtype), mom2_out)
+
+        # Iter lives on the CPU
+        input_device_options = {'iter': hu.cpu_do}
+
+        self.assertReferenceChecks(
+            gc, op,
+            [param, mom1, mom2, indices, grad, LR, ITER],
+            ref_row_wise_sparse,
+            threshold=1e-3 if fp16_moment else 1e-4,
+            input_device_options=input_device_options)
+
 
 if __name__ == "__main__":
     import unittest
@@ -235,6 +235,67 @@ def create_test(output_dir, width, height, default_bound, minsize, crop, means,
     return expected_results
 
 
+# Smooth images keep a reduced JPEG decode close to a full decode and resize
+def create_smooth_image(height, width):
+    y, x = np.mgrid[0:height, 0:width].astype(np.float32)
+    channels = [
+        127.5 + 127.5 * np.sin(x / 17.0 + c) * np.cos(y / 23.0 - c)
+        for c in range(3)
+    ]
+    return np.stack(channels, axis=2).astype(np.uint8)
+
+
+# Creates an lmdb of the given images with their index as label
+def create_image_db(output_dir, images, image_format):
+    LMDB_MAP_SIZE = 1 << 40
+    env = lmdb.open(output_dir, map_size=LMDB_MAP_SIZE, subdir=True)
+    with env.begin(write=True) as txn:
+        for index, img_array in enumerate(images):
+            img_str = six.BytesIO()
+            Image.fromarray(img_array).save(img_str, image_format)
+
+            tensor_protos = caffe2_pb2.TensorProtos()
+            image_tensor = tensor_protos.protos.add()
+            image_tensor.data_type = 4  # string data
+            image_tensor.string_data.append(img_str.getvalue())
+            img_str.close()
+
+            label_tensor = tensor_protos.protos.add()
+            label_tensor.data_type = 2  # int32 data
+            label_tensor.int32_data.append(index)
+
+            txn.put(
+                '{}'.format(index).encode('ascii'),
+                tensor_protos.SerializeToString()
+            )
+
+
+# Runs one batch of ImageInput over the db on CPU. Returns the images and
+# the exported stats of the operator.
+def run_image_input(db_dir, count_images, **kwargs):
+    with hu.temp_workspace():
+        reader_net = core.Net('reader')
+        reader_net.CreateDB([], 'DB', db=db_dir, db_type="lmdb")
+        workspace.RunNetOnce(reader_net)
+        main_net = core.Net('main')
+        # Resets the counters left by earlier runs
+        main_net.StatRegistryExport([], ['prev_k', 'prev_v', 'prev_ts'])
+        main_net.ImageInput(
+            ['DB'],
+            ['data', 'label'],
+            batch_size=count_images,
+            color=3,
+            **kwargs
+        )
+        main_net.StatRegistryExport([], ['k', 'v', 'ts'])
+        workspace.RunNetOnce(main_net)
+        stats = dict(zip(
+            [k.decode('ascii') if isinstance(k, bytes) else k
+             for k in workspace.FetchBlob('k')],
+            workspace.FetchBlob('v')))
+        return workspace.FetchBlob('data'), stats
+
+
 def run_test(
         size_tuple, means, stds, label_type, num_labels, is_test, scale_jitter_type,
         color_jitter, color_lighting, dc, validator, output1=None, output2_size=None):
@@ -427,6 +488,103 @@ class TestImport(hu.HypothesisTestCase):
             validator, output1, output2_size)
     # End test_imageinput
 
+    def test_imageinput_output_order(self):
+        # NCHW batches are written directly by the decode threads, they must
+        # be the transposed NHWC batches
+        height, width, crop = 40, 52, 32
+        images = [np.random.randint(0, 256, [height, width, 3]).astype(np.uint8)
+                  for _ in range(3)]
+        out_dir = tempfile.mkdtemp()
+        create_image_db(out_dir, images, 'PNG')
+        args = dict(
+            minsize=height,
+            crop=crop,
+            is_test=1,
+            mean_per_channel=[104.0, 117.0, 123.0],
+            std_per_channel=[1.5, 2.0, 2.5],
+        )
+        nhwc, _ = run_image_input(out_dir, len(images), **args)
+        nchw, _ = run_image_input(
+            out_dir, len(images), output_order='NCHW', **args)
+        shutil.rmtree(out_dir)
+        self.assertEqual(nhwc.shape, (len(images), crop, crop, 3))
+        self.assertEqual(nchw.shape, (len(images), 3, crop, crop))
+        np.testing.assert_array_equal(nchw, nhwc.transpose(0, 3, 1, 2))
+
+    def test_imageinput_reduced_decode(self):
+        # A 256 pixel JPEG scaled to 64 is decoded at 1/4 of its size, the
+        # result must stay close to a full decode followed by a resize
+        cv_version = tuple(int(v) for v in cv2.__version__.split('.')[:2])
+        if cv_version < (3, 2):
+            self.skipTest('reduced decoding needs OpenCV 3.2')
+        height, width, scale = 256, 320, 64
+        images = [create_smooth_image(height, width) for _ in range(2)]
+        out_dir = tempfile.mkdtemp()
+        create_image_db(out_dir, images, 'JPEG')
+        args = dict(scale=scale, crop=scale, is_test=1)
+        full, _ = run_image_input(out_dir, len(images), **args)
+        reduced, stats = run_image_input(
+            out_dir, len(images), reduced_decode=1, **args)
+        shutil.rmtree(out_dir)
+        self.assertGreaterEqual(
+            stats['image_input_op/data/reduced_decodes'], len(images))
+        self.assertEqual(reduced.shape, full.shape)
+        self.assertLess(np.abs(reduced - full).mean(), 3.0)
+
+    def test_imageinput_reduced_decode_not_jpeg(self):
+        # GetJpegSize rejects other formats, which are decoded in full
+        height, width, scale = 256, 256, 64
+        images = [create_smooth_image(height, width) for _ in range(2)]
+        out_dir = tempfile.mkdtemp()
+        create_image_db(out_dir, images, 'PNG')
+        args = dict(scale=scale, crop=scale, is_test=1)
+        full, _ = run_image_input(out_dir, len(images), **args)
+        reduced, stats = run_image_input(
+            out_dir, len(images), reduced_decode=1, **args)
+        shutil.rmtree(out_dir)
+        self.assertEqual(
+            stats.get('image_input_op/data/reduced_decodes', 0), 0)
+        np.testing.assert_array_equal(reduced, full)
+
+    def test_imageinput_color_lighting(self):
+        # Without color jitter the lighting offset is folded into the mean.
+        # With the crop covering the whole image and no mirroring, each
+        # channel must differ from the unlit image by a constant, as when
+        # the offset was added to every pixel.
+        size = 32
+        images = [np.random.randint(0, 256, [size, size, 3]).astype(np.uint8)
+                  for _ in range(3)]
+        out_dir = tempfile.mkdtemp()
+        create_image_db(out_dir, images, 'PNG')
+        stds = [1.5, 2.0, 2.5]
+        args = dict(
+            minsize=size,
+            crop=size,
+            is_test=0,
+            mirror=0,
+            mean_per_channel=[104.0, 117.0, 123.0],
+            std_per_channel=stds,
+        )
+        for output_order in ['NHWC', 'NCHW']:
+            unlit, _ = run_image_input(
+                out_dir, len(images), output_order=output_order, **args)
+            lit, _ = run_image_input(
+                out_dir, len(images), output_order=output_order,
+                color_lighting=1, **args)
+            if output_order == 'NCHW':
+                unlit = unlit.transpose(0, 2, 3, 1)
+                lit = lit.transpose(0, 2, 3, 1)
+            for i in range(len(images)):
+                offset = (lit[i] - unlit[i]).reshape(-1, 3)
+                np.testing.assert_allclose(
+                    offset, np.broadcast_to(offset[0], offset.shape),
+                    rtol=0, atol=1e-3)
+                # The offset is in pixel units before the scaling by 1 / std
+                delta = offset[0] * np.array(stds)
+                self.assertTrue(np.any(delta != 0))
+                self.assertTrue(np.all(np.abs(delta) < 255))
+        shutil.rmtree(out_dir)
+
 
 if __name__ == '__main__':
     import unittest
@@ -1,13 +1,11 @@
 #include "caffe2/queue/blobs_queue.h"
 
-#include <atomic>
-#include <condition_variable>
+#include <chrono>
 #include <memory>
-#include <mutex>
-#include <queue>
 
 #include "caffe2/core/blob_stats.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/core/scope_guard.h"
 #include "caffe2/core/stats.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/core/timer.h"
@@ -29,13 +27,15 @@ BlobsQueue::BlobsQueue(
     size_t numBlobs,
     bool enforceUniqueName,
     const std::vector<std::string>& fieldNames)
-    : numBlobs_(numBlobs), name_(queueName), stats_(queueName) {
+    : numBlobs_(numBlobs),
+      queue_(capacity),
+      name_(queueName),
+      stats_(queueName) {
   if (!fieldNames.empty()) {
     CAFFE_ENFORCE_EQ(
         fieldNames.size(), numBlobs, "Wrong number of fieldNames provided.");
     stats_.queue_dequeued_bytes.setDetails(fieldNames);
   }
-  queue_.reserve(capacity);
   for (size_t i = 0; i < capacity; ++i) {
     std::vector<Blob*> blobs;
     blobs.reserve(numBlobs);
@@ -49,57 +49,81 @@ BlobsQueue::BlobsQueue(
       }
       blobs.push_back(ws->CreateBlob(blobName));
     }
-    queue_.push_back(blobs);
+    queue_.at(i) = std::move(blobs);
+  }
+}
+
+size_t BlobsQueue::claimRead(
+    size_t maxCount,
+    float timeout_secs,
+    uint64_t* position) {
+  const auto deadline = MPMCRing<std::vector<Blob*>>::Clock::now() +
+      std::chrono::milliseconds(int(timeout_secs * 1000));
+  for (;;) {
+    const auto count = queue_.tryClaimRead(maxCount, position);
+    if (count > 0) {
+      return count;
+    }
+    const bool readable = timeout_secs > 0 ? queue_.waitReadable(deadline)
+                                           : queue_.waitReadable();
+    if (!readable) {
+      const auto& name = name_.c_str();
+      if (timeout_secs > 0 && !queue_.closed()) {
+        LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
+        CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
+      } else {
+        CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
+      }
+      return 0;
+    }
   }
-  DCHECK_EQ(queue_.size(), capacity);
 }
 
 bool BlobsQueue::blockingRead(
     const std::vector<Blob*>& inputs,
     float timeout_secs) {
+  return blockingReadMany(
+             c10::ArrayRef<std::vector<Blob*>>(inputs), timeout_secs) > 0;
+}
+
+size_t BlobsQueue::blockingReadMany(
+    c10::ArrayRef<std::vector<Blob*>> records,
+    float timeout_secs) {
   Timer readTimer;
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
-  auto canRead = [this]() {
-    CAFFE_ENFORCE_LE(reader_, writer_);
-    return reader_ != writer_;
-  };
+  for (const auto& inputs : records) {
+    CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  }
   // Decrease queue balance before reading to indicate queue read pressure
   // is being increased (-ve queue balance indicates more reads than writes)
   CAFFE_EVENT(stats_, queue_balance, -1);
-  if (timeout_secs > 0) {
-    std::chrono::milliseconds timeout_ms(int(timeout_secs * 1000));
-    cv_.wait_for(
-        g, timeout_ms, [this, canRead]() { return closing_ || canRead(); });
-  } else {
-    cv_.wait(g, [this, canRead]() { return closing_ || canRead(); });
-  }
-  if (!canRead()) {
-    if (timeout_secs > 0 && !closing_) {
-      LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
-      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
-    } else {
-      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
+  size_t count = 0;
+  while (count == 0) {
+    uint64_t position;
+    const auto claimed = claimRead(records.size(), timeout_secs, &position);
+    if (claimed == 0) {
+      return 0;
+    }
+    // Hands the claimed slots back to the writers even if a read throws;
+    // the records of a failed read are dropped. So are the slots whose
+    // write failed.
+    auto publish = MakeGuard([&] { queue_.publishRead(position, claimed); });
+    for (size_t i = 0; i < claimed; ++i) {
+      if (!queue_.skipped(position + i)) {
+        doRead(position + i, records[count++]);
+      }
     }
-    return false;
   }
-  DCHECK(canRead());
-  auto& result = queue_[reader_ % queue_.size()];
-  CAFFE_ENFORCE(inputs.size() >= result.size());
-  for (auto i = 0; i < result.size(); ++i) {
-    auto bytes = BlobStat::sizeBytes(*result[i]);
-    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
-    using std::swap;
-    swap(*(inputs[i]), *(result[i]));
+  if (count > 1) {
+    // the first record was accounted for above
+    CAFFE_EVENT(stats_, queue_balance, 1 - int64_t(count));
   }
-  CAFFE_SDT(queue_read_end, name, (void*)this, writer_ - reader_);
-  CAFFE_EVENT(stats_, queue_dequeued_records);
-  ++reader_;
-  cv_.notify_all();
+  CAFFE_SDT(queue_read_end, name, (void*)this, queue_.size());
+  CAFFE_EVENT(stats_, queue_dequeued_records, count);
   CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
-  return true;
+  return count;
 }
 
 bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
@@ -107,67 +131,108 @@ bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_write_start, name, (void*)this, SDT_NONBLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
-  if (!canWrite()) {
+  CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  uint64_t position;
+  if (queue_.tryClaimWrite(1, &position) == 0) {
     CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
     return false;
   }
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
   CAFFE_EVENT(stats_, queue_balance, 1);
-  DCHECK(canWrite());
-  doWrite(inputs);
+  {
+    bool done = false;
+    auto publish = MakeGuard([&] {
+      if (done) {
+        queue_.publishWrite(position, 1);
+      } else {
+        queue_.abandonWrite(position, 1);
+      }
+    });
+    doWrite(position, inputs);
+    done = true;
+  }
+  CAFFE_SDT(
+      queue_write_end,
+      name,
+      (void*)this,
+      queue_.capacity() - queue_.size());
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
 
 bool BlobsQueue::blockingWrite(const std::vector<Blob*>& inputs) {
+  return blockingWriteMany(c10::ArrayRef<std::vector<Blob*>>(inputs));
+}
+
+bool BlobsQueue::blockingWriteMany(
+    c10::ArrayRef<std::vector<Blob*>> records) {
   Timer writeTimer;
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
   CAFFE_SDT(queue_write_start, name, (void*)this, SDT_BLOCKING_OP);
-  std::unique_lock<std::mutex> g(mutex_);
+  for (const auto& inputs : records) {
+    CAFFE_ENFORCE(inputs.size() >= numBlobs_);
+  }
   // Increase queue balance before writing to indicate queue write pressure is
   // being increased (+ve queue balance indicates more writes than reads)
-  CAFFE_EVENT(stats_, queue_balance, 1);
-  cv_.wait(g, [this]() { return closing_ || canWrite(); });
-  if (!canWrite()) {
-    CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
-    return false;
+  CAFFE_EVENT(stats_, queue_balance, records.size());
+  size_t written = 0;
+  while (written < records.size()) {
+    uint64_t position;
+    const auto count =
+        queue_.tryClaimWrite(records.size() - written, &position);
+    if (count == 0) {
+      if (!queue_.waitWritable()) {
+        CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
+        return false;
+      }
+      continue;
+    }
+    // Hands the claimed slots over to readers even if a write throws, so
+    // that they are not stuck; the slots that were not written are marked
+    // as skipped.
+    size_t done = 0;
+    auto publish = MakeGuard([&] {
+      queue_.publishWrite(position, done);
+      queue_.abandonWrite(position + done, count - done);
+    });
+    for (; done < count; ++done) {
+      doWrite(position + done, records[written + done]);
+    }
+    written += count;
   }
-  DCHECK(canWrite());
-  doWrite(inputs);
+  CAFFE_SDT(
+      queue_write_end,
+      name,
+      (void*)this,
+      queue_.capacity() - queue_.size());
   CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
   return true;
 }
 
 void BlobsQueue::close() {
-  closing_ = true;
-
-  std::lock_guard<std::mutex> g(mutex_);
-  cv_.notify_all();
+  queue_.close();
 }
 
-bool BlobsQueue::canWrite() {
-  // writer is always within [reader, reader + size)
-  // we can write if reader is within [reader, reader + size)
-  CAFFE_ENFORCE_LE(reader_, writer_);
-  CAFFE_ENFORCE_LE(writer_, reader_ + queue_.size());
-  return writer_ != reader_ + queue_.size();
+void BlobsQueue::doRead(uint64_t position, const std::vector<Blob*>& inputs) {
+  auto& result = queue_.at(position);
+  DCHECK_GE(inputs.size(), result.size());
+  for (auto i = 0; i < result.size(); ++i) {
+    auto bytes = BlobStat::sizeBytes(*result[i]);
+    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
+    using std::swap;
+    swap(*(inputs[i]), *(result[i]));
+  }
 }
 
-void BlobsQueue::doWrite(const std::vector<Blob*>& inputs) {
-  auto& result = queue_[writer_ % queue_.size()];
-  CAFFE_ENFORCE(inputs.size() >= result.size());
-  const auto& name = name_.c_str();
+void BlobsQueue::doWrite(uint64_t position, const std::vector<Blob*>& inputs) {
+  auto& result = queue_.at(position);
+  DCHECK_GE(inputs.size(), result.size());
   for (auto i = 0; i < result.size(); ++i) {
     using std::swap;
     swap(*(inputs[i]), *(result[i]));
   }
-  CAFFE_SDT(
-      queue_write_end, name, (void*)this, reader_ + queue_.size() - writer_);
-  ++writer_;
-  cv_.notify_all();
 }
 
 } // namespace caffe2
@@ -1,21 +1,20 @@
 #pragma once
 
-#include <atomic>
-#include <condition_variable>
 #include <memory>
-#include <mutex>
-#include <queue>
 
+#include <c10/util/ArrayRef.h>
 #include "caffe2/core/blob_stats.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/stats.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/core/workspace.h"
+#include "caffe2/queue/mpmc_ring.h"
 
 namespace caffe2 {
 
 // A thread-safe, bounded, blocking queue.
-// Modelled as a circular buffer.
+// Modelled as a lock-free circular buffer (see MPMCRing); threads only take a
+// lock when they have to wait for the queue to become non-empty or non-full.
 
 // Containing blobs are owned by the workspace.
 // On read, we swap out the underlying data for the blob passed in for blobs
@@ -39,23 +38,27 @@ class CAFFE2_API BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
       float timeout_secs = 0.0f);
   bool tryWrite(const std::vector<Blob*>& inputs);
   bool blockingWrite(const std::vector<Blob*>& inputs);
+  // Waits until at least one record can be read, then reads as many records
+  // as are available, up to records.size(), in a single claim. Returns the
+  // number of records read, 0 if the queue was closed or timed out.
+  size_t blockingReadMany(
+      c10::ArrayRef<std::vector<Blob*>> records,
+      float timeout_secs = 0.0f);
+  // Writes all records, claiming as many free slots at once as possible.
+  // Returns false if the queue was closed before all of them were written.
+  bool blockingWriteMany(c10::ArrayRef<std::vector<Blob*>> records);
   void close();
   size_t getNumBlobs() const {
     return numBlobs_;
   }
 
  private:
-  bool canWrite();
-  void doWrite(const std::vector<Blob*>& inputs);
-
-  std::atomic<bool> closing_{false};
+  size_t claimRead(size_t maxCount, float timeout_secs, uint64_t* position);
+  void doRead(uint64_t position, const std::vector<Blob*>& inputs);
+  void doWrite(uint64_t position, const std::vector<Blob*>& inputs);
 
   size_t numBlobs_;
-  std::mutex mutex_; // protects all variables in the class.
-  std::condition_variable cv_;
-  int64_t reader_{0};
-  int64_t writer_{0};
-  std::vector<std::vector<Blob*>> queue_;
+  MPMCRing<std::vector<Blob*>> queue_;
   const std::string name_;
 
   struct QueueStats {
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "caffe2/core/logging.h"
+
+namespace caffe2 {
+
+// A bounded multi-producer/multi-consumer ring buffer, used as the storage of
+// BlobsQueue and RebatchingQueue.
+//
+// Every slot carries a sequence number that says whose turn it is: a slot at
+// position p is free for the writer of p when its sequence is 2p, and ready
+// for the reader of p when its sequence is 2p + 1. Doubling the positions
+// keeps the two states apart even with a capacity of 1, where the slot written
+// at p is the one the writer of p + 1 waits for. Readers and writers claim
+// positions with a CAS on their cursor, access the claimed slots without any
+// lock, and hand them over by bumping their sequence numbers. The mutex and
+// condition variables are only used to put threads to sleep when the ring is
+// full or empty and are not touched by producers and consumers that never
+// have to wait.
+//
+// Several consecutive positions can be claimed with a single CAS, which is how
+// batch enqueue and dequeue are implemented. A writer that cannot fill the
+// positions it claimed hands them over with abandonWrite; readers still claim
+// them, check skipped() and drop them.
+template <typename T>
+class MPMCRing {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit MPMCRing(size_t capacity)
+      : capacity_(capacity), slots_(new Slot[capacity]) {
+    CAFFE_ENFORCE_GT(capacity, 0, "Ring capacity must be positive.");
+    for (size_t i = 0; i < capacity; ++i) {
+      slots_[i].sequence.store(2 * i, std::memory_order_relaxed);
+    }
+  }
+
+  MPMCRing(const MPMCRing&) = delete;
+  MPMCRing& operator=(const MPMCRing&) = delete;
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+  // Approximate number of elements in the ring; exact when no claim is in
+  // flight.
+  size_t size() const {
+    const auto reader = readPos_.load(std::memory_order_relaxed);
+    const auto writer = writePos_.load(std::memory_order_relaxed);
+    return writer > reader ? writer - reader : 0;
+  }
+
+  T& at(uint64_t position) {
+    return slots_[position % capacity_].value;
+  }
+
+  // Claims up to maxCount consecutive positions for writing, starting at
+  // *position. Returns how many were claimed, 0 if the ring is full.
+  size_t tryClaimWrite(size_t maxCount, uint64_t* position) {
+    return tryClaim_(writePos_, 0, maxCount, position);
+  }
+
+  // Makes count positions starting at position, claimed by tryClaimWrite,
+  // visible to readers.
+  void publishWrite(uint64_t position, size_t count) {
+    publishWrite_(position, count, false);
+  }
+
+  // Same as publishWrite, for claimed positions that were not written. Readers
+  // still claim them and must drop them (see skipped).
+  void abandonWrite(uint64_t position, size_t count) {
+    publishWrite_(position, count, true);
+  }
+
+  // Whether a position claimed by tryClaimRead was abandoned by its writer.
+  bool skipped(uint64_t position) const {
+    return slots_[position % capacity_].skipped;
+  }
+
+  // Claims up to maxCount consecutive positions for reading, starting at
+  // *position. Returns how many were claimed, 0 if the ring is empty.
+  size_t tryClaimRead(size_t maxCount, uint64_t* position) {
+    return tryClaim_(readPos_, 1, maxCount, position);
+  }
+
+  // Hands count positions starting at position, claimed by tryClaimRead,
+  // back to writers.
+  void publishRead(uint64_t position, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      auto& slot = slots_[(position + i) % capacity_];
+      slot.skipped = false;
+      slot.sequence.store(
+          2 * (position + i + capacity_), std::memory_order_release);
+    }
+    notify_(writeWaiters_, writeCv_);
+  }
+
+  bool readable() const {
+    return ready_(readPos_, 1);
+  }
+
+  bool writable() const {
+    return ready_(writePos_, 0);
+  }
+
+  // Block until the next position can be read (true) or the ring is closed
+  // and empty or the deadline passed (false). Another reader may still win
+  // the race for the position, so callers retry their claim in a loop.
+  bool waitReadable() {
+    return wait_(readWaiters_, readCv_, [this] { return readable(); }, nullptr);
+  }
+  bool waitReadable(const Clock::time_point& deadline) {
+    return wait_(
+        readWaiters_, readCv_, [this] { return readable(); }, &deadline);
+  }
+
+  // Same as waitReadable, for writers.
+  bool waitWritable() {
+    return wait_(
+        writeWaiters_, writeCv_, [this] { return writable(); }, nullptr);
+  }
+
+  bool closed() const {
+    return closed_.load();
+  }
+
+  // Wakes up all waiting threads. Positions that can still be claimed stay
+  // available after closing.
+  void close() {
+    closed_ = true;
+
+    std::lock_guard<std::mutex> g(mutex_);
+    readCv_.notify_all();
+    writeCv_.notify_all();
+  }
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> sequence{0};
+    // Set by abandonWrite; published and cleared along with the sequence.
+    bool skipped = false;
+    T value;
+  };
+
+  void publishWrite_(uint64_t position, size_t count, bool skipped) {
+    for (size_t i = 0; i < count; ++i) {
+      auto& slot = slots_[(position + i) % capacity_];
+      slot.skipped = skipped;
+      slot.sequence.store(2 * (position + i) + 1, std::memory_order_release);
+    }
+    notify_(readWaiters_, readCv_);
+  }
+
+  bool ready_(const std::atomic<uint64_t>& cursor, uint64_t lag) const {
+    const auto pos = cursor.load(std::memory_order_relaxed);
+    return slots_[pos % capacity_].sequence.load(std::memory_order_acquire) ==
+        2 * pos + lag;
+  }
+
+  size_t tryClaim_(
+      std::atomic<uint64_t>& cursor,
+      uint64_t lag,
+      size_t maxCount,
+      uint64_t* position) {
+    auto pos = cursor.load(std::memory_order_relaxed);
+    for (;;) {
+      size_t count = 0;
+      while (count < maxCount && count < capacity_ &&
+             slots_[(pos + count) % capacity_].sequence.load(
+                 std::memory_order_acquire) == 2 * (pos + count) + lag) {
+        ++count;
+      }
+      if (count == 0) {
+        const auto sequence =
+            slots_[pos % capacity_].sequence.load(std::memory_order_acquire);
+        if (static_cast<int64_t>(sequence - (2 * pos + lag)) < 0) {
+          // the slot still belongs to the previous lap: full or empty
+          return 0;
+        }
+        // somebody else claimed pos already
+        pos = cursor.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (cursor.compare_exchange_weak(
+              pos, pos + count, std::memory_order_relaxed)) {
+        *position = pos;
+        return count;
+      }
+    }
+  }
+
+  void notify_(std::atomic<int>& waiters, std::condition_variable& cv) {
+    // Pairs with the fence in wait_: either the waiter sees the published
+    // sequence number, or we see the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> g(mutex_);
+      cv.notify_all();
+    }
+  }
+
+  template <typename Ready>
+  bool wait_(
+      std::atomic<int>& waiters,
+      std::condition_variable& cv,
+      Ready ready,
+      const Clock::time_point* deadline) {
+    if (ready()) {
+      return true;
+    }
+    std::unique_lock<std::mutex> g(mutex_);
+    waiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto done = [this, &ready]() { return closed_ || ready(); };
+    if (deadline) {
+      cv.wait_until(g, *deadline, done);
+    } else {
+      cv.wait(g, done);
+    }
+    waiters.fetch_sub(1);
+    return ready();
+  }
+
+  const size_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+
+  // Keep the cursors on separate cache lines so that producers and consumers
+  // don't invalidate each other's.
+  char pad0_[64];
+  std::atomic<uint64_t> writePos_{0};
+  char pad1_[64];
+  std::atomic<uint64_t> readPos_{0};
+  char pad2_[64];
+
+  std::atomic<bool> closed_{false};
+  std::atomic<int> readWaiters_{0};
+  std::atomic<int> writeWaiters_{0};
+  std::mutex mutex_; // only used for sleeping
+  std::condition_variable readCv_;
+  std::condition_variable writeCv_;
+};
+
+} // namespace caffe2
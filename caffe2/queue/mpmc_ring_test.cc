@@ -0,0 +1,156 @@
+#include <thread> // NOLINT
+#include <vector>
+
+#include "caffe2/queue/mpmc_ring.h"
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+namespace {
+
+void produce(MPMCRing<int64_t>* ring, int batch, int64_t count) {
+  int64_t value = 0;
+  while (value < count) {
+    uint64_t position;
+    const auto claimed = ring->tryClaimWrite(
+        std::min<int64_t>(batch, count - value), &position);
+    if (claimed == 0) {
+      ring->waitWritable();
+      continue;
+    }
+    for (size_t i = 0; i < claimed; ++i) {
+      ring->at(position + i) = ++value;
+    }
+    ring->publishWrite(position, claimed);
+  }
+}
+
+void consume(
+    MPMCRing<int64_t>* ring,
+    int batch,
+    std::atomic<int64_t>* sum,
+    std::atomic<int64_t>* count) {
+  for (;;) {
+    uint64_t position;
+    const auto claimed = ring->tryClaimRead(batch, &position);
+    if (claimed == 0) {
+      if (!ring->waitReadable()) {
+        return;
+      }
+      continue;
+    }
+    for (size_t i = 0; i < claimed; ++i) {
+      *sum += ring->at(position + i);
+    }
+    *count += claimed;
+    ring->publishRead(position, claimed);
+  }
+}
+
+void checkManyProducersManyConsumers(size_t capacity) {
+  const int kProducers = 6;
+  const int kConsumers = 5;
+  const int64_t kCount = 20000;
+  MPMCRing<int64_t> ring(capacity);
+  std::atomic<int64_t> sum{0};
+  std::atomic<int64_t> count{0};
+
+  std::vector<std::thread> producers;
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < kProducers; ++i) {
+    producers.emplace_back(produce, &ring, 1 + i % 3, kCount);
+  }
+  for (int i = 0; i < kConsumers; ++i) {
+    consumers.emplace_back(consume, &ring, 1 + i % 4, &sum, &count);
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  ring.close();
+  for (auto& t : consumers) {
+    t.join();
+  }
+
+  EXPECT_EQ(count, kProducers * kCount) << "capacity " << capacity;
+  EXPECT_EQ(sum, kProducers * kCount * (kCount + 1) / 2)
+      << "capacity " << capacity;
+}
+
+} // namespace
+
+TEST(MPMCRingTest, SingleThreaded) {
+  MPMCRing<int> ring(3);
+  uint64_t position;
+  EXPECT_EQ(ring.tryClaimRead(1, &position), 0);
+  EXPECT_EQ(ring.tryClaimWrite(5, &position), 3);
+  EXPECT_EQ(position, 0);
+  EXPECT_EQ(ring.tryClaimWrite(1, &position), 0);
+  for (int i = 0; i < 3; ++i) {
+    ring.at(i) = i;
+  }
+  ring.publishWrite(0, 3);
+  EXPECT_EQ(ring.size(), 3);
+  EXPECT_EQ(ring.tryClaimRead(2, &position), 2);
+  EXPECT_EQ(position, 0);
+  EXPECT_EQ(ring.at(position + 1), 1);
+  ring.publishRead(position, 2);
+  EXPECT_EQ(ring.tryClaimWrite(5, &position), 2);
+  EXPECT_EQ(position, 3);
+}
+
+TEST(MPMCRingTest, CapacityOne) {
+  MPMCRing<int> ring(1);
+  uint64_t position;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(ring.tryClaimRead(1, &position), 0);
+    ASSERT_EQ(ring.tryClaimWrite(2, &position), 1);
+    EXPECT_EQ(position, i);
+    ring.at(position) = i;
+    ring.publishWrite(position, 1);
+    // Full: the unread element must not be overwritten
+    EXPECT_FALSE(ring.writable());
+    EXPECT_EQ(ring.tryClaimWrite(1, &position), 0);
+    EXPECT_TRUE(ring.readable());
+    ASSERT_EQ(ring.tryClaimRead(2, &position), 1);
+    EXPECT_EQ(position, i);
+    EXPECT_EQ(ring.at(position), i);
+    ring.publishRead(position, 1);
+  }
+}
+
+TEST(MPMCRingTest, AbandonedWritesAreSkipped) {
+  MPMCRing<int> ring(3);
+  uint64_t position;
+  ASSERT_EQ(ring.tryClaimWrite(3, &position), 3);
+  ring.at(0) = 7;
+  ring.publishWrite(0, 1);
+  ring.abandonWrite(1, 2);
+  ASSERT_EQ(ring.tryClaimRead(3, &position), 3);
+  EXPECT_FALSE(ring.skipped(0));
+  EXPECT_TRUE(ring.skipped(1));
+  EXPECT_TRUE(ring.skipped(2));
+  ring.publishRead(0, 3);
+  // Reused slots are no longer skipped
+  ASSERT_EQ(ring.tryClaimWrite(3, &position), 3);
+  ring.publishWrite(position, 3);
+  ASSERT_EQ(ring.tryClaimRead(3, &position), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(ring.skipped(position + i));
+  }
+}
+
+TEST(MPMCRingTest, CloseWakesUpReaders) {
+  MPMCRing<int> ring(2);
+  std::thread reader([&ring]() { EXPECT_FALSE(ring.waitReadable()); });
+  ring.close();
+  reader.join();
+  EXPECT_TRUE(ring.closed());
+}
+
+TEST(MPMCRingTest, ManyProducersManyConsumers) {
+  for (size_t capacity : {1, 2, 7}) {
+    checkManyProducersManyConsumers(capacity);
+  }
+}
+
+} // namespace caffe2
@@ -130,41 +130,52 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
   bool dequeueMany(std::shared_ptr<BlobsQueue>& queue) {
     auto size = queue->getNumBlobs();
 
-    if (blobs_.size() != size) {
-      blobs_.resize(size);
-      blobPtrs_.resize(size);
-      for (int col = 0; col < size; ++col) {
-        blobPtrs_.at(col) = &blobs_.at(col);
+    if (blobs_.empty() || blobs_.size() != numRecords_ ||
+        blobs_[0].size() != size) {
+      blobs_.resize(numRecords_);
+      recordPtrs_.resize(numRecords_);
+      for (int row = 0; row < numRecords_; ++row) {
+        blobs_[row] = std::vector<Blob>(size);
+        recordPtrs_[row].resize(size);
+        for (int col = 0; col < size; ++col) {
+          recordPtrs_[row][col] = &blobs_[row][col];
+        }
       }
     }
 
     const int kTensorGrowthPct = 40;
-    for (int i = 0; i < numRecords_; ++i) {
-      if (!queue->blockingRead(blobPtrs_)) {
+    int i = 0;
+    while (i < numRecords_) {
+      // Take as many records as the queue has ready in one go.
+      auto count = queue->blockingReadMany(
+          c10::ArrayRef<std::vector<Blob*>>(recordPtrs_).slice(i));
+      if (count == 0) {
         // if we read at least one record, status is still true
         return i > 0;
       }
-      for (int col = 0; col < size; ++col) {
-        auto* out = this->Output(col);
-        const auto& in = blobPtrs_.at(col)->template Get<Tensor>();
-        if (i == 0) {
-          out->CopyFrom(in);
-        } else {
-          auto oldSize = out->numel();
-
-          CAFFE_ENFORCE(
-              in.dim() > 0,
-              "Empty tensor to dequeue at column ",
-              col,
-              " within ",
-              size,
-              " total columns");
-
-          out->Extend(in.sizes()[0], kTensorGrowthPct);
-          auto* dst =
-              (char*)out->raw_mutable_data() + oldSize * in.dtype().itemsize();
-          context_.template CopyItems<Context, Context>(
-              in.meta(), in.numel(), in.raw_data(), dst);
+      for (auto end = i + count; i < end; ++i) {
+        for (int col = 0; col < size; ++col) {
+          auto* out = this->Output(col);
+          const auto& in = recordPtrs_[i][col]->template Get<Tensor>();
+          if (i == 0) {
+            out->CopyFrom(in);
+          } else {
+            auto oldSize = out->numel();
+
+            CAFFE_ENFORCE(
+                in.dim() > 0,
+                "Empty tensor to dequeue at column ",
+                col,
+                " within ",
+                size,
+                " total columns");
+
+            out->Extend(in.sizes()[0], kTensorGrowthPct);
+            auto* dst = (char*)out->raw_mutable_data() +
+                oldSize * in.dtype().itemsize();
+            context_.template CopyItems<Context, Context>(
+                in.meta(), in.numel(), in.raw_data(), dst);
+          }
         }
       }
     }
@@ -194,8 +205,8 @@ class SafeDequeueBlobsOp final : public Operator<Context> {
 
  private:
   int numRecords_;
-  std::vector<Blob> blobs_;
-  std::vector<Blob*> blobPtrs_;
+  std::vector<std::vector<Blob>> blobs_;
+  std::vector<std::vector<Blob*>> recordPtrs_;
 };
 
 template <typename Context>
@@ -98,16 +98,12 @@ std::vector<std::vector<TensorCPU>> split(
 } // anonymous namespace
 
 RebatchingQueue::RebatchingQueue(size_t capacity, size_t numBlobs)
-    : capacity_(capacity), numBlobs_(numBlobs), queue_(capacity) {}
+    : numBlobs_(numBlobs), queue_(capacity) {}
 
 RebatchingQueue::~RebatchingQueue() {
   close();
 }
 
-bool RebatchingQueue::canRead() const {
-  return tail_ < head_;
-}
-
 bool RebatchingQueue::dequeue(
     CPUContext& context,
     size_t numElements,
@@ -115,31 +111,22 @@ bool RebatchingQueue::dequeue(
   std::vector<std::vector<TensorCPU>> results;
   results.reserve(numElements);
 
-  for (;;) {
-    if (results.size() == numElements) {
-      break;
-    }
-
-    {
-      std::unique_lock<std::mutex> lock(mutex_);
-
-      cvEmpty_.wait(lock, [this] { return canRead() || isClosed_; });
-
+  while (results.size() < numElements) {
+    uint64_t position;
+    const auto count =
+        queue_.tryClaimRead(numElements - results.size(), &position);
+    if (count == 0) {
       // We only want to stop reading if the queue is empty and closed
-      if (!canRead() && isClosed_) {
+      if (!queue_.waitReadable()) {
         break;
       }
-
-      do {
-        results.push_back(std::move(queue_[tail_++ % capacity()]));
-      } while (canRead() && results.size() < numElements);
+      continue;
     }
 
-    if (numElements == 1) {
-      cvOverflow_.notify_one();
-    } else {
-      cvOverflow_.notify_all();
+    for (size_t i = 0; i < count; ++i) {
+      results.push_back(std::move(queue_.at(position + i)));
     }
+    queue_.publishRead(position, count);
   }
 
   if (results.empty()) {
@@ -151,10 +138,6 @@ bool RebatchingQueue::dequeue(
   return true;
 }
 
-bool RebatchingQueue::canWrite() const {
-  return tail_ + capacity() > head_;
-}
-
 bool RebatchingQueue::enqueueOne(
     CPUContext& /*context*/,
     const std::vector<const TensorCPU*>& inputs) {
@@ -181,36 +164,33 @@ bool RebatchingQueue::enqueueMany(
 
 bool RebatchingQueue::enqueue(
     std::vector<std::vector<TensorCPU>> splittedInputs) {
-  int idx = 0;
-  for (;;) {
-    if (idx >= splittedInputs.size()) {
-      break;
+  size_t idx = 0;
+  while (idx < splittedInputs.size()) {
+    if (queue_.closed()) {
+      // If we are here it means that we didn't apply the entire batch and if
+      // we get closed in the middle of enquing we treat it as a non-success.
+      return false;
     }
 
-    {
-      std::unique_lock<std::mutex> lock(mutex_);
-
-      cvOverflow_.wait(lock, [this] { return canWrite() || isClosed_; });
-
-      if (isClosed_) {
-        // If we are here it means that we didn't apply the entire batch and if
-        // we get closed in the middle of enquing we treat it as a non-success.
-        return false;
-      }
-
-      do {
-        queue_[head_++ % capacity()] = std::move(splittedInputs[idx++]);
-      } while (canWrite() && idx < splittedInputs.size());
+    uint64_t position;
+    const auto count =
+        queue_.tryClaimWrite(splittedInputs.size() - idx, &position);
+    if (count == 0) {
+      queue_.waitWritable();
+      continue;
     }
 
-    cvEmpty_.notify_all();
+    for (size_t i = 0; i < count; ++i) {
+      queue_.at(position + i) = std::move(splittedInputs[idx++]);
+    }
+    queue_.publishWrite(position, count);
   }
 
   return true;
 }
 
 size_t RebatchingQueue::capacity() const {
-  return capacity_;
+  return queue_.capacity();
 }
 
 size_t RebatchingQueue::numBlobs() const {
@@ -218,17 +198,10 @@ size_t RebatchingQueue::numBlobs() const {
 }
 
 bool RebatchingQueue::isClosed() const {
-  std::lock_guard<std::mutex> g(mutex_);
-  return isClosed_;
+  return queue_.closed();
 }
 
 void RebatchingQueue::close() {
-  {
-    std::lock_guard<std::mutex> g(mutex_);
-    isClosed_ = true;
-  }
-
-  cvEmpty_.notify_all();
-  cvOverflow_.notify_all();
+  queue_.close();
 }
 } // caffe2
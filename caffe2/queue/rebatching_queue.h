@@ -1,21 +1,17 @@
 #pragma once
 
-#include <atomic>
-#include <condition_variable>
 #include <memory>
-#include <mutex>
-#include <queue>
 
 #include "caffe2/core/logging.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/stats.h"
 #include "caffe2/core/tensor.h"
+#include "caffe2/queue/mpmc_ring.h"
 
 namespace caffe2 {
 
-// TODO: This is a very naive implementation with a single mutex. We can do the
-// atomic index + circular queue optimizations or pull something more
-// heavy-weight later
+// Queue of rows backed by a lock-free ring (see MPMCRing). enqueueMany and
+// dequeue move as many rows per claim as the ring has room or data for.
 
 class RebatchingQueue {
  public:
@@ -47,22 +43,8 @@ class RebatchingQueue {
  private:
   bool enqueue(std::vector<std::vector<TensorCPU>> splittedInputs);
 
-  bool canWrite() const;
-  bool canRead() const;
-
-  const size_t capacity_;
   const size_t numBlobs_;
 
-  mutable std::mutex mutex_;
-
-  bool isClosed_{false};
-
-  uint64_t head_{0};
-  uint64_t tail_{0};
-
-  std::condition_variable cvEmpty_;
-  std::condition_variable cvOverflow_;
-
-  std::vector<std::vector<TensorCPU>> queue_;
+  MPMCRing<std::vector<TensorCPU>> queue_;
 };
 } // caffe2
@@ -2,6 +2,8 @@
 
 #include "caffe2/core/operator.h"
 #include "caffe2/perfkernels/adagrad.h"
+#include "caffe2/perfkernels/rowwise_update.h"
+#include "caffe2/sgd/rowwise_sparse_utils.h"
 
 namespace caffe2 {
 
@@ -243,7 +245,10 @@ class RowWiseSparseAdagradOp final : public Operator<Context> {
   USE_OPERATOR_CONTEXT_FUNCTIONS;
   RowWiseSparseAdagradOp(const OperatorDef& operator_def, Workspace* ws)
       : Operator<Context>(operator_def, ws),
-        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)) {}
+        ws_(ws),
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)),
+        dedup_indices_(
+            this->template GetSingleArgument<bool>("dedup_indices", false)) {}
 
   bool RunOnDevice() override {
     // Enforce shapes
@@ -274,6 +279,37 @@ class RowWiseSparseAdagradOp final : public Operator<Context> {
 
     auto block_size = Input(GRAD).numel() / n;
 
+    if (dedup_indices_) {
+      DeduplicateRowGradients(
+          n,
+          block_size,
+          Input(PARAM).size(0),
+          indices,
+          gradIn,
+          &order_,
+          &unique_indices_,
+          &unique_grad_);
+      // Every unique index owns its rows: update disjoint shards in parallel.
+      RunInShards(
+          ws_->GetThreadPool(),
+          unique_indices_.size(),
+          block_size,
+          kRowWiseUpdateMinWorkPerShard,
+          [&](int64_t begin, int64_t end) {
+            for (auto k = begin; k < end; ++k) {
+              const auto idx = unique_indices_[k];
+              rowwise_adagrad_update_row(
+                  block_size,
+                  paramOut + idx * block_size,
+                  unique_grad_.data() + k * block_size,
+                  momentOut + idx,
+                  epsilon_,
+                  lr[0]);
+            }
+          });
+      return true;
+    }
+
     for (auto i = 0; i < n; ++i) {
       auto idx = indices[i];
       if (block_size == 1) {
@@ -305,28 +341,26 @@ class RowWiseSparseAdagradOp final : public Operator<Context> {
             i);
 #endif
 
-        const float* w = paramIn + offsetIdx;
-        const float* g = gradIn + offsetI;
-        const float* h = momentIn + idx;
-        float* nw = paramOut + offsetIdx;
-        float* nh = momentOut + idx;
-        float hs = 0.;
-        for (auto j = 0; j < block_size; ++j) {
-          float gj = g[j];
-          hs += gj * gj;
-        }
-        float hi = nh[0] = h[0] + hs / block_size;
-        float step = lr[0] / (std::sqrt(hi) + epsilon_);
-        for (auto j = 0; j < block_size; ++j) {
-          nw[j] = w[j] + g[j] * step;
-        }
+        // param and moment are updated in place
+        rowwise_adagrad_update_row(
+            block_size,
+            paramOut + offsetIdx,
+            gradIn + offsetI,
+            momentOut + idx,
+            epsilon_,
+            lr[0]);
       }
     }
     return true;
   }
 
  protected:
+  Workspace* ws_;
   T epsilon_;
+  bool dedup_indices_;
+  std::vector<int64_t> order_;
+  std::vector<int64_t> unique_indices_;
+  std::vector<float> unique_grad_;
   INPUT_TAGS(PARAM, MOMENT_1, INDICES, GRAD, LR);
   OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1);
 };
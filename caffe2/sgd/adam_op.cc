@@ -94,7 +94,8 @@ OPERATOR_SCHEMA(RowWiseSparseAdam)
     with length equal to the number of rows in param:
     shape(moment2) == shape(param)[0]. Each element of  moment2 is
     applied to an entire row of param, and the new moment2 values are
-    calculated by averaging across the row.
+    calculated by averaging across the row. moment1 may be stored in fp16,
+    the update is always computed in fp32.
 
     )DOC")
     .Input(0, "param", "Parameters to be updated")
@@ -110,7 +111,12 @@ OPERATOR_SCHEMA(RowWiseSparseAdam)
     .Output(3, "output_grad", "Optional Effective gradient")
     .Arg("beta1", "Default 0.9")
     .Arg("beta2", "Default 0.999")
-    .Arg("epsilon", "Default 1e-5");
+    .Arg("epsilon", "Default 1e-5")
+    .Arg(
+        "dedup_indices",
+        "Default false. If true, the gradients of duplicate indices are "
+        "summed and the unique rows are updated in parallel. Not supported "
+        "together with output_grad.");
 
 SHOULD_NOT_DO_GRADIENT(Adam);
 SHOULD_NOT_DO_GRADIENT(SparseAdam);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/rowwise_update.h"
+#include "caffe2/sgd/rowwise_sparse_utils.h"
 
 namespace caffe2 {
 
@@ -514,9 +516,12 @@ class RowWiseSparseAdamOp final : public Operator<Context> {
   USE_OPERATOR_CONTEXT_FUNCTIONS;
   RowWiseSparseAdamOp(const OperatorDef& operator_def, Workspace* ws)
       : Operator<Context>(operator_def, ws),
+        ws_(ws),
         beta1_(this->template GetSingleArgument<float>("beta1", 0.9f)),
         beta2_(this->template GetSingleArgument<float>("beta2", 0.999f)),
-        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)) {}
+        epsilon_(this->template GetSingleArgument<float>("epsilon", 1e-5f)),
+        dedup_indices_(
+            this->template GetSingleArgument<bool>("dedup_indices", false)) {}
 
   bool RunOnDevice() override {
     // Enforce shapes
@@ -526,6 +531,9 @@ class RowWiseSparseAdamOp final : public Operator<Context> {
         Input(PARAM).size_from_dim(1),
         Input(GRAD).size_from_dim(Input(INDICES).dim()));
     CAFFE_ENFORCE_EQ(Input(LR).numel(), 1);
+    CAFFE_ENFORCE(
+        !dedup_indices_ || OutputSize() == 3,
+        "dedup_indices doesn't support the effective gradient output");
 
     return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
         this, Input(INDICES));
@@ -533,6 +541,14 @@ class RowWiseSparseAdamOp final : public Operator<Context> {
 
   template <typename SIndex>
   bool DoRunWithType() {
+    if (Input(MOMENT_1).template IsType<at::Half>()) {
+      return DoRunWithMomentType<SIndex, at::Half>();
+    }
+    return DoRunWithMomentType<SIndex, T>();
+  }
+
+  template <typename SIndex, typename TMoment>
+  bool DoRunWithMomentType() {
     const auto* lr = Input(LR).template data<T>();
     const auto iter =
         OperatorBase::Input<Tensor>(ITER, CPU).template data<int64_t>()[0];
@@ -544,145 +560,126 @@ class RowWiseSparseAdamOp final : public Operator<Context> {
     auto block_size = Input(PARAM).numel() / Input(PARAM).size(0);
     auto n = Input(GRAD).numel() / block_size;
 
-    const auto* paramIn = Input(PARAM).template data<T>();
     const auto* indices = Input(INDICES).template data<SIndex>();
     const auto* gradIn = Input(GRAD).template data<T>();
-    const auto* moment1In = Input(MOMENT_1).template data<T>();
-    const auto* moment2In = Input(MOMENT_2).template data<T>();
+    // param and moments are updated in place
     auto* paramOut = Output(OUTPUT_PARAM)->template mutable_data<T>();
-    auto* moment1Out = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
+    auto* moment1Out =
+        Output(OUTPUT_MOMENT_1)->template mutable_data<TMoment>();
     auto* moment2Out = Output(OUTPUT_MOMENT_2)->template mutable_data<T>();
 
-    if (OutputSize() == 3) {
-      for (auto i = 0; i < n; ++i) {
-        auto idx = indices[i];
-
-        if (block_size == 1) {
-          float gi = gradIn[i];
-          float mi = moment1Out[idx] =
-              moment1In[idx] * beta1_ + gi * (1 - beta1_);
-          float vi = moment2Out[idx] =
-              moment2In[idx] * beta2_ + gi * gi * (1 - beta2_);
-          paramOut[idx] = paramIn[idx] +
-              lr[0] * correction * mi / (std::sqrt(vi) + epsilon_);
-
-        } else {
-          auto offsetI = i * block_size;
-          auto offsetIdx = idx * block_size;
-
-#ifndef NDEBUG
-          CAFFE_ENFORCE_GE(
-              Input(PARAM).numel(),
-              block_size + offsetIdx,
-              this->debug_def().input(PARAM),
-              ", out of bound,  idx:",
-              idx,
-              " for input i:",
-              i,
-              " and block size:",
-              block_size);
-          CAFFE_ENFORCE_GE(
-              Input(GRAD).numel(),
-              block_size + offsetI,
-              this->debug_def().input(GRAD),
-              ", out of bound idx, idx:",
-              idx,
-              " for input i:",
-              i);
-#endif
+    if (dedup_indices_) {
+      DeduplicateRowGradients(
+          n,
+          block_size,
+          Input(PARAM).size(0),
+          indices,
+          gradIn,
+          &order_,
+          &unique_indices_,
+          &unique_grad_);
+      // Every unique index owns its rows: update disjoint shards in parallel.
+      RunInShards(
+          ws_->GetThreadPool(),
+          unique_indices_.size(),
+          block_size,
+          kRowWiseUpdateMinWorkPerShard,
+          [&](int64_t begin, int64_t end) {
+            for (auto k = begin; k < end; ++k) {
+              const auto idx = unique_indices_[k];
+              updateRow(
+                  block_size,
+                  paramOut + idx * block_size,
+                  unique_grad_.data() + k * block_size,
+                  moment1Out + idx * block_size,
+                  moment2Out + idx,
+                  correction,
+                  lr[0],
+                  nullptr);
+            }
+          });
+      return true;
+    }
 
-          const float* w = paramIn + offsetIdx;
-          const float* g = gradIn + offsetI;
-          const float* m1 = moment1In + offsetIdx;
-          const float* m2 = moment2In + idx;
-          float* nw = paramOut + offsetIdx;
-          float* nm1 = moment1Out + offsetIdx;
-          float* nm2 = moment2Out + idx;
-
-          float m2_sum = 0.;
-          for (auto j = 0; j < block_size; ++j) {
-            float gj = g[j];
-            m2_sum += gj * gj;
-          }
-          float vi = nm2[0] =
-              m2[0] * beta2_ + (m2_sum / block_size) * (1 - beta2_);
-          for (auto j = 0; j < block_size; ++j) {
-            float mi = nm1[j] = m1[j] * beta1_ + g[j] * (1 - beta1_);
-            nw[j] = w[j] + lr[0] * correction * mi / (std::sqrt(vi) + epsilon_);
-          }
-        }
-      }
-    } else {
+    T* gradOut = nullptr;
+    if (OutputSize() == 4) {
       Output(OUTPUT_GRAD)->ResizeLike(Input(GRAD));
-      auto* gradOut = Output(OUTPUT_GRAD)->template mutable_data<T>();
-      for (auto i = 0; i < n; ++i) {
-        auto idx = indices[i];
-
-        if (block_size == 1) {
-          float gi = gradIn[i];
-          float mi = moment1Out[idx] =
-              moment1In[idx] * beta1_ + gi * (1 - beta1_);
-          float vi = moment2Out[idx] =
-              moment2In[idx] * beta2_ + gi * gi * (1 - beta2_);
-          float ngi = gradOut[i] = correction * mi / (std::sqrt(vi) + epsilon_);
-          paramOut[idx] = paramIn[idx] + lr[0] * ngi;
-
-        } else {
-          auto offsetI = i * block_size;
-          auto offsetIdx = idx * block_size;
+      gradOut = Output(OUTPUT_GRAD)->template mutable_data<T>();
+    }
+    for (auto i = 0; i < n; ++i) {
+      auto idx = indices[i];
+      auto offsetI = i * block_size;
+      auto offsetIdx = idx * block_size;
 
 #ifndef NDEBUG
-          CAFFE_ENFORCE_GE(
-              Input(PARAM).numel(),
-              block_size + offsetIdx,
-              this->debug_def().input(PARAM),
-              ", out of bound,  idx:",
-              idx,
-              " for input i:",
-              i,
-              " and block size:",
-              block_size);
-          CAFFE_ENFORCE_GE(
-              Input(GRAD).numel(),
-              block_size + offsetI,
-              this->debug_def().input(GRAD),
-              ", out of bound idx, idx:",
-              idx,
-              " for input i:",
-              i);
+      CAFFE_ENFORCE_GE(
+          Input(PARAM).numel(),
+          block_size + offsetIdx,
+          this->debug_def().input(PARAM),
+          ", out of bound,  idx:",
+          idx,
+          " for input i:",
+          i,
+          " and block size:",
+          block_size);
+      CAFFE_ENFORCE_GE(
+          Input(GRAD).numel(),
+          block_size + offsetI,
+          this->debug_def().input(GRAD),
+          ", out of bound idx, idx:",
+          idx,
+          " for input i:",
+          i);
 #endif
 
-          const float* w = paramIn + offsetIdx;
-          const float* g = gradIn + offsetI;
-          const float* m1 = moment1In + offsetIdx;
-          const float* m2 = moment2In + idx;
-          float* nw = paramOut + offsetIdx;
-          float* nm1 = moment1Out + offsetIdx;
-          float* nm2 = moment2Out + idx;
-          float* ng = gradOut + offsetI;
-
-          float m2_sum = 0.;
-          for (auto j = 0; j < block_size; ++j) {
-            float gj = g[j];
-            m2_sum += gj * gj;
-          }
-          float vi = nm2[0] =
-              m2[0] * beta2_ + (m2_sum / block_size) * (1 - beta2_);
-          for (auto j = 0; j < block_size; ++j) {
-            float mi = nm1[j] = m1[j] * beta1_ + g[j] * (1 - beta1_);
-            float ngi = ng[j] = correction * mi / (std::sqrt(vi) + epsilon_);
-            nw[j] = w[j] + lr[0] * ngi;
-          }
-        }
-      }
+      updateRow(
+          block_size,
+          paramOut + offsetIdx,
+          gradIn + offsetI,
+          moment1Out + offsetIdx,
+          moment2Out + idx,
+          correction,
+          lr[0],
+          gradOut ? gradOut + offsetI : nullptr);
     }
     return true;
   }
 
  protected:
+  void updateRow(
+      int N,
+      float* w,
+      const float* g,
+      float* m1,
+      float* m2,
+      float correction,
+      float lr,
+      float* ng) {
+    rowwise_adam_update_row(
+        N, w, g, m1, m2, beta1_, beta2_, epsilon_, correction, lr, ng);
+  }
+
+  void updateRow(
+      int N,
+      float* w,
+      const float* g,
+      at::Half* m1,
+      float* m2,
+      float correction,
+      float lr,
+      float* ng) {
+    rowwise_adam_fp16_update_row(
+        N, w, g, m1, m2, beta1_, beta2_, epsilon_, correction, lr, ng);
+  }
+
+  Workspace* ws_;
   T beta1_;
   T beta2_;
   T epsilon_;
+  bool dedup_indices_;
+  std::vector<int64_t> order_;
+  std::vector<int64_t> unique_indices_;
+  std::vector<float> unique_grad_;
   INPUT_TAGS(PARAM, MOMENT_1, MOMENT_2, INDICES, GRAD, LR, ITER);
   OUTPUT_TAGS(OUTPUT_PARAM, OUTPUT_MOMENT_1, OUTPUT_MOMENT_2, OUTPUT_GRAD);
 };
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/perfkernels/typed_axpy.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
+
+namespace caffe2 {
+
+// Work, in elements, below which a row-wise sparse update is not split
+// across threads.
+constexpr int64_t kRowWiseUpdateMinWorkPerShard = 1 << 16;
+
+// Gathers the gradient rows of a sparse update by index. unique_indices gets
+// every index once, in increasing order, and unique_grad the sum of the
+// gradient rows hitting that index, in the order they appear in the batch.
+// Since every unique index then owns its rows of the parameters, the update
+// can be split across threads without any locking.
+template <typename SIndex>
+void DeduplicateRowGradients(
+    int64_t num_rows,
+    int64_t block_size,
+    int64_t num_param_rows,
+    const SIndex* indices,
+    const float* grad,
+    std::vector<int64_t>* order,
+    std::vector<int64_t>* unique_indices,
+    std::vector<float>* unique_grad) {
+  order->resize(num_rows);
+  std::iota(order->begin(), order->end(), 0);
+  std::stable_sort(
+      order->begin(), order->end(), [indices](int64_t a, int64_t b) {
+        return indices[a] < indices[b];
+      });
+
+  unique_indices->clear();
+  unique_grad->clear();
+  unique_grad->reserve(num_rows * block_size);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    const auto row = (*order)[i];
+    const auto idx = indices[row];
+    const float* g = grad + row * block_size;
+    if (!unique_indices->empty() && unique_indices->back() == idx) {
+      TypedAxpy<float, float>(
+          block_size,
+          1.f,
+          g,
+          unique_grad->data() + unique_grad->size() - block_size);
+      continue;
+    }
+    CAFFE_ENFORCE(
+        0 <= idx && idx < num_param_rows,
+        "Index out of bound: ",
+        idx,
+        " for ",
+        num_param_rows,
+        " rows");
+    unique_indices->push_back(idx);
+    unique_grad->insert(unique_grad->end(), g, g + block_size);
+  }
+}
+
+// Calls fn(begin, end) on contiguous shards of [0, n) in parallel. Shards get
+// at least min_work_per_shard / work_per_item items so that small updates
+// stay on the calling thread.
+inline void RunInShards(
+    ThreadPool* pool,
+    int64_t n,
+    int64_t work_per_item,
+    int64_t min_work_per_shard,
+    const std::function<void(int64_t, int64_t)>& fn) {
+  int64_t num_shards = 1;
+  if (pool) {
+    num_shards = std::min<int64_t>(
+        pool->getNumThreads(),
+        n * work_per_item / std::max<int64_t>(min_work_per_shard, 1));
+  }
+  if (num_shards <= 1) {
+    fn(0, n);
+    return;
+  }
+  pool->run(
+      [&](int /* thread_id */, size_t shard) {
+        fn(n * shard / num_shards, n * (shard + 1) / num_shards);
+      },
+      num_shards);
+}
+
+} // namespace caffe2
@@ -123,6 +123,36 @@ TEST(AutogradAPITests, GradUnreachableTest) {
   ASSERT_FALSE(grad_res[1].defined());
 }
 
+TEST(AutogradAPITests, CheckpointPlannerTest) {
+  Variable x = torch::randn({8, 8}, torch::requires_grad());
+  Variable w1 = torch::randn({8, 8}, torch::requires_grad());
+  Variable w2 = torch::randn({8, 8}, torch::requires_grad());
+
+  auto block = [](Variable w) {
+    return [w](const variable_list& inputs) -> variable_list {
+      return {torch::relu(torch::mm(inputs[0], w)).tanh()};
+    };
+  };
+
+  auto expected = grad(
+      {(torch::relu(torch::mm(torch::relu(torch::mm(x, w1)).tanh(), w2)).tanh())
+           .sum()},
+      {x, w1, w2});
+
+  CheckpointPlanner planner;
+  Variable out = planner.run_segment(block(w1), {x})[0];
+  out = planner.run_segment(block(w2), {out})[0];
+  auto held = planner.saved_bytes();
+  ASSERT_GT(held, 0);
+  ASSERT_EQ(planner.plan(held), held);
+  ASSERT_LT(planner.plan(0), held);
+
+  auto result = grad({out.sum()}, {x, w1, w2});
+  for (size_t i = 0; i < result.size(); ++i) {
+    ASSERT_VARIABLE_EQ(result[i], expected[i]);
+  }
+}
+
 TEST(CustomAutogradTest, CustomFunction) {
   struct MyFunction : public Function<MyFunction> {
     static Variable forward(AutogradContext *ctx, Variable var1, int mul, Variable var2) {
@@ -3,6 +3,7 @@
 #include <torch/csrc/autograd/generated/variable_factories.h>
 #include <torch/csrc/jit/mobile/import.h>
 #include <torch/csrc/jit/mobile/module.h>
+#include <torch/csrc/jit/mobile/op_table.h>
 #include <torch/csrc/jit/import.h>
 
 // Tests go in torch::jit
@@ -153,5 +154,36 @@ void testLiteInterpreterPrim() {
   auto refi = ref.toInt();
   AT_ASSERT(resi == refi);
 }
+
+void testLiteInterpreterOpTable() {
+  auto table = mobile::opTable();
+  for (size_t i = 0; i < table.size(); ++i) {
+    c10::OperatorName opname(table[i].name, table[i].overload_name);
+    auto index = mobile::findOpTableIndex(opname);
+    AT_ASSERT(index.has_value() && *index == i);
+    if (i > 0) {
+      c10::OperatorName prev(table[i - 1].name, table[i - 1].overload_name);
+      AT_ASSERT(prev.name < opname.name ||
+                (prev.name == opname.name && prev.overload_name < opname.overload_name));
+    }
+  }
+  AT_ASSERT(!mobile::findOpTableIndex(c10::OperatorName("aten::not_an_op", "")));
+
+  // Operators resolved through the table and through the dispatcher can be
+  // mixed in a single method.
+  script::Module m("m");
+  m.define(R"JIT(
+  def forward(self, x):
+      result = [1, 2]
+      result.append(3)
+      return torch.relu(x) + result[2]
+  )JIT");
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  mobile::Module bc = _load_for_mobile(ss);
+  std::vector<torch::jit::IValue> inputs({-torch::ones({})});
+  auto output = bc.run_method("forward", inputs);
+  AT_ASSERT(output.toTensor().item<float>() == 3);
+}
 } // namespace torch
 } // namespace jit
@@ -79,7 +79,8 @@ namespace jit {
   _(CommonAncestor)                    \
   _(AutogradSymbols)                   \
   _(MobileTypeParser)                  \
-  _(LiteInterpreterPrim)
+  _(LiteInterpreterPrim)               \
+  _(LiteInterpreterOpTable)
 
 #define TH_FORALL_TESTS_CUDA(_) \
   _(ArgumentSpec)               \
@@ -2148,6 +2148,87 @@ class TestAutograd(TestCase):
             y = x * 2
         self.assertTrue(y.requires_grad)
 
+    def test_inference_mode(self):
+        x = torch.ones(2, 3, requires_grad=True)
+        with torch.autograd.inference_mode():
+            self.assertFalse(torch.is_grad_enabled())
+            y = x * 2
+            y.add_(1)
+            v = y.view(6)
+            d = y.detach()
+            n = torch.ones(1)
+            with torch.autograd.inference_mode(False):
+                self.assertFalse(torch.is_grad_enabled())
+                self.assertFalse(torch.ones(1)._is_inference())
+            self.assertTrue(torch._C._is_inference_mode_enabled())
+        self.assertTrue(torch.is_grad_enabled())
+        self.assertFalse(torch._C._is_inference_mode_enabled())
+
+        self.assertFalse(x._is_inference())
+        for t in (y, v, d, n):
+            self.assertTrue(t._is_inference())
+            self.assertFalse(t.requires_grad)
+            self.assertIsNone(t.grad_fn)
+        self.assertEqual(y, torch.full((2, 3), 3))
+        self.assertEqual(v.data_ptr(), y.data_ptr())
+
+        # Outside of inference mode, functional ops on inference tensors
+        # give normal tensors.
+        w = y + 1
+        self.assertFalse(w._is_inference())
+
+        with self.assertRaisesRegex(RuntimeError, "Inference tensors cannot require gradients"):
+            y.requires_grad_()
+        with self.assertRaisesRegex(RuntimeError, "Inference tensors cannot be saved for backward"):
+            y * x
+        with self.assertRaisesRegex(RuntimeError, "Inplace update to inference tensor outside InferenceMode"):
+            y.add_(x)
+        with self.assertRaisesRegex(RuntimeError, "Inference tensors do not track version counter"):
+            y._version
+
+        z = y.clone()
+        self.assertFalse(z._is_inference())
+        (z * x).sum().backward()
+        self.assertEqual(x.grad, z)
+
+        # Views of inference tensors taken outside of inference mode are
+        # inference tensors too, so they can't be saved for backward and then
+        # be modified behind autograd's back through their base.
+        v = y[0]
+        self.assertTrue(v._is_inference())
+        with self.assertRaisesRegex(RuntimeError, "Inference tensors cannot be saved for backward"):
+            v * x[0]
+        y.mul_(2)
+        self.assertEqual(v, torch.full((3,), 6))
+        # Neither can normal tensors aliasing an inference storage.
+        a = torch.empty(0).set_(y.storage())
+        self.assertFalse(a._is_inference())
+        with self.assertRaisesRegex(RuntimeError, "Inference tensors cannot be saved for backward"):
+            a * x.view(6)
+
+        # A view of a normal tensor taken in inference mode doesn't share the
+        # version counter of its base, so updating the base through it outside
+        # of the mode is an error, and leaves the base untouched.
+        base = torch.ones(2, 3)
+        with torch.autograd.inference_mode():
+            bv = base[0]
+        self.assertTrue(bv._is_inference())
+        w = torch.ones(2, 3, requires_grad=True)
+        out = w * base
+        version = base._version
+        with self.assertRaisesRegex(RuntimeError, "Inplace update to inference tensor outside InferenceMode"):
+            bv.add_(1)
+        self.assertEqual(base, torch.ones(2, 3))
+        self.assertEqual(base._version, version)
+        out.sum().backward()
+        self.assertEqual(w.grad, torch.ones(2, 3))
+
+        @torch.autograd.inference_mode()
+        def doubler(x):
+            return x * 2
+        self.assertTrue(doubler(x)._is_inference())
+        self.assertTrue(torch.is_grad_enabled())
+
     def test_reentrant(self):
         y_data = torch.randn(2, 2)
 
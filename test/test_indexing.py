@@ -115,6 +115,40 @@ class TestIndexing(TestCase):
         res = src.index_put_(indices, vals, accumulate=True)
         self.assertEqual(res.shape, src.shape)
 
+    def test_index_put_accumulate_large(self, device):
+        # enough elements with duplicate indices to be reduced in parallel
+        t = torch.zeros(100, 3, dtype=torch.double, device=device)
+        indices = torch.randint(0, 100, (100000,), device=device)
+        values = torch.randn(100000, 3, dtype=torch.double, device=device)
+        t.index_put_((indices,), values, accumulate=True)
+        expected = torch.zeros(100, 3, dtype=torch.double, device=device).index_add_(0, indices, values)
+        self.assertEqual(t, expected)
+        self._check_index_put_accumulate_threads(t, indices, values)
+
+    def test_index_put_accumulate_hot_index(self, device):
+        # more than one block of elements, mostly adding to a single destination
+        n = 1200000
+        indices = torch.randint(0, 1000, (n,), device=device)
+        indices[torch.rand(n, device=device) < 0.9] = 0
+        values = torch.randn(n, dtype=torch.double, device=device)
+        t = torch.zeros(1000, dtype=torch.double, device=device)
+        t.index_put_((indices,), values, accumulate=True)
+        expected = torch.zeros(1000, dtype=torch.double, device=device).index_add_(0, indices, values)
+        self.assertEqual(t, expected)
+        self._check_index_put_accumulate_threads(t, indices, values)
+
+    def _check_index_put_accumulate_threads(self, t, indices, values):
+        # the parallel reduction must give the same result as the serial one
+        num_threads = torch.get_num_threads()
+        results = []
+        try:
+            for threads in (1, max(2, num_threads)):
+                torch.set_num_threads(threads)
+                results.append(torch.zeros_like(t).index_put_((indices,), values, accumulate=True))
+        finally:
+            torch.set_num_threads(num_threads)
+        self.assertEqual(results[0], results[1], prec=0)
+
     @dtypes(torch.float, torch.bfloat16, torch.long, torch.bool)
     @dtypesIfCPU(torch.float, torch.long, torch.bfloat16, torch.bool)
     @dtypesIfCUDA(torch.half, torch.long, torch.bfloat16, torch.bool)
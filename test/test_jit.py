@@ -6041,6 +6041,49 @@ a")
             # this triggers 2 bailouts
             self.assertEqual(def_in_one_branch(a, True), 3.0)
 
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING, "skip if profiling isn't enabled")
+    def test_profiling_plan_cache(self):
+        @torch.jit.script
+        def add_one(x):
+            return x + 1
+
+        a = torch.rand(2, 3)
+        b = torch.rand(4)
+        c = torch.rand(5, 5)
+
+        old_size = torch._C._jit_set_profiling_plan_cache_size(2)
+        try:
+            with enable_profiling_mode():
+                # profile and specialize for a
+                add_one(a)
+                add_one(a)
+                # a one-off shape runs the plan for a and bails out
+                self.assertEqual(add_one(b), b + 1)
+                stats = add_one.get_debug_state().stats
+                self.assertEqual(stats.plan_cache_hits, 0)
+                self.assertGreater(stats.bailouts, 0)
+                # a recurring shape gets its own plan
+                for _ in range(3):
+                    self.assertEqual(add_one(b), b + 1)
+                bailouts = add_one.get_debug_state().stats.bailouts
+                for x in (a, b, a, b):
+                    self.assertEqual(add_one(x), x + 1)
+                stats = add_one.get_debug_state().stats
+                self.assertEqual(stats.bailouts, bailouts)
+                self.assertEqual(stats.plan_cache_evictions, 0)
+                self.assertGreaterEqual(stats.plan_cache_hits, 4)
+                # a third shape evicts the least recently used plan
+                for _ in range(4):
+                    self.assertEqual(add_one(c), c + 1)
+                self.assertEqual(add_one.get_debug_state().stats.plan_cache_evictions, 1)
+                # shapes that keep changing don't trigger profiling runs
+                for n in range(1, 11):
+                    x = torch.rand(n, 7)
+                    self.assertEqual(add_one(x), x + 1)
+                self.assertEqual(add_one.get_debug_state().stats.plan_cache_evictions, 1)
+        finally:
+            torch._C._jit_set_profiling_plan_cache_size(old_size)
+
     def test_resize_input_ops(self):
         # resize_ and resize_as resize the input tensor. because our shape analysis
         # is flow invariant, we set any Tensor that can alias a resized Tensor
@@ -11784,6 +11827,76 @@ a")
             self.assertEqual(torch.autograd.grad(slstm(*inputs).sum(), inputs),
                              torch.autograd.grad(lstm(*inputs).sum(), inputs))
 
+    def test_linear_batching(self):
+        input_str = """
+graph(%x : Tensor, %w1 : Tensor, %w2 : Tensor, %w3 : Tensor, %b1 : Tensor, %b2 : Tensor, %b3 : Tensor):
+  %y1 : Tensor = aten::linear(%x, %w1, %b1)
+  %y2 : Tensor = aten::linear(%x, %w2, %b2)
+  %z : Tensor = aten::linear(%y1, %w3, %b3)
+  %w3_t : Tensor = aten::t(%w3)
+  %y3 : Tensor = aten::mm(%x, %w3_t)
+  %w2_t : Tensor = aten::t(%w2)
+  %y4 : Tensor = aten::mm(%x, %w2_t)
+  return (%y1, %y2, %z, %y3, %y4)
+"""
+        graph = parse_ir(input_str)
+        self.run_pass('batch_mm', graph)
+        # the linear depending on another one is left alone
+        FileCheck().check_count("prim::LinearBatchSide", 2, exactly=True) \
+            .check_count("aten::linear", 1, exactly=True) \
+            .check_not("aten::mm").run(str(graph))
+
+        fn = self.createFunctionFromGraph(graph)
+        # enough rows for the weights to be concatenated
+        x = torch.randn(200, 4)
+        w1, w2, w3 = torch.randn(3, 4), torch.randn(2, 4), torch.randn(4, 4)
+        b1, b2, b3 = torch.randn(3), torch.randn(2), torch.randn(4)
+        inputs = (x, w1, w2, w3, b1, b2, b3)
+
+        def expected():
+            y1 = F.linear(x, w1, b1)
+            return (y1, F.linear(x, w2, b2), F.linear(y1, w3, b3), x.mm(w3.t()), x.mm(w2.t()))
+
+        self.assertEqual(fn(*inputs), expected())
+        with torch.no_grad():
+            self.assertEqual(fn(*inputs), expected())
+            # weights changed in place between calls are picked up
+            w2.add_(1)
+            self.assertEqual(fn(*inputs), expected())
+
+        # optimizers update parameters through .data, which doesn't bump the
+        # version counter of the parameter itself
+        w1 = torch.nn.Parameter(w1)
+        inputs = (x, w1, w2, w3, b1, b2, b3)
+        with torch.no_grad():
+            self.assertEqual(fn(*inputs), expected())
+        w1.data.add_(1)
+        with torch.no_grad():
+            self.assertEqual(fn(*inputs), expected())
+        w1.data = torch.randn(3, 4)
+        with torch.no_grad():
+            self.assertEqual(fn(*inputs), expected())
+        w1 = w1.detach()
+
+        # biases that can't be concatenated go through the unbatched path
+        b2 = torch.randn(200, 2)
+        inputs = (x, w1, w2, w3, b1, b2, b3)
+        self.assertEqual(fn(*inputs), expected())
+
+        # so do inputs with too few rows to pay for the concatenation
+        x = torch.randn(5, 4)
+        b2 = torch.randn(2)
+        inputs = (x, w1, w2, w3, b1, b2, b3)
+        self.assertEqual(fn(*inputs), expected())
+
+        w1.requires_grad_()
+        b2 = torch.randn(2)
+        outputs = fn(x, w1, w2, w3, b1, b2, b3)
+        grad = torch.autograd.grad(outputs[0].sum() + outputs[2].sum(), w1)
+        w1_ = w1.detach().requires_grad_()
+        y1 = F.linear(x, w1_, b1)
+        self.assertEqual(grad, torch.autograd.grad(y1.sum() + F.linear(y1, w3, b3).sum(), w1_))
+
     def test_loop_unrolling(self):
         def fn(x):
             y = 0
@@ -167,6 +167,16 @@ def fs_sharing():
         mp.set_sharing_strategy(prev_strategy)
 
 
+@contextlib.contextmanager
+def fs_pool_sharing():
+    prev_strategy = mp.get_sharing_strategy()
+    mp.set_sharing_strategy('file_system_pool')
+    try:
+        yield
+    finally:
+        mp.set_sharing_strategy(prev_strategy)
+
+
 class leak_checker(object):
 
     def __init__(self, test_case):
@@ -351,6 +361,72 @@ class TestMultiprocessing(TestCase):
             for _ in range(TEST_REPEATS):
                 queue_put()
 
+    @unittest.skipIf(IS_WINDOWS, "file_system_pool strategy is not supported on Windows")
+    def test_fs_pool_sharing(self):
+        with fs_pool_sharing():
+            self._test_sharing(repeat=TEST_REPEATS)
+
+    @unittest.skipIf(IS_WINDOWS, "file_system_pool strategy is not supported on Windows")
+    def test_fs_pool_preserve_sharing(self):
+        with fs_pool_sharing():
+            self._test_preserve_sharing(repeat=TEST_REPEATS)
+
+    @unittest.skipIf(IS_WINDOWS, "file_system_pool strategy is not supported on Windows")
+    def test_fs_pool_process_pool(self):
+        with fs_pool_sharing():
+            self._test_pool(repeat=TEST_REPEATS)
+
+    @unittest.skipIf(IS_WINDOWS, "file_system_pool strategy is not supported on Windows")
+    def test_fs_pool_recycles_slots(self):
+        with fs_pool_sharing():
+            x = torch.randn(5, 5).share_memory_()
+            _, handle, size, offset = x.storage()._share_filename_(True)
+            self.assertEqual(size, 25)
+            del x
+            # The slot is released along with x, so it's handed out again
+            y = torch.randn(5, 5).share_memory_()
+            _, new_handle, _, new_offset = y.storage()._share_filename_(True)
+            self.assertEqual(new_handle, handle)
+            self.assertEqual(new_offset, offset)
+            # Storages that are alive at the same time get distinct slots
+            z = torch.randn(5, 5).share_memory_()
+            _, z_handle, _, z_offset = z.storage()._share_filename_(True)
+            self.assertNotEqual((z_handle, z_offset), (handle, offset))
+
+    @unittest.skipIf(IS_WINDOWS, "file_system_pool strategy is not supported on Windows")
+    def test_fs_pool_fork(self):
+        with fs_pool_sharing():
+            x = torch.zeros(5, 5).share_memory_()
+            # Free a slot in the parent, so that a child inheriting the
+            # parent's free list would hand it out again
+            torch.ones(5, 5).share_memory_()
+            r, w = os.pipe()
+            pid = os.fork()
+            if pid == 0:
+                # Child: allocations must not reuse slots of the parent
+                status = 1
+                try:
+                    os.close(r)
+                    y = torch.full((5, 5), 2.).share_memory_()
+                    _, handle, _, offset = y.storage()._share_filename_(True)
+                    os.write(w, '{} {}\n'.format(handle.decode(), offset).encode())
+                    status = 0
+                finally:
+                    os._exit(status)
+            os.close(w)
+            with os.fdopen(r) as f:
+                child_handle, child_offset = f.read().split()
+            _, status = os.waitpid(pid, 0)
+            self.assertEqual(status, 0)
+            z = torch.full((5, 5), 3.).share_memory_()
+            _, z_handle, _, z_offset = z.storage()._share_filename_(True)
+            _, x_handle, _, x_offset = x.storage()._share_filename_(True)
+            self.assertNotEqual(child_handle, z_handle.decode())
+            self.assertNotEqual(child_handle, x_handle.decode())
+            self.assertNotEqual((z_handle, z_offset), (x_handle, x_offset))
+            self.assertEqual(x, torch.zeros(5, 5))
+            self.assertEqual(z, torch.full((5, 5), 3.))
+
     def test_inherit_tensor(self):
         t = torch.zeros(5, 5)
         p = SubProcess(t.share_memory_())
@@ -816,6 +892,11 @@ if __name__ == "__main__":
         with fs_sharing():
             self._test_is_shared()
 
+    @unittest.skipIf(IS_WINDOWS, "file_system_pool strategy is not supported on Windows")
+    def test_fs_pool_is_shared(self):
+        with fs_pool_sharing():
+            self._test_is_shared()
+
     @unittest.skipIf(not torch.cuda.is_available(), 'CUDA not available')
     def test_is_shared_cuda(self):
         t = torch.randn(5, 5).cuda()
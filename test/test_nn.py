@@ -6141,6 +6141,50 @@ class TestNN(NNTestCase):
         self.assertEqual(bn.bias.grad, ref_bn.bias.grad)
         self.assertEqual(input.grad, ref_input.grad)
 
+    def test_batchnorm_nhwc_cpu(self):
+        # The contiguous and channels last inputs take the fused kernels,
+        # the reference input is neither and takes the generic path: its
+        # batch stride is doubled, which also holds for 1x1 images.
+        for shape in [(4, 19, 5, 7), (3, 8, 1, 1), (2, 1, 6, 6)]:
+            input = torch.randn(shape, dtype=torch.double)
+            grad = torch.randn(shape, dtype=torch.double)
+            ref_input = torch.stack([input, input], dim=1)[:, 0].requires_grad_(True)
+            self.assertFalse(ref_input.is_contiguous())
+            self.assertFalse(ref_input.is_contiguous(memory_format=torch.channels_last))
+            ref_bn = nn.BatchNorm2d(shape[1]).double()
+            ref_bn.weight.data.uniform_()
+            ref_bn.bias.data.uniform_()
+            ref_out = ref_bn(ref_input)
+            ref_out.backward(grad)
+
+            for memory_format in [torch.contiguous_format, torch.channels_last]:
+                x = input.contiguous(memory_format=memory_format).requires_grad_(True)
+                bn = nn.BatchNorm2d(shape[1]).double()
+                bn.load_state_dict(ref_bn.state_dict())
+                bn.running_mean.zero_()
+                bn.running_var.fill_(1)
+                out = bn(x)
+                out.backward(grad.contiguous(memory_format=memory_format))
+
+                self.assertTrue(out.is_contiguous(memory_format=memory_format))
+                self.assertEqual(out, ref_out)
+                self.assertEqual(bn.running_mean, ref_bn.running_mean)
+                self.assertEqual(bn.running_var, ref_bn.running_var)
+                self.assertEqual(bn.weight.grad, ref_bn.weight.grad)
+                self.assertEqual(bn.bias.grad, ref_bn.bias.grad)
+                self.assertEqual(x.grad, ref_input.grad)
+
+    def test_batchnorm_large_float_cpu(self):
+        # The fused kernels merge the statistics of the chunks of the input
+        # in double, which keeps them accurate over many samples far from 0.
+        for memory_format in [torch.contiguous_format, torch.channels_last]:
+            input = (torch.randn(16, 2, 256, 256) + 100).contiguous(memory_format=memory_format)
+            bn = nn.BatchNorm2d(2, momentum=1.)
+            bn(input)
+            ref = input.double()
+            self.assertEqual(bn.running_mean.double(), ref.mean((0, 2, 3)), prec=1e-4)
+            self.assertEqual(bn.running_var.double(), ref.var((0, 2, 3)), prec=1e-4)
+
     @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
     def test_batchnorm_cudnn_half(self):
         # THNN
@@ -7877,6 +7921,16 @@ class TestNN(NNTestCase):
         self.assertEqual(input.grad.dtype, dtype)
         self.assertEqual(input.grad, inputf.grad.to(dtype), prec=0.1)
 
+    def test_log_softmax_cpu_non_last_dim(self, dtype=torch.bfloat16):
+        # Long enough along dim that summing the exponentials in bfloat16
+        # would be far off
+        input = torch.rand(1000, 3, 11, device="cpu").to(dtype)
+        for dim in [0, 1]:
+            out = F.log_softmax(input, dim=dim)
+            self.assertEqual(out.dtype, dtype)
+            # Only the rounding of the output to bfloat16 is left
+            self.assertEqual(out.float(), F.log_softmax(input.float(), dim=dim), prec=0.02)
+
     def test_adaptive_log_softmax(self):
         # args validation
         with self.assertRaises(ValueError):
@@ -7970,6 +8024,53 @@ class TestNN(NNTestCase):
         out = asfm.predict(x)
         self.assertEqual(out, asfm.log_prob(x).argmax(dim=1))
 
+    def test_cross_entropy_loss_fused(self):
+        # cross_entropy uses a fused log_softmax + nll_loss kernel on CPU
+        input = torch.randn(20, 9, dtype=torch.double, requires_grad=True)
+        target = torch.randint(9, (20,), dtype=torch.long)
+        target[3] = -100
+        weight = torch.rand(9, dtype=torch.double)
+        for reduction in ['none', 'mean', 'sum']:
+            for w in [None, weight]:
+                out = F.cross_entropy(input, target, w, ignore_index=-100, reduction=reduction)
+                expected = F.nll_loss(F.log_softmax(input, 1), target, w,
+                                      ignore_index=-100, reduction=reduction)
+                self.assertEqual(out, expected)
+                grad, = torch.autograd.grad(out.sum(), input)
+                expected_grad, = torch.autograd.grad(expected.sum(), input)
+                self.assertEqual(grad, expected_grad)
+
+                def func(x):
+                    return F.cross_entropy(x, target, w, ignore_index=-100, reduction=reduction)
+                self.assertTrue(gradcheck(func, (input,)))
+                self.assertTrue(gradgradcheck(func, (input,)))
+
+    def test_cross_entropy_loss_fused_bfloat16(self):
+        # The fused kernel sums the exponentials of a row and the losses in
+        # float, rows this long would be far off in bfloat16
+        input = torch.randn(64, 2000).to(torch.bfloat16).requires_grad_()
+        target = torch.randint(2000, (64,), dtype=torch.long)
+        inputf = input.detach().float().requires_grad_()
+        for reduction in ['none', 'mean', 'sum']:
+            out = F.cross_entropy(input, target, reduction=reduction)
+            expected = F.cross_entropy(inputf, target, reduction=reduction)
+            self.assertEqual(out.dtype, torch.bfloat16)
+            # Only the rounding of the result to bfloat16 is left
+            self.assertEqual(out.float(), expected, prec=0.05 * expected.abs().max().item())
+            grad, = torch.autograd.grad(out.sum(), input)
+            expected_grad, = torch.autograd.grad(expected.sum(), inputf)
+            self.assertEqual(grad.dtype, torch.bfloat16)
+            self.assertEqual(grad.float(), expected_grad, prec=0.01 * expected_grad.abs().max().item())
+
+    def test_softmax_non_last_dim(self):
+        # sizes of the inner dimensions don't divide the vector width
+        x = torch.randn(3, 7, 13, 5, dtype=torch.double, requires_grad=True)
+        for dim in range(x.dim() - 1):
+            for fn, ref in [(F.softmax, lambda x, d: x.exp() / x.exp().sum(d, keepdim=True)),
+                            (F.log_softmax, lambda x, d: x - x.logsumexp(d, keepdim=True))]:
+                self.assertEqual(fn(x, dim), ref(x, dim))
+                self.assertTrue(gradcheck(lambda x: fn(x, dim), (x,)))
+
     def test_cross_entropy_loss(self, dtype=torch.bfloat16):
         loss_cpu = nn.CrossEntropyLoss().cpu()
         inputf = torch.randn(15, 10, device="cpu", dtype=torch.float, requires_grad=True)
@@ -10,6 +10,7 @@ import shutil
 import torch
 import torch.cuda
 import torch.backends.cuda
+import torch.backends.mkl
 import tempfile
 import unittest
 import warnings
@@ -25,6 +26,7 @@ from torch._utils import _rebuild_tensor
 from torch._six import inf, nan, string_classes, istuple
 from itertools import product, combinations, combinations_with_replacement, permutations
 from functools import reduce
+from contextlib import contextmanager
 from random import randrange
 from torch import multiprocessing as mp
 from common_methods_invocations import tri_tests_args, run_additional_tri_tests, \
@@ -2341,6 +2343,49 @@ class _TestTorchMixin(object):
     def test_fft_ifft_rfft_irfft(self):
         self._test_fft_ifft_rfft_irfft(self)
 
+    @unittest.skipIf(not TEST_MKL, "PyTorch is built without MKL support")
+    def test_fft_plan_cache(self):
+        plan_cache = torch.backends.mkl.fft_plan_cache
+
+        @contextmanager
+        def plan_cache_max_size(n):
+            original = plan_cache.max_size
+            plan_cache.max_size = n
+            yield
+            plan_cache.max_size = original
+
+        with plan_cache_max_size(max(1, plan_cache.size - 10)):
+            self._test_fft_ifft_rfft_irfft(self)
+
+        with plan_cache_max_size(0):
+            self._test_fft_ifft_rfft_irfft(self)
+            self.assertEqual(plan_cache.size, 0)
+
+        plan_cache.clear()
+        self.assertEqual(plan_cache.size, 0)
+
+        # check that stll works after clearing cache
+        with plan_cache_max_size(10):
+            self._test_fft_ifft_rfft_irfft(self)
+            self.assertLessEqual(plan_cache.size, 10)
+
+        # batches of small signals are split between threads
+        x = torch.randn(256, 400, dtype=torch.double)
+        with plan_cache_max_size(0):
+            expected = x.rfft(1)
+        num_threads = torch.get_num_threads()
+        for threads in (1, max(2, num_threads)):
+            torch.set_num_threads(threads)
+            self.assertEqual(x.rfft(1), expected, 1e-10)
+            self.assertEqual(x.rfft(1).irfft(1, signal_sizes=(400,)), x, 1e-10)
+        torch.set_num_threads(num_threads)
+
+        with self.assertRaisesRegex(RuntimeError, r"must be non-negative"):
+            plan_cache.max_size = -1
+
+        with self.assertRaisesRegex(RuntimeError, r"read-only property"):
+            plan_cache.size = -1
+
     @unittest.skip("Not implemented yet")
     def test_conv2(self):
         x = torch.rand(math.floor(torch.uniform(50, 100)), math.floor(torch.uniform(50, 100)))
@@ -10312,6 +10357,48 @@ class TestTorchDeviceType(TestCase):
             self.assertTrue(y.is_contiguous())
             self.assertTrue(torch.allclose(expected, actual))
 
+    # near duplicates are only recomputed exactly on CPU
+    @onlyCPU
+    def test_cdist_euclidean_near_duplicates(self, device):
+        # far from the origin, the matmul expansion cancels catastrophically
+        x = torch.randn(50, 16, device=device) + 1000
+        y = torch.cat([x[:10] + 1e-3, torch.randn(40, 16, device=device) + 1000])
+        actual = torch.cdist(x, y, p=2, compute_mode='use_mm_for_euclid_dist')
+        expected = brute_cdist(x.double(), y.double(), p=2).float()
+        self.assertTrue(torch.allclose(expected, actual, rtol=1e-3, atol=1e-4))
+
+        # two tight clusters: too many near duplicates to recompute one by one,
+        # so the direct kernel is used
+        centers = torch.randn(2, 16, device=device) * 10
+        x = centers.repeat(25, 1) + torch.randn(50, 16, device=device) * 1e-4
+        y = centers.repeat(30, 1) + torch.randn(60, 16, device=device) * 1e-4
+        actual = torch.cdist(x, y, p=2, compute_mode='use_mm_for_euclid_dist')
+        expected = brute_cdist(x.double(), y.double(), p=2).float()
+        self.assertTrue(torch.allclose(expected, actual, rtol=1e-3, atol=1e-6))
+        values, _ = torch._cdist_topk(x, y, 5)
+        self.assertTrue(torch.allclose(expected.topk(5, largest=False).values, values, rtol=1e-3, atol=1e-6))
+
+    @onlyCPU
+    def test_cdist_topk(self, device):
+        for p in [0, 1, 2, 3, 1.5, float('inf')]:
+            for largest in [False, True]:
+                for (r1, r2, m, k) in [(7, 9, 5, 3), (600, 5000, 3, 10), (4, 6, 0, 2), (3, 8, 4, 8), (3, 8, 4, 0)]:
+                    x = torch.randn(r1, m, dtype=torch.double, device=device)
+                    y = torch.randn(r2, m, dtype=torch.double, device=device)
+                    values, indices = torch._cdist_topk(x, y, k, p, largest)
+                    expected = torch.cdist(x, y, p=p, compute_mode='donot_use_mm_for_euclid_dist')
+                    expected_values, _ = expected.topk(k, dim=-1, largest=largest)
+                    self.assertEqual(values, expected_values)
+                    self.assertEqual(expected.gather(-1, indices), values)
+
+        x = torch.randn(2, 3, 10, 4, device=device)
+        y = torch.randn(3, 20, 4, device=device)
+        values, indices = torch._cdist_topk(x, y, 5)
+        self.assertEqual(values.shape, (2, 3, 10, 5))
+        self.assertEqual(values, torch.cdist(x, y).topk(5, largest=False).values)
+        self.assertRaisesRegex(RuntimeError, "must be in the range",
+                               lambda: torch._cdist_topk(x, y, 21))
+
     def test_multinomial_constraints(self, device):
         x = torch.empty(1, 2, 3, dtype=torch.double, device=device)
         self.assertRaisesRegex(
@@ -11203,6 +11290,17 @@ class TestTorchDeviceType(TestCase):
                                             [False, True, False, True, False],
                                             [True, False, True, False, True]], device=device))
 
+    def test_scatter_gather_1d_large(self, device):
+        # A single slice along dim, large enough to be split between threads
+        src = torch.randn(100000, dtype=torch.double, device=device)
+        index = torch.randint(0, 50, (100000,), device=device)
+        res = torch.zeros(50, dtype=torch.double, device=device).scatter_add_(0, index, src)
+        expected = torch.zeros(50, dtype=torch.double, device=device).index_add_(0, index, src)
+        self.assertEqual(res, expected)
+
+        res = torch.gather(src[:50], 0, index)
+        self.assertEqual(res, src[:50][index], 0)
+
     def test_masked_scatter_bool_tensor(self, device):
         src = torch.tensor([True, True, True], device=device)
         dst = torch.tensor([False, False, False], device=device)
@@ -12599,6 +12697,35 @@ class TestTorchDeviceType(TestCase):
         y = nhwc.permute(0, 1, 3, 2).permute(0, 1, 3, 2)
         self.assertTrue(y.is_contiguous(memory_format=torch.channels_last))
 
+    def test_elementwise_dense_layouts(self, device):
+        # operands sharing a dense layout are iterated in memory order, with
+        # 0-dim inputs broadcast
+        x = torch.randn(4, 3, 8, 8, device=device)
+        y = torch.randn(4, 3, 8, 8, device=device)
+        layouts = [
+            lambda t: t,
+            lambda t: t.contiguous(memory_format=torch.channels_last),
+            lambda t: t.permute(3, 1, 0, 2).contiguous().permute(2, 1, 3, 0),
+        ]
+        for layout in layouts:
+            a, b = layout(x), layout(y)
+            for result, expected in ((a + b, x + y),
+                                     (a * 2, x * 2),
+                                     (a + torch.tensor(1.5, device=device), x + 1.5),
+                                     (torch.add(a, b, out=layout(torch.empty_like(x))), x + y)):
+                self.assertEqual(result, expected)
+                self.assertEqual(result.stride(), a.stride())
+            self.assertEqual(a.sin(), x.sin())
+            c = a.clone()
+            c.mul_(b)
+            self.assertEqual(c, x * y)
+
+        # mixed layouts and broadcasts still work
+        a = x.contiguous(memory_format=torch.channels_last)
+        self.assertEqual(a + y, x + y)
+        self.assertEqual(a + y[0], x + y[0])
+        self.assertEqual(a + x.new_tensor([2.]), x + 2)
+
     def test_resize_as_preserves_strides(self, device):
         x = torch.empty(2, 3).t()
         old_strides = x.stride()
@@ -10,7 +10,8 @@ import torch
 import torch.nn as nn
 import torch.utils.data
 import torch.cuda
-from torch.utils.checkpoint import checkpoint, checkpoint_sequential
+from torch.utils.checkpoint import checkpoint, checkpoint_sequential, CheckpointPlanner, \
+    checkpoint_sequential_with_budget
 import torch.hub as hub
 from torch.autograd._functions.utils import check_onnx_broadcast
 from torch.onnx.symbolic_opset9 import _prepare_onnx_paddings
@@ -266,6 +267,67 @@ class TestCheckpoint(TestCase):
         out = checkpoint(run_fn, input_var, None)
         out.sum().backward()
 
+    def _checkpoint_planner_blocks(self, dropout=False):
+        def block():
+            layers = [nn.Linear(20, 20), nn.ReLU(), nn.Linear(20, 20), nn.ReLU()]
+            if dropout:
+                layers.append(nn.Dropout(0.5))
+            return nn.Sequential(*layers)
+        return [block() for _ in range(4)]
+
+    def test_checkpoint_planner(self):
+        blocks = self._checkpoint_planner_blocks()
+        params = [p for block in blocks for p in block.parameters()]
+        input_var = torch.randn(8, 20, requires_grad=True)
+
+        out = input_var
+        for block in blocks:
+            out = block(out)
+        expected = torch.autograd.grad(out.sum(), [input_var] + params)
+
+        planner = CheckpointPlanner()
+        out = input_var
+        for block in blocks:
+            out = planner.run(block, out)
+        held = planner.saved_bytes()
+        self.assertGreater(held, 0)
+        self.assertEqual(planner.plan(held), held)
+        self.assertLess(planner.plan(0), held)
+        self.assertEqual(torch.autograd.grad(out.sum(), [input_var] + params), expected)
+
+        out = checkpoint_sequential_with_budget(blocks, 0, input_var)
+        out.sum().backward()
+        self.assertEqual(input_var.grad, expected[0])
+
+    def test_checkpoint_planner_rng(self):
+        blocks = self._checkpoint_planner_blocks(dropout=True)
+        input_var = torch.randn(8, 20, requires_grad=True)
+
+        torch.manual_seed(100)
+        out = input_var
+        for block in blocks:
+            out = block(out)
+        out.sum().backward()
+        expected = input_var.grad.clone()
+        input_var.grad = None
+
+        torch.manual_seed(100)
+        out = checkpoint_sequential_with_budget(blocks, 0, input_var)
+        out.sum().backward()
+        self.assertEqual(input_var.grad, expected)
+
+    def test_checkpoint_planner_inplace_input(self):
+        blocks = self._checkpoint_planner_blocks()
+        input_var = torch.randn(8, 20)
+
+        planner = CheckpointPlanner()
+        out = planner.run(blocks[0], input_var)
+        out = planner.run(blocks[1], out)
+        planner.plan(0)
+        input_var.add_(1)
+        with self.assertRaisesRegex(RuntimeError, "modified by an inplace operation"):
+            out.sum().backward()
+
 
 class TestDataLoader(TestCase):
     def setUp(self):
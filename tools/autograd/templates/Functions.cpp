@@ -1038,6 +1038,33 @@ Tensor mse_loss_double_backward_grad_output(const Tensor & grad, const Tensor &
   return (r * grad).sum();
 }
 
+Tensor log_softmax_nll_loss_double_backward_grad_output(const Tensor & grad, const Tensor & grad_output, const Tensor & input, const Tensor & target, const Tensor & weight, int64_t reduction, int64_t ignore_index, const Tensor & total_weight, const Tensor & logsumexp) {
+  auto r = at::_log_softmax_nll_loss_backward(ones_like(grad_output), input, target, weight, reduction, ignore_index, total_weight, logsumexp);
+  if (reduction == at::Reduction::None) {
+    return (r * grad).sum(1);
+  }
+  return (r * grad).sum();
+}
+
+Tensor log_softmax_nll_loss_double_backward(const Tensor & grad, const Tensor & grad_output, const Tensor & input, const Tensor & target, const Tensor & weight, int64_t reduction, int64_t ignore_index, const Tensor & total_weight, const Tensor & logsumexp) {
+  // The first derivative is row_scale * (softmax(input) - one_hot(target)),
+  // where row_scale is the (weighted, normalized) gradient of each row's loss.
+  if (reduction == at::Reduction::Mean && total_weight.item<double>() <= 0) {
+    return zeros_like(input, at::MemoryFormat::Preserve);
+  }
+  auto ignored = target == ignore_index;
+  auto row_scale = weight.defined()
+      ? weight.index_select(0, target.masked_fill(ignored, 0))
+      : at::ones({input.size(0)}, input.options());
+  row_scale = row_scale.masked_fill(ignored, 0) * grad_output;
+  if (reduction == at::Reduction::Mean) {
+    row_scale = row_scale / total_weight;
+  }
+  // logsumexp is float for bfloat16 inputs
+  auto probs = (input - logsumexp.unsqueeze(1)).exp().to(input.scalar_type());
+  return row_scale.unsqueeze(1) * at::_softmax_backward_data(grad, probs, 1, probs);
+}
+
 Tensor soft_margin_loss_double_backward(const Tensor & grad, const Tensor & input, const Tensor & target, int64_t reduction) {
   auto z = (input * -target).exp();
   auto zplus1 = z + 1;
@@ -15,6 +15,7 @@ GENERATED_CPP = [
     "register_aten_ops_0.cpp",
     "register_aten_ops_1.cpp",
     "register_aten_ops_2.cpp",
+    "register_mobile_op_table.cpp",
     "python_functions.cpp",
     "python_nn_functions.cpp",
     "python_torch_functions.cpp",
@@ -27,6 +28,7 @@ libtorch_sources = [
     ":generate-code=register_aten_ops_0.cpp",
     ":generate-code=register_aten_ops_1.cpp",
     ":generate-code=register_aten_ops_2.cpp",
+    ":generate-code=register_mobile_op_table.cpp",
     ":generate-code=VariableType_0.cpp",
     ":generate-code=VariableType_1.cpp",
     ":generate-code=VariableType_2.cpp",
@@ -35,6 +37,7 @@ libtorch_sources = [
     "torch/csrc/autograd/VariableTypeManual.cpp",
     "torch/csrc/autograd/anomaly_mode.cpp",
     "torch/csrc/autograd/autograd.cpp",
+    "torch/csrc/autograd/checkpoint.cpp",
     "torch/csrc/autograd/custom_function.cpp",
     "torch/csrc/autograd/cpp_hook.cpp",
     "torch/csrc/autograd/engine.cpp",
@@ -185,6 +188,7 @@ libtorch_sources = [
     "torch/csrc/jit/mobile/module.cpp",
     "torch/csrc/jit/mobile/register_mobile_ops.cpp",
     "torch/csrc/jit/mobile/interpreter.cpp",
+    "torch/csrc/jit/mobile/op_table.cpp",
     "torch/csrc/jit/mobile/type_parser.cpp",
     "torch/csrc/utils/byte_order.cpp",
     "torch/csrc/utils/tensor_flatten.cpp",
@@ -181,6 +181,35 @@ Operator(
 ),
 """)
 
+MOBILE_OP_FUNCTION = CodeTemplate("""\
+int ${function_name}(Stack & stack) {
+#ifdef USE_STATIC_DISPATCH
+    at::AutoNonVariableTypeMode non_var_type_mode(true);
+#endif
+    ${lvalues}
+    ${call}
+    drop(stack, ${num_inputs});
+    pack(stack, std::move(result_));
+    return 0;
+}
+""")
+
+MOBILE_OP_TABLE_ENTRY = CodeTemplate("""\
+{"${name}", "${overload_name}", ${function_name}},
+""")
+
+# Non-ATen operators of the lite interpreter, implemented by hand in
+# templates/register_mobile_op_table.cpp. They are always part of the table.
+MOBILE_PRIM_OPS = [
+    ('aten::__is__', '', 'is_op'),
+    ('aten::append', 'Tensor', 'list_append_op<at::Tensor>'),
+    ('aten::append', 'int', 'list_append_op<int64_t>'),
+    ('aten::eq', 'int', 'eq_int_op'),
+    ('aten::warn', '', 'warn_op'),
+    ('prim::NumToTensor', '', 'num_to_tensor_op'),
+    ('prim::unchecked_cast', '', 'unchecked_cast_op'),
+]
+
 
 blacklisted_types = {
     'Storage',
@@ -274,6 +303,7 @@ def load_op_list(path):
 
 def gen_jit_dispatch(declarations, out, template_path, disable_autograd=False, selected_op_list_path=None):
     REGISTER_ATEN_OPS_CPP = CodeTemplate.from_file(template_path + '/register_aten_ops.cpp')
+    REGISTER_MOBILE_OP_TABLE_CPP = CodeTemplate.from_file(template_path + '/register_mobile_op_table.cpp')
 
     ops = []
 
@@ -315,7 +345,7 @@ def gen_jit_dispatch(declarations, out, template_path, disable_autograd=False, s
     def requires_lvalue(arg):
         return 'jit_type' in arg and arg['jit_type'] in {"Tensor!", "Tensor(a!)"}
 
-    def emit_decl_variant(decl):
+    def emit_decl_variant(decl, template=CONSTRUCTOR, function_name=None):
         if ('emit_dummy_placeholder' in decl):
             return "DUMMY_OPERATION"
         kw_assignments = []
@@ -340,12 +370,13 @@ def gen_jit_dispatch(declarations, out, template_path, disable_autograd=False, s
 
         returns = decl['returns']
 
-        constructor = CONSTRUCTOR.substitute(name=decl['name'],
-                                             call=call,
-                                             kw_assignments=kw_assignments,
-                                             num_inputs=num_inputs,
-                                             op_capture=op_capture,
-                                             lvalues=lvalues)
+        constructor = template.substitute(name=decl['name'],
+                                          function_name=function_name,
+                                          call=call,
+                                          kw_assignments=kw_assignments,
+                                          num_inputs=num_inputs,
+                                          op_capture=op_capture,
+                                          lvalues=lvalues)
         return constructor
 
     def filter_decls(jit_decls, disable_autograd, selected_op_list):
@@ -473,6 +504,31 @@ def gen_jit_dispatch(declarations, out, template_path, disable_autograd=False, s
         }
         write(out, 'register_aten_ops_%d.cpp' % i, REGISTER_ATEN_OPS_CPP, env)
 
+    # The lite interpreter gets direct function pointers for the selected ops,
+    # in a table sorted by (name, overload_name) that it binary searches.
+    mobile_ops = {}
+    if selected_op_list:
+        for decl in jit_decls:
+            if 'emit_dummy_placeholder' in decl or not decl['should_match_schema']:
+                continue
+            name = signature_without_args(decl).split('.')[0]
+            key = (name, decl['overload_name'])
+            if key not in mobile_ops:
+                mobile_ops[key] = decl
+    functions = []
+    entries = {(name, overload_name): fn for name, overload_name, fn in MOBILE_PRIM_OPS}
+    for i, key in enumerate(sorted(mobile_ops.keys())):
+        function_name = 'op_{}'.format(i)
+        functions.append(emit_decl_variant(mobile_ops[key], MOBILE_OP_FUNCTION, function_name))
+        entries[key] = function_name
+    env = {
+        'functions': functions,
+        'entries': [MOBILE_OP_TABLE_ENTRY.substitute(name=name, overload_name=overload_name, function_name=fn)
+                    for (name, overload_name), fn in sorted(entries.items())],
+        'num_entries': len(entries),
+    }
+    write(out, 'register_mobile_op_table.cpp', REGISTER_MOBILE_OP_TABLE_CPP, env)
+
 
 default_map = {'{}': 'None', 'nullptr': 'None', 'c10::nullopt': 'None'}
 
@@ -0,0 +1,111 @@
+#include "torch/csrc/jit/mobile/op_table.h"
+#include "torch/csrc/autograd/generated/variable_factories.h"
+
+#include <ATen/ATen.h>
+#include <ATen/core/stack.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+// ${generated_comment}
+
+// Direct entry points for the operators in SELECTED_OP_LIST, used by the lite
+// interpreter instead of looking each operator up in the c10 dispatcher when a
+// model is loaded. Only the listed operators are referenced from here, so the
+// linker can drop the kernels of every other one.
+
+namespace torch { namespace jit { namespace mobile {
+
+using at::Scalar;
+using at::ScalarType;
+using at::Tensor;
+using at::TensorOptions;
+using at::MemoryFormat;
+
+namespace {
+
+at::Tensor toOptionalTensor(const c10::IValue& v) {
+  if (v.isNone()) {
+    return at::Tensor();
+  }
+  return v.toTensor();
+}
+
+std::vector<Tensor> toListOfOptionalTensor(const c10::IValue& v) {
+  auto vlist = v.toGenericListRef();
+  std::vector<Tensor> res;
+
+  for (const c10::IValue &v: vlist) {
+    res.emplace_back(toOptionalTensor(v));
+  }
+  return res;
+}
+
+template<size_t N>
+std::array<bool, N> as_bool_array(const c10::List<bool>& list) {
+  std::array<bool, N> res;
+  AT_ASSERT(list.size() == N);
+  std::copy(list.begin(), list.end(), res.begin());
+  return res;
+}
+
+// Operators that are not ATen functions but that the lite interpreter needs
+// alongside them (see register_mobile_ops.cpp for the dispatcher versions).
+int num_to_tensor_op(Stack& stack) {
+  auto s = pop(stack).toScalar();
+  push(stack, at::scalar_to_tensor(s));
+  return 0;
+}
+
+int is_op(Stack& stack) {
+  c10::IValue self, obj;
+  pop(stack, self, obj);
+  push(stack, self.isSameIdentity(obj));
+  return 0;
+}
+
+int eq_int_op(Stack& stack) {
+  int64_t a, b;
+  pop(stack, a, b);
+  push(stack, a == b);
+  return 0;
+}
+
+int warn_op(Stack& stack) {
+  drop(stack, 1);
+  pop(stack);
+  return 0;
+}
+
+int unchecked_cast_op(Stack& stack) {
+  return 0;
+}
+
+template <typename T>
+int list_append_op(Stack& stack) {
+  T el = pop(stack).to<T>();
+  c10::List<T> list = pop(stack).to<c10::List<T>>();
+
+  list.push_back(std::move(el));
+  push(stack, std::move(list));
+  return 0;
+}
+
+// Generated operators
+${functions}
+
+// Sorted by (name, overload_name) for findOpTableIndex. The trailing entry
+// only keeps the array non-empty and is not part of the table.
+const OpTableEntry kOpTable[] = {
+    ${entries}
+    {nullptr, nullptr, nullptr},
+};
+
+} // anon namespace
+
+c10::ArrayRef<OpTableEntry> opTable() {
+  return c10::ArrayRef<OpTableEntry>(kOpTable, ${num_entries});
+}
+
+}}} // namespace torch::jit::mobile
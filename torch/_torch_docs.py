@@ -6703,7 +6703,9 @@ The inverse of this function is :func:`~torch.ifft`.
     For CUDA tensors, an LRU cache is used for cuFFT plans to speed up
     repeatedly running FFT methods on tensors of same geometry with same
     configuration. See :ref:`cufft-plan-cache` for more details on how to
-    monitor and control the cache.
+    monitor and control the cache. The MKL descriptors used for CPU tensors
+    are cached in the same way, and ``torch.backends.mkl.fft_plan_cache``
+    provides the same ``max_size``, ``size`` and ``clear()`` controls.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
@@ -6798,7 +6800,9 @@ The inverse of this function is :func:`~torch.fft`.
     For CUDA tensors, an LRU cache is used for cuFFT plans to speed up
     repeatedly running FFT methods on tensors of same geometry with same
     configuration. See :ref:`cufft-plan-cache` for more details on how to
-    monitor and control the cache.
+    monitor and control the cache. The MKL descriptors used for CPU tensors
+    are cached in the same way, and ``torch.backends.mkl.fft_plan_cache``
+    provides the same ``max_size``, ``size`` and ``clear()`` controls.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
@@ -6882,7 +6886,9 @@ The inverse of this function is :func:`~torch.irfft`.
     For CUDA tensors, an LRU cache is used for cuFFT plans to speed up
     repeatedly running FFT methods on tensors of same geometry with same
     configuration. See :ref:`cufft-plan-cache` for more details on how to
-    monitor and control the cache.
+    monitor and control the cache. The MKL descriptors used for CPU tensors
+    are cached in the same way, and ``torch.backends.mkl.fft_plan_cache``
+    provides the same ``max_size``, ``size`` and ``clear()`` controls.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
@@ -6959,7 +6965,9 @@ The inverse of this function is :func:`~torch.rfft`.
     For CUDA tensors, an LRU cache is used for cuFFT plans to speed up
     repeatedly running FFT methods on tensors of same geometry with same
     configuration. See :ref:`cufft-plan-cache` for more details on how to
-    monitor and control the cache.
+    monitor and control the cache. The MKL descriptors used for CPU tensors
+    are cached in the same way, and ``torch.backends.mkl.fft_plan_cache``
+    provides the same ``max_size``, ``size`` and ``clear()`` controls.
 
 .. warning::
     For CPU tensors, this method is currently only available with MKL. Use
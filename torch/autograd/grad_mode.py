@@ -158,3 +158,67 @@ class set_grad_enabled(object):
     def __exit__(self, *args):
         torch.set_grad_enabled(self.prev)
         return False
+
+
+class inference_mode(_DecoratorContextManager):
+    r"""Context-manager that enables or disables inference mode.
+
+    Inference mode is a stricter version of :class:`~no_grad` for code that
+    will never run backward, such as a model being served. On top of
+    disabling gradient calculation, operations skip all autograd bookkeeping
+    (including version counter updates), and Tensors created in this mode
+    are *inference tensors*, which carry no autograd metadata at all. This
+    removes a fixed overhead from every operation, which matters most for
+    models made of many small operations.
+
+    Inference tensors can still be used outside of this mode, with some
+    restrictions: they can't require gradients, they can't be saved for
+    backward by an operation that records autograd history, and they can't be
+    modified in-place by such an operation. Use :meth:`Tensor.clone` to get a
+    normal Tensor in these cases.
+
+    In-place operations run in this mode don't update the version counters
+    of normal Tensors, so Tensors that have been saved for a later backward
+    shouldn't be modified in this mode.
+
+    This context manager is thread local; it will not affect computation
+    in other threads.
+
+    Also functions as a decorator.
+
+    Arguments:
+        mode (bool): Flag whether to enable inference mode (``True``), or
+                     disable it (``False``). Disabling it doesn't re-enable
+                     gradient calculation if it was disabled already.
+
+    Example::
+
+        >>> x = torch.ones(1, 2, 3, requires_grad=True)
+        >>> with torch.autograd.inference_mode():
+        ...   y = x * x
+        >>> y.requires_grad
+        False
+        >>> y._is_inference()
+        True
+        >>> @torch.autograd.inference_mode()
+        ... def func(x):
+        ...   return x * x
+        >>> out = func(x)
+        >>> out.requires_grad
+        False
+
+    """
+    def __init__(self, mode=True):
+        self.mode = mode
+
+    def __enter__(self):
+        self.prev = torch._C._is_inference_mode_enabled()
+        self.prev_grad = torch.is_grad_enabled()
+        torch._C._set_inference_mode_enabled(self.mode)
+        if self.mode:
+            torch._C.set_grad_enabled(False)
+
+    def __exit__(self, *args):
+        torch._C._set_inference_mode_enabled(self.prev)
+        torch.set_grad_enabled(self.prev_grad)
+        return False
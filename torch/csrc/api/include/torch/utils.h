@@ -8,6 +8,9 @@ namespace torch {
 
 using NoGradGuard = at::NoGradGuard;
 
+/// A RAII guard for inference mode, see NOTE [ Inference Mode ].
+using InferenceModeGuard = at::AutoInferenceMode;
+
 /// Sets the global random seed for all newly created CPU and CUDA tensors.
 using at::manual_seed;
 
@@ -306,6 +306,8 @@ Tensor & detach_(Tensor & self) {
 // Unfortunately, this setup doesn't work in NonVariableTypeMode because that will
 // skip past variable kernels. So for ops that we want to use in NonVariableTypeMode
 // (and that don't use dispatch), we register them as catch-all kernels instead.
+// The same goes for inference mode and inference tensors (see NOTE [ Inference Mode ]),
+// which is why detach() and detach_() have catch-all kernels.
 static auto registry = torch::RegisterOperators()
   .op(torch::RegisterOperators::options()
     .schema("aten::resize_(Tensor(a!) self, int[] size, *, MemoryFormat? memory_format=None) -> Tensor(a!)")
@@ -317,11 +319,12 @@ static auto registry = torch::RegisterOperators()
     .aliasAnalysis(AliasAnalysisKind::FROM_SCHEMA))
   .op(torch::RegisterOperators::options()
     .schema("aten::detach(Tensor self) -> Tensor")
-    .kernel<decltype(VariableType::detach)>(DispatchKey::VariableTensorId, &VariableType::detach)
+    .catchAllKernel<decltype(VariableType::detach), &VariableType::detach>()
     .aliasAnalysis(AliasAnalysisKind::FROM_SCHEMA))
   .op(torch::RegisterOperators::options()
     .schema("aten::detach_(Tensor(a!) self) -> Tensor(a!)")
     .impl_unboxedOnlyKernel<decltype(VariableType::detach_), &VariableType::detach_>(DispatchKey::VariableTensorId)
+    .impl_unboxedOnlyCatchAllKernel<decltype(VariableType::detach_), &VariableType::detach_>()
     .aliasAnalysis(AliasAnalysisKind::FROM_SCHEMA))
   .op(torch::RegisterOperators::options()
     .schema("aten::copy_(Tensor(a!) self, Tensor src, bool non_blocking=False) -> Tensor(a!)")
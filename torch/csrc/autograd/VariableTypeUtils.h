@@ -41,6 +41,14 @@ namespace torch { namespace autograd {
 
 inline void check_inplace(const Tensor& tensor) {
   auto& var = static_cast<const Variable&>(tensor);
+  // Checked before the update rather than when bumping the version: inference
+  // tensors that go through VariableType may alias a normal tensor, see
+  // NOTE [ Inference Mode ].
+  TORCH_CHECK(
+      !var.unsafeGetTensorImpl()->is_inference(),
+      "Inplace update to inference tensor outside InferenceMode is not "
+      "allowed. You can make a clone to get a normal tensor before doing "
+      "inplace update.");
   if (var.requires_grad() && var.is_leaf() && GradMode::is_enabled()) {
     AT_ERROR(
       "a leaf Variable that requires grad has been used in an in-place operation.");
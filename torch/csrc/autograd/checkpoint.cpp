@@ -0,0 +1,302 @@
+#include <torch/csrc/autograd/checkpoint.h>
+
+#include <torch/csrc/autograd/grad_mode.h>
+
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <unordered_map>
+
+namespace torch { namespace autograd {
+
+namespace {
+
+thread_local CheckpointSegment* current_segment = nullptr;
+
+struct CurrentSegmentGuard {
+  explicit CurrentSegmentGuard(CheckpointSegment* segment)
+      : prev_segment_(current_segment) {
+    current_segment = segment;
+  }
+  ~CurrentSegmentGuard() {
+    current_segment = prev_segment_;
+  }
+  CheckpointSegment* prev_segment_;
+};
+
+// See Note [Acquire lock when using random generators]
+std::shared_ptr<at::CPUGenerator> get_cpu_rng_state() {
+  auto gen = at::detail::getDefaultCPUGenerator();
+  std::lock_guard<std::mutex> lock(gen->mutex_);
+  return gen->clone();
+}
+
+void set_cpu_rng_state(at::CPUGenerator& state) {
+  auto gen = at::detail::getDefaultCPUGenerator();
+  std::lock_guard<std::mutex> lock(gen->mutex_);
+  gen->set_engine(state.engine());
+  gen->set_next_float_normal_sample(state.next_float_normal_sample());
+  gen->set_next_double_normal_sample(state.next_double_normal_sample());
+  gen->set_philox_mode(state.philox_mode());
+  gen->set_philox_offset(state.philox_offset());
+}
+
+// Runs a recomputation with the CPU RNG state of the forward pass, without
+// perturbing the random numbers drawn by the rest of the backward pass.
+struct CPURNGStateGuard {
+  explicit CPURNGStateGuard(at::CPUGenerator& state)
+      : prev_state_(get_cpu_rng_state()) {
+    set_cpu_rng_state(state);
+  }
+  ~CPURNGStateGuard() {
+    set_cpu_rng_state(*prev_state_);
+  }
+  std::shared_ptr<at::CPUGenerator> prev_state_;
+};
+
+int64_t version(const Variable& var) {
+  if (!var.defined() || var.unsafeGetTensorImpl()->is_inference()) {
+    return 0;
+  }
+  return impl::version_counter(var).current_version();
+}
+
+// A storage referenced by droppable saved variables.
+struct HeldStorage {
+  c10::Storage storage;
+  size_t refs = 0;
+  // Indices of the segments whose saved variables reference the storage.
+  std::vector<size_t> segments;
+
+  // Whether dropping the saved variables frees the storage.
+  bool freeable() const {
+    // The extra reference is our own.
+    return storage.use_count() == refs + 1;
+  }
+};
+
+std::unordered_map<c10::StorageImpl*, HeldStorage> held_storages(
+    const std::vector<std::shared_ptr<CheckpointSegment>>& segments) {
+  std::unordered_map<c10::StorageImpl*, HeldStorage> storages;
+  for (size_t i = 0; i < segments.size(); ++i) {
+    for (const auto& saved : segments[i]->droppable()) {
+      const auto& storage = saved->data.storage();
+      auto& held = storages[storage.unsafeGetStorageImpl()];
+      if (held.refs++ == 0) {
+        held.storage = storage;
+      }
+      if (held.segments.empty() || held.segments.back() != i) {
+        held.segments.push_back(i);
+      }
+    }
+  }
+  return storages;
+}
+
+} // namespace
+
+CheckpointSegment::CheckpointSegment(Function fn) : fn_(std::move(fn)) {}
+
+CheckpointSegment* CheckpointSegment::current() {
+  return current_segment;
+}
+
+variable_list CheckpointSegment::run(const variable_list& inputs) {
+  TORCH_CHECK(
+      current_segment == nullptr, "Checkpoint segments cannot be nested");
+  TORCH_INTERNAL_ASSERT(inputs_.empty() && saved_.empty());
+  inputs_.reserve(inputs.size());
+  input_versions_.reserve(inputs.size());
+  for (const auto& input : inputs) {
+    Variable detached;
+    if (input.defined()) {
+      detached = input.detach();
+      detached.set_requires_grad(input.requires_grad());
+    }
+    inputs_.push_back(std::move(detached));
+    input_versions_.push_back(version(input));
+  }
+  grad_mode_ = GradMode::is_enabled();
+  rng_state_ = get_cpu_rng_state();
+
+  auto start = std::chrono::steady_clock::now();
+  variable_list outputs;
+  {
+    CurrentSegmentGuard guard(this);
+    outputs = fn_(inputs);
+  }
+  forward_time_us_ = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  return outputs;
+}
+
+// NB: record() is only called on the thread running or recomputing the
+// segment, and the latter holds mutex_.
+std::shared_ptr<RecomputableData> CheckpointSegment::record(
+    const at::Tensor& data,
+    bool is_parameter) {
+  if (recomputing_) {
+    TORCH_CHECK(
+        next_saved_ < saved_.size(),
+        "Recomputing a checkpoint segment saved more variables for backward "
+        "than its forward pass did. The function of a checkpoint segment must "
+        "do the same computation every time it is run.");
+    auto saved = saved_[next_saved_++].lock();
+    if (saved && saved->dropped) {
+      saved->data = data;
+      saved->dropped = false;
+    }
+    return nullptr;
+  }
+
+  auto saved = std::make_shared<RecomputableData>();
+  saved->data = data;
+  saved->segment = shared_from_this();
+  // Inputs and parameters are kept alive regardless of what we do with the
+  // saved variables, so there is nothing to gain from dropping them.
+  saved->droppable = !is_parameter && data.has_storage() &&
+      std::none_of(inputs_.begin(), inputs_.end(), [&](const Variable& input) {
+        return input.defined() && input.has_storage() &&
+            input.storage().is_alias_of(data.storage());
+      });
+  saved_.emplace_back(saved);
+  return saved;
+}
+
+at::Tensor CheckpointSegment::unpack(RecomputableData& saved) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (saved.dropped) {
+    recompute();
+    TORCH_CHECK(
+        !saved.dropped,
+        "Recomputing a checkpoint segment didn't save all the variables its "
+        "forward pass saved for backward. The function of a checkpoint "
+        "segment must do the same computation every time it is run.");
+  }
+  return saved.data;
+}
+
+void CheckpointSegment::recompute() {
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    TORCH_CHECK(
+        version(inputs_[i]) == input_versions_[i],
+        "Input ", i, " of a checkpoint segment has been modified by an "
+        "inplace operation since the segment was run, so the activations "
+        "it saved for backward cannot be recomputed.");
+  }
+
+  CPURNGStateGuard rng_guard(*rng_state_);
+  AutoGradMode grad_mode(grad_mode_);
+  CurrentSegmentGuard segment_guard(this);
+  recomputing_ = true;
+  next_saved_ = 0;
+  try {
+    // The outputs, and the graph recorded while computing them, are dropped
+    // right away; only the data handed over by record() is kept.
+    fn_(inputs_);
+  } catch (...) {
+    recomputing_ = false;
+    throw;
+  }
+  recomputing_ = false;
+}
+
+void CheckpointSegment::drop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& weak_saved : saved_) {
+    auto saved = weak_saved.lock();
+    if (saved && saved->droppable) {
+      saved->data.reset();
+      saved->dropped = true;
+    }
+  }
+}
+
+std::vector<std::shared_ptr<RecomputableData>> CheckpointSegment::droppable()
+    const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::shared_ptr<RecomputableData>> result;
+  for (const auto& weak_saved : saved_) {
+    auto saved = weak_saved.lock();
+    if (saved && saved->droppable && saved->data.defined()) {
+      result.push_back(std::move(saved));
+    }
+  }
+  return result;
+}
+
+variable_list CheckpointPlanner::run_segment(
+    CheckpointSegment::Function fn,
+    variable_list inputs) {
+  auto segment = std::make_shared<CheckpointSegment>(std::move(fn));
+  auto outputs = segment->run(inputs);
+  // Segments are kept alive by the variables they recorded; one that saved
+  // nothing for backward has nothing to recompute either.
+  segments_.emplace_back(segment);
+  return outputs;
+}
+
+size_t CheckpointPlanner::plan(size_t memory_budget) {
+  std::vector<std::shared_ptr<CheckpointSegment>> segments;
+  for (const auto& weak_segment : segments_) {
+    if (auto segment = weak_segment.lock()) {
+      segments.push_back(std::move(segment));
+    }
+  }
+  if (segments.size() < 2) {
+    return saved_bytes();
+  }
+
+  // Only storages referenced by a single segment are freed by dropping it.
+  size_t held_bytes = 0;
+  std::vector<size_t> freed_bytes(segments.size(), 0);
+  for (const auto& entry : held_storages(segments)) {
+    const auto& held = entry.second;
+    if (held.freeable()) {
+      held_bytes += held.storage.capacity();
+      if (held.segments.size() == 1) {
+        freed_bytes[held.segments[0]] += held.storage.capacity();
+      }
+    }
+  }
+
+  // The last segment is the first one backward goes through, so dropping it
+  // would only delay its memory use by a few operations.
+  std::vector<size_t> order(segments.size() - 1);
+  std::iota(order.begin(), order.end(), 0);
+  auto cost = [&](size_t i) {
+    return static_cast<double>(std::max<int64_t>(segments[i]->forward_time_us(), 1));
+  };
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return freed_bytes[a] / cost(a) > freed_bytes[b] / cost(b);
+  });
+  for (size_t i : order) {
+    if (held_bytes <= memory_budget || freed_bytes[i] == 0) {
+      break;
+    }
+    segments[i]->drop();
+    held_bytes -= freed_bytes[i];
+  }
+  return saved_bytes();
+}
+
+size_t CheckpointPlanner::saved_bytes() const {
+  std::vector<std::shared_ptr<CheckpointSegment>> segments;
+  for (const auto& weak_segment : segments_) {
+    if (auto segment = weak_segment.lock()) {
+      segments.push_back(std::move(segment));
+    }
+  }
+  size_t bytes = 0;
+  for (const auto& entry : held_storages(segments)) {
+    if (entry.second.freeable()) {
+      bytes += entry.second.storage.capacity();
+    }
+  }
+  return bytes;
+}
+
+}} // namespace torch::autograd
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/autograd/variable.h>
+
+#include <ATen/ATen.h>
+#include <ATen/CPUGenerator.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace torch { namespace autograd {
+
+using variable_list = std::vector<Variable>;
+
+// NOTE [ Activation Checkpointing ]
+//
+// Activation checkpointing trades compute for memory: instead of keeping the
+// activations a forward pass saves for backward, we drop them and recompute
+// them when backward needs them.
+//
+// A CheckpointSegment runs a function whose inputs are known, and records
+// every SavedVariable constructed while it runs (in any Node, be it
+// generated, a C++ custom Function or a Python Function).  The data of these
+// SavedVariables is then held in a RecomputableData shared between the
+// SavedVariable and the segment, so that the segment can drop it.  The
+// autograd graph itself is left untouched, so backward traverses it as usual.
+//
+// When a SavedVariable whose data has been dropped is unpacked, its segment
+// runs the function again on its (detached) inputs, with grad mode and the
+// CPU RNG state of the original run.  As the function is deterministic, it
+// constructs the same SavedVariables in the same order, which lets us match
+// them with the recorded ones by index and hand their data over.  The graph
+// built by this rerun is thrown away.  As a result, recomputation is a plain
+// forward call on the backward thread: it doesn't re-enter the engine, and
+// unlike torch.utils.checkpoint it works with torch.autograd.grad.
+//
+// Recomputed data is released by release_variables() like any other saved
+// data once the Node that saved it has run.  Only saved variables whose data
+// was produced inside of the segment are dropped: segment inputs (and views
+// of them) and parameters stay alive anyway.
+//
+// Dropping is decided by a CheckpointPlanner after the forward pass, given a
+// memory budget, so that segments can be declared liberally (e.g. one per
+// block of layers) and only the ones worth recomputing are.  It estimates the
+// memory held by each segment from the storages only referenced by its saved
+// variables, and the cost of recomputing it from the time its forward took.
+// The activations passed from one segment to the next are inputs, and are
+// never dropped.
+//
+// Limitations: segments can't be nested, the function must be deterministic
+// given its inputs and the CPU RNG state (the CUDA RNG state is not
+// restored), and side effects of the function (e.g. updates of batch norm
+// running statistics) happen again when it is recomputed.
+
+struct CheckpointSegment;
+
+// The data of a variable saved for backward inside of a checkpoint segment.
+struct TORCH_API RecomputableData {
+  at::Tensor data;
+  std::shared_ptr<CheckpointSegment> segment;
+  // Whether the data was produced inside of the segment, and can be dropped.
+  bool droppable = false;
+  bool dropped = false;
+};
+
+struct TORCH_API CheckpointSegment
+    : std::enable_shared_from_this<CheckpointSegment> {
+  using Function = std::function<variable_list(const variable_list&)>;
+
+  explicit CheckpointSegment(Function fn);
+
+  // Runs the function on the inputs, recording the variables it saves. Must
+  // only be called once.
+  variable_list run(const variable_list& inputs);
+
+  // Called by the constructor of SavedVariable with the data it saves.
+  // Returns the RecomputableData that should hold the data from now on, or
+  // nullptr if the SavedVariable should keep it.
+  std::shared_ptr<RecomputableData> record(
+      const at::Tensor& data,
+      bool is_parameter);
+
+  // Returns the data of a recorded variable, recomputing it if it has been
+  // dropped.
+  at::Tensor unpack(RecomputableData& saved);
+
+  // Drops the data of all the variables that can be recomputed.
+  void drop();
+
+  // The segment recording or recomputing on this thread, if any.
+  static CheckpointSegment* current();
+
+  // Wall time the function took in forward, in microseconds.
+  int64_t forward_time_us() const {
+    return forward_time_us_;
+  }
+
+  // Live recorded variables whose data can be dropped.
+  std::vector<std::shared_ptr<RecomputableData>> droppable() const;
+
+ private:
+  void recompute();
+
+  Function fn_;
+  // Detached inputs, requiring grad as the original ones did.
+  variable_list inputs_;
+  std::vector<int64_t> input_versions_;
+  bool grad_mode_ = true;
+  std::shared_ptr<at::CPUGenerator> rng_state_;
+  int64_t forward_time_us_ = 0;
+
+  // Serializes recomputation with the unpacking of the recorded variables,
+  // which may happen on several threads. Recomputing runs fn_, which may
+  // take the GIL, so mutex_ must not be taken while holding the GIL.
+  mutable std::mutex mutex_;
+  std::vector<std::weak_ptr<RecomputableData>> saved_;
+  // While recomputing, the index of the next recorded variable.
+  size_t next_saved_ = 0;
+  bool recomputing_ = false;
+};
+
+// Runs functions as checkpoint segments and decides which of them to
+// recompute in backward. A planner is used from one thread at a time.
+struct TORCH_API CheckpointPlanner {
+  // Runs fn(inputs) as a new checkpoint segment.
+  variable_list run_segment(
+      CheckpointSegment::Function fn,
+      variable_list inputs);
+
+  // Drops the saved activations of segments until the memory they hold is at
+  // most memory_budget bytes, or until only the last segment (which would be
+  // recomputed right away in backward) is left.  Segments that free the most
+  // memory per time spent recomputing them are dropped first.  Returns the
+  // number of bytes still held.
+  size_t plan(size_t memory_budget);
+
+  // Number of bytes held by the saved activations of the live segments.
+  size_t saved_bytes() const;
+
+ private:
+  std::vector<std::weak_ptr<CheckpointSegment>> segments_;
+};
+
+}} // namespace torch::autograd
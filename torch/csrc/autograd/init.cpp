@@ -2,6 +2,7 @@
 
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/utils/pybind.h>
+#include <torch/csrc/autograd/checkpoint.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/profiler.h>
 #include <torch/csrc/autograd/python_function.h>
@@ -59,6 +60,38 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
   py::class_<RecordFunction, std::shared_ptr<RecordFunction>>(m, "_RecordFunction")
     .def(py::init<>());
 
+  using torch::autograd::CheckpointPlanner;
+  using torch::autograd::variable_list;
+  py::class_<CheckpointPlanner>(m, "_CheckpointPlanner")
+      .def(py::init<>())
+      .def(
+          "run_segment",
+          [](CheckpointPlanner& self, py::function fn, variable_list inputs) {
+            // The function is called again, and eventually destroyed, by
+            // the backward pass, which doesn't hold the GIL.
+            std::shared_ptr<py::function> fn_ptr(
+                new py::function(std::move(fn)), [](py::function* fn) {
+                  pybind11::gil_scoped_acquire gil;
+                  delete fn;
+                });
+            return self.run_segment(
+                [fn_ptr](const variable_list& inputs) {
+                  pybind11::gil_scoped_acquire gil;
+                  return (*fn_ptr)(inputs).cast<variable_list>();
+                },
+                std::move(inputs));
+          })
+      // Both take the mutex of each segment, which a backward pass holds
+      // while recomputing the segment, and so while waiting for the GIL.
+      .def(
+          "plan",
+          &CheckpointPlanner::plan,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "saved_bytes",
+          &CheckpointPlanner::saved_bytes,
+          py::call_guard<py::gil_scoped_release>());
+
   Py_RETURN_TRUE;
 }
 
@@ -104,10 +137,32 @@ static PyObject * is_anomaly_mode_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_inference_mode_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("enabled must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  c10::InferenceMode::set_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_inference_mode_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (c10::InferenceMode::is_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 // autograd methods on torch._C
 static PyMethodDef methods[] = {
   {"set_grad_enabled", (PyCFunction)set_grad_enabled, METH_O, nullptr},
   {"is_grad_enabled", (PyCFunction)is_grad_enabled, METH_NOARGS, nullptr},
+  {"_set_inference_mode_enabled", (PyCFunction)set_inference_mode_enabled, METH_O, nullptr},
+  {"_is_inference_mode_enabled", (PyCFunction)is_inference_mode_enabled, METH_NOARGS, nullptr},
   {"set_anomaly_enabled", (PyCFunction)set_anomaly_mode_enabled, METH_O, nullptr},
   {"is_anomaly_enabled", (PyCFunction)is_anomaly_mode_enabled, METH_NOARGS, nullptr},
   {nullptr, nullptr, 0, nullptr}
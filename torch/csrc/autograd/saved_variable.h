@@ -11,6 +11,7 @@ namespace torch { namespace autograd {
 
 using Variable = at::Tensor;
 struct Node;
+struct RecomputableData;
 
 TORCH_API extern const char* ERR_BACKWARD_TWICE;
 
@@ -29,7 +30,8 @@ class TORCH_API SavedVariable {
   Variable unpack(std::shared_ptr<Node> saved_for = nullptr) const;
 
   void reset_data() {
-    return data_.reset();
+    data_.reset();
+    recomputable_.reset();
   }
 
   void reset_grad_function() {
@@ -38,6 +40,9 @@ class TORCH_API SavedVariable {
 
  private:
   at::Tensor data_;
+  // Holds the data instead of data_ for variables saved inside of a
+  // checkpoint segment, see NOTE [ Activation Checkpointing ].
+  std::shared_ptr<RecomputableData> recomputable_;
 
   // The gradient function associated with this node. If has_grad_fn
   // is false, then this is a leaf node. Note that the grad_fn is not saved if
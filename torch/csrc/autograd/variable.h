@@ -209,6 +209,10 @@ struct TORCH_API AutogradMeta : public c10::AutogradMetaInterface {
     TORCH_CHECK(
       !requires_grad || at::isFloatingType(at::typeMetaToScalarType(self_impl->dtype())),
       "Only Tensors of floating point dtype can require gradients");
+    TORCH_CHECK(
+      !requires_grad || !self_impl->is_inference(),
+      "Inference tensors cannot require gradients. You can make a clone to "
+      "get a normal tensor that can.");
     requires_grad_ = requires_grad;
   }
 
@@ -393,7 +397,10 @@ inline Variable make_variable(
     bool requires_grad = false,
     bool allow_tensor_metadata_change = true) {
   if (data.defined()) {
-    if (data.getIntrusivePtr().use_count() == 1 && data.getIntrusivePtr()->unique_version()) {
+    // Inference tensors don't share a version counter with anything.
+    if (data.getIntrusivePtr().use_count() == 1 &&
+        (data.getIntrusivePtr()->unique_version() ||
+         data.getIntrusivePtr()->is_inference())) {
       auto data_impl = data.getIntrusivePtr();
       data_impl->set_allow_tensor_metadata_change(allow_tensor_metadata_change);
       if (requires_grad) {
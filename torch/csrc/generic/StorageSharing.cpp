@@ -14,6 +14,8 @@ static PyObject * THPStorage_(sharedDecref)(THPStorage *self, PyObject *noargs)
   THManagedMapAllocator *ctx = THManagedMapAllocator::fromDataPtr(storage->data_ptr());
   if (ctx) {
     ctx->decref();
+  } else if (THManagedArenaSlot *slot = THManagedArenaSlot::fromDataPtr(storage->data_ptr())) {
+    slot->decref();
   }
 #endif
   Py_INCREF(self);
@@ -29,6 +31,8 @@ static PyObject * THPStorage_(sharedIncref)(THPStorage *self, PyObject *noargs)
   THManagedMapAllocator *ctx = THManagedMapAllocator::fromDataPtr(storage->data_ptr());
   if (ctx) {
     ctx->incref();
+  } else if (THManagedArenaSlot *slot = THManagedArenaSlot::fromDataPtr(storage->data_ptr())) {
+    slot->incref();
   }
 #endif
   Py_RETURN_NONE;
@@ -50,8 +54,15 @@ static std::string THPStorage_(__newHandle)() {
   return handle;
 }
 
-static THWStorage* THPStorage_(newFilenameStorage)(ptrdiff_t size)
+// If use_pool is set, storages small enough to fit into a slot of a pooled
+// shared memory arena are placed there instead of getting a segment of their
+// own (see THManagedArenaSlot).
+static THWStorage* THPStorage_(newFilenameStorage)(ptrdiff_t size, bool use_pool)
 {
+  if (use_pool && THManagedArenaSlot::canAllocate(size * sizeof(scalar_t))) {
+    return THWStorage_(newWithDataAndAllocator)(
+        THManagedArenaSlot::makeDataPtr(size * sizeof(scalar_t)), size, /* allocator */ nullptr);
+  }
   int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_EXCLUSIVE;
   std::string handle = THPStorage_(__newHandle)();
   return THWStorage_(newWithDataAndAllocator)(
@@ -62,40 +73,57 @@ static PyObject * THPStorage_(pyNewFilenameStorage)(PyObject *_unused, PyObject
 {
   HANDLE_TH_ERRORS
   long long size;
-  if (!PyArg_ParseTuple(args, "L", &size)) {
+  PyObject *use_pool = nullptr;
+  if (!PyArg_ParseTuple(args, "L|O", &size, &use_pool)) {
     return nullptr;
   }
-  return THPStorage_(New)(THPStorage_(newFilenameStorage)(size));
+  return THPStorage_(New)(THPStorage_(newFilenameStorage)(
+      size, use_pool && PyObject_IsTrue(use_pool)));
   END_HANDLE_TH_ERRORS
 }
 
-static PyObject * THPStorage_(shareFilename)(THPStorage *self, PyObject *noargs)
+static PyObject * THPStorage_(shareFilename)(THPStorage *self, PyObject *args)
 {
   HANDLE_TH_ERRORS
   THWStorage *storage = self->cdata;
-  THManagedMapAllocator *ctx;
+  PyObject *use_pool = nullptr;
+  if (!PyArg_ParseTuple(args, "|O", &use_pool)) {
+    return nullptr;
+  }
+  THManagedMapAllocator *ctx = THManagedMapAllocator::fromDataPtr(storage->data_ptr());
+  THManagedArenaSlot *slot = THManagedArenaSlot::fromDataPtr(storage->data_ptr());
   // Storage is already in shared memory, just return a handle
-  if ((ctx = THManagedMapAllocator::fromDataPtr(storage->data_ptr()))) {
+  if (ctx || slot) {
     // done
   } else {
     // TODO: retry on collision
     // TODO: free GIL - but remember to reacquire it when an exception is thrown
-    THWStoragePtr new_storage(THPStorage_(newFilenameStorage)(storage->numel()));
+    THWStoragePtr new_storage(THPStorage_(newFilenameStorage)(
+        storage->numel(), use_pool && PyObject_IsTrue(use_pool)));
     THWStorage_(copy)(new_storage, storage);
     THWStorage_(swap)(storage, new_storage);
     ctx = THManagedMapAllocator::fromDataPtr(storage->data_ptr());
-    AT_ASSERT(ctx);
+    slot = THManagedArenaSlot::fromDataPtr(storage->data_ptr());
+    AT_ASSERT(ctx || slot);
   }
 
-  THPObjectPtr manager_handle(PyBytes_FromString(ctx->manager_handle()));
+  THPObjectPtr manager_handle(PyBytes_FromString(
+      ctx ? ctx->manager_handle() : slot->manager_handle()));
   if (!manager_handle) return nullptr;
-  THPObjectPtr storage_handle(PyBytes_FromString(ctx->filename()));
+  THPObjectPtr storage_handle(PyBytes_FromString(
+      ctx ? ctx->filename() : slot->arena_handle()));
   if (!storage_handle) return nullptr;
   THPObjectPtr size(PyLong_FromLong(storage->numel()));
   if (!size) return nullptr;
 
-  THPObjectPtr tuple(PyTuple_New(3));
+  // Storages living in an arena slot also carry their offset into the arena
+  THPObjectPtr tuple(PyTuple_New(ctx ? 3 : 4));
   if (!tuple) return nullptr;
+  if (slot) {
+    THPObjectPtr offset(PyLong_FromSsize_t(slot->offset()));
+    if (!offset) return nullptr;
+    PyTuple_SET_ITEM(tuple.get(), 3, offset.release());
+  }
   PyTuple_SET_ITEM(tuple.get(), 0, manager_handle.release());
   PyTuple_SET_ITEM(tuple.get(), 1, storage_handle.release());
   PyTuple_SET_ITEM(tuple.get(), 2, size.release());
@@ -106,18 +134,29 @@ static PyObject * THPStorage_(shareFilename)(THPStorage *self, PyObject *noargs)
 static PyObject * THPStorage_(newSharedFilename)(PyObject *_unused, PyObject *args)
 {
   HANDLE_TH_ERRORS
-  THPUtils_assert(PyTuple_GET_SIZE(args) == 3, "tuple of 3 items expected");
+  THPUtils_assert(PyTuple_GET_SIZE(args) == 3 || PyTuple_GET_SIZE(args) == 4,
+      "tuple of 3 or 4 items expected");
   PyObject *_manager_handle = PyTuple_GET_ITEM(args, 0);
   PyObject *_object_handle = PyTuple_GET_ITEM(args, 1);
   PyObject *_size = PyTuple_GET_ITEM(args, 2);
-  if (!PyBytes_Check(_manager_handle) || !PyBytes_Check(_object_handle) || !THPUtils_checkLong(_size)) {
+  PyObject *_offset = PyTuple_GET_SIZE(args) == 4 ? PyTuple_GET_ITEM(args, 3) : nullptr;
+  if (!PyBytes_Check(_manager_handle) || !PyBytes_Check(_object_handle) || !THPUtils_checkLong(_size) ||
+      (_offset && !THPUtils_checkLong(_offset))) {
     THPUtils_invalidArguments(args, nullptr, "_new_shared in file system mode", 1,
-        "a handle (string/bytes) and storage size (int)");
+        "a handle (string/bytes), storage size (int) and an optional arena offset (int)");
     return nullptr;
   }
   const char *manager_handle = PyBytes_AS_STRING(_manager_handle);
   const char *object_handle = PyBytes_AS_STRING(_object_handle);
   int64_t size = THPUtils_unpackLong(_size);
+  if (_offset) {
+    int64_t offset = THPUtils_unpackLong(_offset);
+    return THPStorage_(New)(
+            THWStorage_(newWithDataAndAllocator)(
+              THManagedArenaSlot::makeDataPtr(manager_handle, object_handle, offset, size * sizeof(scalar_t)),
+              size,
+              /* allocator */ nullptr));
+  }
   int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM |
               TH_ALLOCATOR_MAPPED_NOCREATE;
   return THPStorage_(New)(
@@ -516,7 +555,8 @@ PyObject * THPStorage_(isShared)(THPStorage *self, PyObject *noargs)
   Py_RETURN_TRUE;
 #else
   if (THMapAllocator::fromDataPtr(self->cdata->data_ptr()) ||
-      THManagedMapAllocator::fromDataPtr(self->cdata->data_ptr())) {
+      THManagedMapAllocator::fromDataPtr(self->cdata->data_ptr()) ||
+      THManagedArenaSlot::fromDataPtr(self->cdata->data_ptr())) {
     Py_RETURN_TRUE;
   } else {
     Py_RETURN_FALSE;
@@ -534,7 +574,7 @@ static PyMethodDef THPStorage_(sharingMethods)[] = {
   {"_share_fd_", (PyCFunction)THPStorage_(shareFd), METH_NOARGS, nullptr},
   {"_new_shared_fd", (PyCFunction)(void(*)(void))THPStorage_(newSharedFd), METH_VARARGS | METH_STATIC, nullptr},
   {"_new_using_fd", (PyCFunction)(void(*)(void))THPStorage_(pyNewFdStorage), METH_VARARGS | METH_STATIC, nullptr},
-  {"_share_filename_", (PyCFunction)THPStorage_(shareFilename), METH_NOARGS, nullptr},
+  {"_share_filename_", (PyCFunction)THPStorage_(shareFilename), METH_VARARGS, nullptr},
   {"_new_shared_filename", (PyCFunction)(void(*)(void))THPStorage_(newSharedFilename), METH_VARARGS | METH_STATIC, nullptr},
   {"_new_using_filename", (PyCFunction)(void(*)(void))THPStorage_(pyNewFilenameStorage), METH_VARARGS | METH_STATIC, nullptr},
 #endif
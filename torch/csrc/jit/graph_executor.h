@@ -31,10 +31,20 @@ struct ExecutionPlan {
 // They is only valid only right after you call getDebugState() and should never
 // be used again once another GraphExecutor function is called.
 
+// Counters maintained by the profiling executor. The bailout rate is
+// bailouts / plan_cache_hits, as every hit runs an optimized plan.
+struct GraphExecutorStats {
+  size_t plan_cache_hits = 0;
+  size_t plan_cache_misses = 0;
+  size_t plan_cache_evictions = 0;
+  size_t bailouts = 0;
+};
+
 struct GraphExecutorState {
   const Graph* graph = nullptr;
   ExecutionPlan fallback; // XXX: members of this field are optional
   std::unordered_map<ArgumentSpec, ExecutionPlan> execution_plans;
+  GraphExecutorStats stats;
 };
 
 struct GraphExecutorImplBase;
@@ -62,6 +72,9 @@ TORCH_API std::shared_ptr<Graph> lastExecutedOptimizedGraph();
 
 TORCH_API std::atomic<bool> &getProfilingMode();
 TORCH_API std::atomic<bool>& getExecutorMode();
+// Maximum number of shape specializations the profiling executor keeps per
+// graph, see NOTE [ Profiling Executor Plan Cache ].
+TORCH_API std::atomic<size_t>& getProfilingPlanCacheSize();
 
 struct TORCH_API GraphOptimizerEnabledGuard {
   GraphOptimizerEnabledGuard(bool state)
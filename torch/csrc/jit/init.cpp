@@ -9,6 +9,7 @@
 #include <torch/csrc/jit/import.h>
 #include <torch/csrc/jit/irparser.h>
 #include <torch/csrc/jit/operator.h>
+#include <torch/csrc/jit/passes/batch_mm.h>
 #include <torch/csrc/jit/passes/canonicalize.h>
 #include <torch/csrc/jit/passes/canonicalize_ops.h>
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
@@ -195,6 +196,7 @@ void initJITBindings(PyObject* module) {
           [](std::shared_ptr<Graph>& g) { return QuantFusion(g); })
       .def("_jit_pass_fold_convbn", &FoldConvBatchNorm2d)
       .def("_jit_pass_fuse_linear", &FuseLinear)
+      .def("_jit_pass_batch_mm", &BatchMM)
       .def(
           "_jit_pass_fold_quantize",
           [](script::Module& module, const std::string& method_name) {
@@ -356,6 +358,13 @@ void initJITBindings(PyObject* module) {
             getExecutorMode() = profiling_flag;
             return oldState;
           })
+      .def(
+          "_jit_set_profiling_plan_cache_size",
+          [](size_t size) {
+            size_t oldSize = getProfilingPlanCacheSize();
+            getProfilingPlanCacheSize() = size;
+            return oldSize;
+          })
       .def(
           "_jit_set_inline_everything_mode",
           [](bool enabled) { script::getInlineEverythingMode() = enabled; })
@@ -435,7 +444,17 @@ void initJITBindings(PyObject* module) {
           "execution_plans",
           [](GraphExecutorState& s) { return s.execution_plans; })
       .def_property_readonly(
-          "fallback", [](GraphExecutorState& s) { return s.fallback; });
+          "fallback", [](GraphExecutorState& s) { return s.fallback; })
+      .def_property_readonly(
+          "stats", [](GraphExecutorState& s) { return s.stats; });
+
+  py::class_<GraphExecutorStats>(m, "GraphExecutorStats")
+      .def_readonly("plan_cache_hits", &GraphExecutorStats::plan_cache_hits)
+      .def_readonly(
+          "plan_cache_misses", &GraphExecutorStats::plan_cache_misses)
+      .def_readonly(
+          "plan_cache_evictions", &GraphExecutorStats::plan_cache_evictions)
+      .def_readonly("bailouts", &GraphExecutorStats::bailouts);
 
   py::class_<PyTorchStreamWriter>(m, "PyTorchFileWriter")
       .def(py::init<std::string>())
@@ -17,6 +17,7 @@
 #include <torch/csrc/jit/script/compilation_unit.h>
 #include <torch/csrc/jit/script/jit_exception.h>
 
+#include <atomic>
 #include <exception>
 #include <iostream>
 #include <memory>
@@ -381,6 +382,8 @@ struct CodeImpl {
   // out-of-line jumps for bailouts that are patched in at the end
   std::vector<BailoutBlock> bailout_blocks_;
   std::vector<std::unique_ptr<Function>> bailout_functions_;
+  // number of times a guard of this code failed and we bailed out
+  std::atomic<size_t> num_bailouts_{0};
 
   CodeImpl(const std::shared_ptr<Graph>& graph)
       : preprocess_(*graph), current_node_(preprocess_.graph->return_node()) {
@@ -1023,7 +1026,11 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             auto t = stack.back().toTensor();
             auto actual = tensorTypeInCurrentExecutionContext(t);
             const TypePtr& expected = af.types[inst.X];
-            push(stack, *expected == *actual);
+            bool matches = *expected == *actual;
+            if (!matches) {
+              frames.back().function->num_bailouts_++;
+            }
+            push(stack, matches);
             ++af.pc;
           } break;
           case TAIL_CALL: {
@@ -1165,6 +1172,10 @@ size_t Code::register_size() const {
   return pImpl->register_size_;
 }
 
+size_t Code::num_bailouts() const {
+  return pImpl->num_bailouts_;
+}
+
 InterpreterState::InterpreterState(const Code& code)
     : pImpl(c10::make_intrusive<InterpreterStateImpl>(code)) {}
 InterpreterState::~InterpreterState() = default;
@@ -18,6 +18,12 @@ void tupleConstructFunc(int num_inputs, Stack& stack) {
   drop(stack, num_inputs);
   push(stack, c10::ivalue::Tuple::create(std::move(elems)));
 }
+
+bool isVarargOperator(const c10::OperatorName& opname) {
+  return opname.name == "prim::ListConstruct" ||
+      opname.name == "prim::TupleConstruct" ||
+      opname.name == "prim::TupleUnpack" || opname.name == "aten::format";
+}
 }
 
 char const * toString(OpCode op);
@@ -36,6 +42,19 @@ void Function::append_operator(const std::string& name,
   // Keep the original opname in code_
   code_->op_names_.emplace_back(name, overload_name);
   auto opname = code_->op_names_.back();
+  // Operators in the table generated for this build are resolved to their
+  // index there; the rest still go through the dispatcher.
+  if (auto index = findOpTableIndex(opname)) {
+    code_->operators_.emplace_back(c10::nullopt);
+    code_->op_functions_.emplace_back(opTable()[*index].fn);
+    return;
+  }
+  // Vararg operators get their functions from build_vararg_operator_table.
+  if (isVarargOperator(opname)) {
+    code_->operators_.emplace_back(c10::nullopt);
+    code_->op_functions_.emplace_back(nullptr);
+    return;
+  }
   // Add "_" prefix to work around the double registration both of jit/generated
   // and here. TODO: remove it when we have separate build for lite interpreter.
   if (opname.name != "aten::Int") {
@@ -44,6 +63,7 @@ void Function::append_operator(const std::string& name,
   auto op = c10::Dispatcher::singleton().findSchema(opname);
   TORCH_CHECK(op.has_value(), opname.name, ".", opname.overload_name, " cannot be found.");
   code_->operators_.emplace_back(op);
+  code_->op_functions_.emplace_back(nullptr);
 }
 
 void Function::build_vararg_operator_table() {
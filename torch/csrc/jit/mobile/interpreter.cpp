@@ -57,7 +57,11 @@ bool InterpreterState::run(Stack& stack) {
         RECORD_FUNCTION(code_->op_names_[inst.X].name, stack);
 #endif
 
-        c10::Dispatcher::singleton().callBoxed(*code_->operators_[inst.X], &stack);
+        if (auto fn = code_->op_functions_[inst.X]) {
+          fn(stack);
+        } else {
+          c10::Dispatcher::singleton().callBoxed(*code_->operators_[inst.X], &stack);
+        }
         ++pc;
       } break;
       case OPN: {
@@ -3,6 +3,7 @@
 #include <ATen/core/operator_name.h>
 #include <torch/csrc/jit/instruction.h>
 #include <ATen/core/dispatch/Dispatcher.h>
+#include <torch/csrc/jit/mobile/op_table.h>
 
 namespace torch{
 namespace jit{
@@ -13,6 +14,9 @@ struct Code {
   std::vector<Instruction> instructions_;
   std::vector<c10::OperatorName> op_names_;
   std::vector<c10::optional<c10::OperatorHandle>> operators_;
+  // Direct entries from opTable(), parallel to operators_. Operators that are
+  // not in the table are null here and called through the dispatcher.
+  std::vector<OpFunction> op_functions_;
   std::vector<VarargFuncton> vararg_operators_;
   std::vector<c10::IValue> constants_;
   size_t register_size_; // Aggregated output size.
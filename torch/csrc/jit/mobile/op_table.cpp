@@ -0,0 +1,29 @@
+#include "op_table.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace torch{
+namespace jit{
+namespace mobile {
+
+c10::optional<size_t> findOpTableIndex(const c10::OperatorName& opname) {
+  const auto table = opTable();
+  const char* name = opname.name.c_str();
+  const char* overload_name = opname.overload_name.c_str();
+  auto it = std::lower_bound(
+      table.begin(), table.end(), opname,
+      [&](const OpTableEntry& entry, const c10::OperatorName&) {
+        int cmp = std::strcmp(entry.name, name);
+        return cmp < 0 || (cmp == 0 && std::strcmp(entry.overload_name, overload_name) < 0);
+      });
+  if (it == table.end() || std::strcmp(it->name, name) != 0 ||
+      std::strcmp(it->overload_name, overload_name) != 0) {
+    return c10::nullopt;
+  }
+  return it - table.begin();
+}
+
+} // namespace mobile
+} // namespace torch
+} // namespace jit
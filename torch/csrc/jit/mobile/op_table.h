@@ -0,0 +1,31 @@
+#pragma once
+#include <ATen/core/ivalue.h>
+#include <ATen/core/operator_name.h>
+#include <c10/util/ArrayRef.h>
+#include <c10/util/Optional.h>
+
+namespace torch{
+namespace jit{
+namespace mobile {
+using Stack = std::vector<c10::IValue>;
+using OpFunction = int (*)(Stack&);
+
+// An operator that the lite interpreter calls directly, without going through
+// the c10 dispatcher.
+struct OpTableEntry {
+  const char* name;
+  const char* overload_name;
+  OpFunction fn;
+};
+
+// The table generated for the operators listed in SELECTED_OP_LIST (see
+// tools/jit/gen_jit_dispatch.py), sorted by (name, overload_name). It is
+// statically initialized and empty when no op list was given at build time.
+TORCH_API c10::ArrayRef<OpTableEntry> opTable();
+
+// Index of opname in opTable(), if the build has a direct entry for it.
+TORCH_API c10::optional<size_t> findOpTableIndex(const c10::OperatorName& opname);
+
+} // namespace mobile
+} // namespace torch
+} // namespace jit
@@ -368,31 +368,39 @@ RegisterOperators mm_batch_side_reg({Operator(
     },
     aliasAnalysisIsSpecialCase())});
 
-std::pair<std::vector<Node*>, std::vector<Node*>> gatherIndependentMMUses(
-    Value* value,
+// Returns the nodes of `nodes` (in topological order) that could be moved next
+// to the first one of them, i.e. that don't depend on each other.
+std::vector<Node*> filterIndependentNodes(
+    std::vector<Node*> nodes,
     AliasDb& alias_db) {
-  const auto postprocess = [&](std::vector<Node*> mms) {
-    if (mms.size() == 0) {
-      return mms;
-    }
-    std::sort(mms.begin(), mms.end(), [](Node* n, Node* m) {
-      return n->isBefore(m);
-    });
-    // Filter out dependent MMs. This algorithm might do very badly if e.g. you
-    // have a lot of independent MMs, that depend on the first one, but I doubt
-    // this will be a common scenario.
-    for (size_t i = 0; i < mms.size(); ++i) {
-      if (mms[i] == nullptr)
+  if (nodes.size() == 0) {
+    return nodes;
+  }
+  std::sort(nodes.begin(), nodes.end(), [](Node* n, Node* m) {
+    return n->isBefore(m);
+  });
+  // Filter out dependent nodes. This algorithm might do very badly if e.g. you
+  // have a lot of independent nodes, that depend on the first one, but I doubt
+  // this will be a common scenario.
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i] == nullptr)
+      continue;
+    for (size_t j = i + 1; j < nodes.size(); ++j) {
+      if (nodes[j] == nullptr)
         continue;
-      for (size_t j = i + 1; j < mms.size(); ++j) {
-        if (mms[j] == nullptr)
-          continue;
-        if (!alias_db.couldMoveBeforeTopologically(mms[j], mms[i])) {
-          mms[j] = nullptr;
-        }
+      if (!alias_db.couldMoveBeforeTopologically(nodes[j], nodes[i])) {
+        nodes[j] = nullptr;
       }
     }
-    return c10::filter(mms, [](Node* n) { return n != nullptr; });
+  }
+  return c10::filter(nodes, [](Node* n) { return n != nullptr; });
+}
+
+std::pair<std::vector<Node*>, std::vector<Node*>> gatherIndependentMMUses(
+    Value* value,
+    AliasDb& alias_db) {
+  const auto postprocess = [&](std::vector<Node*> mms) {
+    return filterIndependentNodes(std::move(mms), alias_db);
   };
 
   Block* block = value->node()->owningBlock();
@@ -459,6 +467,190 @@ void BatchMMSide(Block* block, AliasDb& alias_db) {
   }
 }
 
+// Multi-head and multi-tower models apply many linear layers with different
+// weights to the same input. BatchLinearSide replaces independent linear nodes
+// sharing their input with a single prim::LinearBatchSide node, which
+// concatenates the weights (and biases) and computes all the outputs with a
+// single GEMM:
+//
+// +------+   +------+   +------+   +------+       +------+   +------+------+
+// |      | x |  W1  | , |      | x |  W2  |  =>   |      | x |  W1  |  W2  |
+// |  X   |   |      |   |  X   |   |      |       |  X   |   |      |      |
+// +------+   +------+   +------+   +------+       +------+   +------+------+
+//
+// and splits the result into the outputs of the original nodes. Both
+// aten::linear and mm(input, weight.t()) are batched, though never together.
+// The latter is what F.linear becomes for 2-d inputs once DecomposeOps has
+// split its addmm, and unlike prim::MMBatchSide we don't need to concatenate
+// the transposed weights.
+//
+// The concatenated weights are not cached across calls: weights can be
+// changed behind the graph's back (optimizers update them through .data,
+// which has a version counter of its own), so there's nothing reliable to
+// invalidate such a cache with. Concatenating them copies as much memory as
+// the weights take, which only pays off when the GEMM has enough rows to
+// amortize it; smaller inputs run the linear layers one by one.
+
+// Tunable parameters. Even two linear layers gain from sharing the reads of
+// their input.
+static constexpr size_t min_linear_batch_size = 2;
+// Below this many input rows, copying the weights costs more than batching
+// saves.
+static constexpr int64_t min_linear_batch_rows = 128;
+
+bool can_batch_linears(
+    const at::Tensor& input,
+    at::TensorList weights,
+    at::TensorList biases,
+    bool is_mm) {
+  if (input.layout() != at::kStrided || input.dim() < 1 ||
+      (is_mm && input.dim() != 2)) {
+    return false;
+  }
+  if (input.size(-1) == 0 ||
+      input.numel() / input.size(-1) < min_linear_batch_rows) {
+    return false;
+  }
+  const auto same_kind_as_input = [&](const at::Tensor& t) {
+    return t.layout() == at::kStrided &&
+        t.scalar_type() == input.scalar_type() &&
+        t.device() == input.device();
+  };
+  bool has_bias = biases[0].defined();
+  for (size_t i = 0; i < weights.size(); ++i) {
+    const at::Tensor& weight = weights[i];
+    const at::Tensor& bias = biases[i];
+    if (!same_kind_as_input(weight) || weight.dim() != 2 ||
+        weight.size(1) != input.size(-1) || bias.defined() != has_bias) {
+      return false;
+    }
+    if (has_bias &&
+        (!same_kind_as_input(bias) || bias.dim() != 1 ||
+         bias.size(0) != weight.size(0))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+RegisterOperators linear_batch_side_reg({Operator(
+    prim::LinearBatchSide,
+    [](const Node* node) -> Operation {
+      size_t num_linears = (node->inputs().size() - 1) / 2;
+      bool is_mm = node->i(Symbol::attr("mm"));
+      return [num_linears, is_mm](Stack& stack) {
+        auto biases = fmap(last(stack, num_linears), [](const IValue& v) {
+          return v.isNone() ? at::Tensor() : v.toTensor();
+        });
+        drop(stack, num_linears);
+        auto weights = fmap(last(stack, num_linears), [](const IValue& v) {
+          return v.toTensor();
+        });
+        drop(stack, num_linears);
+        at::Tensor input;
+        pop(stack, input);
+
+        if (can_batch_linears(input, weights, biases, is_mm)) {
+          auto weight = at::cat(weights, /*dim=*/0);
+          auto bias =
+              biases[0].defined() ? at::cat(biases, /*dim=*/0) : at::Tensor();
+          auto out = is_mm ? input.mm(weight.t())
+                           : at::linear(input, weight, bias);
+          auto outputs = at::split_with_sizes(
+              out,
+              fmap(weights, [](const at::Tensor& w) { return w.size(0); }),
+              /*dim=*/-1);
+          stack.insert(
+              stack.end(),
+              std::make_move_iterator(outputs.begin()),
+              std::make_move_iterator(outputs.end()));
+        } else {
+          for (size_t i = 0; i < num_linears; ++i) {
+            stack.emplace_back(
+                is_mm ? input.mm(weights[i].t())
+                      : at::linear(input, weights[i], biases[i]));
+          }
+        }
+
+        return 0;
+      };
+    },
+    aliasAnalysisIsSpecialCase())});
+
+// Returns the weight of a linear node we know how to batch, nullptr for any
+// other node.
+Value* batchableLinearWeight(Node* node) {
+  if (node->matches(
+          "aten::linear(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor")) {
+    return node->input(1);
+  }
+  if (node->matches("aten::mm(Tensor self, Tensor mat2) -> Tensor") &&
+      node->input(1)->node()->matches("aten::t(Tensor self) -> Tensor")) {
+    return node->input(1)->node()->input();
+  }
+  return nullptr;
+}
+
+void BatchLinearSide(Block* block, AliasDb& alias_db) {
+  const auto batch_linears = [&](std::vector<Node*>& linears) {
+    AT_ASSERT(!linears.empty());
+    for (int64_t i = static_cast<int64_t>(linears.size()) - 2; i >= 0; --i) {
+      bool move_ok =
+          alias_db.moveBeforeTopologicallyValid(linears[i], linears[i + 1]);
+      AT_ASSERT(move_ok);
+    }
+    WithInsertPoint insert_guard{linears[0]};
+    Graph* graph = linears[0]->owningGraph();
+    bool is_mm = linears[0]->kind() == aten::mm;
+    Value* none = is_mm ? graph->insertConstant(IValue()) : nullptr;
+    Node* batch_linear = graph->create(
+        prim::LinearBatchSide,
+        /*inputs=*/{},
+        /*num_outputs=*/linears.size());
+    graph->insertNode(batch_linear);
+    batch_linear->i_(Symbol::attr("mm"), is_mm);
+    batch_linear->addInput(linears[0]->input(0));
+    for (Node* linear : linears) {
+      batch_linear->addInput(batchableLinearWeight(linear));
+    }
+    for (Node* linear : linears) {
+      batch_linear->addInput(is_mm ? none : linear->input(2));
+    }
+    for (size_t i = 0; i < linears.size(); ++i) {
+      batch_linear->outputs().at(i)->setType(linears[i]->output()->type());
+      linears[i]->output()->replaceAllUsesWith(batch_linear->outputs().at(i));
+    }
+  };
+
+  std::unordered_set<Value*> considered_values;
+  for (Node* node : block->nodes()) {
+    if (batchableLinearWeight(node)) {
+      Value* input = node->input(0);
+      if (/*bool not_inserted = */ !considered_values.emplace(input).second) {
+        continue;
+      }
+      std::vector<Node*> linears;
+      std::vector<Node*> mms;
+      for (Use u : input->uses()) {
+        if (u.offset == 0 && u.user->owningBlock() == block &&
+            batchableLinearWeight(u.user)) {
+          (u.user->kind() == aten::mm ? mms : linears).push_back(u.user);
+        }
+      }
+      for (auto group : {&linears, &mms}) {
+        *group = filterIndependentNodes(std::move(*group), alias_db);
+        if (group->size() >= min_linear_batch_size) {
+          batch_linears(*group);
+        }
+      }
+    } else {
+      for (Block* subblock : node->blocks()) {
+        BatchLinearSide(subblock, alias_db);
+      }
+    }
+  }
+}
+
 bool hasMutableOperators(Block* block) {
   for (auto n : block->nodes()) {
     if (n->kind().is_aten() && n->schema().is_mutable())
@@ -476,8 +668,19 @@ void BatchMM(std::shared_ptr<Graph>& graph) {
     // TODO(suo): make BatchMM mutability-safe
     return;
   }
-  AliasDb alias_db(graph);
   BatchMMTreeReduce(graph->block());
+  // The passes below need an up to date AliasDb, and mustn't see the nodes
+  // replaced by the previous ones.
+  EliminateDeadCode(graph);
+  {
+    // Before BatchMMSide, which would also batch mm(input, weight.t()), but
+    // regardless of the number of input rows and with a copy of the
+    // transposed weights.
+    AliasDb alias_db(graph);
+    BatchLinearSide(graph->block(), alias_db);
+  }
+  EliminateDeadCode(graph);
+  AliasDb alias_db(graph);
   BatchMMSide(graph->block(), alias_db);
   EliminateDeadCode(graph);
   // It's possible that transpose rearrangements have created sequences of
@@ -20,6 +20,8 @@
 #include <torch/csrc/jit/passes/specialize_autogradzero.h>
 #include <torch/csrc/jit/profiling_graph_executor_impl.h>
 
+#include <sstream>
+
 namespace torch {
 namespace jit {
 
@@ -124,51 +126,181 @@ ProfilingGraphExecutorImpl::ProfilingGraphExecutorImpl(
     const std::shared_ptr<Graph>& graph)
     : GraphExecutorImplBase(graph) {}
 
+// NOTE [ Profiling Executor Plan Cache ]
+// Profiling a graph once and optimizing it for the shapes seen then means that
+// every call with other shapes goes down the bailout path, which is slow for
+// workloads cycling through a handful of input shapes.
+//
+// Instead, we keep up to getProfilingPlanCacheSize() optimized plans, each
+// keyed by the types its ProfilingRecord recorded for the graph inputs. A call
+// runs the first plan whose key matches its inputs, and that plan moves to the
+// front of the list so that the hot plans are checked first. When no plan
+// matches, we keep running the most recently used one, which bails out where
+// needed, until the same input signature (the dtypes, shapes and devices of
+// the tensor inputs) has missed kMissesBeforeProfiling times. Then we profile
+// the graph again and add a plan specialized to the shapes seen during that
+// run, evicting the least recently used plan if the cache is full. This way
+// one-off shapes don't pay for a profiling run and a compilation, and neither
+// do workloads whose shapes keep changing.
+static constexpr size_t kMissesBeforeProfiling = 2;
+// Bounds the memory used to count misses when the shapes keep changing.
+static constexpr size_t kMaxMissedSignatures = 64;
+
+static std::atomic<size_t> profiling_plan_cache_size{8};
+
+std::atomic<size_t>& getProfilingPlanCacheSize() {
+  return profiling_plan_cache_size;
+}
+
+std::vector<TensorTypePtr> ProfilingGraphExecutorImpl::profiledInputTypes(
+    const Graph& profiled_graph) {
+  std::vector<TensorTypePtr> input_types;
+  for (const Value* input : profiled_graph.inputs()) {
+    TensorTypePtr input_type = nullptr;
+    for (const auto& use : input->uses()) {
+      if (use.user->kind() != prim::profile) {
+        continue;
+      }
+      // profiles in branches that weren't taken haven't recorded anything
+      auto type = use.user->output()->type()->cast<TensorType>();
+      if (type && *type != *TensorType::get()) {
+        input_type = type;
+        break;
+      }
+    }
+    input_types.push_back(input_type);
+  }
+  return input_types;
+}
+
+static bool matchesProfiledType(
+    const TensorTypePtr& expected,
+    const IValue& input) {
+  if (!expected) {
+    return true;
+  }
+  if (!input.isTensor()) {
+    return false;
+  }
+  auto actual = tensorTypeInCurrentExecutionContext(input.toTensor());
+  // same check as the guards in the plan, types merged over several profiling
+  // runs also accept anything they subsume
+  return *expected == *actual || *expected->merge(actual) == *expected;
+}
+
+ProfilingGraphExecutorImpl::SpecializedPlan* ProfilingGraphExecutorImpl::
+    findPlan(const Stack& stack) {
+  auto inputs = last(stack, num_inputs);
+  for (auto it = optimized_plans_.begin(); it != optimized_plans_.end(); ++it) {
+    bool matches = true;
+    for (size_t i = 0; i < num_inputs && matches; i++) {
+      matches = matchesProfiledType(it->input_types[i], inputs[i]);
+    }
+    if (matches) {
+      optimized_plans_.splice(
+          optimized_plans_.begin(), optimized_plans_, it);
+      return &optimized_plans_.front();
+    }
+  }
+  return nullptr;
+}
+
+size_t ProfilingGraphExecutorImpl::countMiss(const Stack& stack) {
+  std::ostringstream signature;
+  for (const auto& input : last(stack, num_inputs)) {
+    if (input.isTensor()) {
+      const auto& tensor = input.toTensor();
+      signature << *tensorTypeInCurrentExecutionContext(tensor);
+      if (tensor.defined()) {
+        signature << tensor.device();
+      }
+    }
+    signature << ";";
+  }
+  if (misses_by_signature_.size() >= kMaxMissedSignatures) {
+    misses_by_signature_.clear();
+  }
+  return ++misses_by_signature_[signature.str()];
+}
+
+void ProfilingGraphExecutorImpl::addPlan(SpecializedPlan plan) {
+  size_t max_size = std::max<size_t>(getProfilingPlanCacheSize(), 1);
+  while (optimized_plans_.size() >= max_size) {
+    // keep counting the bailouts of the plans we drop
+    stats_.bailouts += optimized_plans_.back().plan.code.num_bailouts();
+    stats_.plan_cache_evictions++;
+    optimized_plans_.pop_back();
+  }
+  optimized_plans_.push_front(std::move(plan));
+}
+
 ExecutionPlan ProfilingGraphExecutorImpl::getPlanFor(Stack& stack) {
   std::lock_guard<std::mutex> lock(compile_mutex);
   GRAPH_DEBUG("Running ProfilingGraphExecutorImpl ", this);
 
-  if (optimized_plan_) {
-    return *optimized_plan_;
-  }
-
   // simple executor
   if (!getProfilingMode()) {
-    auto copy = graph->copy();
-    runProfilingInsensitiveOptimizations(copy);
-    GRAPH_DUMP("Optimized SimpleExecutor Graph : ", copy);
-    optimized_plan_ = ExecutionPlan(copy);
-    return *optimized_plan_;
+    if (optimized_plans_.empty()) {
+      auto copy = graph->copy();
+      runProfilingInsensitiveOptimizations(copy);
+      GRAPH_DUMP("Optimized SimpleExecutor Graph : ", copy);
+      // no input types, this plan runs whatever the inputs
+      optimized_plans_.push_front(SpecializedPlan{
+          std::vector<TensorTypePtr>(num_inputs), ExecutionPlan(copy)});
+    }
+    return optimized_plans_.front().plan;
+  }
+
+  if (auto specialized = findPlan(stack)) {
+    stats_.plan_cache_hits++;
+    return specialized->plan;
+  }
+  stats_.plan_cache_misses++;
+
+  // a profiling run has completed, specialize a plan for what it recorded
+  if (pr_ && pr_->ready()) {
+    auto copy = pr_->graph()->copy();
+    auto input_types = profiledInputTypes(*copy);
+    runProfilingOptimizations(copy);
+    addPlan(SpecializedPlan{std::move(input_types), ExecutionPlan(copy)});
+    pr_.reset();
+    profiling_plan_.reset();
+    if (auto specialized = findPlan(stack)) {
+      return specialized->plan;
+    }
   }
 
   // if a profiling graph hasn't been created yet
-  if (!pr_) {
+  if (!pr_ &&
+      (optimized_plans_.empty() ||
+       countMiss(stack) >= kMissesBeforeProfiling)) {
     auto copy = graph->copy();
     runProfilingInsensitiveOptimizations(copy);
     pr_ = ProfilingRecord::instrumentGraph(copy);
     auto pr_copy = pr_->graph()->copy();
     GRAPH_DUMP("Profiled Graph: ", pr_copy);
     profiling_plan_ = ExecutionPlan(pr_copy);
-    // fall-through
+    misses_by_signature_.clear();
   }
 
   // profile until a graph is ready
-  if (!pr_->ready()) {
+  if (pr_) {
     return *profiling_plan_;
   }
-
-  auto copy = pr_->graph()->copy();
-  runProfilingOptimizations(copy);
-  // cache
-  optimized_plan_ = ExecutionPlan(copy);
-  return *optimized_plan_;
+  return optimized_plans_.front().plan;
 }
 
 GraphExecutorState ProfilingGraphExecutorImpl::getDebugState() {
+  std::lock_guard<std::mutex> lock(compile_mutex);
   GraphExecutorState state;
-  TORCH_INTERNAL_ASSERT(optimized_plan_);
-  auto opt_plan = *optimized_plan_;
+  TORCH_INTERNAL_ASSERT(!optimized_plans_.empty());
+  // the most recently used plan
+  auto opt_plan = optimized_plans_.front().plan;
   state.execution_plans.emplace(ArgumentSpec{0, 0}, opt_plan);
+  state.stats = stats_;
+  for (const auto& specialized : optimized_plans_) {
+    state.stats.bailouts += specialized.plan.code.num_bailouts();
+  }
   return state;
 }
 
@@ -1,6 +1,10 @@
 #pragma once
 #include <torch/csrc/jit/graph_executor_impl.h>
 
+#include <list>
+#include <string>
+#include <unordered_map>
+
 namespace torch {
 namespace jit {
 
@@ -12,12 +16,30 @@ struct ProfilingGraphExecutorImpl : public GraphExecutorImplBase {
   ~ProfilingGraphExecutorImpl() override = default;
 
  private:
+  // An optimized plan together with the types of the graph inputs observed
+  // while profiling it. A nullptr type matches any input.
+  struct SpecializedPlan {
+    std::vector<TensorTypePtr> input_types;
+    ExecutionPlan plan;
+  };
+
   void runProfilingInsensitiveOptimizations(std::shared_ptr<Graph>& graph);
   void runProfilingOptimizations(std::shared_ptr<Graph>& graph);
+  std::vector<TensorTypePtr> profiledInputTypes(const Graph& profiled_graph);
+  SpecializedPlan* findPlan(const Stack& stack);
+  void addPlan(SpecializedPlan plan);
+  // Counts a plan cache miss, returns the misses of the input signature of
+  // stack since we last started profiling.
+  size_t countMiss(const Stack& stack);
   std::unique_ptr<ProfilingRecord> pr_;
   c10::optional<ExecutionPlan>
       profiling_plan_; // plan to run in order to profiling the code
-  c10::optional<ExecutionPlan> optimized_plan_;
+  // most recently used first
+  std::list<SpecializedPlan> optimized_plans_;
+  // misses since we last started profiling by input signature, see
+  // NOTE [ Profiling Executor Plan Cache ]
+  std::unordered_map<std::string, size_t> misses_by_signature_;
+  GraphExecutorStats stats_;
 };
 
 } // namespace jit
@@ -1,6 +1,16 @@
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <random>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
+
+#include <pthread.h>
 
 #include <TH/TH.h>
 #include <libshm/err.h>
@@ -124,3 +134,310 @@ at::DataPtr THManagedMapAllocator::makeDataPtr(const char* manager_handle, const
 THManagedMapAllocator* THManagedMapAllocator::fromDataPtr(const at::DataPtr& dptr) {
   return dptr.cast_context<THManagedMapAllocator>(&deleteTHManagedMapAllocator);
 }
+
+// Pooled shared memory arenas
+//
+// Each arena is a single managed shared memory segment split into slots of
+// one size class.  The first TH_ALLOC_ALIGNMENT bytes of every slot hold its
+// cross-process refcount, the rest is storage data.  Only the process that
+// created an arena hands out its slots; other processes merely attach to
+// slots they receive.  A slot whose refcount drops to zero in the owner is
+// returned to the free list right away, while slots released by other
+// processes are reclaimed lazily, the next time the owner runs out of free
+// slots in that arena.
+//
+// Ownership is tied to the creating pid.  A forked child inherits the
+// parent's mappings but must never hand out the parent's slots, so the pool
+// is replaced with an empty one in a pthread_atfork child handler, arenas
+// inherited from the parent turn attach-only, and slots inherited through
+// fork (which the child never took a reference on) aren't released by it.
+
+namespace {
+
+constexpr ptrdiff_t kSlotHeaderSize = 64;
+constexpr ptrdiff_t kMinSlotSize = 4096;         // 4KB
+constexpr ptrdiff_t kMaxSlotSize = 4194304;      // 4MB
+constexpr ptrdiff_t kMinArenaSize = 33554432;    // 32MB
+// Number of attached arenas kept mapped after their last slot is released,
+// so that a consumer receiving a steady stream of storages doesn't remap the
+// same arenas over and over again.
+constexpr size_t kAttachedArenaCacheSize = 16;
+
+struct SlotHeader {
+  std::atomic<int> refcount;
+};
+
+ptrdiff_t slot_size_for(ptrdiff_t size) {
+  ptrdiff_t slot_size = kMinSlotSize;
+  while (slot_size < size + kSlotHeaderSize) {
+    slot_size *= 2;
+  }
+  return slot_size;
+}
+
+// Both the owner and the attaching process derive the arena size from the
+// slot size, so it never has to be sent along with the handle.
+ptrdiff_t arena_size_for(ptrdiff_t slot_size) {
+  return std::max(kMinArenaSize, slot_size);
+}
+
+std::string new_arena_handle() {
+  static std::random_device rd;
+  std::string handle = "/torch_arena_";
+  handle += std::to_string(getpid());
+  handle += "_";
+  handle += std::to_string(rd());
+  return handle;
+}
+
+} // namespace
+
+class THManagedArena {
+public:
+  THManagedArena(const char* manager_handle, const char* filename, int flags, ptrdiff_t slot_size)
+    : segment_(manager_handle, filename, flags, arena_size_for(slot_size)),
+      slot_size_(slot_size),
+      owner_pid_((flags & TH_ALLOCATOR_MAPPED_EXCLUSIVE) ? getpid() : 0) {
+    if (owned()) {
+      ptrdiff_t num_slots = arena_size_for(slot_size_) / slot_size_;
+      in_use_.assign(num_slots, false);
+      free_slots_.reserve(num_slots);
+      for (ptrdiff_t i = num_slots - 1; i >= 0; i--) {
+        new (&header(i * slot_size_)->refcount) std::atomic<int>(0);
+        free_slots_.push_back(i * slot_size_);
+      }
+    }
+  }
+
+  const char* manager_handle() const { return segment_.manager_handle(); }
+  const char* filename() const { return segment_.filename(); }
+  ptrdiff_t slot_size() const { return slot_size_; }
+  bool owned() const { return owner_pid_ != 0 && owner_pid_ == getpid(); }
+
+  bool contains(ptrdiff_t offset) const {
+    return offset >= 0 && offset % slot_size_ == 0 &&
+           offset < arena_size_for(slot_size_);
+  }
+
+  SlotHeader* header(ptrdiff_t offset) const {
+    return reinterpret_cast<SlotHeader*>(static_cast<char*>(segment_.data()) + offset);
+  }
+
+  void* slot_data(ptrdiff_t offset) const {
+    return static_cast<char*>(segment_.data()) + offset + kSlotHeaderSize;
+  }
+
+  // The following methods are only used on owned arenas, and have to be
+  // called with the pool mutex held.
+  bool acquire(ptrdiff_t* offset) {
+    if (free_slots_.empty()) {
+      reclaim();
+    }
+    if (free_slots_.empty()) {
+      return false;
+    }
+    *offset = free_slots_.back();
+    free_slots_.pop_back();
+    in_use_[*offset / slot_size_] = true;
+    header(*offset)->refcount.store(1);
+    return true;
+  }
+
+  void release(ptrdiff_t offset) {
+    if (--header(offset)->refcount == 0) {
+      in_use_[offset / slot_size_] = false;
+      free_slots_.push_back(offset);
+    }
+  }
+
+private:
+  // Picks up slots whose last reference was dropped by another process.
+  void reclaim() {
+    for (size_t i = 0; i < in_use_.size(); i++) {
+      ptrdiff_t offset = i * slot_size_;
+      if (in_use_[i] && header(offset)->refcount.load() == 0) {
+        in_use_[i] = false;
+        free_slots_.push_back(offset);
+      }
+    }
+  }
+
+  THManagedMapAllocator segment_;
+  ptrdiff_t slot_size_;
+  pid_t owner_pid_;
+  std::vector<bool> in_use_;
+  std::vector<ptrdiff_t> free_slots_;
+};
+
+namespace {
+
+class ArenaPool {
+public:
+  std::pair<std::shared_ptr<THManagedArena>, ptrdiff_t> allocate(ptrdiff_t size) {
+    ptrdiff_t slot_size = slot_size_for(size);
+    ptrdiff_t offset;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& arenas = owned_arenas_[slot_size];
+    for (auto& arena : arenas) {
+      if (arena->acquire(&offset)) {
+        return {arena, offset};
+      }
+    }
+    int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_EXCLUSIVE;
+    auto arena = std::make_shared<THManagedArena>(
+        "", new_arena_handle().c_str(), flags, slot_size);
+    arenas.push_back(arena);
+    arenas_by_handle_[arena->filename()] = arena;
+    bool acquired = arena->acquire(&offset);
+    AT_ASSERT(acquired);
+    return {arena, offset};
+  }
+
+  std::shared_ptr<THManagedArena> attach(const char* manager_handle, const char* arena_handle, ptrdiff_t size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto arena = arenas_by_handle_[arena_handle].lock();
+    if (!arena) {
+      int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_NOCREATE;
+      arena = std::make_shared<THManagedArena>(
+          manager_handle, arena_handle, flags, slot_size_for(size));
+      arenas_by_handle_[arena_handle] = arena;
+    }
+    if (!arena->owned()) {
+      auto it = std::find(recently_attached_.begin(), recently_attached_.end(), arena);
+      if (it != recently_attached_.end()) {
+        recently_attached_.erase(it);
+      } else if (recently_attached_.size() == kAttachedArenaCacheSize) {
+        recently_attached_.pop_back();
+        forget_unmapped_arenas();
+      }
+      recently_attached_.push_front(arena);
+    }
+    return arena;
+  }
+
+  void release(THManagedArena& arena, ptrdiff_t offset) {
+    if (!arena.owned()) {
+      --arena.header(offset)->refcount;
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    arena.release(offset);
+  }
+
+private:
+  void forget_unmapped_arenas() {
+    for (auto it = arenas_by_handle_.begin(); it != arenas_by_handle_.end();) {
+      if (it->second.expired()) {
+        it = arenas_by_handle_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  // Arenas created by this process, grouped by slot size.  They stay mapped
+  // for the lifetime of the process and the manager unlinks them once every
+  // process that used them has exited.
+  std::map<ptrdiff_t, std::vector<std::shared_ptr<THManagedArena>>> owned_arenas_;
+  std::unordered_map<std::string, std::weak_ptr<THManagedArena>> arenas_by_handle_;
+  std::deque<std::shared_ptr<THManagedArena>> recently_attached_;
+};
+
+ArenaPool* pool_instance = nullptr;
+
+// The child of a fork starts with a fresh pool.  The old one is leaked on
+// purpose: its mutex may have been held by another parent thread at the time
+// of the fork, and storages inherited by the child still point to its arenas.
+void reset_arena_pool_in_child() {
+  pool_instance = new ArenaPool();
+}
+
+// Intentionally leaked: arenas have to outlive the manager sockets, which are
+// torn down during static destruction.
+ArenaPool& arena_pool() {
+  static bool initialized = [] {
+    pool_instance = new ArenaPool();
+    pthread_atfork(nullptr, nullptr, &reset_arena_pool_in_child);
+    return true;
+  }();
+  (void)initialized;
+  return *pool_instance;
+}
+
+} // namespace
+
+THManagedArenaSlot::THManagedArenaSlot(std::shared_ptr<THManagedArena> arena, ptrdiff_t offset)
+  : arena_(std::move(arena)), offset_(offset), pid_(getpid()) {}
+
+THManagedArenaSlot::~THManagedArenaSlot() {
+  // A copy inherited through fork holds no reference of its own
+  if (pid_ == getpid()) {
+    arena_pool().release(*arena_, offset_);
+  }
+}
+
+bool THManagedArenaSlot::canAllocate(ptrdiff_t size) {
+  return size + kSlotHeaderSize <= kMaxSlotSize;
+}
+
+static void deleteTHManagedArenaSlot(void* ptr) {
+  delete static_cast<THManagedArenaSlot*>(ptr);
+}
+
+at::DataPtr THManagedArenaSlot::makeDataPtr(ptrdiff_t size) {
+  if (!canAllocate(size)) {
+    THError("storage of %td bytes is too large for a shared memory arena", size);
+  }
+  std::shared_ptr<THManagedArena> arena;
+  ptrdiff_t offset;
+  try {
+    std::tie(arena, offset) = arena_pool().allocate(size);
+  } catch(std::exception &e) {
+    THError(e.what());
+  }
+  auto* context = new THManagedArenaSlot(std::move(arena), offset);
+  return {context->data(), context, &deleteTHManagedArenaSlot, at::DeviceType::CPU};
+}
+
+at::DataPtr THManagedArenaSlot::makeDataPtr(const char* manager_handle, const char* arena_handle, ptrdiff_t offset, ptrdiff_t size) {
+  if (!canAllocate(size)) {
+    THError("storage of %td bytes can't live in a shared memory arena", size);
+  }
+  std::shared_ptr<THManagedArena> arena;
+  try {
+    arena = arena_pool().attach(manager_handle, arena_handle, size);
+  } catch(std::exception &e) {
+    THError(e.what());
+  }
+  if (!arena->contains(offset)) {
+    THError("invalid offset %td into shared memory arena %s", offset, arena_handle);
+  }
+  ++arena->header(offset)->refcount;
+  auto* context = new THManagedArenaSlot(std::move(arena), offset);
+  return {context->data(), context, &deleteTHManagedArenaSlot, at::DeviceType::CPU};
+}
+
+THManagedArenaSlot* THManagedArenaSlot::fromDataPtr(const at::DataPtr& dptr) {
+  return dptr.cast_context<THManagedArenaSlot>(&deleteTHManagedArenaSlot);
+}
+
+const char* THManagedArenaSlot::manager_handle() const {
+  return arena_->manager_handle();
+}
+
+const char* THManagedArenaSlot::arena_handle() const {
+  return arena_->filename();
+}
+
+void* THManagedArenaSlot::data() const {
+  return arena_->slot_data(offset_);
+}
+
+void THManagedArenaSlot::incref() {
+  ++arena_->header(offset_)->refcount;
+}
+
+int THManagedArenaSlot::decref() {
+  return --arena_->header(offset_)->refcount == 0;
+}
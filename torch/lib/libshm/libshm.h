@@ -4,6 +4,9 @@
 
 #ifdef __cplusplus
 
+#include <memory>
+#include <sys/types.h>
+
 void libshm_init(const char *manager_exec_path);
 
 // Superclass to run a constructor before THRefcountedMapAllocator
@@ -30,4 +33,42 @@ public:
   const char* manager_handle() const { return manager_handle_.c_str(); }
 };
 
+class THManagedArena;
+
+// A slot carved out of a pooled shared memory arena.  Every process keeps a
+// set of large, pre-mapped arenas (one slab per size class) that are
+// registered with the shared memory manager like any other allocation.
+// Storages placed in a slot are shared as an (arena, offset) handle, so the
+// receiving process maps each arena once instead of calling shm_open/mmap for
+// every storage.  Slots are refcounted across processes and recycled by the
+// process that owns the arena once every user has released them.
+class THManagedArenaSlot {
+public:
+  ~THManagedArenaSlot();
+
+  // Returns true if a storage of `size` bytes fits into a pooled slot.
+  static bool canAllocate(ptrdiff_t size);
+  // Allocates a fresh slot in one of the arenas owned by this process.
+  static at::DataPtr makeDataPtr(ptrdiff_t size);
+  // Attaches to a slot of an arena created by (possibly) another process.
+  static at::DataPtr makeDataPtr(const char* manager_handle, const char* arena_handle, ptrdiff_t offset, ptrdiff_t size);
+  static THManagedArenaSlot* fromDataPtr(const at::DataPtr&);
+
+  const char* manager_handle() const;
+  const char* arena_handle() const;
+  ptrdiff_t offset() const { return offset_; }
+  void* data() const;
+
+  void incref();
+  int decref();
+
+private:
+  THManagedArenaSlot(std::shared_ptr<THManagedArena> arena, ptrdiff_t offset);
+
+  std::shared_ptr<THManagedArena> arena_;
+  ptrdiff_t offset_;
+  // Process that took the reference held by this slot
+  pid_t pid_;
+};
+
 #endif
@@ -21,3 +21,11 @@ at::DataPtr THManagedMapAllocator::makeDataPtr(const char* manager_handle, const
 THManagedMapAllocator* THManagedMapAllocator::fromDataPtr(const at::DataPtr& dptr) {
   return dptr.cast_context<THManagedMapAllocator>(&deleteTHManagedMapAllocator);
 }
+
+at::DataPtr THManagedArenaSlot::makeDataPtr(ptrdiff_t size) {
+  AT_ERROR("shared memory arenas are not supported on Windows");
+}
+
+at::DataPtr THManagedArenaSlot::makeDataPtr(const char* manager_handle, const char* arena_handle, ptrdiff_t offset, ptrdiff_t size) {
+  AT_ERROR("shared memory arenas are not supported on Windows");
+}
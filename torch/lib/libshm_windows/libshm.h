@@ -23,4 +23,21 @@ public:
   const char* manager_handle() const { return "no_manager"; }
 };
 
+// Pooled shared memory arenas are not supported on Windows, canAllocate()
+// always returns false so every storage gets a mapping of its own.
+class SHM_API THManagedArenaSlot {
+public:
+  static bool canAllocate(ptrdiff_t size) { return false; }
+  static at::DataPtr makeDataPtr(ptrdiff_t size);
+  static at::DataPtr makeDataPtr(const char* manager_handle, const char* arena_handle, ptrdiff_t offset, ptrdiff_t size);
+  static THManagedArenaSlot* fromDataPtr(const at::DataPtr&) { return nullptr; }
+
+  const char* manager_handle() const { return "no_manager"; }
+  const char* arena_handle() const { return ""; }
+  ptrdiff_t offset() const { return 0; }
+
+  void incref() {}
+  int decref() { return 0; }
+};
+
 #endif
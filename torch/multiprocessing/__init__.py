@@ -45,12 +45,15 @@ them. This depends `mp.get_context` which was added in Python 3.4."""
 from .spawn import spawn, SpawnContext, _supports_context, start_processes, ProcessContext
 
 
-if sys.platform == 'darwin' or sys.platform == 'win32':
+if sys.platform == 'win32':
     _sharing_strategy = 'file_system'
     _all_sharing_strategies = {'file_system'}
+elif sys.platform == 'darwin':
+    _sharing_strategy = 'file_system'
+    _all_sharing_strategies = {'file_system', 'file_system_pool'}
 else:
     _sharing_strategy = 'file_descriptor'
-    _all_sharing_strategies = {'file_descriptor', 'file_system'}
+    _all_sharing_strategies = {'file_descriptor', 'file_system', 'file_system_pool'}
 
 
 def set_sharing_strategy(new_strategy):
@@ -303,12 +303,18 @@ def rebuild_storage_fd(cls, df, size):
         os.close(fd)
 
 
-def rebuild_storage_filename(cls, manager, handle, size):
-    storage = storage_from_cache(cls, handle)
+def rebuild_storage_filename(cls, manager, handle, size, offset=None):
+    # Storages allocated from a pooled arena share their handle with all the
+    # other storages in that arena, and are told apart by their offset.
+    cache_key = handle if offset is None else (handle, offset)
+    storage = storage_from_cache(cls, cache_key)
     if storage is not None:
         return storage._shared_decref()
-    storage = cls._new_shared_filename(manager, handle, size)
-    shared_cache[handle] = StorageWeakRef(storage)
+    if offset is None:
+        storage = cls._new_shared_filename(manager, handle, size)
+    else:
+        storage = cls._new_shared_filename(manager, handle, size, offset)
+    shared_cache[cache_key] = StorageWeakRef(storage)
     return storage._shared_decref()
 
 
@@ -320,9 +326,9 @@ def reduce_storage(storage):
     from . import get_sharing_strategy
     if storage.is_cuda:
         raise RuntimeError("Cannot pickle CUDA storage; try pickling a CUDA tensor instead")
-    elif get_sharing_strategy() == 'file_system':
-        metadata = storage._share_filename_()
-        cache_key = metadata[1]
+    elif get_sharing_strategy() in ('file_system', 'file_system_pool'):
+        metadata = storage._share_filename_(get_sharing_strategy() == 'file_system_pool')
+        cache_key = metadata[1] if len(metadata) == 3 else (metadata[1], metadata[3])
         rebuild = rebuild_storage_filename
         storage._shared_incref()
     elif storage.size() == 0:
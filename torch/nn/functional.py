@@ -2025,6 +2025,10 @@ def cross_entropy(input, target, weight=None, size_average=None, ignore_index=-1
     """
     if size_average is not None or reduce is not None:
         reduction = _Reduction.legacy_get_string(size_average, reduce)
+    if input.dim() == 2 and target.dim() == 1:
+        # Uses a fused kernel that doesn't materialize the log-probabilities
+        # on CPU, and log_softmax followed by nll_loss on other backends
+        return torch._C._nn._log_softmax_nll_loss(input, target, weight, _Reduction.get_enum(reduction), ignore_index)
     return nll_loss(log_softmax(input, 1), target, weight, None, ignore_index, None, reduction)
 
 
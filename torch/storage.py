@@ -114,6 +114,8 @@ class _StorageBase(object):
             pass  # CUDA doesn't use POSIX shared memory
         elif get_sharing_strategy() == 'file_system':
             self._share_filename_()
+        elif get_sharing_strategy() == 'file_system_pool':
+            self._share_filename_(True)
         else:
             self._share_fd_()
         return self
@@ -126,6 +128,8 @@ class _StorageBase(object):
             return cls(size)
         elif get_sharing_strategy() == 'file_system':
             return cls._new_using_filename(size)
+        elif get_sharing_strategy() == 'file_system_pool':
+            return cls._new_using_filename(size, True)
         else:
             return cls._new_using_fd(size)
 
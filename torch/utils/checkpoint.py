@@ -218,3 +218,100 @@ def checkpoint_sequential(functions, segments, input, **kwargs):
         input = checkpoint(run_function(start, end, functions), input,
                            preserve_rng_state=preserve)
     return run_function(end + 1, len(functions) - 1, functions)(input)
+
+
+class CheckpointPlanner(object):
+    r"""Runs functions as checkpoint segments, and chooses which of them to
+    recompute in the backward pass given a memory budget.
+
+    Unlike :func:`~torch.utils.checkpoint.checkpoint`, segments run with
+    gradient calculation enabled, and record the activations they save for
+    backward. Once the forward pass is done, :meth:`plan` drops the saved
+    activations of the segments that free the most memory per time spent
+    recomputing them, until the activations still held fit in the budget.
+    When the backward pass needs a dropped activation, its segment is run
+    again, with the CPU RNG state of the forward pass, and the activations it
+    saves are handed over to the original autograd graph. The backward pass
+    itself is not re-entered, so this works with :func:`torch.autograd.grad`
+    as well.
+
+    The inputs of a segment, which include the activations passed from one
+    segment to the next, are never dropped, so segments should be made of
+    several operations (e.g. a block of layers).
+
+    .. warning::
+        The functions must do the same computation when they are run again,
+        and must not modify their inputs in-place afterwards. Side effects,
+        e.g. updates of the running statistics of batch norm layers, happen
+        again when a segment is recomputed. The CUDA RNG state is not
+        restored.
+
+    Example:
+        >>> planner = CheckpointPlanner()
+        >>> for block in model.blocks:
+        ...     input = planner.run(block, input)
+        >>> planner.plan(memory_budget)
+        >>> loss_fn(input).backward()
+    """
+
+    def __init__(self):
+        self._planner = torch.autograd._CheckpointPlanner()
+
+    def run(self, function, *args):
+        r"""Runs ``function(*args)`` as a checkpoint segment. The arguments and
+        results of the function must be Tensors."""
+        returns_tensor = []
+
+        def run_function(inputs):
+            outputs = function(*inputs)
+            if isinstance(outputs, torch.Tensor):
+                returns_tensor.append(True)
+                return [outputs]
+            return list(outputs)
+
+        outputs = self._planner.run_segment(run_function, list(args))
+        return outputs[0] if returns_tensor else tuple(outputs)
+
+    def plan(self, memory_budget):
+        r"""Drops the saved activations of the segments run so far until they
+        hold at most :attr:`memory_budget` bytes, or until only the last
+        segment is left. Returns the number of bytes still held."""
+        return self._planner.plan(memory_budget)
+
+    def saved_bytes(self):
+        r"""Returns the number of bytes held by the saved activations of the
+        segments run so far."""
+        return self._planner.saved_bytes()
+
+
+def checkpoint_sequential_with_budget(functions, memory_budget, input):
+    r"""A helper function for checkpointing sequential models under a memory
+    budget.
+
+    Runs each of :attr:`functions` as a segment of a
+    :class:`~torch.utils.checkpoint.CheckpointPlanner`, and lets it choose
+    which segments to recompute in the backward pass so that the activations
+    saved for backward hold at most :attr:`memory_budget` bytes.
+
+    Args:
+        functions: A :class:`torch.nn.Sequential` or the list of modules or
+            functions (comprising the model) to run sequentially. Each one
+            should be made of several operations, e.g. a block of layers.
+        memory_budget: Number of bytes the saved activations may hold
+        input: A Tensor that is input to :attr:`functions`
+
+    Returns:
+        Output of running :attr:`functions` sequentially on :attr:`input`
+
+    Example:
+        >>> model = nn.Sequential(...)
+        >>> output = checkpoint_sequential_with_budget(model, 2 ** 30, input)
+    """
+    if isinstance(functions, torch.nn.Sequential):
+        functions = list(functions.children())
+
+    planner = CheckpointPlanner()
+    for function in functions:
+        input = planner.run(function, input)
+    planner.plan(memory_budget)
+    return input